@@ -0,0 +1,275 @@
+#include <QApplication>
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStandardPaths>
+#include <QTextStream>
+#include <QUrl>
+
+#include <katebuffer.h>
+#include <katedocument.h>
+
+static constexpr int lines = 100000;
+static constexpr int edits = 20;
+
+// one block of typical code per syntax definition, repeated with varying identifiers
+struct Corpus {
+    QString name;
+    QString mode;
+    QString block;
+    // edit that switches the highlighting context of the rest of the line, e.g. opens a string
+    QString contextEdit;
+};
+
+static const Corpus generatedCorpora[] = {
+    {QStringLiteral("cpp"),
+     QStringLiteral("C++"),
+     QStringLiteral("/**\n * Compute value %1.\n */\nint compute%1(const std::vector<int> &values)\n{\n    int sum = 0; // running sum\n"
+                    "    for (int v : values) {\n        if (v > %1) {\n            sum += v * 0x%1;\n        }\n    }\n"
+                    "    printf(\"%d %s\\n\", sum, \"value%1\");\n    return sum;\n}\n"),
+     QStringLiteral("\"")},
+    {QStringLiteral("python"),
+     QStringLiteral("Python"),
+     QStringLiteral("class Value%1(Base):\n    \"\"\"Value number %1.\"\"\"\n\n    def compute(self, values):\n        # running sum\n"
+                    "        total = 0\n        for v in values:\n            if v > %1:\n                total += v * 0x%1\n"
+                    "        return f\"{total} value%1\"\n\n"),
+     QStringLiteral("\"\"\"")},
+    {QStringLiteral("javascript"),
+     QStringLiteral("JavaScript"),
+     QStringLiteral("// value %1\nfunction compute%1(values) {\n    let sum = 0;\n    for (const v of values) {\n        if (v > %1) {\n"
+                    "            sum += v * 0x%1;\n        }\n    }\n    return `${sum} value%1`.replace(/value/g, 'v');\n}\n"),
+     QStringLiteral("/*")},
+    {QStringLiteral("xml"),
+     QStringLiteral("XML"),
+     QStringLiteral("<!-- value %1 -->\n<item id=\"%1\" type=\"value\">\n    <name>value%1</name>\n    <values>\n        <value>%1</value>\n"
+                    "        <value><![CDATA[ <%1> ]]></value>\n    </values>\n</item>\n"),
+     QStringLiteral("<!--")},
+    {QStringLiteral("markdown"),
+     QStringLiteral("Markdown"),
+     QStringLiteral("## Value %1\n\nSome *emphasized* and **strong** text about `value%1`, see [link](https://kde.org/%1).\n\n"
+                    "- first item\n- second item\n\n```cpp\nint value%1 = %1;\n```\n\n"),
+     QStringLiteral("```\n")},
+    {QStringLiteral("bash"),
+     QStringLiteral("Bash"),
+     QStringLiteral("# value %1\ncompute_%1() {\n    local sum=0\n    for v in \"$@\"; do\n        if [ \"$v\" -gt %1 ]; then\n"
+                    "            sum=$((sum + v))\n        fi\n    done\n    cat <<EOF\n$sum value%1\nEOF\n}\n"),
+     QStringLiteral("'")},
+};
+
+struct Result {
+    QString name;
+    QString mode;
+    int lines = 0;
+    double fullHighlight = 0;
+    double folding = 0;
+    int foldingRanges = 0;
+    double attributeMapping = 0;
+    int stateChanges = 0;
+    double editTop = 0;
+    double editMiddle = 0;
+    double editBottom = 0;
+    double contextEditTop = 0;
+    double contextEditMiddle = 0;
+    double contextEditBottom = 0;
+};
+
+static double elapsedMs(const QElapsedTimer &t)
+{
+    return t.nsecsElapsed() / 1000000.0;
+}
+
+// average cost of one edit at the given line and the re-highlighting needed afterwards
+static double benchEdit(KTextEditor::DocumentPrivate &doc, int line, const QString &text)
+{
+    KateBuffer &buffer = doc.buffer();
+    double total = 0;
+    for (int i = 0; i < edits; ++i) {
+        QElapsedTimer t;
+        t.start();
+        doc.insertText({line, 0}, text);
+        buffer.ensureHighlighted(doc.lines() - 1, 0);
+        total += elapsedMs(t);
+
+        doc.undo();
+        buffer.ensureHighlighted(doc.lines() - 1, 0);
+    }
+    return total / edits;
+}
+
+static Result benchDocument(KTextEditor::DocumentPrivate &doc, const QString &name, const QString &contextEdit)
+{
+    Result r;
+    r.name = name;
+    r.mode = doc.highlightingMode();
+    r.lines = doc.lines();
+
+    KateBuffer &buffer = doc.buffer();
+    const int lastLine = doc.lines() - 1;
+
+    // everything from scratch
+    buffer.invalidateHighlighting();
+    QElapsedTimer t;
+    t.start();
+    buffer.ensureHighlighted(lastLine, 0);
+    r.fullHighlight = elapsedMs(t);
+
+    // line end states that differ from the previous line, these are the context switches that
+    // force re-highlighting of the following lines after an edit
+    for (int line = 1; line <= lastLine; ++line) {
+        if (!(buffer.plainLine(line).highlightingState() == buffer.plainLine(line - 1).highlightingState())) {
+            ++r.stateChanges;
+        }
+    }
+
+    // folding, like the folding markers of the icon border for every line
+    t.restart();
+    for (int line = 0; line <= lastLine; ++line) {
+        r.foldingRanges += buffer.computeFoldingRangeForStartLine(line).isValid();
+    }
+    r.folding = elapsedMs(t);
+
+    // mapping of highlighting attributes to default styles, e.g. for the comment and indentation code
+    t.restart();
+    int styles = 0;
+    for (int line = 0; line <= lastLine; line += 3) {
+        const int length = doc.lineLength(line);
+        for (int column = 0; column < length; column += 4) {
+            styles += int(doc.defaultStyleAt({line, column}));
+        }
+    }
+    r.attributeMapping = elapsedMs(t);
+    Q_UNUSED(styles)
+
+    // incremental re-highlighting, with and without a switch of the context
+    r.editTop = benchEdit(doc, 1, QStringLiteral("x"));
+    r.editMiddle = benchEdit(doc, lastLine / 2, QStringLiteral("x"));
+    r.editBottom = benchEdit(doc, lastLine - 1, QStringLiteral("x"));
+    r.contextEditTop = benchEdit(doc, 1, contextEdit);
+    r.contextEditMiddle = benchEdit(doc, lastLine / 2, contextEdit);
+    r.contextEditBottom = benchEdit(doc, lastLine - 1, contextEdit);
+
+    return r;
+}
+
+static QJsonObject toJson(const Result &r)
+{
+    return QJsonObject{
+        {QStringLiteral("name"), r.name},
+        {QStringLiteral("mode"), r.mode},
+        {QStringLiteral("lines"), r.lines},
+        {QStringLiteral("fullHighlightMs"), r.fullHighlight},
+        {QStringLiteral("foldingMs"), r.folding},
+        {QStringLiteral("foldingRanges"), r.foldingRanges},
+        {QStringLiteral("attributeMappingMs"), r.attributeMapping},
+        {QStringLiteral("stateChanges"), r.stateChanges},
+        {QStringLiteral("editTopMs"), r.editTop},
+        {QStringLiteral("editMiddleMs"), r.editMiddle},
+        {QStringLiteral("editBottomMs"), r.editBottom},
+        {QStringLiteral("contextEditTopMs"), r.contextEditTop},
+        {QStringLiteral("contextEditMiddleMs"), r.contextEditMiddle},
+        {QStringLiteral("contextEditBottomMs"), r.contextEditBottom},
+    };
+}
+
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv);
+    QStandardPaths::setTestModeEnabled(true);
+
+    QCommandLineParser p;
+    p.setApplicationDescription(QStringLiteral("Performance benchmark for syntax highlighting of whole documents"));
+    p.addHelpOption();
+    // number of lines
+    QCommandLineOption iterOpt(QStringLiteral("i"), QStringLiteral("Number of lines of the generated documents"), QStringLiteral("iters"), QStringLiteral("0"));
+    p.addOption(iterOpt);
+    QCommandLineOption jsonOpt(QStringLiteral("json"), QStringLiteral("Write the results as JSON to the given file, - for stdout"), QStringLiteral("file"));
+    p.addOption(jsonOpt);
+    QCommandLineOption modeOpt(QStringLiteral("m"), QStringLiteral("Only benchmark the generated document of the given corpus, e.g. cpp"), QStringLiteral("corpus"));
+    p.addOption(modeOpt);
+    p.addPositionalArgument(QStringLiteral("files"), QStringLiteral("Real world files to benchmark, highlighted with the mode detected for them"));
+
+    p.process(app);
+    bool ok = false;
+    int iters = p.value(iterOpt).toInt(&ok);
+    const int linesInText = ok ? (iters > 0 ? iters : lines) : lines;
+
+    QList<Result> results;
+
+    // generated corpora
+    for (const Corpus &corpus : generatedCorpora) {
+        if (p.isSet(modeOpt) && p.value(modeOpt) != corpus.name) {
+            continue;
+        }
+
+        KTextEditor::DocumentPrivate doc;
+        if (!doc.setHighlightingMode(corpus.mode)) {
+            QTextStream(stderr) << "no syntax definition " << corpus.mode << ", skipped\n";
+            continue;
+        }
+
+        QString text;
+        const int blockLines = corpus.block.count(QLatin1Char('\n'));
+        for (int i = 0; i * blockLines < linesInText; ++i) {
+            text += corpus.block.arg(i);
+        }
+        doc.setText(text);
+        results.append(benchDocument(doc, corpus.name, corpus.contextEdit));
+    }
+
+    // real world files
+    for (const QString &file : p.positionalArguments()) {
+        KTextEditor::DocumentPrivate doc;
+        if (!doc.openUrl(QUrl::fromLocalFile(QFileInfo(file).absoluteFilePath())) || doc.lines() < 3) {
+            QTextStream(stderr) << "can't open " << file << ", skipped\n";
+            continue;
+        }
+        results.append(benchDocument(doc, QFileInfo(file).fileName(), QStringLiteral("\"")));
+    }
+
+    if (p.isSet(jsonOpt)) {
+        QJsonArray documents;
+        for (const Result &r : std::as_const(results)) {
+            documents.append(toJson(r));
+        }
+        const QJsonObject json{
+            {QStringLiteral("benchmark"), QStringLiteral("highlighting")},
+            {QStringLiteral("date"), QDateTime::currentDateTimeUtc().toString(Qt::ISODate)},
+            {QStringLiteral("qtVersion"), QString::fromLatin1(qVersion())},
+            {QStringLiteral("editsPerMeasurement"), edits},
+            {QStringLiteral("documents"), documents},
+        };
+
+        const QString fileName = p.value(jsonOpt);
+        QFile out(fileName);
+        bool opened = false;
+        if (fileName == QLatin1String("-")) {
+            opened = out.open(stdout, QIODevice::WriteOnly);
+        } else {
+            opened = out.open(QIODevice::WriteOnly);
+        }
+        if (!opened) {
+            QTextStream(stderr) << "can't write " << fileName << "\n";
+            return 1;
+        }
+        out.write(QJsonDocument(json).toJson());
+        return 0;
+    }
+
+    QTextStream out(stdout);
+    for (const Result &r : std::as_const(results)) {
+        out << r.name << " (" << r.mode << ", " << r.lines << " lines)\n";
+        out << "  full highlight:    " << r.fullHighlight << " ms, " << r.stateChanges << " context switches\n";
+        out << "  folding:           " << r.folding << " ms, " << r.foldingRanges << " ranges\n";
+        out << "  attribute mapping: " << r.attributeMapping << " ms\n";
+        out << "  edit top/mid/bot:  " << r.editTop << " / " << r.editMiddle << " / " << r.editBottom << " ms\n";
+        out << "  context edit:      " << r.contextEditTop << " / " << r.contextEditMiddle << " / " << r.contextEditBottom << " ms\n";
+    }
+
+    return 0;
+}
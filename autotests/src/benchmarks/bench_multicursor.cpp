@@ -0,0 +1,61 @@
+#include <QApplication>
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
+
+#include <katedocument.h>
+#include <kateview.h>
+
+static constexpr int lines = 25000;
+
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv);
+
+    QCommandLineParser p;
+    p.setApplicationDescription(QStringLiteral("Performance benchmark for typing with many cursors"));
+    p.addHelpOption();
+    // number of lines
+    QCommandLineOption iterOpt(QStringLiteral("i"), QStringLiteral("Number of lines of text, each gets two cursors"), QStringLiteral("iters"), QStringLiteral("0"));
+    p.addOption(iterOpt);
+
+    p.process(app);
+    bool ok = false;
+    int iters = p.value(iterOpt).toInt(&ok);
+    const int linesInText = ok ? (iters > 0 ? iters : lines) : lines;
+
+    KTextEditor::DocumentPrivate doc;
+    KTextEditor::ViewPrivate view(&doc, nullptr);
+
+    QStringList l;
+    l.reserve(linesInText);
+    for (int i = 0; i < linesInText; ++i) {
+        l.append(QStringLiteral("foo bar foo"));
+    }
+    doc.setText(l);
+    view.setCursorPosition({0, 0});
+
+    // select all occurrences of foo, two per line
+    QTextStream out(stdout);
+    QElapsedTimer t;
+    t.start();
+    view.findAllOccuruncesAndSelect();
+    out << "select all: " << t.elapsed() << " ms, " << view.secondaryCursors().size() + 1 << " cursors\n";
+
+    // replace them all and type along
+    t.restart();
+    doc.typeChars(&view, QStringLiteral("b"));
+    out << "replace:    " << t.elapsed() << " ms\n";
+
+    t.restart();
+    for (int i = 0; i < 10; ++i) {
+        doc.typeChars(&view, QStringLiteral("a"));
+    }
+    out << "type 10x:   " << t.elapsed() << " ms, line 0: " << doc.line(0) << "\n";
+
+    t.restart();
+    doc.undo();
+    out << "undo:       " << t.elapsed() << " ms\n";
+    return 0;
+}
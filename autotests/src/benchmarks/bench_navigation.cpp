@@ -0,0 +1,87 @@
+#include <QApplication>
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
+
+#include <katedocument.h>
+#include <kateview.h>
+
+static constexpr int lines = 100000;
+
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv);
+
+    QCommandLineParser p;
+    p.setApplicationDescription(QStringLiteral("Performance benchmark for cursor navigation"));
+    p.addHelpOption();
+    // number of lines
+    QCommandLineOption iterOpt(QStringLiteral("i"), QStringLiteral("Number of lines of text to navigate through"), QStringLiteral("iters"), QStringLiteral("0"));
+    p.addOption(iterOpt);
+
+    p.process(app);
+    bool ok = false;
+    int iters = p.value(iterOpt).toInt(&ok);
+    const int linesInText = ok ? (iters > 0 ? iters : lines) : lines;
+
+    KTextEditor::DocumentPrivate doc;
+    KTextEditor::ViewPrivate view(&doc, nullptr);
+    view.resize(800, 600);
+    view.show();
+    QCoreApplication::processEvents();
+
+    // code like ASCII lines of varying length, with tabs
+    QStringList l;
+    l.reserve(linesInText);
+    for (int i = 0; i < linesInText; ++i) {
+        l.append(QStringLiteral("\tif (value%1 != nullptr) { result += compute(value%1, %2); } // line %1").arg(i).arg(i % 97).left(20 + i % 60));
+    }
+    doc.setText(l);
+    view.setCursorPosition({0, 30});
+    QCoreApplication::processEvents();
+
+    QTextStream out(stdout);
+    QElapsedTimer t;
+
+    // line by line, this needs the geometry of each line to keep the x position
+    t.start();
+    for (int i = 0; i < linesInText - 1; ++i) {
+        view.down();
+    }
+    out << "down:      " << t.elapsed() << " ms, cursor " << view.cursorPosition().line() << ":" << view.cursorPosition().column() << "\n";
+
+    t.restart();
+    for (int i = 0; i < linesInText - 1; ++i) {
+        view.up();
+    }
+    out << "up:        " << t.elapsed() << " ms\n";
+
+    // page wise, lays out lines far away from the visible ones
+    t.restart();
+    while (view.cursorPosition().line() < linesInText - 1) {
+        view.pageDown();
+    }
+    out << "page down: " << t.elapsed() << " ms\n";
+
+    // along the lines
+    t.restart();
+    for (int i = 0; i < linesInText; i += 10) {
+        view.setCursorPosition({i, 0});
+        view.end();
+        view.home();
+    }
+    out << "end/home:  " << t.elapsed() << " ms\n";
+
+    // mouse hit testing
+    t.restart();
+    int hits = 0;
+    for (int i = 0; i < linesInText; i += 10) {
+        view.setCursorPosition({i, 5});
+        const QPoint pos = view.cursorPositionCoordinates();
+        hits += view.coordinatesToCursor(pos + QPoint(40, 0)).isValid();
+    }
+    out << "hit test:  " << t.elapsed() << " ms, " << hits << " hits\n";
+
+    return 0;
+}
@@ -0,0 +1,217 @@
+#include <QApplication>
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QPainter>
+#include <QTextStream>
+
+#include <KTextEditor/InlineNote>
+#include <KTextEditor/InlineNoteProvider>
+#include <KTextEditor/MovingRange>
+#include <katebuffer.h>
+#include <kateconfig.h>
+#include <katedocument.h>
+#include <kateview.h>
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <vector>
+
+static constexpr int lines = 100000;
+static constexpr int frames = 200;
+
+// a note every third line, like inlay hints of a language server
+class NoteProvider : public KTextEditor::InlineNoteProvider
+{
+public:
+    QList<int> inlineNotes(int line) const override
+    {
+        if (line % 3) {
+            return {};
+        }
+        return {4, 20};
+    }
+
+    QSize inlineNoteSize(const KTextEditor::InlineNote &note) const override
+    {
+        return QSize(note.lineHeight() * 3, note.lineHeight());
+    }
+
+    void paintInlineNote(const KTextEditor::InlineNote &note, QPainter &painter, Qt::LayoutDirection) const override
+    {
+        const QRectF rect(0, 0, note.lineHeight() * 3, note.lineHeight());
+        painter.fillRect(rect, QColor(200, 200, 255));
+        painter.drawText(rect, Qt::AlignCenter, QStringLiteral("hint"));
+    }
+};
+
+class FrameStats
+{
+public:
+    void add(qint64 ns)
+    {
+        m_frames.push_back(ns);
+    }
+
+    QString toString()
+    {
+        if (m_frames.empty()) {
+            return QStringLiteral("no frames");
+        }
+        std::sort(m_frames.begin(), m_frames.end());
+        qint64 total = 0;
+        for (qint64 ns : m_frames) {
+            total += ns;
+        }
+        const auto ms = [](qint64 ns) {
+            return QString::number(ns / 1e6, 'f', 2);
+        };
+        return QStringLiteral("avg %1 ms, median %2 ms, p95 %3 ms, max %4 ms, %5 frames")
+            .arg(ms(total / qint64(m_frames.size())),
+                 ms(m_frames[m_frames.size() / 2]),
+                 ms(m_frames[m_frames.size() * 95 / 100]),
+                 ms(m_frames.back()),
+                 QString::number(m_frames.size()));
+    }
+
+private:
+    std::vector<qint64> m_frames;
+};
+
+// paints the whole view like a paint event after the change
+static void renderFrame(KTextEditor::ViewPrivate &view, QImage &image)
+{
+    if (image.size() != view.size()) {
+        image = QImage(view.size(), QImage::Format_ARGB32_Premultiplied);
+    }
+    view.render(&image);
+}
+
+static void benchFrames(const QString &name, KTextEditor::ViewPrivate &view, const std::function<void(int)> &change)
+{
+    QImage image;
+    renderFrame(view, image);
+
+    FrameStats stats;
+    for (int frame = 0; frame < frames; ++frame) {
+        QElapsedTimer t;
+        t.start();
+        change(frame);
+        renderFrame(view, image);
+        stats.add(t.nsecsElapsed());
+    }
+    QTextStream(stdout) << name << ": " << stats.toString() << "\n";
+}
+
+static void benchView(const QString &scenario, KTextEditor::DocumentPrivate &doc, KTextEditor::ViewPrivate &view)
+{
+    for (const bool wrap : {false, true}) {
+        view.config()->setDynWordWrap(wrap);
+        view.resize(1000, 800);
+        view.setCursorPosition({0, 0});
+        view.setScrollPosition({0, 0});
+        QCoreApplication::processEvents();
+
+        const QString name = scenario + (wrap ? QStringLiteral(", dynamic word wrap") : QString());
+        const int linesInText = doc.lines();
+
+        // line by line, then page wise, then jumps through the whole document
+        benchFrames(QStringLiteral("scroll line  (%1)").arg(name), view, [&view](int frame) {
+            view.setScrollPosition({frame, 0});
+        });
+        benchFrames(QStringLiteral("scroll page  (%1)").arg(name), view, [&view](int frame) {
+            view.setScrollPosition({frame * 40, 0});
+        });
+        benchFrames(QStringLiteral("scroll jump  (%1)").arg(name), view, [&view, linesInText](int frame) {
+            view.setScrollPosition({int(qint64(frame) * 7919 % linesInText), 0});
+        });
+
+        // typing in the middle of the visible lines, keeps the selection and the secondary cursors
+        const KTextEditor::Range selection = view.selectionRange();
+        view.clearSelection();
+        view.setCursorPosition({20, 10});
+        benchFrames(QStringLiteral("typing       (%1)").arg(name), view, [&doc, &view](int frame) {
+            doc.typeChars(&view, (frame % 10 == 9) ? QStringLiteral(" ") : QStringLiteral("x"));
+        });
+        doc.undo();
+        if (selection.isValid()) {
+            view.setSelection(selection);
+        }
+
+        benchFrames(QStringLiteral("resize       (%1)").arg(name), view, [&view](int frame) {
+            view.resize(600 + (frame % 20) * 30, 500 + (frame % 7) * 40);
+        });
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    // no window system needed, frames are rendered into an image
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+
+    QCommandLineParser p;
+    p.setApplicationDescription(QStringLiteral("Performance benchmark for rendering of views"));
+    p.addHelpOption();
+    // number of lines
+    QCommandLineOption iterOpt(QStringLiteral("i"), QStringLiteral("Number of lines of text to render"), QStringLiteral("iters"), QStringLiteral("0"));
+    p.addOption(iterOpt);
+
+    p.process(app);
+    bool ok = false;
+    int iters = p.value(iterOpt).toInt(&ok);
+    const int linesInText = ok ? (iters > 0 ? iters : lines) : lines;
+
+    KTextEditor::DocumentPrivate doc;
+    KTextEditor::ViewPrivate view(&doc, nullptr);
+    view.show();
+
+    // heavily highlighted code with long lines that wrap
+    QStringList l;
+    l.reserve(linesInText);
+    for (int i = 0; i < linesInText; ++i) {
+        if (i % 7 == 0) {
+            l.append(QStringLiteral("    // comment %1 with a \"string\" and TODO markers, long enough to be wrapped in a narrow view: %2").arg(i).arg(QString(i % 80, QLatin1Char('x'))));
+        } else {
+            l.append(QStringLiteral("    if (value%1 != nullptr && value%1->isValid()) { result += compute(value%1, 0x%2, \"text %1\", '\\n'); } /* %1 */").arg(i).arg(i % 97));
+        }
+    }
+    doc.setText(l);
+    doc.setHighlightingMode(QStringLiteral("C++"));
+    doc.buffer().ensureHighlighted(doc.lines() - 1, 0);
+
+    benchView(QStringLiteral("plain"), doc, view);
+
+    // attributed moving ranges on every line, like search matches or diagnostics
+    KTextEditor::Attribute::Ptr background(new KTextEditor::Attribute());
+    background->setBackground(QColor(255, 255, 150));
+    KTextEditor::Attribute::Ptr underline(new KTextEditor::Attribute());
+    underline->setUnderlineStyle(QTextCharFormat::SpellCheckUnderline);
+    underline->setUnderlineColor(Qt::red);
+    std::vector<std::unique_ptr<KTextEditor::MovingRange>> ranges;
+    ranges.reserve(2 * linesInText);
+    for (int i = 0; i < linesInText; ++i) {
+        ranges.emplace_back(doc.newMovingRange({i, 8, i, 20}))->setAttribute(background);
+        ranges.emplace_back(doc.newMovingRange({i, 30 + i % 20, i, 45 + i % 20}))->setAttribute(underline);
+    }
+
+    NoteProvider notes;
+    view.registerInlineNoteProvider(&notes);
+
+    // a selection over most of the document and a cursor on every 25th line
+    view.setSelection({{5, 5}, {linesInText - 5, 5}});
+    QList<KTextEditor::Cursor> cursors;
+    for (int i = 25; i < linesInText; i += 25) {
+        cursors.append({i, 10});
+    }
+    view.setSecondaryCursors(cursors);
+
+    benchView(QStringLiteral("decorated"), doc, view);
+
+    view.unregisterInlineNoteProvider(&notes);
+    return 0;
+}
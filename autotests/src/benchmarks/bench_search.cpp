@@ -1,15 +1,56 @@
 #include <QApplication>
 #include <QCommandLineOption>
 #include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
 
 #include <KMainWindow>
 #include <kateconfig.h>
 #include <katedocument.h>
+#include <kateregexpsearch.h>
 #include <katesearchbar.h>
 #include <kateview.h>
 
 static constexpr int lines = 100000;
 
+// multi-line regular expression searches, like find next/previous with the cursor far away from the match
+static void benchMultiLineSearch(KTextEditor::DocumentPrivate &doc)
+{
+    const int lastLine = doc.lines() - 1;
+    const KTextEditor::Range wholeDocument = doc.documentRange();
+    doc.insertText({lastLine - 10, 0}, QStringLiteral("marker"));
+    doc.insertText({10, 0}, QStringLiteral("marker"));
+
+    struct Case {
+        const char *name;
+        QString pattern;
+        KTextEditor::Range range;
+        bool backwards;
+    };
+    const Case cases[] = {
+        {"forward, match at end", QStringLiteral("marker.*\\nThis"), {{20, 0}, wholeDocument.end()}, false},
+        {"backward, match at start", QStringLiteral("marker.*\\nThis"), {{0, 0}, {lastLine - 20, 0}}, true},
+        {"forward, no match", QStringLiteral("nothing\\nThis"), wholeDocument, false},
+        {"backward, no match", QStringLiteral("nothing\\nThis"), wholeDocument, true},
+        {"forward, next line", QStringLiteral("sentence\\.\\nThis"), wholeDocument, false},
+        {"backward, previous line", QStringLiteral("sentence\\.\\nThis"), wholeDocument, true},
+        {"forward, unbounded", QStringLiteral("marker(.*\\n)+marker"), wholeDocument, false},
+    };
+
+    QTextStream out(stdout);
+    KateRegExpSearch searcher(&doc);
+    for (const Case &c : cases) {
+        QElapsedTimer t;
+        t.start();
+        KTextEditor::Range result;
+        for (int i = 0; i < 10; ++i) {
+            result = searcher.search(c.pattern, c.range, c.backwards).at(0);
+        }
+        out << c.name << ": " << t.elapsed() / 10 << " ms, " << result.start().line() << ":" << result.start().column() << "-" << result.end().line() << ":"
+            << result.end().column() << "\n";
+    }
+}
+
 int main(int argc, char *argv[])
 {
     QApplication app(argc, argv);
@@ -23,6 +64,8 @@ int main(int argc, char *argv[])
                                QStringLiteral("iters"),
                                QStringLiteral("0"));
     p.addOption(iterOpt);
+    QCommandLineOption multiLineOpt(QStringLiteral("m"), QStringLiteral("Benchmark multi-line regular expression search instead of find all"));
+    p.addOption(multiLineOpt);
 
     p.process(app);
     bool ok = false;
@@ -45,6 +88,11 @@ int main(int argc, char *argv[])
     }
     doc.setText(l);
 
+    if (p.isSet(multiLineOpt)) {
+        benchMultiLineSearch(doc);
+        return 0;
+    }
+
     QObject::connect(&bar, &KateSearchBar::findOrReplaceAllFinished, [&w]() {
         w->close();
     });
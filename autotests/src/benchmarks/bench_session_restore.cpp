@@ -0,0 +1,95 @@
+#include <QApplication>
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QImage>
+#include <QTemporaryDir>
+#include <QTextStream>
+
+#include <KConfig>
+#include <KConfigGroup>
+#include <katedocument.h>
+#include <kateview.h>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+static constexpr int documents = 500;
+static constexpr int linesPerDocument = 2000;
+
+// restores all documents like an application restoring its session, then shows the last one
+static void benchRestore(const QString &name, KConfig &config, int count, const QSet<QString> &flags)
+{
+    std::vector<std::unique_ptr<KTextEditor::DocumentPrivate>> docs;
+    docs.reserve(count);
+
+    QElapsedTimer t;
+    t.start();
+    for (int i = 0; i < count; ++i) {
+        docs.push_back(std::make_unique<KTextEditor::DocumentPrivate>());
+        docs.back()->readSessionConfig(KConfigGroup(&config, QStringLiteral("Document %1").arg(i)), flags);
+    }
+    const qint64 restored = t.elapsed();
+
+    std::unique_ptr<KTextEditor::View> view(docs.back()->createView(nullptr));
+    view->resize(1000, 800);
+    QImage image(view->size(), QImage::Format_ARGB32_Premultiplied);
+    view->render(&image);
+    const qint64 firstPaint = t.elapsed();
+
+    // the remaining documents come in the background
+    while (std::any_of(docs.cbegin(), docs.cend(), [](const auto &doc) {
+        return doc->isLoadDeferred();
+    })) {
+        QCoreApplication::processEvents();
+    }
+    const qint64 allLoaded = t.elapsed();
+
+    QTextStream(stdout) << name << ": restored " << restored << " ms, first paint " << firstPaint << " ms, all loaded " << allLoaded << " ms\n";
+}
+
+int main(int argc, char *argv[])
+{
+    // no window system needed, the first frame is rendered into an image
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+
+    QCommandLineParser p;
+    p.setApplicationDescription(QStringLiteral("Performance benchmark for restoring sessions"));
+    p.addHelpOption();
+    // number of documents
+    QCommandLineOption iterOpt(QStringLiteral("i"), QStringLiteral("Number of documents to restore"), QStringLiteral("iters"), QStringLiteral("0"));
+    p.addOption(iterOpt);
+
+    p.process(app);
+    bool ok = false;
+    int iters = p.value(iterOpt).toInt(&ok);
+    const int count = ok ? (iters > 0 ? iters : documents) : documents;
+
+    // C++ files with bookmarks, like a session of a bigger project
+    QTemporaryDir dir;
+    KConfig config(QString(), KConfig::SimpleConfig);
+    QByteArray text;
+    for (int i = 0; i < linesPerDocument; ++i) {
+        text += "    if (value != nullptr && value->isValid()) { result += compute(value, 0x" + QByteArray::number(i % 97, 16) + "); } // line\n";
+    }
+    for (int i = 0; i < count; ++i) {
+        const QString fileName = dir.filePath(QStringLiteral("file%1.cpp").arg(i));
+        QFile file(fileName);
+        if (!file.open(QIODevice::WriteOnly) || file.write(text) != text.size()) {
+            return 1;
+        }
+
+        KConfigGroup group(&config, QStringLiteral("Document %1").arg(i));
+        group.writeEntry("URL", QUrl::fromLocalFile(fileName).toString());
+        group.writeEntry("Bookmarks", QList<int>{10, 100, 1000});
+    }
+
+    benchRestore(QStringLiteral("immediate"), config, count, {QStringLiteral("SkipLazyLoad")});
+    benchRestore(QStringLiteral("lazy"), config, count, {});
+    return 0;
+}
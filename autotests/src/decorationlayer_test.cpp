@@ -0,0 +1,153 @@
+/*
+    SPDX-FileCopyrightText: KDE Developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "decorationlayer_test.h"
+
+#include <katebuffer.h>
+#include <katedocument.h>
+#include <ktexteditor/decorationlayer.h>
+
+#include <QStandardPaths>
+#include <QTest>
+
+#include <memory>
+
+using namespace KTextEditor;
+
+QTEST_MAIN(DecorationLayerTest)
+
+DecorationLayerTest::DecorationLayerTest()
+    : QObject()
+{
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+// decorations of a line as ranges, easy to compare
+static QList<Range> decoratedRanges(const DecorationLayer &layer, int line)
+{
+    QList<Range> ranges;
+    for (const Decoration &decoration : layer.decorations(line)) {
+        ranges.append(Range(decoration.line, decoration.column, decoration.line, decoration.column + decoration.length));
+    }
+    return ranges;
+}
+
+void DecorationLayerTest::testSetDecorations()
+{
+    DocumentPrivate doc;
+    doc.setText(QStringLiteral("int foo = bar;\nreturn foo;"));
+
+    std::unique_ptr<DecorationLayer> layer(doc.newDecorationLayer());
+    QCOMPARE(layer->document(), static_cast<Document *>(&doc));
+    QCOMPARE(doc.buffer().decorationLayers().size(), size_t(1));
+
+    Attribute::Ptr variable(new Attribute());
+    variable->setForeground(Qt::red);
+    layer->setAttributes({variable});
+    QCOMPARE(layer->attributes().size(), 1);
+
+    // unsorted input, empty decorations are dropped
+    layer->setDecorations({{1, 7, 3, 0}, {0, 10, 3, 0}, {0, 4, 3, 0}, {0, 0, 0, 0}});
+    QCOMPARE(decoratedRanges(*layer, 0), (QList<Range>{Range(0, 4, 0, 7), Range(0, 10, 0, 13)}));
+    QCOMPARE(decoratedRanges(*layer, 1), (QList<Range>{Range(1, 7, 1, 10)}));
+    QCOMPARE(layer->decorations(1).first().attribute, 0);
+
+    layer->clear();
+    QVERIFY(layer->decorations(0).isEmpty());
+
+    layer.reset();
+    QVERIFY(doc.buffer().decorationLayers().empty());
+}
+
+void DecorationLayerTest::testEditing()
+{
+    DocumentPrivate doc;
+    doc.setText(QStringLiteral("int foo = bar;\nreturn foo;"));
+
+    std::unique_ptr<DecorationLayer> layer(doc.newDecorationLayer());
+    layer->setDecorations({{0, 4, 3, 0}, {0, 10, 3, 0}, {1, 7, 3, 0}});
+
+    // typing in front of a decoration moves it, typing at its end doesn't expand it
+    doc.insertText({0, 0}, QStringLiteral("const "));
+    doc.insertText({0, 13}, QStringLiteral("x"));
+    QCOMPARE(doc.line(0), QStringLiteral("const int foox = bar;"));
+    QCOMPARE(decoratedRanges(*layer, 0), (QList<Range>{Range(0, 10, 0, 13), Range(0, 17, 0, 20)}));
+
+    // wrapping in front of a decoration moves it to the new line, all later lines follow
+    doc.insertText({0, 15}, QStringLiteral("\n"));
+    QCOMPARE(decoratedRanges(*layer, 0), (QList<Range>{Range(0, 10, 0, 13)}));
+    QCOMPARE(decoratedRanges(*layer, 1), (QList<Range>{Range(1, 2, 1, 5)}));
+    QCOMPARE(decoratedRanges(*layer, 2), (QList<Range>{Range(2, 7, 2, 10)}));
+
+    // wrapping inside of a decoration keeps its first part
+    doc.insertText({2, 8}, QStringLiteral("\n"));
+    QCOMPARE(decoratedRanges(*layer, 2), (QList<Range>{Range(2, 7, 2, 8)}));
+    QVERIFY(decoratedRanges(*layer, 3).isEmpty());
+
+    // unwrapping moves the decorations of the line to the end of the previous one
+    doc.removeText({0, 15, 1, 0});
+    QCOMPARE(decoratedRanges(*layer, 0), (QList<Range>{Range(0, 10, 0, 13), Range(0, 17, 0, 20)}));
+    QCOMPARE(decoratedRanges(*layer, 1), (QList<Range>{Range(1, 7, 1, 8)}));
+
+    // removing the text of a decoration removes it
+    doc.removeText({0, 9, 0, 14});
+    QCOMPARE(decoratedRanges(*layer, 0), (QList<Range>{Range(0, 12, 0, 15)}));
+}
+
+void DecorationLayerTest::testOlderRevision()
+{
+    DocumentPrivate doc;
+    doc.setText(QStringLiteral("int foo = bar;"));
+
+    // decorations computed for a revision that is outdated when they arrive, like from a language server
+    const qint64 revision = doc.revision();
+    doc.lockRevision(revision);
+    doc.insertText({0, 0}, QStringLiteral("\n"));
+    doc.insertText({1, 0}, QStringLiteral("static "));
+
+    std::unique_ptr<DecorationLayer> layer(doc.newDecorationLayer());
+    layer->setDecorations({{0, 4, 3, 0}}, revision);
+    doc.unlockRevision(revision);
+    QVERIFY(layer->decorations(0).isEmpty());
+    QCOMPARE(decoratedRanges(*layer, 1), (QList<Range>{Range(1, 11, 1, 14)}));
+}
+
+void DecorationLayerTest::testReload()
+{
+    DocumentPrivate doc;
+    doc.setText(QStringLiteral("int foo = bar;"));
+
+    std::unique_ptr<DecorationLayer> layer(doc.newDecorationLayer());
+    layer->setDecorations({{0, 4, 3, 0}});
+    doc.insertText({0, 0}, QStringLiteral("x"));
+
+    // the text history is gone, the decorations too
+    doc.setModified(false);
+    QVERIFY(doc.closeUrl());
+    QVERIFY(layer->decorations(0).isEmpty());
+
+    // still usable
+    doc.setText(QStringLiteral("int foo = bar;"));
+    layer->setDecorations({{0, 4, 3, 0}});
+    QCOMPARE(decoratedRanges(*layer, 0), (QList<Range>{Range(0, 4, 0, 7)}));
+}
+
+void DecorationLayerTest::testLayerSurvivesDocument()
+{
+    std::unique_ptr<DecorationLayer> layer;
+    {
+        DocumentPrivate doc;
+        doc.setText(QStringLiteral("int foo = bar;"));
+        layer.reset(doc.newDecorationLayer());
+        layer->setDecorations({{0, 4, 3, 0}});
+    }
+    QVERIFY(!layer->document());
+    QVERIFY(layer->decorations(0).isEmpty());
+    layer->setDecorations({{0, 4, 3, 0}});
+    QVERIFY(layer->decorations(0).isEmpty());
+}
+
+#include "moc_decorationlayer_test.cpp"
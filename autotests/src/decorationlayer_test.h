@@ -0,0 +1,27 @@
+/*
+    SPDX-FileCopyrightText: KDE Developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef DECORATION_LAYER_TEST_H
+#define DECORATION_LAYER_TEST_H
+
+#include <QObject>
+
+class DecorationLayerTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    DecorationLayerTest();
+
+private Q_SLOTS:
+    void testSetDecorations();
+    void testEditing();
+    void testOlderRevision();
+    void testReload();
+    void testLayerSurvivesDocument();
+};
+
+#endif
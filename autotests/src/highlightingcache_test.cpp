@@ -0,0 +1,130 @@
+/*
+    SPDX-FileCopyrightText: KDE Developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "highlightingcache_test.h"
+
+#include <katebuffer.h>
+#include <kateconfig.h>
+#include <katedocument.h>
+
+#include <QDir>
+#include <QStandardPaths>
+#include <QTemporaryFile>
+#include <QTest>
+
+using namespace KTextEditor;
+
+QTEST_MAIN(HighlightingCacheTest)
+
+HighlightingCacheTest::HighlightingCacheTest()
+    : QObject()
+{
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+void HighlightingCacheTest::initTestCase()
+{
+    QDir(QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + QStringLiteral("/ktexteditor/highlighting")).removeRecursively();
+    KateGlobalConfig::global()->setHighlightingCache(true);
+}
+
+void HighlightingCacheTest::cleanupTestCase()
+{
+    KateGlobalConfig::global()->setHighlightingCache(false);
+}
+
+// attributes of a line as plain values, easy to compare
+static QList<int> lineAttributes(KateBuffer &buffer, int line)
+{
+    QList<int> values;
+    for (const Kate::TextLine::Attribute &attribute : buffer.plainLine(line).attributesList()) {
+        values << attribute.offset << attribute.length << attribute.attributeValue;
+    }
+    return values;
+}
+
+// the cache is keyed by the content, use different function names per test
+static void writeFile(QTemporaryFile &file, const QByteArray &functionName)
+{
+    QVERIFY(file.open());
+    for (int i = 0; i < 1000; ++i) {
+        file.write("int " + functionName + QByteArray::number(i) + "() {\n    return 0; // comment\n}\n");
+    }
+    file.close();
+}
+
+void HighlightingCacheTest::testRestore()
+{
+    QTemporaryFile file(QDir::tempPath() + QStringLiteral("/highlightingcacheXXXXXX.cpp"));
+    writeFile(file, "restore");
+
+    QList<int> expectedAttributes;
+    KTextEditor::Range expectedFolding;
+    {
+        DocumentPrivate doc;
+        QVERIFY(doc.openUrl(QUrl::fromLocalFile(file.fileName())));
+        QCOMPARE(doc.highlightingMode(), QStringLiteral("C++"));
+        QCOMPARE(doc.buffer().restoredLines(), 0);
+
+        doc.buffer().ensureHighlighted(doc.lines() - 1);
+        QCOMPARE(doc.buffer().highlightedLines(), doc.lines());
+        expectedAttributes = lineAttributes(doc.buffer(), 2998);
+        QVERIFY(!expectedAttributes.isEmpty());
+        expectedFolding = doc.buffer().computeFoldingRangeForStartLine(2997);
+        QVERIFY(expectedFolding.isValid());
+
+        // closing stores the highlighting
+        QVERIFY(doc.closeUrl());
+    }
+
+    {
+        DocumentPrivate doc;
+        QVERIFY(doc.openUrl(QUrl::fromLocalFile(file.fileName())));
+        QCOMPARE(doc.buffer().restoredLines(), doc.lines());
+
+        // the end of the file is highlighted without highlighting all lines in front of it
+        doc.buffer().ensureHighlighted(2998);
+        QCOMPARE(doc.buffer().highlightedLines(), 0);
+        QCOMPARE(lineAttributes(doc.buffer(), 2998), expectedAttributes);
+        QVERIFY(doc.buffer().isFoldingStartingOnLine(2997).first);
+        QVERIFY(!doc.buffer().isFoldingStartingOnLine(2998).first);
+
+        // folding ranges need the real highlighting state
+        QCOMPARE(doc.buffer().computeFoldingRangeForStartLine(2997), expectedFolding);
+
+        // an edit invalidates the restored lines behind it
+        doc.insertText(KTextEditor::Cursor(1500, 0), QStringLiteral("/* "));
+        QCOMPARE(doc.buffer().restoredLines(), 1500);
+        doc.buffer().ensureHighlighted(2998);
+        QVERIFY(lineAttributes(doc.buffer(), 2998) != expectedAttributes);
+
+        // the modified document is not stored on destruction
+    }
+
+    DocumentPrivate reopened;
+    QVERIFY(reopened.openUrl(QUrl::fromLocalFile(file.fileName())));
+    QCOMPARE(reopened.buffer().restoredLines(), reopened.lines());
+    QCOMPARE(lineAttributes(reopened.buffer(), 2998), expectedAttributes);
+}
+
+void HighlightingCacheTest::testDisabled()
+{
+    QTemporaryFile file(QDir::tempPath() + QStringLiteral("/highlightingcacheXXXXXX.cpp"));
+    writeFile(file, "disabled");
+
+    KateGlobalConfig::global()->setHighlightingCache(false);
+    {
+        DocumentPrivate doc;
+        QVERIFY(doc.openUrl(QUrl::fromLocalFile(file.fileName())));
+        doc.buffer().ensureHighlighted(doc.lines() - 1);
+        QVERIFY(doc.closeUrl());
+    }
+
+    KateGlobalConfig::global()->setHighlightingCache(true);
+    DocumentPrivate doc;
+    QVERIFY(doc.openUrl(QUrl::fromLocalFile(file.fileName())));
+    QCOMPARE(doc.buffer().restoredLines(), 0);
+}
@@ -0,0 +1,26 @@
+/*
+    SPDX-FileCopyrightText: KDE Developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef HIGHLIGHTING_CACHE_TEST_H
+#define HIGHLIGHTING_CACHE_TEST_H
+
+#include <QObject>
+
+class HighlightingCacheTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    HighlightingCacheTest();
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+    void testRestore();
+    void testDisabled();
+};
+
+#endif
@@ -0,0 +1,198 @@
+/*
+    SPDX-FileCopyrightText: KDE Developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "htmlexporter_test.h"
+
+#include <export/exporter.h>
+#include <katedocument.h>
+#include <kateview.h>
+
+#include <QApplication>
+#include <QClipboard>
+#include <QMimeData>
+#include <QRegularExpression>
+#include <QSignalSpy>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QTest>
+
+QTEST_MAIN(HtmlExporterTest)
+
+HtmlExporterTest::HtmlExporterTest()
+    : QObject()
+{
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+static QString readFile(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QString();
+    }
+    return QString::fromUtf8(file.readAll());
+}
+
+static QString cppCode(int lines)
+{
+    QString text;
+    for (int i = 0; i < lines; ++i) {
+        text += QStringLiteral("int value%1 = compute(%1, \"text\"); // comment %1\n").arg(i);
+    }
+    return text;
+}
+
+void HtmlExporterTest::testCssClasses()
+{
+    KTextEditor::DocumentPrivate doc;
+    doc.setHighlightingMode(QStringLiteral("C++"));
+    doc.setText(cppCode(10) + QStringLiteral("a < b && c > d;"));
+    KTextEditor::ViewPrivate view(&doc, nullptr);
+
+    QTemporaryDir dir;
+    const QString fileName = dir.filePath(QStringLiteral("export.html"));
+    view.exportHtmlToFile(fileName);
+    const QString html = readFile(fileName);
+
+    // one style sheet in the header, the text only refers to its classes
+    QVERIFY(html.contains(QLatin1String("<style type=\"text/css\">")));
+    QVERIFY(html.indexOf(QLatin1String("</style>")) < html.indexOf(QLatin1String("<body>")));
+    QVERIFY(html.contains(QLatin1String("<span class=\"s")));
+    QVERIFY(!html.contains(QLatin1String("<span style=")));
+    QVERIFY(html.contains(QLatin1String("a &lt; b &amp;&amp; c &gt; d;")));
+
+    // each class is defined once and adjacent runs of the same class are merged
+    const QRegularExpression definition(QStringLiteral("^\\.(s\\d+) \\{"), QRegularExpression::MultilineOption);
+    QStringList classes;
+    for (auto it = definition.globalMatch(html); it.hasNext();) {
+        const QString cssClass = it.next().captured(1);
+        QVERIFY(!classes.contains(cssClass));
+        classes.append(cssClass);
+    }
+    QVERIFY(!classes.isEmpty());
+    QVERIFY(!html.contains(QRegularExpression(QStringLiteral("<span class=\"(s\\d+)\">[^<]*</span><span class=\"\\1\">"))));
+}
+
+void HtmlExporterTest::testClipboard()
+{
+    KTextEditor::DocumentPrivate doc;
+    doc.setHighlightingMode(QStringLiteral("C++"));
+    doc.setText(cppCode(10));
+    KTextEditor::ViewPrivate view(&doc, nullptr);
+    view.setSelection({1, 0, 3, 0});
+
+    KateExporter exporter(&view);
+    QSignalSpy finished(&exporter, &KateExporter::finished);
+    exporter.exportToClipboard();
+    QCOMPARE(finished.count(), 1);
+    QCOMPARE(finished.first().first().toBool(), true);
+
+    // no header for the clipboard, so inline styles
+    const QString html = QApplication::clipboard()->mimeData()->html();
+    QVERIFY(html.startsWith(QLatin1String("<pre")));
+    QVERIFY(html.contains(QLatin1String("<span style=")));
+    QVERIFY(!html.contains(QLatin1String("class=")));
+    QVERIFY(html.contains(QLatin1String("value1")));
+    QVERIFY(html.contains(QLatin1String("value2")));
+    QVERIFY(!html.contains(QLatin1String("value3")));
+}
+
+void HtmlExporterTest::testInChunks()
+{
+    KTextEditor::DocumentPrivate doc;
+    doc.setHighlightingMode(QStringLiteral("C++"));
+    doc.setText(cppCode(95));
+    KTextEditor::ViewPrivate view(&doc, nullptr);
+
+    QTemporaryDir dir;
+    const QString blockingFile = dir.filePath(QStringLiteral("blocking.html"));
+    view.exportHtmlToFile(blockingFile);
+
+    const QString chunkedFile = dir.filePath(QStringLiteral("chunked.html"));
+    KateExporter exporter(&view);
+    exporter.setExportInChunks(true, 10);
+    QSignalSpy progress(&exporter, &KateExporter::progress);
+    QSignalSpy finished(&exporter, &KateExporter::finished);
+    exporter.exportToFile(chunkedFile);
+
+    // first chunk done right away, the others from the event loop
+    QVERIFY(exporter.isRunning());
+    QCOMPARE(progress.count(), 1);
+    QCOMPARE(progress.first().at(0).toInt(), 10);
+    QCOMPARE(progress.first().at(1).toInt(), 96);
+
+    QTRY_COMPARE(finished.count(), 1);
+    QCOMPARE(finished.first().first().toBool(), true);
+    QVERIFY(!exporter.isRunning());
+    QCOMPARE(progress.count(), 9);
+    QCOMPARE(progress.last().at(0).toInt(), 90);
+
+    // same result as without chunks
+    QCOMPARE(readFile(chunkedFile), readFile(blockingFile));
+}
+
+void HtmlExporterTest::testCancel()
+{
+    KTextEditor::DocumentPrivate doc;
+    doc.setText(cppCode(100));
+    KTextEditor::ViewPrivate view(&doc, nullptr);
+
+    QTemporaryDir dir;
+    const QString fileName = dir.filePath(QStringLiteral("canceled.html"));
+    KateExporter exporter(&view);
+    exporter.setExportInChunks(true, 10);
+    QSignalSpy finished(&exporter, &KateExporter::finished);
+    connect(&exporter, &KateExporter::progress, &exporter, [&exporter](int exportedLines) {
+        if (exportedLines >= 30) {
+            exporter.cancel();
+        }
+    });
+    exporter.exportToFile(fileName);
+
+    QTRY_COMPARE(finished.count(), 1);
+    QCOMPARE(finished.first().first().toBool(), false);
+    QVERIFY(!exporter.isRunning());
+
+    // the lines exported so far are kept, the file is still complete HTML
+    const QString html = readFile(fileName);
+    QVERIFY(html.contains(QLatin1String("value29")));
+    QVERIFY(!html.contains(QLatin1String("value30")));
+    QVERIFY(html.endsWith(QLatin1String("</html>\n")));
+
+    // the document going away cancels too
+    KateExporter closed(&view);
+    closed.setExportInChunks(true, 10);
+    QSignalSpy closedFinished(&closed, &KateExporter::finished);
+    closed.exportToFile(dir.filePath(QStringLiteral("closed.html")));
+    QVERIFY(closed.isRunning());
+    doc.setModified(false);
+    doc.closeUrl();
+    QCOMPARE(closedFinished.count(), 1);
+    QCOMPARE(closedFinished.first().first().toBool(), false);
+
+    // an edit between two chunks would mix the old and the new text
+    doc.setText(cppCode(100));
+    KateExporter edited(&view);
+    edited.setExportInChunks(true, 10);
+    QSignalSpy editedFinished(&edited, &KateExporter::finished);
+    const QString editedFileName = dir.filePath(QStringLiteral("edited.html"));
+    edited.exportToFile(editedFileName);
+    QVERIFY(edited.isRunning());
+    doc.removeLine(50);
+    QCOMPARE(editedFinished.count(), 1);
+    QCOMPARE(editedFinished.first().first().toBool(), false);
+    QVERIFY(!readFile(editedFileName).contains(QLatin1String("value51")));
+
+    // so would a new highlighting with other attributes
+    KateExporter highlighted(&view);
+    highlighted.setExportInChunks(true, 10);
+    QSignalSpy highlightedFinished(&highlighted, &KateExporter::finished);
+    highlighted.exportToFile(dir.filePath(QStringLiteral("highlighted.html")));
+    QVERIFY(highlighted.isRunning());
+    doc.setHighlightingMode(QStringLiteral("C++"));
+    QCOMPARE(highlightedFinished.count(), 1);
+    QCOMPARE(highlightedFinished.first().first().toBool(), false);
+}
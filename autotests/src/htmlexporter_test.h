@@ -0,0 +1,26 @@
+/*
+    SPDX-FileCopyrightText: KDE Developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef HTML_EXPORTER_TEST_H
+#define HTML_EXPORTER_TEST_H
+
+#include <QObject>
+
+class HtmlExporterTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    HtmlExporterTest();
+
+private Q_SLOTS:
+    void testCssClasses();
+    void testClipboard();
+    void testInChunks();
+    void testCancel();
+};
+
+#endif
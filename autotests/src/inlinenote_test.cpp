@@ -102,6 +102,31 @@ public:
     int mouseMoveCount = 0;
     bool lastUnderMouse = false;
 };
+
+class CountingNoteProvider : public InlineNoteProvider
+{
+public:
+    QList<int> inlineNotes(int) const override
+    {
+        ++queryCount;
+        return columns;
+    }
+
+    QSize inlineNoteSize(const InlineNote &note) const override
+    {
+        ++sizeCount;
+        return QSize(7, note.lineHeight());
+    }
+
+    void paintInlineNote(const InlineNote &, QPainter &, Qt::LayoutDirection) const override
+    {
+    }
+
+public:
+    QList<int> columns;
+    mutable int queryCount = 0;
+    mutable int sizeCount = 0;
+};
 }
 
 InlineNoteTest::InlineNoteTest()
@@ -209,4 +234,47 @@ void InlineNoteTest::testInlineNote()
     view.unregisterInlineNoteProvider(&noteProvider);
 }
 
+void InlineNoteTest::testNoteCache()
+{
+    KTextEditor::DocumentPrivate doc;
+    doc.setText(QStringLiteral("xxxxxxxxxx\nxxxxxxxxxx\nxxxxxxxxxx"));
+    KTextEditor::ViewPrivate view(&doc, nullptr);
+
+    CountingNoteProvider noteProvider;
+    noteProvider.columns = {2};
+    view.registerInlineNoteProvider(&noteProvider);
+
+    // once the notes of a line are known, the provider is not asked again
+    QCOMPARE(view.inlineNotes(1).size(), 1);
+    QCOMPARE(view.inlineNotes(2).size(), 1);
+    const int queryCount = noteProvider.queryCount;
+    const int sizeCount = noteProvider.sizeCount;
+    QCOMPARE(view.inlineNotes(1).size(), 1);
+    QCOMPARE(KTextEditor::InlineNote(view.inlineNotes(1).front()).width(), 7.0);
+    QCOMPARE(noteProvider.queryCount, queryCount);
+    QCOMPARE(noteProvider.sizeCount, sizeCount);
+
+    // silent changes are not seen, the provider needs to tell about them
+    noteProvider.columns = {2, 4};
+    QCOMPARE(view.inlineNotes(1).size(), 1);
+    Q_EMIT noteProvider.inlineNotesRangeChanged({0, 1});
+    QCOMPARE(view.inlineNotes(1).size(), 2);
+
+    // edited lines are asked again, lines behind too if lines got inserted
+    noteProvider.columns = {3};
+    doc.insertText({1, 0}, QStringLiteral("y"));
+    QCOMPARE(view.inlineNotes(1).size(), 1);
+    QCOMPARE(view.inlineNotes(1).front().m_position, Cursor(1, 3));
+    QCOMPARE(view.inlineNotes(2).front().m_position, Cursor(2, 2));
+    doc.insertLine(0, QStringLiteral("new"));
+    QCOMPARE(view.inlineNotes(3).front().m_position, Cursor(3, 3));
+
+    // a reset drops everything
+    noteProvider.columns = {};
+    Q_EMIT noteProvider.inlineNotesReset();
+    QVERIFY(view.inlineNotes(1).isEmpty());
+
+    view.unregisterInlineNoteProvider(&noteProvider);
+}
+
 // kate: indent-mode cstyle; indent-width 4; replace-tabs on;
@@ -8,14 +8,19 @@
 #include "katedocument_test.h"
 #include "moc_katedocument_test.cpp"
 
+#include <katebuffer.h>
 #include <kateconfig.h>
 #include <katedocument.h>
 #include <kateglobal.h>
+#include <katetextblock.h>
 #include <kateview.h>
 
+#include <KConfig>
+#include <KConfigGroup>
 #include <KLazyLocalizedString>
 #include <KLocalizedString>
 
+#include <QDir>
 #include <QRegularExpression>
 #include <QSignalSpy>
 #include <QStandardPaths>
@@ -243,6 +248,87 @@ void KateDocumentTest::testRemoveTextPerformance()
     }
 }
 
+void KateDocumentTest::testEditReplaceText()
+{
+    KTextEditor::DocumentPrivate doc;
+    doc.setText(QStringLiteral("aaa bbb ccc\nfoo bar\nuntouched\nlast line"));
+
+    std::unique_ptr<MovingCursor> c1{doc.newMovingCursor(Cursor(0, 9), MovingCursor::MoveOnInsert)};
+    std::unique_ptr<MovingCursor> c2{doc.newMovingCursor(Cursor(1, 5), MovingCursor::MoveOnInsert)};
+    std::unique_ptr<MovingCursor> c3{doc.newMovingCursor(Cursor(1, 5), MovingCursor::StayOnInsert)};
+    std::unique_ptr<MovingCursor> c4{doc.newMovingCursor(Cursor(2, 4))};
+
+    QList<std::pair<Range, QString>> removed;
+    connect(&doc, &KTextEditor::DocumentPrivate::textRemoved, this, [&removed](KTextEditor::Document *, Range range, const QString &text) {
+        removed.append({range, text});
+    });
+    QList<Range> inserted;
+    connect(&doc, &KTextEditor::DocumentPrivate::textInsertedRange, this, [&inserted](KTextEditor::Document *, Range range) {
+        inserted.append(range);
+    });
+    const uint undoCount = doc.undoCount();
+
+    // unsorted, two replacements on line 0, an overlapping one that must be skipped
+    std::vector<Kate::LineReplacement> replacements;
+    replacements.push_back({1, 4, 3, QStringLiteral("baz!")});
+    replacements.push_back({0, 8, 3, QStringLiteral("C")});
+    replacements.push_back({0, 0, 4, QString()});
+    replacements.push_back({1, 5, 1, QStringLiteral("x")});
+    replacements.push_back({3, 5, 0, QStringLiteral("new ")});
+    QVERIFY(doc.editReplaceText(replacements));
+
+    QCOMPARE(doc.text(), QStringLiteral("bbb C\nfoo baz!\nuntouched\nlast new line"));
+    QCOMPARE(c1->toCursor(), Cursor(0, 5));
+    QCOMPARE(c2->toCursor(), Cursor(1, 8));
+    QCOMPARE(c3->toCursor(), Cursor(1, 4));
+    QCOMPARE(c4->toCursor(), Cursor(2, 4));
+
+    // one notification per line, from the first to the last replaced column
+    QCOMPARE(removed,
+             (QList<std::pair<Range, QString>>{{Range(0, 0, 0, 11), QStringLiteral("aaa bbb ccc")}, {Range(1, 4, 1, 7), QStringLiteral("bar")}}));
+    QCOMPARE(inserted, (QList<Range>{Range(0, 0, 0, 5), Range(1, 4, 1, 8), Range(3, 5, 3, 9)}));
+
+    // whole batch is one undo step
+    QCOMPARE(doc.undoCount(), undoCount + 1);
+    doc.undo();
+    QCOMPARE(doc.text(), QStringLiteral("aaa bbb ccc\nfoo bar\nuntouched\nlast line"));
+    doc.redo();
+    QCOMPARE(doc.text(), QStringLiteral("bbb C\nfoo baz!\nuntouched\nlast new line"));
+
+    // several replacements on one line undo in the columns after the edit
+    doc.setText(QStringLiteral("a b c d"));
+    QVERIFY(doc.editReplaceText({{0, 0, 1, QStringLiteral("xx")}, {0, 2, 1, QString()}, {0, 4, 0, QStringLiteral("yyy")}, {0, 6, 1, QStringLiteral("z")}}));
+    QCOMPARE(doc.text(), QStringLiteral("xx  yyyc z"));
+    doc.undo();
+    QCOMPARE(doc.text(), QStringLiteral("a b c d"));
+    doc.redo();
+    QCOMPARE(doc.text(), QStringLiteral("xx  yyyc z"));
+}
+
+void KateDocumentTest::testRemoveAllTrailingSpacesPerformance()
+{
+    const int lines = 50000;
+
+    KTextEditor::DocumentPrivate doc;
+
+    QString text;
+    const QString line = QStringLiteral("some text with trailing spaces    \t  ");
+    for (int l = 0; l < lines; ++l) {
+        text.append(line);
+        text.append(QLatin1Char('\n'));
+    }
+
+    doc.setText(text);
+
+    QBENCHMARK_ONCE {
+        doc.removeAllTrailingSpaces();
+    }
+
+    for (int l = 0; l < lines; ++l) {
+        QCOMPARE(doc.line(l), QStringLiteral("some text with trailing spaces"));
+    }
+}
+
 void KateDocumentTest::testForgivingApiUsage()
 {
     KTextEditor::DocumentPrivate doc;
@@ -740,6 +826,71 @@ void KateDocumentTest::testMatchingBracket()
     QCOMPARE(doc.findMatchingBracket(cursor, maxLines), match);
 }
 
+void KateDocumentTest::testMatchingBracketAcrossBlocks()
+{
+    // deeply nested code spanning many buffer blocks, with brackets inside comments that must be skipped
+    const int depth = 1000;
+    QString text;
+    for (int i = 0; i < depth; ++i) {
+        text += QStringLiteral("{ // }\n");
+    }
+    for (int i = 0; i < depth; ++i) {
+        text += QStringLiteral("} /* { */\n");
+    }
+
+    KTextEditor::DocumentPrivate doc;
+    doc.setHighlightingMode(QStringLiteral("C++"));
+    doc.setText(text);
+
+    // forward and backward, far beyond the line limit once highlighted
+    QCOMPARE(doc.findMatchingBracket(Cursor(0, 0), 2 * depth), Range(0, 0, 2 * depth - 1, 0));
+    QCOMPARE(doc.findMatchingBracket(Cursor(2 * depth - 1, 0), 10), Range(0, 0, 2 * depth - 1, 0));
+    QCOMPARE(doc.findMatchingBracket(Cursor(10, 0), 10), Range(10, 0, 2 * depth - 11, 0));
+
+    // edits invalidate the index of the touched block
+    doc.insertText(Cursor(depth - 1, 1), QStringLiteral("}"));
+    QCOMPARE(doc.findMatchingBracket(Cursor(depth - 1, 0), 10), Range(depth - 1, 0, depth - 1, 1));
+    QCOMPARE(doc.findMatchingBracket(Cursor(0, 0), 10), Range(0, 0, 2 * depth - 2, 0));
+
+    // a near match only highlights the blocks the search gets to
+    KTextEditor::DocumentPrivate lazy;
+    lazy.setHighlightingMode(QStringLiteral("C++"));
+    lazy.setText(QStringLiteral("{\n}\n") + text);
+    QCOMPARE(lazy.findMatchingBracket(Cursor(0, 0), 2 * depth), Range(0, 0, 1, 0));
+    QVERIFY(lazy.buffer().highlightedLines() <= 2 * Kate::BufferBlockSize);
+}
+
+void KateDocumentTest::testEnclosingBrackets()
+{
+    KTextEditor::DocumentPrivate doc;
+    doc.setHighlightingMode(QStringLiteral("C++"));
+    doc.setText(QStringLiteral("int f() {\n    g(a, \"(\", x[1]);\n    // {\n    h(\n}"));
+
+    QCOMPARE(doc.findEnclosingBrackets(Cursor(1, 16), 10), Range(1, 15, 1, 17));
+
+    // brackets in strings and comments and unclosed ones don't count
+    QCOMPARE(doc.findEnclosingBrackets(Cursor(1, 12), 10), Range(1, 5, 1, 18));
+    QCOMPARE(doc.findEnclosingBrackets(Cursor(3, 6), 10), Range(0, 8, 4, 0));
+
+    // neither does a bracket at the position
+    QCOMPARE(doc.findEnclosingBrackets(Cursor(1, 5), 10), Range(0, 8, 4, 0));
+    QCOMPARE(doc.findEnclosingBrackets(Cursor(0, 8), 10), Range::invalid());
+
+    // deeply nested across many blocks
+    const int depth = 1000;
+    QString text;
+    for (int i = 0; i < depth; ++i) {
+        text += QStringLiteral("{ // }\n");
+    }
+    for (int i = 0; i < depth; ++i) {
+        text += QStringLiteral("} /* { */\n");
+    }
+    doc.setText(text);
+    QCOMPARE(doc.findEnclosingBrackets(Cursor(depth, 1), 2 * depth), Range(depth - 2, 0, depth + 1, 0));
+    QCOMPARE(doc.findEnclosingBrackets(Cursor(2 * depth - 2, 1), 10), Range(0, 0, 2 * depth - 1, 0));
+    QCOMPARE(doc.findEnclosingBrackets(Cursor(2 * depth - 1, 1), 10), Range::invalid());
+}
+
 void KateDocumentTest::testIndentOnPaste()
 {
     KTextEditor::DocumentPrivate doc;
@@ -1129,3 +1280,138 @@ void KateDocumentTest::testDocumentDeduplication()
     fileDoc2.setUrl(QUrl(QStringLiteral("file:///elsewhere/test.txt")));
     QCOMPARE(fileDoc2.documentName(), QStringLiteral("test.txt - elsewhere"));
 }
+
+void KateDocumentTest::testLazySessionRestore()
+{
+    QTemporaryFile file(QDir::tempPath() + QStringLiteral("/testLazySessionRestore-XXXXXX.cpp"));
+    QVERIFY(file.open());
+    file.write("int a;\nint b;\nint c;\n");
+    file.flush();
+    const QUrl url = QUrl::fromLocalFile(file.fileName());
+
+    KConfig config(QString(), KConfig::SimpleConfig);
+    KConfigGroup group(&config, QStringLiteral("Document"));
+    group.writeEntry("URL", url.toString());
+    group.writeEntry("Bookmarks", QList<int>{1});
+
+    // the url and mode are restored right away, the file is not read yet
+    KTextEditor::DocumentPrivate doc;
+    QSignalSpy loaded(&doc, &KTextEditor::DocumentPrivate::loaded);
+    doc.readSessionConfig(group);
+    QVERIFY(doc.isLoadDeferred());
+    QCOMPARE(doc.url(), url);
+    QCOMPARE(doc.mode(), QStringLiteral("C++"));
+    QCOMPARE(loaded.count(), 0);
+
+    // bookmarks survive writing the session again without loading
+    KConfigGroup written(&config, QStringLiteral("Written"));
+    doc.writeSessionConfig(written);
+    QCOMPARE(written.readEntry("Bookmarks", QList<int>()), QList<int>{1});
+    QVERIFY(doc.isLoadDeferred());
+
+    // first access loads the file and applies the bookmarks
+    QCOMPARE(doc.lines(), 4);
+    QVERIFY(!doc.isLoadDeferred());
+    QCOMPARE(loaded.count(), 1);
+    QCOMPARE(doc.line(1), QStringLiteral("int b;"));
+    QCOMPARE(doc.mark(1), uint(KTextEditor::Document::markType01));
+    QVERIFY(!doc.isModified());
+
+    // other documents are loaded in the background
+    KTextEditor::DocumentPrivate background;
+    background.readSessionConfig(group);
+    QVERIFY(background.isLoadDeferred());
+    QTRY_VERIFY(!background.isLoadDeferred());
+    QCOMPARE(background.text(), QStringLiteral("int a;\nint b;\nint c;\n"));
+
+    // a view loads right away
+    KTextEditor::DocumentPrivate withView;
+    withView.readSessionConfig(group);
+    QVERIFY(withView.isLoadDeferred());
+    std::unique_ptr<KTextEditor::View> view(withView.createView(nullptr));
+    QVERIFY(!withView.isLoadDeferred());
+    QCOMPARE(withView.lines(), 4);
+
+    // can be skipped
+    KTextEditor::DocumentPrivate immediate;
+    immediate.readSessionConfig(group, {QStringLiteral("SkipLazyLoad")});
+    QVERIFY(!immediate.isLoadDeferred());
+    QCOMPARE(immediate.lines(), 4);
+
+    // marks and checksum need the file
+    KTextEditor::DocumentPrivate marks;
+    marks.readSessionConfig(group);
+    QCOMPARE(marks.marks().size(), 1);
+    QVERIFY(!marks.isLoadDeferred());
+    KTextEditor::DocumentPrivate checksum;
+    checksum.readSessionConfig(group);
+    QCOMPARE(checksum.checksum(), doc.checksum());
+    QVERIFY(!checksum.isLoadDeferred());
+
+    // closing doesn't load, even if the text is read on aboutToClose
+    KTextEditor::DocumentPrivate closed;
+    closed.readSessionConfig(group);
+    QSignalSpy closedLoaded(&closed, &KTextEditor::DocumentPrivate::loaded);
+    connect(&closed, &KTextEditor::Document::aboutToClose, this, [](KTextEditor::Document *document) {
+        QCOMPARE(document->text(), QString());
+    });
+    QVERIFY(closed.closeUrl());
+    QVERIFY(!closed.isLoadDeferred());
+    QCOMPARE(closedLoaded.count(), 0);
+}
+
+void KateDocumentTest::testReloadKeepsUnchangedLines()
+{
+    QTemporaryFile file(QDir::tempPath() + QStringLiteral("/testReloadKeepsUnchangedLines-XXXXXX.cpp"));
+    QVERIFY(file.open());
+    QStringList lines;
+    for (int i = 0; i < 300; ++i) {
+        lines.append(QStringLiteral("int value%1 = %1; // comment").arg(i));
+    }
+    file.write(lines.join(QLatin1Char('\n')).toUtf8() + "\n");
+    file.flush();
+
+    KTextEditor::DocumentPrivate doc;
+    QVERIFY(doc.openUrl(QUrl::fromLocalFile(file.fileName())));
+    doc.buffer().ensureHighlighted(doc.lines() - 1, 0);
+    QVERIFY(!doc.buffer().plainLine(10).attributesList().empty());
+
+    std::unique_ptr<KTextEditor::MovingCursor> front(doc.newMovingCursor({10, 4}));
+    std::unique_ptr<KTextEditor::MovingCursor> back(doc.newMovingCursor({250, 4}));
+    doc.addMark(200, KTextEditor::Document::markType01);
+    QSignalSpy invalidated(&doc, &KTextEditor::DocumentPrivate::aboutToInvalidateMovingInterfaceContent);
+    QSignalSpy reloaded(&doc, &KTextEditor::DocumentPrivate::reloaded);
+    const QByteArray checksum = doc.checksum();
+
+    // change two lines in the middle and insert one
+    lines[100] = QStringLiteral("float changed = 1;");
+    lines[101] = QStringLiteral("float changed = 2;");
+    lines.insert(102, QStringLiteral("float inserted = 3;"));
+    QVERIFY(file.resize(0));
+    QVERIFY(file.seek(0));
+    file.write(lines.join(QLatin1Char('\n')).toUtf8() + "\n");
+    file.flush();
+
+    QVERIFY(doc.documentReload());
+    QCOMPARE(doc.text(), lines.join(QLatin1Char('\n')) + QLatin1Char('\n'));
+    QCOMPARE(reloaded.count(), 1);
+    QVERIFY(!doc.isModified());
+    QVERIFY(!doc.isUndoAvailable());
+    QVERIFY(doc.checksum() != checksum);
+
+    // nothing was invalidated, lines behind the change moved
+    QCOMPARE(invalidated.count(), 0);
+    QCOMPARE(front->toCursor(), KTextEditor::Cursor(10, 4));
+    QCOMPARE(back->toCursor(), KTextEditor::Cursor(251, 4));
+    QCOMPARE(doc.mark(201), uint(KTextEditor::Document::markType01));
+
+    // the highlighting in front of the change is kept
+    QVERIFY(!doc.buffer().plainLine(10).attributesList().empty());
+
+    // without changes on disk nothing happens
+    const qint64 revision = doc.revision();
+    QVERIFY(doc.documentReload());
+    QCOMPARE(doc.revision(), revision);
+    QCOMPARE(back->toCursor(), KTextEditor::Cursor(251, 4));
+    QCOMPARE(invalidated.count(), 0);
+}
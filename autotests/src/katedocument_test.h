@@ -77,6 +77,8 @@ private Q_SLOTS:
     void testMovingInterfaceSignals();
     void testSetTextPerformance();
     void testRemoveTextPerformance();
+    void testEditReplaceText();
+    void testRemoveAllTrailingSpacesPerformance();
     void testForgivingApiUsage();
     void testRemoveMultipleLines();
     void testInsertNewline();
@@ -92,6 +94,8 @@ private Q_SLOTS:
     void testSearch();
     void testMatchingBracket_data();
     void testMatchingBracket();
+    void testMatchingBracketAcrossBlocks();
+    void testEnclosingBrackets();
     void testIndentOnPaste();
     void testAboutToSave();
     void testKeepUndoOverReload();
@@ -104,6 +108,8 @@ private Q_SLOTS:
     void testDocumentName_data();
     void testDocumentName();
     void testDocumentDeduplication();
+    void testLazySessionRestore();
+    void testReloadKeepsUnchangedLines();
 };
 
 #endif // KATE_DOCUMENT_TEST_H
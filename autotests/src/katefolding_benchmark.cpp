@@ -0,0 +1,93 @@
+/*
+    SPDX-FileCopyrightText: KDE Developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "katefolding_benchmark.h"
+
+#include <katebuffer.h>
+#include <katedocument.h>
+#include <katetextfolding.h>
+
+#include <QStandardPaths>
+#include <QTest>
+
+// like "fold all" on a large source file: many small folded ranges
+static constexpr int lines = 200000;
+static constexpr int linesPerFold = 5;
+
+KateFoldingBenchmark::KateFoldingBenchmark() = default;
+
+KateFoldingBenchmark::~KateFoldingBenchmark() = default;
+
+void KateFoldingBenchmark::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+
+    m_doc = std::make_unique<KTextEditor::DocumentPrivate>();
+    QStringList text;
+    text.reserve(lines);
+    for (int i = 0; i < lines; ++i) {
+        text.append((i % linesPerFold) ? QStringLiteral("    statement();") : QStringLiteral("void function() {"));
+    }
+    m_doc->setText(text);
+    QCOMPARE(m_doc->lines(), lines);
+
+    m_folding = std::make_unique<Kate::TextFolding>(m_doc->buffer());
+    for (int i = 0; i + linesPerFold <= lines; i += linesPerFold) {
+        QVERIFY(m_folding->newFoldingRange(KTextEditor::Range(i, 17, i + linesPerFold - 1, 16), Kate::TextFolding::Folded) >= 0);
+    }
+    QCOMPARE(m_folding->visibleLines(), lines / linesPerFold);
+}
+
+void KateFoldingBenchmark::benchmarkVisibleLines()
+{
+    int visibleLines = 0;
+    QBENCHMARK {
+        visibleLines = m_folding->visibleLines();
+    }
+    QCOMPARE(visibleLines, lines / linesPerFold);
+}
+
+void KateFoldingBenchmark::benchmarkLineToVisibleLine()
+{
+    // the layout cache and the view map every painted line, scroll through the whole document
+    int sum = 0;
+    QBENCHMARK {
+        sum = 0;
+        for (int line = 0; line < lines; line += 7) {
+            sum += m_folding->lineToVisibleLine(line);
+        }
+    }
+    QVERIFY(sum > 0);
+}
+
+void KateFoldingBenchmark::benchmarkVisibleLineToLine()
+{
+    const int visibleLines = m_folding->visibleLines();
+    int sum = 0;
+    QBENCHMARK {
+        sum = 0;
+        for (int visibleLine = 0; visibleLine < visibleLines; ++visibleLine) {
+            sum += m_folding->visibleLineToLine(visibleLine);
+        }
+    }
+    QVERIFY(sum > 0);
+}
+
+void KateFoldingBenchmark::benchmarkMappingAfterEdit()
+{
+    // typing invalidates the hidden line counts, the next mapping has to update them
+    const KTextEditor::Cursor position(lines / 2 + 1, 0);
+    int visibleLine = 0;
+    QBENCHMARK {
+        m_doc->insertText(position, QStringLiteral("x"));
+        visibleLine = m_folding->lineToVisibleLine(lines - 1);
+    }
+    QCOMPARE(visibleLine, lines / linesPerFold - 1);
+}
+
+QTEST_MAIN(KateFoldingBenchmark)
+
+#include "moc_katefolding_benchmark.cpp"
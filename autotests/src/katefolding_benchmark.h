@@ -0,0 +1,44 @@
+/*
+    SPDX-FileCopyrightText: KDE Developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef KTEXTEDITOR_KATEFOLDING_BENCHMARK_H
+#define KTEXTEDITOR_KATEFOLDING_BENCHMARK_H
+
+#include <QObject>
+
+#include <memory>
+
+namespace KTextEditor
+{
+class DocumentPrivate;
+}
+
+namespace Kate
+{
+class TextFolding;
+}
+
+class KateFoldingBenchmark : public QObject
+{
+    Q_OBJECT
+
+public:
+    KateFoldingBenchmark();
+    ~KateFoldingBenchmark() override;
+
+private Q_SLOTS:
+    void initTestCase();
+    void benchmarkVisibleLines();
+    void benchmarkLineToVisibleLine();
+    void benchmarkVisibleLineToLine();
+    void benchmarkMappingAfterEdit();
+
+private:
+    std::unique_ptr<KTextEditor::DocumentPrivate> m_doc;
+    std::unique_ptr<Kate::TextFolding> m_folding;
+};
+
+#endif // KTEXTEDITOR_KATEFOLDING_BENCHMARK_H
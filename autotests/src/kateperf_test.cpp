@@ -0,0 +1,163 @@
+/*
+    SPDX-FileCopyrightText: KDE Developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "kateperf_test.h"
+
+#include <katedocument.h>
+#include <kateperf.h>
+#include <kateview.h>
+#include <ktexteditor/command.h>
+#include <ktexteditor/editor.h>
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QTest>
+
+QTEST_MAIN(KatePerfTest)
+
+using namespace KatePerf;
+
+void KatePerfTest::testTimings()
+{
+    Counters counters;
+    QVERIFY(counters.isEmpty());
+
+    counters.addTiming("paint", 0, 500); // < 1 us
+    counters.addTiming("paint", 1000, 3000); // < 4 us
+    counters.addTiming("paint", 5000, 3000);
+    counters.addTiming("search", 10000, 2000000); // 2 ms
+
+    const auto timings = counters.timings();
+    QCOMPARE(timings.size(), 2);
+
+    const Timing paint = timings.value(QStringLiteral("paint"));
+    QCOMPARE(paint.count, quint64(3));
+    QCOMPARE(paint.totalNs, qint64(6500));
+    QCOMPARE(paint.maxNs, qint64(3000));
+    QCOMPARE(paint.histogram[0], quint64(1));
+    QCOMPARE(paint.histogram[2], quint64(2));
+
+    const Timing search = timings.value(QStringLiteral("search"));
+    QCOMPARE(search.count, quint64(1));
+    QCOMPARE(search.histogram[11], quint64(1));
+
+    QVERIFY(counters.summary().contains(QLatin1String("paint: 3 calls")));
+
+    counters.reset();
+    QVERIFY(counters.isEmpty());
+    QVERIFY(counters.traceEvents().isEmpty());
+}
+
+void KatePerfTest::testCounts()
+{
+    Counters counters;
+    counters.count("layout cache hits");
+    counters.count("layout cache hits", 2);
+    counters.count("highlighted lines", 100);
+
+    const auto counts = counters.counts();
+    QCOMPARE(counts.value(QStringLiteral("layout cache hits")), qint64(3));
+    QCOMPARE(counts.value(QStringLiteral("highlighted lines")), qint64(100));
+    QVERIFY(counters.summary().contains(QLatin1String("highlighted lines: 100")));
+}
+
+void KatePerfTest::testTraceEventsRing()
+{
+    // only the most recent scopes are kept, oldest first
+    Counters counters;
+    const qsizetype total = Counters::MaxTraceEvents + 10;
+    for (qsizetype i = 0; i < total; ++i) {
+        counters.addTiming("paint", i, 1);
+    }
+
+    const auto events = counters.traceEvents();
+    QCOMPARE(events.size(), Counters::MaxTraceEvents);
+    QCOMPARE(events.first().startNs, qint64(10));
+    QCOMPARE(events.last().startNs, qint64(total - 1));
+
+    // the statistics still see everything
+    QCOMPARE(counters.timings().value(QStringLiteral("paint")).count, quint64(total));
+}
+
+void KatePerfTest::testChromeTrace()
+{
+    Counters document;
+    document.addTiming("highlight", 2000, 5000);
+    document.count("highlighted lines", 42);
+    Counters view;
+    view.addTiming("paint", 3000, 1000);
+
+    const QJsonDocument json = QJsonDocument::fromJson(chromeTrace({{QStringLiteral("doc"), &document}, {QStringLiteral("view"), &view}}));
+    QVERIFY(json.isObject());
+    const QJsonArray events = json.object().value(QLatin1String("traceEvents")).toArray();
+
+    int complete = 0;
+    int metadata = 0;
+    int counterSamples = 0;
+    for (const auto &value : events) {
+        const QJsonObject event = value.toObject();
+        const QString phase = event.value(QLatin1String("ph")).toString();
+        if (phase == QLatin1String("X")) {
+            ++complete;
+            if (event.value(QLatin1String("name")).toString() == QLatin1String("highlight")) {
+                QCOMPARE(event.value(QLatin1String("pid")).toInt(), 1);
+                QCOMPARE(event.value(QLatin1String("ts")).toDouble(), 2.0);
+                QCOMPARE(event.value(QLatin1String("dur")).toDouble(), 5.0);
+            } else {
+                QCOMPARE(event.value(QLatin1String("name")).toString(), QStringLiteral("paint"));
+                QCOMPARE(event.value(QLatin1String("pid")).toInt(), 2);
+            }
+        } else if (phase == QLatin1String("M")) {
+            ++metadata;
+        } else if (phase == QLatin1String("C")) {
+            ++counterSamples;
+            QCOMPARE(event.value(QLatin1String("args")).toObject().value(QLatin1String("highlighted lines")).toInt(), 42);
+        }
+    }
+    QCOMPARE(complete, 2);
+    QCOMPARE(metadata, 2);
+    QCOMPARE(counterSamples, 1);
+}
+
+void KatePerfTest::testPerfCommand()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    KTextEditor::DocumentPrivate doc;
+    KTextEditor::View *view = doc.createView(nullptr);
+    doc.setText(QStringLiteral("foo\nbar\nfoo"));
+
+    KTextEditor::Command *command = KTextEditor::Editor::instance()->queryCommand(QStringLiteral("perf"));
+    QVERIFY(command);
+
+    QTemporaryDir dir;
+    const QString traceFile = dir.filePath(QStringLiteral("trace.json"));
+    QString msg;
+    const bool ok = command->exec(view, QStringLiteral("perf trace ") + traceFile, msg);
+    if (!KATE_PERF_TRACING) {
+        // not compiled in, the command tells so
+        QVERIFY(!ok);
+        QVERIFY(!msg.isEmpty());
+        return;
+    }
+
+    QVERIFY(ok);
+    QFile file(traceFile);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QVERIFY(QJsonDocument::fromJson(file.readAll()).isObject());
+
+    doc.searchText(doc.documentRange(), QStringLiteral("foo"));
+    QVERIFY(doc.perfCounters().timings().contains(QStringLiteral("search")));
+    QVERIFY(command->exec(view, QStringLiteral("perf reset"), msg));
+    QVERIFY(doc.perfCounters().isEmpty());
+
+    QVERIFY(!command->exec(view, QStringLiteral("perf nonsense"), msg));
+}
+
+#include "moc_kateperf_test.cpp"
@@ -0,0 +1,24 @@
+/*
+    SPDX-FileCopyrightText: KDE Developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef KATE_PERF_TEST_H
+#define KATE_PERF_TEST_H
+
+#include <QObject>
+
+class KatePerfTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testTimings();
+    void testCounts();
+    void testTraceEventsRing();
+    void testChromeTrace();
+    void testPerfCommand();
+};
+
+#endif
@@ -7,6 +7,7 @@
 */
 
 #include <memory>
+#include <thread>
 
 #include "katetextbuffertest.h"
 #include "katebuffer.h"
@@ -44,6 +45,11 @@ void KateTextBufferTest::basicBufferTest()
 
     // end editing
     buffer.finishEditing();
+
+    // buffers without a document work, too
+    Kate::TextBuffer standalone(nullptr);
+    QVERIFY(standalone.lines() == 1);
+    QVERIFY(standalone.rangesForLine(0, nullptr, false).isEmpty());
 }
 
 void KateTextBufferTest::wrapLineTest()
@@ -410,6 +416,59 @@ void KateTextBufferTest::nestedFoldingTest()
     QVERIFY(folding.unfoldRange(1));
 }
 
+void KateTextBufferTest::foldingLineMappingTest()
+{
+    KTextEditor::DocumentPrivate doc;
+    Kate::TextBuffer &buffer = doc.buffer();
+    Kate::TextFolding folding(buffer);
+
+    buffer.startEditing();
+    for (int i = 0; i < 999; ++i) {
+        buffer.wrapLine(KTextEditor::Cursor(0, 0));
+    }
+    buffer.finishEditing();
+    QCOMPARE(buffer.lines(), 1000);
+
+    // fold every second block of ten lines, nest some unfolded ranges around folded ones
+    for (int i = 0; i < 1000; i += 20) {
+        QVERIFY(folding.newFoldingRange(KTextEditor::Range(i + 2, 0, i + 8, 0), Kate::TextFolding::Folded) >= 0);
+        QVERIFY(folding.newFoldingRange(KTextEditor::Range(i + 10, 0, i + 13, 0), (i % 40) ? Kate::TextFolding::Folded : Kate::TextFolding::FoldingRangeFlags()) >= 0);
+        QVERIFY(folding.newFoldingRange(KTextEditor::Range(i + 1, 0, i + 9, 0)) >= 0);
+    }
+
+    // compare the mapping against the visibility of each line
+    auto verifyMapping = [&]() {
+        int visibleLine = -1;
+        for (int line = 0; line < buffer.lines(); ++line) {
+            if (folding.isLineVisible(line)) {
+                ++visibleLine;
+                QCOMPARE(folding.visibleLineToLine(visibleLine), line);
+            }
+            QCOMPARE(folding.lineToVisibleLine(line), visibleLine);
+        }
+        QCOMPARE(folding.visibleLines(), visibleLine + 1);
+    };
+    verifyMapping();
+
+    // edits inside of folded ranges change the number of hidden lines
+    buffer.startEditing();
+    buffer.wrapLine(KTextEditor::Cursor(4, 0));
+    buffer.wrapLine(KTextEditor::Cursor(500, 0));
+    buffer.unwrapLine(706);
+    buffer.finishEditing();
+    verifyMapping();
+
+    // folding changes
+    const auto ranges = folding.foldingRangesStartingOnLine(42);
+    QCOMPARE(ranges.size(), 1);
+    QVERIFY(folding.foldRange(ranges[0].id));
+    verifyMapping();
+    QVERIFY(folding.unfoldRange(ranges[0].id));
+    verifyMapping();
+    folding.ensureLineIsVisible(906);
+    verifyMapping();
+}
+
 void KateTextBufferTest::saveFileInUnwritableFolder()
 {
     // create temp dir and get file name inside
@@ -674,4 +733,63 @@ void KateTextBufferTest::saveFileWithElevatedPrivileges()
 }
 #endif
 
+void KateTextBufferTest::testSnapshot()
+{
+    KTextEditor::DocumentPrivate doc;
+    QStringList text;
+    for (int i = 0; i < 500; ++i) {
+        text.append(QStringLiteral("line %1").arg(i));
+    }
+    doc.setText(text);
+    const QString original = doc.text();
+
+    const KTextEditor::TextSnapshot snapshot = doc.snapshot();
+    QVERIFY(snapshot.isValid());
+    QCOMPARE(snapshot.revision(), doc.revision());
+    QCOMPARE(snapshot.lines(), 500);
+    QCOMPARE(snapshot.line(123), QStringLiteral("line 123"));
+    QCOMPARE(snapshot.lineLength(499), 8);
+    QCOMPARE(snapshot.lineLength(500), -1);
+    QCOMPARE(snapshot.documentEnd(), doc.documentEnd());
+    QCOMPARE(snapshot.text(), original);
+    QCOMPARE(snapshot.text({10, 2, 12, 4}), doc.text({10, 2, 12, 4}));
+
+    // read the snapshot in another thread while the document changes
+    QString textInThread;
+    std::thread reader([&snapshot, &textInThread]() {
+        for (int i = 0; i < 20; ++i) {
+            textInThread = snapshot.text();
+        }
+    });
+    for (int i = 0; i < 100; ++i) {
+        doc.insertText({i * 5, 0}, QStringLiteral("x"));
+        doc.insertText({i * 5, 2}, QStringLiteral("\n"));
+        doc.removeLine(i * 3 + 1);
+        doc.buffer().ensureHighlighted(i * 4);
+    }
+    reader.join();
+    QCOMPARE(textInThread, original);
+
+    // edits, splitting, merging and clearing the blocks don't touch the snapshot
+    doc.removeText({0, 0, 300, 0});
+    doc.insertText({0, 0}, original);
+    QCOMPARE(snapshot.text(), original);
+    const QString editedText = doc.text();
+    const KTextEditor::TextSnapshot edited = doc.snapshot();
+    QCOMPARE(edited.text(), editedText);
+    QVERIFY(edited.revision() > snapshot.revision());
+
+    doc.clear();
+    QCOMPARE(snapshot.text(), original);
+    QCOMPARE(edited.text(), editedText);
+    QCOMPARE(doc.snapshot().text(), QString());
+
+    // a default snapshot is empty
+    const KTextEditor::TextSnapshot invalid;
+    QVERIFY(!invalid.isValid());
+    QCOMPARE(invalid.lines(), 0);
+    QCOMPARE(invalid.revision(), qint64(-1));
+    QVERIFY(!invalid.documentEnd().isValid());
+}
+
 #include "moc_katetextbuffertest.cpp"
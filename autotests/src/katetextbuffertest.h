@@ -29,10 +29,12 @@ private Q_SLOTS:
     void cursorTest();
     void foldingTest();
     void nestedFoldingTest();
+    void foldingLineMappingTest();
     void saveFileInUnwritableFolder();
     void lineLengthLimit();
     void testBlockSplittingWithMovingRanges();
     void testGetTextWithEmptyFirstBlock();
+    void testSnapshot();
 
 #if HAVE_KAUTH
     void saveFileWithElevatedPrivileges();
@@ -12,6 +12,9 @@
 #include <katebuffer.h>
 #include <kateconfig.h>
 #include <katedocument.h>
+#include <kateglobal.h>
+#include <katerenderer.h>
+#include <kateshapedlayoutcache.h>
 #include <kateview.h>
 #include <kateviewhelpers.h>
 #include <kateviewinternal.h>
@@ -923,6 +926,116 @@ void KateViewTest::testSelectedTextFormats()
     }
 }
 
+void KateViewTest::testSharedShapedLayouts()
+{
+    KTextEditor::DocumentPrivate doc(false, false);
+    doc.setText(QStringLiteral("cursor\nsame line\nsame line\nother line"));
+
+    auto *cache = KTextEditor::EditorPrivate::self()->shapedLayoutCache();
+    cache->resetStatistics();
+
+    auto *view1 = static_cast<KTextEditor::ViewPrivate *>(doc.createView(nullptr));
+    auto *view2 = static_cast<KTextEditor::ViewPrivate *>(doc.createView(nullptr));
+    for (auto *view : {view1, view2}) {
+        view->setCursorPosition({0, 0});
+        view->resize(400, 300);
+        view->show();
+        QVERIFY(QTest::qWaitForWindowExposed(view));
+    }
+
+    // identical lines share one layout, within a view and across views
+    const QTextLayout *layout = view1->textLayout({1, 0});
+    QVERIFY(layout);
+    QCOMPARE(layout->text(), QStringLiteral("same line"));
+    QCOMPARE(view1->textLayout({2, 0}), layout);
+    QCOMPARE(view2->textLayout({1, 0}), layout);
+    QCOMPARE(view2->textLayout({2, 0}), layout);
+    QVERIFY(view1->textLayout({3, 0}) != layout);
+    QVERIFY(cache->hits() >= 3);
+    QVERIFY(cache->misses() > 0);
+    QVERIFY(cache->totalCost() <= cache->maxCost());
+
+    // changing a line must not touch the shared layout of the others
+    doc.insertText({2, 0}, QStringLiteral("not "));
+    view1->update();
+    QTest::qWait(0);
+    QCOMPARE(view1->textLayout({2, 0})->text(), QStringLiteral("not same line"));
+    QCOMPARE(view1->textLayout({1, 0})->text(), QStringLiteral("same line"));
+    QCOMPARE(view2->textLayout({1, 0})->text(), QStringLiteral("same line"));
+
+    delete view1;
+    delete view2;
+}
+
+void KateViewTest::testLongLineWindow()
+{
+    KTextEditor::DocumentPrivate doc(false, false);
+    QString longLine;
+    for (int i = 0; i < 2000; ++i) {
+        longLine += QStringLiteral("{\"key\":\t%1},").arg(i, 4, 10, QLatin1Char('0'));
+    }
+    QVERIFY(longLine.size() > 5 * KateRenderer::LongLineLength);
+    const int length = longLine.size();
+    doc.setText(longLine + QStringLiteral("\nshort line"));
+
+    auto *view = static_cast<KTextEditor::ViewPrivate *>(doc.createView(nullptr));
+    view->config()->setDynWordWrap(false);
+    view->resize(400, 300);
+    view->show();
+    QVERIFY(QTest::qWaitForWindowExposed(view));
+
+    if (!QFontInfo(view->renderer()->currentFont()).fixedPitch()) {
+        delete view;
+        QSKIP("Long line mode needs a fixed pitch font");
+    }
+
+    // only the start of the long line got laid out, the short line is not affected
+    const QString window = view->textLayout({0, 0})->text();
+    QVERIFY(window.size() < length);
+    QVERIFY(longLine.startsWith(window));
+    QCOMPARE(view->textLayout({1, 0})->text(), QStringLiteral("short line"));
+
+    // decorations are only computed for the requested columns
+    view->setSelection(KTextEditor::Range(0, 0, 0, length));
+    const Kate::TextLine textLine = doc.kateTextLine(0);
+    const auto decorations = view->renderer()->decorationsForLine(textLine, 0, false, 100, 200);
+    QCOMPARE(decorations.size(), 1);
+    QCOMPARE(decorations.front().start, 100);
+    QCOMPARE(decorations.front().length, 100);
+    QCOMPARE(view->renderer()->decorationsForLine(textLine, 0).front().length, length);
+    view->clearSelection();
+
+    // geometry inside of the window and outside of it
+    for (int column : {0, 5, 7, 8, 100, int(window.size()) - 1}) {
+        const QPoint pos = view->cursorToCoordinate({0, column});
+        QVERIFY(pos.x() >= 0);
+        QCOMPARE(view->coordinatesToCursor(pos), KTextEditor::Cursor(0, column));
+    }
+    QVERIFY(view->cursorToCoordinate({0, length - 3}).x() > view->width());
+
+    // moving to the end scrolls there and lays out a window around it
+    view->setCursorPosition({0, length});
+    QTest::qWait(0);
+    const QString endWindow = view->textLayout({0, 0})->text();
+    QVERIFY(endWindow.size() < length);
+    QVERIFY(longLine.endsWith(endWindow));
+    for (int column : {length - 3, length - 5, length}) {
+        const QPoint pos = view->cursorToCoordinate({0, column});
+        QVERIFY(pos.x() >= 0);
+        QCOMPARE(view->coordinatesToCursor(pos), KTextEditor::Cursor(0, column));
+    }
+
+    // cursor movement at both ends of the line
+    view->setCursorPosition({0, 1});
+    view->cursorRight();
+    QCOMPARE(view->cursorPosition(), KTextEditor::Cursor(0, 2));
+    view->setCursorPosition({0, length - 20});
+    view->cursorLeft();
+    QCOMPARE(view->cursorPosition(), KTextEditor::Cursor(0, length - 21));
+
+    delete view;
+}
+
 void KateViewTest::testPasteDifferentLineSeparators()
 {
     // we shall handle several new line variants in the paste text
@@ -45,6 +45,8 @@ private Q_SLOTS:
     void testCrashOnPasteInOverwriteMode();
     void testCommandBarSearchReplace();
     void testSelectedTextFormats();
+    void testSharedShapedLayouts();
+    void testLongLineWindow();
     void testPasteDifferentLineSeparators();
     void testMinimapScrollbarWidth();
 };
@@ -0,0 +1,212 @@
+/*
+    SPDX-FileCopyrightText: KDE Developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "markindex_test.h"
+
+#include <katedocument.h>
+#include <katemarkindex.h>
+
+#include <QStandardPaths>
+#include <QTest>
+
+using namespace KTextEditor;
+
+QTEST_MAIN(MarkIndexTest)
+
+MarkIndexTest::MarkIndexTest()
+    : QObject()
+{
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+// lines of the given marks, easy to compare
+static QList<int> markLines(const std::vector<Mark *> &marks)
+{
+    QList<int> lines;
+    for (const Mark *mark : marks) {
+        lines.append(mark->line);
+    }
+    return lines;
+}
+
+static QList<int> markedLines(const DocumentPrivate &doc)
+{
+    return markLines(doc.markIndex().marks());
+}
+
+void MarkIndexTest::testIndex()
+{
+    KateMarkIndex index;
+    QVERIFY(index.isEmpty());
+
+    Mark marks[5];
+    for (int i : {7, 2, 9, 0, 4}) {
+        marks[index.size()] = Mark{.line = i, .type = 1};
+        index.insert(&marks[index.size()]);
+    }
+    QCOMPARE(index.size(), qsizetype(5));
+    QCOMPARE(markLines(index.marks()), QList<int>({0, 2, 4, 7, 9}));
+    QCOMPARE(markLines(index.marks(2, 7)), QList<int>({2, 4, 7}));
+    QCOMPARE(markLines(index.marks(5, 6)), QList<int>());
+
+    QCOMPARE(index.mark(4), &marks[4]);
+    QVERIFY(!index.mark(5));
+
+    QCOMPARE(index.take(2), &marks[1]);
+    QVERIFY(!index.take(2));
+    QCOMPARE(markLines(index.takeLines(3, 8)), QList<int>({4, 7}));
+    QCOMPARE(markLines(index.marks()), QList<int>({0, 9}));
+
+    QCOMPARE(markLines(index.takeAll()), QList<int>({0, 9}));
+    QVERIFY(index.isEmpty());
+    QCOMPARE(index.size(), qsizetype(0));
+}
+
+void MarkIndexTest::testShiftLines()
+{
+    KateMarkIndex index;
+    std::vector<Mark> marks(100);
+    for (int i = 0; i < 100; ++i) {
+        marks[i] = Mark{.line = i * 2, .type = 1};
+        index.insert(&marks[i]);
+    }
+
+    // move everything behind line 50 down, twice
+    QVERIFY(index.shiftLines(50, 3));
+    QVERIFY(index.shiftLines(51, 1));
+    QVERIFY(!index.shiftLines(1000, 1));
+    QCOMPARE(index.mark(48), &marks[24]);
+    QCOMPARE(index.mark(54), &marks[25]);
+    QCOMPARE(index.mark(56), &marks[26]);
+    QVERIFY(!index.mark(50));
+
+    // and back up again
+    QVERIFY(index.shiftLines(52, -4));
+    for (int i = 0; i < 100; ++i) {
+        QCOMPARE(index.mark(i * 2), &marks[i]);
+    }
+
+    // insert in between shifted marks
+    Mark mark{.line = 51, .type = 2};
+    index.insert(&mark);
+    QCOMPARE(markLines(index.marks(48, 54)), QList<int>({48, 50, 51, 52, 54}));
+    QCOMPARE(index.take(51), &mark);
+
+    index.takeAll();
+}
+
+void MarkIndexTest::testNextPrevious()
+{
+    KateMarkIndex index;
+    QVERIFY(!index.first());
+    QVERIFY(!index.last());
+    QVERIFY(!index.next(0));
+    QVERIFY(!index.previous(0));
+
+    std::vector<Mark> marks(100);
+    for (int i = 0; i < 100; ++i) {
+        marks[i] = Mark{.line = i * 2 + 10, .type = 1};
+        index.insert(&marks[i]);
+    }
+
+    QCOMPARE(index.first(), &marks[0]);
+    QCOMPARE(index.last(), &marks[99]);
+    QCOMPARE(index.next(0), &marks[0]);
+    QCOMPARE(index.next(10), &marks[1]);
+    QCOMPARE(index.next(11), &marks[1]);
+    QVERIFY(!index.next(208));
+    QCOMPARE(index.previous(1000), &marks[99]);
+    QCOMPARE(index.previous(12), &marks[0]);
+    QCOMPARE(index.previous(13), &marks[1]);
+    QVERIFY(!index.previous(10));
+
+    // pending shifts are applied to the found marks
+    QVERIFY(index.shiftLines(50, 5));
+    QCOMPARE(index.next(48), &marks[20]);
+    QCOMPARE(marks[20].line, 55);
+    QCOMPARE(index.previous(55), &marks[19]);
+    QCOMPARE(marks[19].line, 48);
+    QCOMPARE(index.last(), &marks[99]);
+    QCOMPARE(marks[99].line, 213);
+
+    index.takeAll();
+}
+
+void MarkIndexTest::testDocumentEditing()
+{
+    DocumentPrivate doc;
+    doc.setText(QStringLiteral("0\n1\n2\n3\n4\n5\n6"));
+    doc.addMark(1, Document::markType01);
+    doc.addMark(2, Document::markType02);
+    doc.addMark(4, Document::markType01);
+    doc.addMark(6, Document::markType01);
+
+    // wrap at the line start moves the mark, else it stays
+    doc.editWrapLine(1, 0);
+    QCOMPARE(markedLines(doc), QList<int>({2, 3, 5, 7}));
+    doc.editWrapLine(2, 1);
+    QCOMPARE(markedLines(doc), QList<int>({2, 4, 6, 8}));
+
+    // unwrap merges the mark of the appended line
+    doc.editUnWrapLine(3);
+    QCOMPARE(markedLines(doc), QList<int>({2, 3, 5, 7}));
+    doc.editUnWrapLine(2);
+    QCOMPARE(markedLines(doc), QList<int>({2, 4, 6}));
+    QCOMPARE(doc.mark(2), uint(Document::markType01 | Document::markType02));
+
+    doc.editInsertLine(0, QStringLiteral("new"));
+    QCOMPARE(markedLines(doc), QList<int>({3, 5, 7}));
+
+    // removed lines take their marks with them
+    doc.editRemoveLines(4, 5);
+    QCOMPARE(markedLines(doc), QList<int>({3, 5}));
+    QCOMPARE(doc.mark(5), uint(Document::markType01));
+
+    doc.clearMarks();
+    QVERIFY(doc.markIndex().isEmpty());
+}
+
+void MarkIndexTest::testMarksHash()
+{
+    DocumentPrivate doc;
+    doc.setText(QStringLiteral("0\n1\n2\n3"));
+    doc.addMark(1, Document::markType01);
+    doc.addMark(3, Document::markType02);
+
+    QCOMPARE(doc.marks().size(), qsizetype(2));
+    QCOMPARE(doc.marks().value(1)->type, uint(Document::markType01));
+
+    // the hash follows the edits
+    doc.insertLine(0, QStringLiteral("new"));
+    QCOMPARE(doc.marks().size(), qsizetype(2));
+    QVERIFY(!doc.marks().contains(1));
+    QCOMPARE(doc.marks().value(2)->line, 2);
+    QCOMPARE(doc.marks().value(4)->type, uint(Document::markType02));
+
+    doc.removeMark(2, Document::markType01);
+    QCOMPARE(doc.marks().size(), qsizetype(1));
+}
+
+void MarkIndexTest::benchWrapLineWithManyMarks()
+{
+    DocumentPrivate doc;
+    QStringList lines;
+    for (int i = 0; i < 100000; ++i) {
+        lines.append(QStringLiteral("line %1").arg(i));
+    }
+    doc.setText(lines);
+    for (int i = 0; i < doc.lines(); i += 2) {
+        doc.addMark(i, Document::markType01);
+    }
+
+    // press enter at the top again and again, all marks behind need to move
+    QBENCHMARK {
+        for (int i = 0; i < 100; ++i) {
+            doc.editWrapLine(0, 2);
+        }
+    }
+    QCOMPARE(doc.markIndex().size(), qsizetype(50000));
+}
@@ -0,0 +1,28 @@
+/*
+    SPDX-FileCopyrightText: KDE Developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef MARK_INDEX_TEST_H
+#define MARK_INDEX_TEST_H
+
+#include <QObject>
+
+class MarkIndexTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    MarkIndexTest();
+
+private Q_SLOTS:
+    void testIndex();
+    void testShiftLines();
+    void testNextPrevious();
+    void testDocumentEditing();
+    void testMarksHash();
+    void benchWrapLineWithManyMarks();
+};
+
+#endif
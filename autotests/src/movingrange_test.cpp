@@ -926,3 +926,75 @@ void MovingRangeTest::testBlockSplitAndMerge()
     QVERIFY(!doc.buffer().hasMultlineRange(range2.get()));
     QVERIFY(!doc.buffer().hasMultlineRange(range3.get()));
 }
+
+void MovingRangeTest::testRangesForLineInsideBlock()
+{
+    KTextEditor::DocumentPrivate doc;
+    const QStringList lines(20, QStringLiteral("text"));
+    doc.setText(lines);
+
+    // all in the first block
+    std::unique_ptr<MovingRange> multiLine(doc.newMovingRange({2, 1, 6, 1}));
+    std::unique_ptr<MovingRange> singleLine(doc.newMovingRange({4, 0, 4, 2}));
+
+    const auto rangesForLine = [&doc](int line) {
+        const auto ranges = doc.buffer().rangesForLine(line, nullptr, false);
+        return QList<KTextEditor::MovingRange *>(ranges.begin(), ranges.end());
+    };
+    QCOMPARE(rangesForLine(1), QList<KTextEditor::MovingRange *>());
+    QCOMPARE(rangesForLine(2), QList<KTextEditor::MovingRange *>{multiLine.get()});
+    QCOMPARE(rangesForLine(3), QList<KTextEditor::MovingRange *>{multiLine.get()});
+    QVERIFY(rangesForLine(4).contains(multiLine.get()));
+    QVERIFY(rangesForLine(4).contains(singleLine.get()));
+    QCOMPARE(rangesForLine(6), QList<KTextEditor::MovingRange *>{multiLine.get()});
+    QCOMPARE(rangesForLine(7), QList<KTextEditor::MovingRange *>());
+
+    // wrap and unwrap lines inside of the range, the lines it spans must follow
+    doc.insertText({3, 2}, QStringLiteral("\n\n"));
+    QCOMPARE(multiLine->toRange(), KTextEditor::Range(2, 1, 8, 1));
+    QCOMPARE(rangesForLine(7), QList<KTextEditor::MovingRange *>{multiLine.get()});
+    QCOMPARE(rangesForLine(9), QList<KTextEditor::MovingRange *>());
+    doc.removeText({{3, 2}, {5, 0}});
+    QCOMPARE(multiLine->toRange(), KTextEditor::Range(2, 1, 6, 1));
+    QCOMPARE(singleLine->toRange(), KTextEditor::Range(4, 0, 4, 2));
+    QCOMPARE(rangesForLine(5), QList<KTextEditor::MovingRange *>{multiLine.get()});
+    QCOMPARE(rangesForLine(7), QList<KTextEditor::MovingRange *>());
+
+    // moving the range updates the lines it spans
+    multiLine->setRange({10, 0, 12, 0});
+    QCOMPARE(rangesForLine(3), QList<KTextEditor::MovingRange *>());
+    QCOMPARE(rangesForLine(11), QList<KTextEditor::MovingRange *>{multiLine.get()});
+    multiLine->setRange({10, 0, 10, 2});
+    QCOMPARE(rangesForLine(11), QList<KTextEditor::MovingRange *>());
+}
+
+void MovingRangeTest::benchTypingWithManyRanges()
+{
+    constexpr int NUM_LINES = 1000;
+    constexpr int RANGES_PER_LINE = 50;
+
+    KTextEditor::DocumentPrivate doc;
+    const QStringList lines(NUM_LINES, QString(RANGES_PER_LINE * 4, QLatin1Char('x')));
+    doc.setText(lines);
+
+    // thousands of ranges per block, like search matches or diagnostics, some of them spanning lines
+    std::vector<std::unique_ptr<KTextEditor::MovingRange>> ranges;
+    for (int i = 0; i < NUM_LINES; ++i) {
+        for (int j = 0; j < RANGES_PER_LINE; ++j) {
+            ranges.emplace_back(doc.newMovingRange({i, j * 4, i, j * 4 + 2}));
+        }
+        if (i + 3 < NUM_LINES) {
+            ranges.emplace_back(doc.newMovingRange({i, 1, i + 3, 1}));
+        }
+    }
+
+    // typing in the middle of a line and asking for the ranges to paint it
+    const int line = NUM_LINES / 2;
+    QBENCHMARK {
+        for (int i = 0; i < 100; ++i) {
+            doc.insertText({line, RANGES_PER_LINE * 2}, QStringLiteral("a"));
+            doc.buffer().rangesForLine(line, nullptr, false);
+        }
+        doc.removeText({line, RANGES_PER_LINE * 2, line, RANGES_PER_LINE * 2 + 100});
+    }
+}
@@ -39,6 +39,8 @@ private Q_SLOTS:
     void testNoCrashWithMultiblockRange();
     void testNoFlippedRange();
     void testBlockSplitAndMerge();
+    void testRangesForLineInsideBlock();
+    void benchTypingWithManyRanges();
 };
 
 #endif // KATE_MOVINGRANGE_TEST_H
@@ -1009,6 +1009,44 @@ void MulticursorTest::testIndent()
     QCOMPARE(doc->text(), expectedDoc->text());
 }
 
+void MulticursorTest::testTypingBehindLineEnd()
+{
+    auto [doc, view] = createDocAndView(QStringLiteral("a\nbb\nccc"), 0, 0);
+
+    // cursors inside of the lines and one behind the end of line 1, e.g. from a block selection
+    view->setSecondaryCursors({{1, 1}, {1, 5}, {2, 3}});
+    QCOMPARE(view->secondaryCursors().size(), size_t(3));
+    doc->typeChars(view, QStringLiteral("x"));
+
+    // the line is filled up to the cursor behind its end like for a single cursor
+    QCOMPARE(doc->text(), QStringLiteral("xa\nbxb  x\ncccx"));
+    const auto expectedCursors = QVector<KTextEditor::Cursor>{{0, 1}, {1, 2}, {1, 6}, {2, 4}};
+    QCOMPARE(view->cursorPositions(), expectedCursors);
+
+    // one undo step for all cursors
+    doc->undo();
+    QCOMPARE(doc->text(), QStringLiteral("a\nbb\nccc"));
+
+    // the primary cursor in front of a cursor behind the end of its line
+    view->clearSecondaryCursors();
+    view->setCursorPosition({1, 0});
+    view->setSecondaryCursors({{1, 5}});
+    doc->typeChars(view, QStringLiteral("x"));
+    QCOMPARE(doc->text(), QStringLiteral("a\nxbb   x\nccc"));
+    QCOMPARE(view->cursorPositions(), (QVector<KTextEditor::Cursor>{{1, 1}, {1, 7}}));
+    doc->undo();
+
+    // the primary cursor at the line end, reached by the filled up line like with single insertions
+    view->clearSecondaryCursors();
+    view->setCursorPosition({1, 2});
+    view->setSecondaryCursors({{1, 1}, {1, 5}});
+    doc->typeChars(view, QStringLiteral("x"));
+    QCOMPARE(doc->text(), QStringLiteral("a\nbxb  xx\nccc"));
+    QCOMPARE(view->cursorPositions(), (QVector<KTextEditor::Cursor>{{1, 2}, {1, 6}, {1, 7}}));
+    doc->undo();
+    QCOMPARE(doc->text(), QStringLiteral("a\nbb\nccc"));
+}
+
 #include "moc_multicursortest.cpp"
 
 // kate: indent-mode cstyle; indent-width 4; replace-tabs on;
@@ -0,0 +1,115 @@
+/*
+    SPDX-FileCopyrightText: KDE Developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "ontheflycheck_test.h"
+
+#include <katedocument.h>
+#include <spellcheck/ontheflycheck.h>
+
+#include <QStandardPaths>
+#include <QTest>
+
+using namespace KTextEditor;
+
+QTEST_MAIN(OnTheFlyCheckTest)
+
+OnTheFlyCheckTest::OnTheFlyCheckTest()
+    : QObject()
+{
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+namespace
+{
+// the real checks need dictionaries, the tests hand in the results of the background check instead
+class TestChecker : public KateOnTheFlyChecker
+{
+public:
+    using KateOnTheFlyChecker::KateOnTheFlyChecker;
+
+    // start a check of the given range, like performSpellCheck() does
+    quint64 startCheck(Range range)
+    {
+        addToSpellCheckQueue(range, QStringLiteral("en_US"));
+        CheckedItem checkedItem;
+        checkedItem.item = m_spellCheckQueue.takeFirst();
+        checkedItem.text = m_document->text(range);
+        m_currentlyCheckedItems.push_back(checkedItem);
+        return ++m_currentSpellCheck;
+    }
+
+    MovingRange *checkedRange() const
+    {
+        return m_currentlyCheckedItems.first().item.range;
+    }
+
+    using KateOnTheFlyChecker::m_spellCheckQueue;
+    using KateOnTheFlyChecker::spellCheckDone;
+};
+}
+
+void OnTheFlyCheckTest::testUpdateMisspellings()
+{
+    DocumentPrivate doc;
+    doc.setText(QStringLiteral("hello wrld and mor text\nsecnd line"));
+    TestChecker checker(&doc);
+
+    checker.spellCheckDone(checker.startCheck(Range(0, 0, 0, 23)), {{{6, 4}, {15, 3}}});
+    auto misspelled = checker.installedMovingRanges(doc.documentRange());
+    QCOMPARE(misspelled.size(), 2);
+    QCOMPARE(misspelled[0]->toRange(), Range(0, 6, 0, 10));
+    QCOMPARE(misspelled[1]->toRange(), Range(0, 15, 0, 18));
+    QCOMPARE(checker.dictionaryForMisspelledRange(Range(0, 6, 0, 10)), QStringLiteral("en_US"));
+    MovingRange *wrld = misspelled[0];
+
+    checker.spellCheckDone(checker.startCheck(Range(1, 0, 1, 10)), {{{0, 5}}});
+    QCOMPARE(checker.installedMovingRanges(doc.documentRange()).size(), 3);
+
+    // checking again keeps the misspellings that are still there and only drops the others,
+    // e.g. after a word was added to the dictionary
+    checker.spellCheckDone(checker.startCheck(Range(0, 0, 0, 23)), {{{6, 4}}});
+    misspelled = checker.installedMovingRanges(Range(0, 0, 0, 23));
+    QCOMPARE(misspelled.size(), 1);
+    QCOMPARE(misspelled[0], wrld);
+    QCOMPARE(wrld->toRange(), Range(0, 6, 0, 10));
+
+    // misspellings of other lines are untouched
+    QCOMPARE(checker.installedMovingRanges(Range(1, 0, 1, 10)).size(), 1);
+
+    // a new misspelling in the same range is added next to the kept one
+    checker.spellCheckDone(checker.startCheck(Range(0, 0, 0, 23)), {{{0, 5}, {6, 4}}});
+    misspelled = checker.installedMovingRanges(Range(0, 0, 0, 23));
+    QCOMPARE(misspelled.size(), 2);
+    QVERIFY(misspelled.contains(wrld));
+}
+
+void OnTheFlyCheckTest::testRequeueChangedText()
+{
+    DocumentPrivate doc;
+    doc.setText(QStringLiteral("hello wrld"));
+    TestChecker checker(&doc);
+
+    // without a view the edit is not handled as modification, the result comes in for an outdated text
+    const quint64 spellCheck = checker.startCheck(Range(0, 0, 0, 10));
+    MovingRange *checkedRange = checker.checkedRange();
+    doc.insertText(Cursor(0, 6), QStringLiteral("wo"));
+    QCOMPARE(checkedRange->toRange(), Range(0, 0, 0, 12));
+
+    // nothing is marked for the old text, the range is checked again
+    checker.spellCheckDone(spellCheck, {{{6, 4}}});
+    QVERIFY(checker.installedMovingRanges(doc.documentRange()).isEmpty());
+    QCOMPARE(checker.m_spellCheckQueue.size(), 1);
+    QCOMPARE(checker.m_spellCheckQueue.first().range, checkedRange);
+    QCOMPARE(checker.m_spellCheckQueue.first().dictionary, QStringLiteral("en_US"));
+
+    // results of a stopped check are ignored
+    const quint64 stopped = checker.startCheck(Range(0, 0, 0, 5));
+    checker.startCheck(Range(0, 6, 0, 12));
+    checker.spellCheckDone(stopped, {{{0, 5}}});
+    QVERIFY(checker.installedMovingRanges(doc.documentRange()).isEmpty());
+}
+
+#include "moc_ontheflycheck_test.cpp"
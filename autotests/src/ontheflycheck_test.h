@@ -0,0 +1,24 @@
+/*
+    SPDX-FileCopyrightText: KDE Developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef ONTHEFLYCHECK_TEST_H
+#define ONTHEFLYCHECK_TEST_H
+
+#include <QObject>
+
+class OnTheFlyCheckTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    OnTheFlyCheckTest();
+
+private Q_SLOTS:
+    void testUpdateMisspellings();
+    void testRequeueChangedText();
+};
+
+#endif
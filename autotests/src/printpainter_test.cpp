@@ -0,0 +1,276 @@
+/*
+    SPDX-FileCopyrightText: KDE Developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "printpainter_test.h"
+
+#include <katedocument.h>
+#include <kateview.h>
+#include <printing/printpainter.h>
+
+#include <QFile>
+#include <QPaintEngine>
+#include <QPainter>
+#include <QPrinter>
+#include <QRegularExpression>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QTest>
+
+using namespace KatePrinter;
+
+QTEST_MAIN(PrintPainterTest)
+
+PrintPainterTest::PrintPainterTest()
+    : QObject()
+{
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+namespace
+{
+// remembers the text drawn on a page, e.g. the header
+class TextRecordingEngine : public QPaintEngine
+{
+public:
+    TextRecordingEngine()
+        : QPaintEngine(QPaintEngine::AllFeatures)
+    {
+    }
+
+    bool begin(QPaintDevice *) override
+    {
+        return true;
+    }
+    bool end() override
+    {
+        return true;
+    }
+    void updateState(const QPaintEngineState &) override
+    {
+    }
+    void drawPath(const QPainterPath &) override
+    {
+    }
+    void drawPolygon(const QPointF *, int, PolygonDrawMode) override
+    {
+    }
+    void drawPixmap(const QRectF &, const QPixmap &, const QRectF &) override
+    {
+    }
+    void drawTextItem(const QPointF &, const QTextItem &textItem) override
+    {
+        texts.append(textItem.text());
+    }
+    Type type() const override
+    {
+        return QPaintEngine::User;
+    }
+
+    QStringList texts;
+};
+
+class TextRecordingDevice : public QPaintDevice
+{
+public:
+    ~TextRecordingDevice() override = default;
+
+    QPaintEngine *paintEngine() const override
+    {
+        return &engine;
+    }
+
+    int metric(PaintDeviceMetric metric) const override
+    {
+        switch (metric) {
+        case PdmWidth:
+            return 800;
+        case PdmHeight:
+            return 1100;
+        case PdmDepth:
+            return 32;
+        case PdmDpiX:
+        case PdmDpiY:
+        case PdmPhysicalDpiX:
+        case PdmPhysicalDpiY:
+            return 96;
+        default:
+            return QPaintDevice::metric(metric);
+        }
+    }
+
+    mutable TextRecordingEngine engine;
+};
+
+QString numberedLines(int lines)
+{
+    QStringList text;
+    for (int i = 0; i < lines; ++i) {
+        text.append(QStringLiteral("line %1").arg(i));
+    }
+    return text.join(QLatin1Char('\n'));
+}
+
+int pdfPageCount(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return -1;
+    }
+    const QString pdf = QString::fromLatin1(file.readAll());
+    return pdf.count(QRegularExpression(QStringLiteral("/Type\\s*/Page\\b")));
+}
+}
+
+void PrintPainterTest::testPageBreaks()
+{
+    KTextEditor::DocumentPrivate doc;
+    doc.setText(numberedLines(500));
+    KTextEditor::ViewPrivate view(&doc, nullptr);
+
+    QPrinter printer;
+    PrintPainter painter(&doc, &view);
+    PageLayout pl;
+    painter.configure(&printer, pl);
+
+    // without header and box each page is filled with the lines that fit completely
+    const int linesPerPage = pl.maxHeight / painter.m_fontHeight;
+    QVERIFY(linesPerPage > 1);
+    QVERIFY(linesPerPage < 500);
+
+    const auto &pages = painter.paginate(pl);
+    QCOMPARE(pages.size(), (500 + linesPerPage - 1) / linesPerPage);
+    for (int page = 0; page < pages.size(); ++page) {
+        QCOMPARE(pages[page].line, uint(page * linesPerPage));
+        QCOMPARE(pages[page].remainder, 0u);
+    }
+
+    // an edit paginates again
+    doc.removeText(KTextEditor::Range(0, 0, linesPerPage, 0));
+    const int remainingLines = 500 - linesPerPage;
+    QCOMPARE(painter.paginate(pl).size(), (remainingLines + linesPerPage - 1) / linesPerPage);
+
+    // a header moves the text down and so the page breaks up
+    painter.setUseHeader(true);
+    painter.setHeaderFormat({QStringLiteral("%p"), QString(), QString()});
+    PageLayout withHeader;
+    painter.configure(&printer, withHeader);
+    const uint top = painter.contentTop(2, withHeader);
+    QVERIFY(top > 0);
+    const auto &headerPages = painter.paginate(withHeader);
+    const int linesPerHeaderPage = (withHeader.maxHeight - top) / painter.m_fontHeight;
+    QCOMPARE(headerPages[1].line, uint(linesPerHeaderPage));
+}
+
+void PrintPainterTest::testWrappedLineRemainder()
+{
+    KTextEditor::DocumentPrivate doc;
+    KTextEditor::ViewPrivate view(&doc, nullptr);
+
+    QPrinter printer;
+    PrintPainter painter(&doc, &view);
+    PageLayout pl;
+    painter.configure(&printer, pl);
+    const int linesPerPage = pl.maxHeight / painter.m_fontHeight;
+
+    // a line wrapping over the end of the first page, only two of its view lines fit there
+    const int wrappedLine = linesPerPage - 2;
+    doc.setText(numberedLines(wrappedLine) + QLatin1Char('\n') + QStringLiteral("word ").repeated(400) + QLatin1Char('\n') + numberedLines(300));
+    const int viewLines = painter.viewLineCount(wrappedLine, pl);
+    QVERIFY(viewLines > 2);
+    QVERIFY(viewLines < linesPerPage);
+
+    const auto &pages = painter.paginate(pl);
+    QCOMPARE(pages[0].line, 0u);
+    QCOMPARE(pages[0].remainder, 0u);
+    QCOMPARE(pages[1].line, uint(wrappedLine));
+    QCOMPARE(pages[1].remainder, uint(viewLines - 2));
+
+    // the remaining view lines of the wrapped line start the second page, all pages are full
+    const int totalViewLines = doc.lines() - 1 + viewLines;
+    QCOMPARE(pages.size(), (totalViewLines + linesPerPage - 1) / linesPerPage);
+    QCOMPARE(pages[2].line, uint(wrappedLine + 1 + linesPerPage - (viewLines - 2)));
+    QCOMPARE(pages[2].remainder, 0u);
+    QCOMPARE(pages.last().line, uint((pages.size() - 1) * linesPerPage - viewLines + 1));
+}
+
+void PrintPainterTest::testPageNumbers()
+{
+    KTextEditor::DocumentPrivate doc;
+    doc.setText(numberedLines(500));
+    KTextEditor::ViewPrivate view(&doc, nullptr);
+
+    QPrinter printer;
+    PrintPainter painter(&doc, &view);
+    painter.setUseHeader(true);
+    painter.setHeaderFormat({QStringLiteral("%p"), QStringLiteral("%P"), QStringLiteral("header")});
+    PageLayout pl;
+    painter.configure(&printer, pl);
+
+    const auto &pages = painter.paginate(pl);
+    QVERIFY(pages.size() > 2);
+    painter.substitutePageCount(pl, pages.size());
+    QCOMPARE(pl.headerTagList, QStringList({QStringLiteral("%p"), QString::number(pages.size()), QStringLiteral("header")}));
+
+    // "%p" is the number of the painted page
+    TextRecordingDevice device;
+    QPainter p(&device);
+    painter.paintPage(p, 2, pages[1], pl);
+    p.end();
+    QVERIFY(device.engine.texts.contains(QStringLiteral("2")));
+    QVERIFY(device.engine.texts.contains(QString::number(pages.size())));
+    QVERIFY(device.engine.texts.contains(QStringLiteral("header")));
+}
+
+void PrintPainterTest::testPageRange()
+{
+    KTextEditor::DocumentPrivate doc;
+    doc.setText(numberedLines(500));
+    KTextEditor::ViewPrivate view(&doc, nullptr);
+
+    QTemporaryDir dir;
+    PrintPainter painter(&doc, &view);
+
+    // all pages
+    QPrinter all;
+    all.setOutputFormat(QPrinter::PdfFormat);
+    all.setOutputFileName(dir.filePath(QStringLiteral("all.pdf")));
+    PageLayout pl;
+    painter.configure(&all, pl);
+    const int totalPages = painter.paginate(pl).size();
+    QVERIFY(totalPages > 3);
+
+    QList<std::pair<int, int>> progress;
+    const auto recordProgress = [&progress](int printedPages, int pages) {
+        progress.append({printedPages, pages});
+        return true;
+    };
+    painter.paint(&all, recordProgress);
+    QCOMPARE(progress.size(), totalPages);
+    QCOMPARE(progress.last(), std::make_pair(totalPages, totalPages));
+    QCOMPARE(pdfPageCount(all.outputFileName()), totalPages);
+
+    // exactly the selected pages
+    progress.clear();
+    QPrinter range;
+    range.setOutputFormat(QPrinter::PdfFormat);
+    range.setOutputFileName(dir.filePath(QStringLiteral("range.pdf")));
+    range.setFromTo(2, 3);
+    painter.paint(&range, recordProgress);
+    QCOMPARE(progress, QList<std::pair<int, int>>({{1, 2}, {2, 2}}));
+    QCOMPARE(pdfPageCount(range.outputFileName()), 2);
+
+    // a range behind the last page ends with the last page
+    progress.clear();
+    QPrinter last;
+    last.setOutputFormat(QPrinter::PdfFormat);
+    last.setOutputFileName(dir.filePath(QStringLiteral("last.pdf")));
+    last.setFromTo(totalPages, totalPages + 10);
+    painter.paint(&last, recordProgress);
+    QCOMPARE(progress, QList<std::pair<int, int>>({{1, 1}}));
+    QCOMPARE(pdfPageCount(last.outputFileName()), 1);
+}
+
+#include "moc_printpainter_test.cpp"
@@ -0,0 +1,26 @@
+/*
+    SPDX-FileCopyrightText: KDE Developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef PRINT_PAINTER_TEST_H
+#define PRINT_PAINTER_TEST_H
+
+#include <QObject>
+
+class PrintPainterTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    PrintPainterTest();
+
+private Q_SLOTS:
+    void testPageBreaks();
+    void testWrappedLineRemainder();
+    void testPageNumbers();
+    void testPageRange();
+};
+
+#endif
@@ -321,3 +321,110 @@ void RegExpSearchTest::testUnicode()
     QCOMPARE(doc.text(result.at(1)), QStringLiteral("O"));
     QCOMPARE(doc.text(result.at(2)), QStringLiteral("Ó"));
 }
+
+void RegExpSearchTest::testMultiLineSearch_data()
+{
+    QTest::addColumn<QString>("pattern");
+    QTest::addColumn<Range>("inputRange");
+    QTest::addColumn<bool>("backwards");
+    QTest::addColumn<Range>("expected");
+
+    // matches crossing the border of the search windows
+    testNewRow() << QStringLiteral("foo\\nbar") << Range(0, 0, 4999, 4) << false << Range(1023, 0, 1024, 3);
+    testNewRow() << QStringLiteral("foo\\nbar") << Range(0, 0, 4999, 4) << true << Range(1023, 0, 1024, 3);
+    testNewRow() << QStringLiteral("foo\\nbar") << Range(0, 0, 1024, 2) << false << Range::invalid();
+    testNewRow() << QStringLiteral("foo\\nbar") << Range(0, 0, 1024, 2) << true << Range::invalid();
+    testNewRow() << QStringLiteral("foo\\nbar") << Range(1023, 1, 4999, 4) << false << Range::invalid();
+    testNewRow() << QStringLiteral("foo\\nbar") << Range(1023, 1, 4999, 4) << true << Range::invalid();
+    testNewRow() << QStringLiteral("^bar\\n") << Range(0, 0, 4999, 4) << true << Range(1024, 0, 1025, 0);
+
+    // unbounded number of lines
+    testNewRow() << QStringLiteral("begin\\n(.*\\n)*end") << Range(0, 0, 4999, 4) << false << Range(2047, 0, 3500, 3);
+    testNewRow() << QStringLiteral("begin\\n(.*\\n)*end") << Range(0, 0, 4999, 4) << true << Range(2047, 0, 3500, 3);
+    testNewRow() << QStringLiteral("begin\\n(.*\\n)*end") << Range(2048, 0, 4999, 4) << false << Range::invalid();
+    testNewRow() << QStringLiteral("begin\\n(.*\\n)*end") << Range(0, 0, 3500, 2) << true << Range::invalid();
+    testNewRow() << QStringLiteral("begin\\n[^X]*end") << Range(0, 0, 4999, 4) << false << Range(2047, 0, 3500, 3);
+    testNewRow() << QStringLiteral("begin\\n[^X]*end") << Range(2000, 0, 4999, 4) << true << Range(2047, 0, 3500, 3);
+    testNewRow() << QStringLiteral("begin\\n[^X]*end") << Range(2000, 0, 3500, 2) << true << Range::invalid();
+
+    // line feeds the pattern doesn't spell as \\n, lookbehinds into the previous window
+    testNewRow() << QStringLiteral("foo\\N{U+000A}bar\\n?") << Range(0, 0, 4999, 4) << false << Range(1023, 0, 1025, 0);
+    testNewRow() << QStringLiteral("foo\\N{U+000A}bar\\n?") << Range(0, 0, 4999, 4) << true << Range(1023, 0, 1025, 0);
+    testNewRow() << QStringLiteral("(?<=foo\\n)bar\\n") << Range(0, 0, 4999, 4) << false << Range(1024, 0, 1025, 0);
+
+    // matches must end inside of the range, also if it doesn't start in the first line
+    testNewRow() << QStringLiteral("\\d\\nline") << Range(10, 0, 11, 3) << false << Range::invalid();
+    testNewRow() << QStringLiteral("\\d\\nline") << Range(10, 0, 20, 3) << false << Range(10, 6, 11, 4);
+    testNewRow() << QStringLiteral("\\d\\nline") << Range(10, 0, 20, 3) << true << Range(18, 6, 19, 4);
+    testNewRow() << QStringLiteral("\\d\\n(.*\\n)*?line") << Range(10, 0, 20, 3) << true << Range(18, 6, 19, 4);
+}
+
+void RegExpSearchTest::testMultiLineSearch()
+{
+    QFETCH(QString, pattern);
+    QFETCH(Range, inputRange);
+    QFETCH(bool, backwards);
+    QFETCH(Range, expected);
+
+    QStringList lines;
+    for (int i = 0; i < 5000; ++i) {
+        lines.append(QStringLiteral("line %1").arg(i));
+    }
+    lines[1023] = QStringLiteral("foo");
+    lines[1024] = QStringLiteral("bar");
+    lines[2047] = QStringLiteral("begin");
+    lines[3500] = QStringLiteral("end");
+
+    KTextEditor::DocumentPrivate doc;
+    doc.setText(lines);
+
+    KateRegExpSearch searcher(&doc);
+    const QList<Range> result = searcher.search(pattern, inputRange, backwards);
+
+    QCOMPARE(result.at(0), expected);
+}
+
+void RegExpSearchTest::testSearchPattern()
+{
+    QVERIFY(!KateRegExpSearchPattern().isValid());
+    QVERIFY(!KateRegExpSearchPattern(QString()).isValid());
+    QVERIFY(!KateRegExpSearchPattern(QStringLiteral("(a")).isValid());
+
+    const KateRegExpSearchPattern singleLine(QStringLiteral("b(a+)r"), QRegularExpression::CaseInsensitiveOption);
+    QVERIFY(singleLine.isValid());
+    QVERIFY(!singleLine.isMultiLine());
+    QCOMPARE(singleLine.pattern(), QStringLiteral("b(a+)r"));
+    QVERIFY(singleLine.options() == QRegularExpression::CaseInsensitiveOption);
+
+    const KateRegExpSearchPattern multiLine(QStringLiteral("foo\\nbar"));
+    QVERIFY(multiLine.isValid());
+    QVERIFY(multiLine.isMultiLine());
+    QCOMPARE(multiLine.lineSpan(), 1);
+
+    // anything the estimation doesn't understand is unbounded
+    QCOMPARE(KateRegExpSearchPattern(QStringLiteral("foo\\N{U+000A}bar\\n")).lineSpan(), -1);
+    QCOMPARE(KateRegExpSearchPattern(QStringLiteral("foo\\n(*pla:bar)")).lineSpan(), -1);
+
+    // one pattern shared by searches in different documents
+    KTextEditor::DocumentPrivate doc1;
+    doc1.setText(QStringLiteral("foo\nBAAR\nbar"));
+    KTextEditor::DocumentPrivate doc2;
+    doc2.setText(QStringLiteral("bar\nfoo\nbar"));
+
+    const KateRegExpSearch searcher1(&doc1);
+    const KateRegExpSearch searcher2(&doc2);
+    const KateRegExpSearchPattern copy = singleLine;
+
+    QList<Range> result = searcher1.search(singleLine, doc1.documentRange());
+    QCOMPARE(result.size(), 2);
+    QCOMPARE(result.at(0), Range(1, 0, 1, 4));
+    QCOMPARE(result.at(1), Range(1, 1, 1, 3));
+    QCOMPARE(searcher2.search(copy, doc2.documentRange(), true).at(0), Range(2, 0, 2, 3));
+    QCOMPARE(searcher1.search(singleLine, doc1.documentRange(), true).at(0), Range(2, 0, 2, 3));
+
+    QCOMPARE(searcher1.search(multiLine, doc1.documentRange()).at(0), Range::invalid());
+    QCOMPARE(searcher2.search(multiLine, doc2.documentRange()).at(0), Range(1, 0, 2, 3));
+
+    // the string based overload gives the same results
+    QCOMPARE(searcher1.search(QStringLiteral("b(a+)r"), doc1.documentRange(), false, QRegularExpression::CaseInsensitiveOption), result);
+}
@@ -40,6 +40,11 @@ private Q_SLOTS:
 
     void test();
     void testUnicode();
+
+    void testMultiLineSearch_data();
+    void testMultiLineSearch();
+
+    void testSearchPattern();
 };
 
 #endif
@@ -0,0 +1,91 @@
+/*
+    SPDX-FileCopyrightText: KDE Developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "spellcheckcache_test.h"
+
+#include <spellcheck/spellcheckcache.h>
+
+#include <QTest>
+
+QTEST_MAIN(SpellCheckCacheTest)
+
+void SpellCheckCacheTest::testLookup()
+{
+    KateSpellCheckCache cache;
+    const QString en = QStringLiteral("en_US");
+    const QString de = QStringLiteral("de_DE");
+
+    QVERIFY(!cache.isMisspelled(en, QStringLiteral("house")));
+
+    cache.insert(en, QStringLiteral("house"), false);
+    cache.insert(en, QStringLiteral("hosue"), true);
+    QCOMPARE(cache.isMisspelled(en, QStringLiteral("house")), std::optional<bool>(false));
+    QCOMPARE(cache.isMisspelled(en, QStringLiteral("hosue")), std::optional<bool>(true));
+
+    // the dictionaries are separate
+    QVERIFY(!cache.isMisspelled(de, QStringLiteral("house")));
+    cache.insert(de, QStringLiteral("house"), true);
+    QCOMPARE(cache.isMisspelled(de, QStringLiteral("house")), std::optional<bool>(true));
+    QCOMPARE(cache.isMisspelled(en, QStringLiteral("house")), std::optional<bool>(false));
+
+    // inserting again updates the result
+    cache.insert(en, QStringLiteral("hosue"), false);
+    QCOMPARE(cache.isMisspelled(en, QStringLiteral("hosue")), std::optional<bool>(false));
+    QCOMPARE(cache.size(en), qsizetype(2));
+    QCOMPARE(cache.size(de), qsizetype(1));
+}
+
+void SpellCheckCacheTest::testLeastRecentlyUsed()
+{
+    KateSpellCheckCache cache(3);
+    const QString en = QStringLiteral("en_US");
+
+    cache.insert(en, QStringLiteral("one"), false);
+    cache.insert(en, QStringLiteral("two"), false);
+    cache.insert(en, QStringLiteral("three"), false);
+
+    // a lookup makes "one" the most recently used word, "two" is dropped next
+    QVERIFY(cache.isMisspelled(en, QStringLiteral("one")));
+    cache.insert(en, QStringLiteral("four"), false);
+    QCOMPARE(cache.size(en), qsizetype(3));
+    QVERIFY(cache.isMisspelled(en, QStringLiteral("one")));
+    QVERIFY(!cache.isMisspelled(en, QStringLiteral("two")));
+    QVERIFY(cache.isMisspelled(en, QStringLiteral("three")));
+    QVERIFY(cache.isMisspelled(en, QStringLiteral("four")));
+
+    // the capacity is per dictionary
+    cache.insert(QStringLiteral("de_DE"), QStringLiteral("eins"), false);
+    QCOMPARE(cache.size(en), qsizetype(3));
+    QCOMPARE(cache.size(QStringLiteral("de_DE")), qsizetype(1));
+}
+
+void SpellCheckCacheTest::testInvalidation()
+{
+    KateSpellCheckCache cache;
+    const QString en = QStringLiteral("en_US");
+    const QString de = QStringLiteral("de_DE");
+
+    cache.insert(en, QStringLiteral("ktexteditor"), true);
+    cache.insert(en, QStringLiteral("editor"), false);
+    cache.insert(de, QStringLiteral("ktexteditor"), true);
+
+    // e.g. the word was added to the session of one dictionary
+    cache.remove(en, QStringLiteral("ktexteditor"));
+    QVERIFY(!cache.isMisspelled(en, QStringLiteral("ktexteditor")));
+    QVERIFY(cache.isMisspelled(en, QStringLiteral("editor")));
+    QVERIFY(cache.isMisspelled(de, QStringLiteral("ktexteditor")));
+
+    // removing unknown words is fine
+    cache.remove(en, QStringLiteral("unknown"));
+    cache.remove(QStringLiteral("fr_FR"), QStringLiteral("unknown"));
+
+    cache.clear(en);
+    QCOMPARE(cache.size(en), qsizetype(0));
+    QCOMPARE(cache.size(de), qsizetype(1));
+
+    cache.clear();
+    QCOMPARE(cache.size(de), qsizetype(0));
+}
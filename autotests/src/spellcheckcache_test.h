@@ -0,0 +1,22 @@
+/*
+    SPDX-FileCopyrightText: KDE Developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef SPELLCHECK_CACHE_TEST_H
+#define SPELLCHECK_CACHE_TEST_H
+
+#include <QObject>
+
+class SpellCheckCacheTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testLookup();
+    void testLeastRecentlyUsed();
+    void testInvalidation();
+};
+
+#endif
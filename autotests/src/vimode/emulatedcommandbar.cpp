@@ -16,6 +16,7 @@
 #include <katebuffer.h>
 #include <kateconfig.h>
 #include <katedocument.h>
+#include <katerenderer.h>
 #include <kateview.h>
 #include <ktexteditor/range.h>
 #include <vimode/emulatedcommandbar/emulatedcommandbar.h>
@@ -778,95 +779,98 @@ void EmulatedCommandBarTest::EmulatedCommandBarTests()
     FinishTest("foo\nbar\nbbc");
 
     // Search-highlighting tests.
-    const QColor searchHighlightColour = kate_view->rendererConfig()->searchHighlightColor();
     BeginTest(QStringLiteral("foo bar xyz"));
 
     // Sanity test.
     const QList<Kate::TextRange *> rangesInitial = rangesOnFirstLine();
     Q_ASSERT(rangesInitial.isEmpty() && "Assumptions about ranges are wrong - this test is invalid and may need updating!");
+    QVERIFY(searchHighlightsOnFirstLine().isEmpty());
     FinishTest("foo bar xyz");
 
     // Test highlighting single character match.
     BeginTest(QStringLiteral("foo bar xyz"));
     TestPressKey(QStringLiteral("/b"));
-    QCOMPARE(rangesOnFirstLine().size(), rangesInitial.size() + 1);
-    QCOMPARE(rangesOnFirstLine().constFirst()->attribute()->background().color(), searchHighlightColour);
-    QCOMPARE(rangesOnFirstLine().constFirst()->start().line(), 0);
-    QCOMPARE(rangesOnFirstLine().constFirst()->start().column(), 4);
-    QCOMPARE(rangesOnFirstLine().constFirst()->end().line(), 0);
-    QCOMPARE(rangesOnFirstLine().constFirst()->end().column(), 5);
+    QCOMPARE(searchHighlightsOnFirstLine().size(), 1);
+    QCOMPARE(searchHighlightsOnFirstLine().constFirst().start().line(), 0);
+    QCOMPARE(searchHighlightsOnFirstLine().constFirst().start().column(), 4);
+    QCOMPARE(searchHighlightsOnFirstLine().constFirst().end().line(), 0);
+    QCOMPARE(searchHighlightsOnFirstLine().constFirst().end().column(), 5);
+    QCOMPARE(searchHighlightDecorationsOnFirstLine().size(), 1);
+    QCOMPARE(searchHighlightDecorationsOnFirstLine().constFirst().start, 4);
+    QCOMPARE(searchHighlightDecorationsOnFirstLine().constFirst().length, 1);
     TestPressKey(QStringLiteral("\\enter"));
     FinishTest("foo bar xyz");
 
     // Test highlighting two character match.
     BeginTest(QStringLiteral("foo bar xyz"));
     TestPressKey(QStringLiteral("/ba"));
-    QCOMPARE(rangesOnFirstLine().size(), rangesInitial.size() + 1);
-    QCOMPARE(rangesOnFirstLine().constFirst()->start().line(), 0);
-    QCOMPARE(rangesOnFirstLine().constFirst()->start().column(), 4);
-    QCOMPARE(rangesOnFirstLine().constFirst()->end().line(), 0);
-    QCOMPARE(rangesOnFirstLine().constFirst()->end().column(), 6);
+    QCOMPARE(searchHighlightsOnFirstLine().size(), 1);
+    QCOMPARE(searchHighlightsOnFirstLine().constFirst().start().line(), 0);
+    QCOMPARE(searchHighlightsOnFirstLine().constFirst().start().column(), 4);
+    QCOMPARE(searchHighlightsOnFirstLine().constFirst().end().line(), 0);
+    QCOMPARE(searchHighlightsOnFirstLine().constFirst().end().column(), 6);
     TestPressKey(QStringLiteral("\\enter"));
     FinishTest("foo bar xyz");
 
     // Test no highlighting if no longer a match.
     BeginTest(QStringLiteral("foo bar xyz"));
     TestPressKey(QStringLiteral("/baz"));
-    QCOMPARE(rangesOnFirstLine().size(), rangesInitial.size());
+    QCOMPARE(searchHighlightsOnFirstLine().size(), 0);
     TestPressKey(QStringLiteral("\\enter"));
     FinishTest("foo bar xyz");
 
     // Test highlighting on wraparound.
     BeginTest(QStringLiteral(" foo bar xyz"));
     TestPressKey(QStringLiteral("ww/foo"));
-    QCOMPARE(rangesOnFirstLine().size(), rangesInitial.size() + 1);
-    QCOMPARE(rangesOnFirstLine().constFirst()->start().line(), 0);
-    QCOMPARE(rangesOnFirstLine().constFirst()->start().column(), 1);
-    QCOMPARE(rangesOnFirstLine().constFirst()->end().line(), 0);
-    QCOMPARE(rangesOnFirstLine().constFirst()->end().column(), 4);
+    QCOMPARE(searchHighlightsOnFirstLine().size(), 1);
+    QCOMPARE(searchHighlightsOnFirstLine().constFirst().start().line(), 0);
+    QCOMPARE(searchHighlightsOnFirstLine().constFirst().start().column(), 1);
+    QCOMPARE(searchHighlightsOnFirstLine().constFirst().end().line(), 0);
+    QCOMPARE(searchHighlightsOnFirstLine().constFirst().end().column(), 4);
     TestPressKey(QStringLiteral("\\enter"));
     FinishTest(" foo bar xyz");
 
     // Test highlighting backwards
     BeginTest(QStringLiteral("foo bar xyz"));
     TestPressKey(QStringLiteral("$?ba"));
-    QCOMPARE(rangesOnFirstLine().size(), rangesInitial.size() + 1);
-    QCOMPARE(rangesOnFirstLine().constFirst()->start().line(), 0);
-    QCOMPARE(rangesOnFirstLine().constFirst()->start().column(), 4);
-    QCOMPARE(rangesOnFirstLine().constFirst()->end().line(), 0);
-    QCOMPARE(rangesOnFirstLine().constFirst()->end().column(), 6);
+    QCOMPARE(searchHighlightsOnFirstLine().size(), 1);
+    QCOMPARE(searchHighlightsOnFirstLine().constFirst().start().line(), 0);
+    QCOMPARE(searchHighlightsOnFirstLine().constFirst().start().column(), 4);
+    QCOMPARE(searchHighlightsOnFirstLine().constFirst().end().line(), 0);
+    QCOMPARE(searchHighlightsOnFirstLine().constFirst().end().column(), 6);
     TestPressKey(QStringLiteral("\\enter"));
     FinishTest("foo bar xyz");
 
     // Test no highlighting when no match is found searching backwards
     BeginTest(QStringLiteral("foo bar xyz"));
     TestPressKey(QStringLiteral("$?baz"));
-    QCOMPARE(rangesOnFirstLine().size(), rangesInitial.size());
+    QCOMPARE(searchHighlightsOnFirstLine().size(), 0);
     TestPressKey(QStringLiteral("\\enter"));
     FinishTest("foo bar xyz");
 
     // Test highlight when wrapping around after searching backwards.
     BeginTest(QStringLiteral("foo bar xyz"));
     TestPressKey(QStringLiteral("w?xyz"));
-    QCOMPARE(rangesOnFirstLine().size(), rangesInitial.size() + 1);
-    QCOMPARE(rangesOnFirstLine().constFirst()->start().line(), 0);
-    QCOMPARE(rangesOnFirstLine().constFirst()->start().column(), 8);
-    QCOMPARE(rangesOnFirstLine().constFirst()->end().line(), 0);
-    QCOMPARE(rangesOnFirstLine().constFirst()->end().column(), 11);
+    QCOMPARE(searchHighlightsOnFirstLine().size(), 1);
+    QCOMPARE(searchHighlightsOnFirstLine().constFirst().start().line(), 0);
+    QCOMPARE(searchHighlightsOnFirstLine().constFirst().start().column(), 8);
+    QCOMPARE(searchHighlightsOnFirstLine().constFirst().end().line(), 0);
+    QCOMPARE(searchHighlightsOnFirstLine().constFirst().end().column(), 11);
     TestPressKey(QStringLiteral("\\enter"));
     FinishTest("foo bar xyz");
 
     // Test no highlighting when bar is dismissed.
     DoTest("foo bar xyz", "/bar\\ctrl-c", "foo bar xyz");
-    QCOMPARE(rangesOnFirstLine().size(), rangesInitial.size());
+    QCOMPARE(searchHighlightsOnFirstLine().size(), 0);
+    QVERIFY(searchHighlightDecorationsOnFirstLine().isEmpty());
     DoTest("foo bar xyz", ":set-nohls\\enter/bar\\enter", "foo bar xyz");
-    QCOMPARE(rangesOnFirstLine().size(), rangesInitial.size());
+    QVERIFY(searchHighlightDecorationsOnFirstLine().isEmpty());
     DoTest("foo bar xyz", "/bar\\ctrl-[", "foo bar xyz");
-    QCOMPARE(rangesOnFirstLine().size(), rangesInitial.size());
+    QVERIFY(searchHighlightDecorationsOnFirstLine().isEmpty());
     DoTest("foo bar xyz", ":set-nohls\\enter/bar\\return", "foo bar xyz");
-    QCOMPARE(rangesOnFirstLine().size(), rangesInitial.size());
+    QVERIFY(searchHighlightDecorationsOnFirstLine().isEmpty());
     DoTest("foo bar xyz", "/bar\\esc", "foo bar xyz");
-    QCOMPARE(rangesOnFirstLine().size(), rangesInitial.size());
+    QVERIFY(searchHighlightDecorationsOnFirstLine().isEmpty());
 
     // Update colour on config change.
     BeginTest(QStringLiteral("foo bar xyz"));
@@ -3284,6 +3288,22 @@ QList<Kate::TextRange *> EmulatedCommandBarTest::rangesOnFirstLine()
     return kate_document->buffer().rangesForLine(0, kate_view, true);
 }
 
+QList<KTextEditor::Range> EmulatedCommandBarTest::searchHighlightsOnFirstLine()
+{
+    return vi_input_mode->searchHighlightsForLine(0);
+}
+
+QList<QTextLayout::FormatRange> EmulatedCommandBarTest::searchHighlightDecorationsOnFirstLine()
+{
+    // what the renderer paints in the search highlight color
+    QList<QTextLayout::FormatRange> decorations = kate_view->renderer()->decorationsForLine(kate_document->kateTextLine(0), 0);
+    const QColor searchHighlightColour = kate_view->rendererConfig()->searchHighlightColor();
+    decorations.removeIf([searchHighlightColour](const QTextLayout::FormatRange &decoration) {
+        return decoration.format.background().color() != searchHighlightColour;
+    });
+    return decorations;
+}
+
 void EmulatedCommandBarTest::verifyTextEditBackgroundColour(const QColor &expectedBackgroundColour)
 {
     QCOMPARE(emulatedCommandBarTextEdit()->palette().brush(QPalette::Base).color(), expectedBackgroundColour);
@@ -11,6 +11,8 @@
 
 #include "base.h"
 
+#include <QTextLayout>
+
 class QCompleter;
 class QLabel;
 class QColor;
@@ -44,6 +46,8 @@ private:
     QStringList replaceHistory();
 
     QList<Kate::TextRange *> rangesOnFirstLine();
+    QList<KTextEditor::Range> searchHighlightsOnFirstLine();
+    QList<QTextLayout::FormatRange> searchHighlightDecorationsOnFirstLine();
     void verifyTextEditBackgroundColour(const QColor &expectedBackgroundColour);
     QLabel *commandResponseMessageDisplay();
     void waitForEmulatedCommandBarToHide(long int timeout);
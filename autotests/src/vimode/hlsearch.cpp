@@ -11,6 +11,7 @@
 #include <katebuffer.h>
 #include <kateconfig.h>
 #include <katedocument.h>
+#include <katerenderer.h>
 #include <kateview.h>
 #include <vimode/emulatedcommandbar/emulatedcommandbar.h>
 
@@ -29,11 +30,9 @@ void HlSearchTest::highlightModeTests()
 
     setWindowSize();
 
-    const QList<Kate::TextRange *> rangesInitial = rangesOnLine(0);
+    const QList<KTextEditor::Range> rangesInitial = rangesOnLine(0);
     Q_ASSERT(rangesInitial.isEmpty() && "Assumptions about ranges are wrong - this test is invalid and may need updating!");
 
-    const QColor searchHighlightColor = kate_view->rendererConfig()->searchHighlightColor();
-
     // test commands exist
     {
         QCOMPARE(vi_input_mode->viModeEmulatedCommandBar()->executeCommand(QStringLiteral("set-hls")).size(), 0);
@@ -52,11 +51,11 @@ void HlSearchTest::highlightModeTests()
 
         TestPressKey(QStringLiteral("w*"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size() + 2);
 
-            TestHighlight(*ranges[0], {0, 4}, {0, 7}, searchHighlightColor);
-            TestHighlight(*ranges[1], {0, 19}, {0, 22}, searchHighlightColor);
+            TestHighlight(ranges[0], {0, 4}, {0, 7});
+            TestHighlight(ranges[1], {0, 19}, {0, 22});
         }
         FinishTest(text.toUtf8().constData());
     }
@@ -69,11 +68,11 @@ void HlSearchTest::highlightModeTests()
 
         TestPressKey(QStringLiteral("w#"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size() + 2);
 
-            TestHighlight(*ranges[0], {0, 4}, {0, 7}, searchHighlightColor);
-            TestHighlight(*ranges[1], {0, 19}, {0, 22}, searchHighlightColor);
+            TestHighlight(ranges[0], {0, 4}, {0, 7});
+            TestHighlight(ranges[1], {0, 19}, {0, 22});
         }
         FinishTest(text.toUtf8().constData());
     }
@@ -86,11 +85,11 @@ void HlSearchTest::highlightModeTests()
 
         TestPressKey(QStringLiteral("/bar\\enter"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size() + 2);
 
-            TestHighlight(*ranges[0], {0, 4}, {0, 7}, searchHighlightColor);
-            TestHighlight(*ranges[1], {0, 19}, {0, 22}, searchHighlightColor);
+            TestHighlight(ranges[0], {0, 4}, {0, 7});
+            TestHighlight(ranges[1], {0, 19}, {0, 22});
         }
         FinishTest(text.toUtf8().constData());
     }
@@ -103,11 +102,11 @@ void HlSearchTest::highlightModeTests()
 
         TestPressKey(QStringLiteral("?bar\\enter"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size() + 2);
 
-            TestHighlight(*ranges[0], {0, 4}, {0, 7}, searchHighlightColor);
-            TestHighlight(*ranges[1], {0, 19}, {0, 22}, searchHighlightColor);
+            TestHighlight(ranges[0], {0, 4}, {0, 7});
+            TestHighlight(ranges[1], {0, 19}, {0, 22});
         }
         FinishTest(text.toUtf8().constData());
     }
@@ -120,15 +119,15 @@ void HlSearchTest::highlightModeTests()
 
         TestPressKey(QStringLiteral("/bar"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size() + 2);
 
-            TestHighlight(*ranges[0], {0, 4}, {0, 7}, searchHighlightColor);
-            TestHighlight(*ranges[1], {0, 19}, {0, 22}, searchHighlightColor);
+            TestHighlight(ranges[0], {0, 4}, {0, 7});
+            TestHighlight(ranges[1], {0, 19}, {0, 22});
         }
         TestPressKey(QStringLiteral("\\esc"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size());
         }
         FinishTest(text.toUtf8().constData());
@@ -142,15 +141,15 @@ void HlSearchTest::highlightModeTests()
 
         TestPressKey(QStringLiteral("/\\\\<\\enter"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size() + 6);
 
-            TestHighlight(*ranges[0], {0, 0}, {0, 1}, searchHighlightColor);
-            TestHighlight(*ranges[3], {0, 7}, {0, 8}, searchHighlightColor);
+            TestHighlight(ranges[0], {0, 0}, {0, 1});
+            TestHighlight(ranges[3], {0, 7}, {0, 8});
         }
         FinishTest(text.toUtf8().constData());
     }
-    // test that only visible matches are highlighted
+    // test that lines scrolled into view are highlighted
     {
         QString text = QStringLiteral("foo bar xyz\n\n\n\n\nfoo ab bar x");
         BeginTest(text);
@@ -160,20 +159,16 @@ void HlSearchTest::highlightModeTests()
 
         TestPressKey(QStringLiteral("/bar\\enter"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size() + 1);
-            TestHighlight(*ranges[0], {0, 4}, {0, 7}, searchHighlightColor);
-            ranges = rangesOnLine(5);
-            QCOMPARE(ranges.size(), rangesInitial.size());
+            TestHighlight(ranges[0], {0, 4}, {0, 7});
         }
 
         kate_view->bottom();
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
-            QCOMPARE(ranges.size(), rangesInitial.size());
-            ranges = rangesOnLine(5);
+            QList<KTextEditor::Range> ranges = rangesOnLine(5);
             QCOMPARE(ranges.size(), rangesInitial.size() + 1);
-            TestHighlight(*ranges[0], {5, 7}, {5, 10}, searchHighlightColor);
+            TestHighlight(ranges[0], {5, 7}, {5, 10});
         }
         FinishTest(text.toUtf8().constData());
     }
@@ -187,11 +182,11 @@ void HlSearchTest::highlightModeTests()
 
         TestPressKey(QStringLiteral("/barx"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size());
             ranges = rangesOnLine(5);
             QCOMPARE(ranges.size(), rangesInitial.size() + 1);
-            TestHighlight(*ranges[0], {5, 7}, {5, 11}, searchHighlightColor);
+            TestHighlight(ranges[0], {5, 7}, {5, 11});
         }
         TestPressKey(QStringLiteral("\\enter"));
 
@@ -204,9 +199,10 @@ void HlSearchTest::highlightModeTests()
 
         TestPressKey(QStringLiteral("/bar"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size() + 1);
-            TestHighlight(*ranges[0], {0, 4}, {0, 7}, searchHighlightColor);
+            TestHighlight(ranges[0], {0, 4}, {0, 7});
+            QVERIFY(kate_document->buffer().rangesForLine(0, kate_view, true).isEmpty());
         }
         TestPressKey(QStringLiteral("\\enter"));
         FinishTest(text.toUtf8().constData());
@@ -221,20 +217,20 @@ void HlSearchTest::highlightModeTests()
 
         TestPressKey(QStringLiteral("/bar\\enter"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size() + 1);
-            TestHighlight(*ranges[0], {0, 4}, {0, 7}, searchHighlightColor);
+            TestHighlight(ranges[0], {0, 4}, {0, 7});
         }
 
         TestPressKey(QStringLiteral(":noh\\enter"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size());
         }
         // changing view range should not activate highlighting again
         kate_view->bottom();
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(5);
+            QList<KTextEditor::Range> ranges = rangesOnLine(5);
             QCOMPARE(ranges.size(), rangesInitial.size());
         }
         FinishTest(text.toUtf8().constData());
@@ -249,20 +245,20 @@ void HlSearchTest::highlightModeTests()
 
         TestPressKey(QStringLiteral("/bar\\enter"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size() + 1);
-            TestHighlight(*ranges[0], {0, 4}, {0, 7}, searchHighlightColor);
+            TestHighlight(ranges[0], {0, 4}, {0, 7});
         }
 
         TestPressKey(QStringLiteral(":nohlsearch\\enter"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size());
         }
         // changing view range should not activate highlighting again
         kate_view->bottom();
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(5);
+            QList<KTextEditor::Range> ranges = rangesOnLine(5);
             QCOMPARE(ranges.size(), rangesInitial.size());
         }
         FinishTest(text.toUtf8().constData());
@@ -274,21 +270,21 @@ void HlSearchTest::highlightModeTests()
 
         TestPressKey(QStringLiteral("/bar\\enter"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size() + 1);
-            TestHighlight(*ranges[0], {0, 4}, {0, 7}, searchHighlightColor);
+            TestHighlight(ranges[0], {0, 4}, {0, 7});
         }
 
         TestPressKey(QStringLiteral(":noh\\enter"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size());
         }
         TestPressKey(QStringLiteral("/bar\\enter"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size() + 1);
-            TestHighlight(*ranges[0], {0, 4}, {0, 7}, searchHighlightColor);
+            TestHighlight(ranges[0], {0, 4}, {0, 7});
         }
         FinishTest(text.toUtf8().constData());
     }
@@ -299,21 +295,21 @@ void HlSearchTest::highlightModeTests()
 
         TestPressKey(QStringLiteral("/bar\\enter"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size() + 1);
-            TestHighlight(*ranges[0], {0, 4}, {0, 7}, searchHighlightColor);
+            TestHighlight(ranges[0], {0, 4}, {0, 7});
         }
 
         TestPressKey(QStringLiteral(":noh\\enter"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size());
         }
         TestPressKey(QStringLiteral("*"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size() + 1);
-            TestHighlight(*ranges[0], {0, 4}, {0, 7}, searchHighlightColor);
+            TestHighlight(ranges[0], {0, 4}, {0, 7});
         }
         FinishTest(text.toUtf8().constData());
     }
@@ -324,21 +320,21 @@ void HlSearchTest::highlightModeTests()
 
         TestPressKey(QStringLiteral("/bar\\enter"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size() + 1);
-            TestHighlight(*ranges[0], {0, 4}, {0, 7}, searchHighlightColor);
+            TestHighlight(ranges[0], {0, 4}, {0, 7});
         }
 
         TestPressKey(QStringLiteral(":noh\\enter"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size());
         }
         TestPressKey(QStringLiteral("n"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size() + 1);
-            TestHighlight(*ranges[0], {0, 4}, {0, 7}, searchHighlightColor);
+            TestHighlight(ranges[0], {0, 4}, {0, 7});
         }
         FinishTest(text.toUtf8().constData());
     }
@@ -349,21 +345,21 @@ void HlSearchTest::highlightModeTests()
 
         TestPressKey(QStringLiteral("/bar\\enter"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size() + 1);
-            TestHighlight(*ranges[0], {0, 4}, {0, 7}, searchHighlightColor);
+            TestHighlight(ranges[0], {0, 4}, {0, 7});
         }
 
         TestPressKey(QStringLiteral(":noh\\enter"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size());
         }
         TestPressKey(QStringLiteral("N"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size() + 1);
-            TestHighlight(*ranges[0], {0, 4}, {0, 7}, searchHighlightColor);
+            TestHighlight(ranges[0], {0, 4}, {0, 7});
         }
         FinishTest(text.toUtf8().constData());
     }
@@ -377,20 +373,20 @@ void HlSearchTest::highlightModeTests()
 
         TestPressKey(QStringLiteral("/bar\\enter"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size() + 1);
-            TestHighlight(*ranges[0], {0, 4}, {0, 7}, searchHighlightColor);
+            TestHighlight(ranges[0], {0, 4}, {0, 7});
         }
 
         TestPressKey(QStringLiteral(":set-nohls\\enter"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size());
         }
         // changing view range should not activate highlighting again
         kate_view->bottom();
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(5);
+            QList<KTextEditor::Range> ranges = rangesOnLine(5);
             QCOMPARE(ranges.size(), rangesInitial.size());
         }
         FinishTest(text.toUtf8().constData());
@@ -405,20 +401,20 @@ void HlSearchTest::highlightModeTests()
 
         TestPressKey(QStringLiteral("/bar\\enter"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size() + 1);
-            TestHighlight(*ranges[0], {0, 4}, {0, 7}, searchHighlightColor);
+            TestHighlight(ranges[0], {0, 4}, {0, 7});
         }
 
         TestPressKey(QStringLiteral(":set-nohlsearch\\enter"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size());
         }
         // changing view range should not activate highlighting again
         kate_view->bottom();
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(5);
+            QList<KTextEditor::Range> ranges = rangesOnLine(5);
             QCOMPARE(ranges.size(), rangesInitial.size());
         }
         FinishTest(text.toUtf8().constData());
@@ -430,19 +426,19 @@ void HlSearchTest::highlightModeTests()
 
         TestPressKey(QStringLiteral("/bar\\enter"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size() + 1);
-            TestHighlight(*ranges[0], {0, 4}, {0, 7}, searchHighlightColor);
+            TestHighlight(ranges[0], {0, 4}, {0, 7});
         }
 
         TestPressKey(QStringLiteral(":set-nohls\\enter"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size());
         }
         TestPressKey(QStringLiteral("/bar\\enter"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size());
         }
         FinishTest(text.toUtf8().constData());
@@ -454,19 +450,19 @@ void HlSearchTest::highlightModeTests()
 
         TestPressKey(QStringLiteral("/bar\\enter"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size() + 1);
-            TestHighlight(*ranges[0], {0, 4}, {0, 7}, searchHighlightColor);
+            TestHighlight(ranges[0], {0, 4}, {0, 7});
         }
 
         TestPressKey(QStringLiteral(":set-nohls\\enter"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size());
         }
         TestPressKey(QStringLiteral("*"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size());
         }
         FinishTest(text.toUtf8().constData());
@@ -478,21 +474,21 @@ void HlSearchTest::highlightModeTests()
 
         TestPressKey(QStringLiteral("/bar\\enter"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size() + 1);
-            TestHighlight(*ranges[0], {0, 4}, {0, 7}, searchHighlightColor);
+            TestHighlight(ranges[0], {0, 4}, {0, 7});
         }
 
         TestPressKey(QStringLiteral(":set-nohls\\enter"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size());
         }
         TestPressKey(QStringLiteral(":set-hls\\enter"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size() + 1);
-            TestHighlight(*ranges[0], {0, 4}, {0, 7}, searchHighlightColor);
+            TestHighlight(ranges[0], {0, 4}, {0, 7});
         }
         FinishTest(text.toUtf8().constData());
     }
@@ -503,21 +499,21 @@ void HlSearchTest::highlightModeTests()
 
         TestPressKey(QStringLiteral("/bar\\enter"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size() + 1);
-            TestHighlight(*ranges[0], {0, 4}, {0, 7}, searchHighlightColor);
+            TestHighlight(ranges[0], {0, 4}, {0, 7});
         }
 
         TestPressKey(QStringLiteral(":set-nohls\\enter"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size());
         }
         TestPressKey(QStringLiteral(":set-hlsearch\\enter"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size() + 1);
-            TestHighlight(*ranges[0], {0, 4}, {0, 7}, searchHighlightColor);
+            TestHighlight(ranges[0], {0, 4}, {0, 7});
         }
         FinishTest(text.toUtf8().constData());
     }
@@ -528,14 +524,14 @@ void HlSearchTest::highlightModeTests()
 
         TestPressKey(QStringLiteral("/bar\\enter"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size() + 1);
-            TestHighlight(*ranges[0], {0, 4}, {0, 7}, searchHighlightColor);
+            TestHighlight(ranges[0], {0, 4}, {0, 7});
         }
 
         kate_view->setInputMode(KTextEditor::View::InputMode::NormalInputMode);
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size());
         }
         kate_view->setInputMode(KTextEditor::View::InputMode::ViInputMode);
@@ -549,33 +545,33 @@ void HlSearchTest::highlightModeTests()
 
         TestPressKey(QStringLiteral("/bar\\enter"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size() + 3);
-            TestHighlight(*ranges[0], {0, 5}, {0, 8}, searchHighlightColor);
+            TestHighlight(ranges[0], {0, 5}, {0, 8});
         }
         TestPressKey(QStringLiteral("/"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size() + 3);
-            TestHighlight(*ranges[0], {0, 5}, {0, 8}, searchHighlightColor);
+            TestHighlight(ranges[0], {0, 5}, {0, 8});
         }
         TestPressKey(QStringLiteral("\\enter"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size() + 3);
-            TestHighlight(*ranges[0], {0, 5}, {0, 8}, searchHighlightColor);
+            TestHighlight(ranges[0], {0, 5}, {0, 8});
         }
         TestPressKey(QStringLiteral("/"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size() + 3);
-            TestHighlight(*ranges[0], {0, 5}, {0, 8}, searchHighlightColor);
+            TestHighlight(ranges[0], {0, 5}, {0, 8});
         }
         TestPressKey(QStringLiteral("\\esc"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size() + 3);
-            TestHighlight(*ranges[0], {0, 5}, {0, 8}, searchHighlightColor);
+            TestHighlight(ranges[0], {0, 5}, {0, 8});
         }
         FinishTest(text.toUtf8().constData());
     }
@@ -587,13 +583,13 @@ void HlSearchTest::highlightModeTests()
 
         TestPressKey(QStringLiteral("/bar"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size() + 3);
-            TestHighlight(*ranges[0], {0, 5}, {0, 8}, searchHighlightColor);
+            TestHighlight(ranges[0], {0, 5}, {0, 8});
         }
         TestPressKey(QStringLiteral("\\backspace\\backspace\\backspace"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size());
         }
         TestPressKey(QStringLiteral("\\esc"));
@@ -607,21 +603,21 @@ void HlSearchTest::highlightModeTests()
 
         TestPressKey(QStringLiteral("/bar\\enter"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size() + 3);
-            TestHighlight(*ranges[0], {0, 5}, {0, 8}, searchHighlightColor);
+            TestHighlight(ranges[0], {0, 5}, {0, 8});
         }
         TestPressKey(QStringLiteral("/rx"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size() + 1);
-            TestHighlight(*ranges[0], {0, 11}, {0, 13}, searchHighlightColor);
+            TestHighlight(ranges[0], {0, 11}, {0, 13});
         }
         TestPressKey(QStringLiteral("\\esc"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size() + 3);
-            TestHighlight(*ranges[0], {0, 5}, {0, 8}, searchHighlightColor);
+            TestHighlight(ranges[0], {0, 5}, {0, 8});
         }
         FinishTest(text.toUtf8().constData());
     }
@@ -631,21 +627,76 @@ void HlSearchTest::highlightModeTests()
 
         TestPressKey(QStringLiteral("/xbar\\enter"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size() + 1);
-            TestHighlight(*ranges[0], {0, 4}, {0, 8}, searchHighlightColor);
+            TestHighlight(ranges[0], {0, 4}, {0, 8});
         }
         TestPressKey(QStringLiteral("wwix\\esc"));
         {
-            QList<Kate::TextRange *> ranges = rangesOnLine(0);
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
             QCOMPARE(ranges.size(), rangesInitial.size() + 2);
-            TestHighlight(*ranges[0], {0, 4}, {0, 8}, searchHighlightColor);
-            TestHighlight(*ranges[1], {0, 14}, {0, 18}, searchHighlightColor);
+            TestHighlight(ranges[0], {0, 4}, {0, 8});
+            TestHighlight(ranges[1], {0, 14}, {0, 18});
         }
 
         BeginTest(text);
         FinishTest(text.toUtf8().constData());
     }
+    // test that the highlight color follows the renderer config
+    {
+        QString text = QStringLiteral("foo bar xyz foo ab bar x");
+        BeginTest(text);
+
+        TestPressKey(QStringLiteral("/bar\\enter"));
+        const QColor oldColor = kate_view->rendererConfig()->searchHighlightColor();
+        kate_view->rendererConfig()->setSearchHighlightColor(QColor(255, 0, 0));
+        {
+            QList<KTextEditor::Range> ranges = rangesOnLine(0);
+            QCOMPARE(ranges.size(), rangesInitial.size() + 2);
+            TestHighlight(ranges[0], {0, 4}, {0, 7});
+            QCOMPARE(backgroundAt({0, 4}), QColor(255, 0, 0));
+            QCOMPARE(backgroundAt({0, 3}), QColor());
+        }
+        kate_view->rendererConfig()->setSearchHighlightColor(oldColor);
+        FinishTest(text.toUtf8().constData());
+    }
+    // test that multi-line matches around an edit are updated
+    {
+        QString text = QStringLiteral("foo\nbar\nfoo\nbaz");
+        BeginTest(text);
+
+        TestPressKey(QStringLiteral("/foo\\nba\\enter"));
+        {
+            QCOMPARE(rangesOnLine(0).size(), rangesInitial.size() + 1);
+            QCOMPARE(rangesOnLine(3).size(), rangesInitial.size() + 1);
+            TestHighlight(rangesOnLine(3)[0], {3, 0}, {3, 2});
+        }
+        TestPressKey(QStringLiteral("Gx"));
+        {
+            QCOMPARE(rangesOnLine(2).size(), rangesInitial.size());
+            QCOMPARE(rangesOnLine(3).size(), rangesInitial.size());
+            QCOMPARE(backgroundAt({2, 0}), QColor());
+        }
+        FinishTest("foo\nbar\nfoo\naz");
+    }
+    // test that multi-line matches crossing the border of the searched blocks are found
+    {
+        QStringList lines(70, QStringLiteral("x"));
+        lines[63] = QStringLiteral("foo");
+        lines[64] = QStringLiteral("bar");
+        const QString text = lines.join(QLatin1Char('\n'));
+        BeginTest(text);
+
+        TestPressKey(QStringLiteral("/foo\\nbar\\enter"));
+        {
+            // ask for the second block first, the match starts in front of it
+            QCOMPARE(rangesOnLine(64).size(), rangesInitial.size() + 1);
+            QCOMPARE(rangesOnLine(64)[0], KTextEditor::Range(64, 0, 64, 3));
+            QCOMPARE(rangesOnLine(63).size(), rangesInitial.size() + 1);
+            QCOMPARE(rangesOnLine(63)[0], KTextEditor::Range(63, 0, 63, 3));
+        }
+        FinishTest(text.toUtf8().constData());
+    }
     // test that no endless loop is triggered
     {
         QString text = QStringLiteral("foo bar xyz\nabc def\nghi jkl\nmno pqr\nstu vwx\nfoo ab bar x");
@@ -660,13 +711,21 @@ void HlSearchTest::highlightModeTests()
     }
 }
 
-QList<Kate::TextRange *> HlSearchTest::rangesOnLine(int line)
+QList<KTextEditor::Range> HlSearchTest::rangesOnLine(int line)
 {
-    QList<Kate::TextRange *> arr = kate_document->buffer().rangesForLine(line, kate_view, true);
-    std::sort(arr.begin(), arr.end(), [](const Kate::TextRange *l, const Kate::TextRange *r) {
-        return l->toRange().start() < r->toRange().start();
-    });
-    return arr;
+    return vi_input_mode->searchHighlightsForLine(line);
+}
+
+QColor HlSearchTest::backgroundAt(KTextEditor::Cursor position)
+{
+    // the background the renderer paints for the text at the position
+    const auto decorations = kate_view->renderer()->decorationsForLine(kate_document->kateTextLine(position.line()), position.line());
+    for (const QTextLayout::FormatRange &decoration : decorations) {
+        if (decoration.start <= position.column() && position.column() < decoration.start + decoration.length) {
+            return decoration.format.background().color();
+        }
+    }
+    return QColor();
 }
 
 void HlSearchTest::setWindowSize()
@@ -684,13 +743,17 @@ void HlSearchTest::setWindowSize()
     QVERIFY(kate_view->visibleRange().end().line() == 3);
 }
 
-void HlSearchTest::TestHighlight_(int line, const char *file, const Kate::TextRange &r, std::array<int, 2> start, std::array<int, 2> end, const QColor &bg)
+void HlSearchTest::TestHighlight_(int line, const char *file, KTextEditor::Range r, std::array<int, 2> start, std::array<int, 2> end)
 {
-    QTest::qCompare(r.attribute()->background().color(), bg, "bgcolor", "bgcolor", file, line);
     QTest::qCompare(r.start().line(), start[0], "start_line", "start_line", file, line);
     QTest::qCompare(r.start().column(), start[1], "start_column", "start_column", file, line);
     QTest::qCompare(r.end().line(), end[0], "end_line", "end_line", file, line);
     QTest::qCompare(r.end().column(), end[1], "end_column", "end_column", file, line);
+
+    // painted by the renderer in the search highlight color
+    const QColor searchHighlightColor = kate_view->rendererConfig()->searchHighlightColor();
+    QTest::qCompare(backgroundAt(r.start()), searchHighlightColor, "start_background", "search_highlight_color", file, line);
+    QTest::qCompare(backgroundAt({r.end().line(), r.end().column() - 1}), searchHighlightColor, "end_background", "search_highlight_color", file, line);
 }
 
 #include "moc_hlsearch.cpp"
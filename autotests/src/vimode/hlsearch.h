@@ -10,10 +10,7 @@
 #include "base.h"
 #include <array>
 
-namespace Kate
-{
-class TextRange;
-}
+#include <ktexteditor/range.h>
 
 class EmulatedCommandBarSetUpAndTearDown;
 
@@ -25,10 +22,11 @@ private Q_SLOTS:
     void highlightModeTests();
 
 private:
-    QList<Kate::TextRange *> rangesOnLine(int line);
+    QList<KTextEditor::Range> rangesOnLine(int line);
+    QColor backgroundAt(KTextEditor::Cursor position);
     void setWindowSize();
 
-    void TestHighlight_(int line, const char *file, const Kate::TextRange &r, std::array<int, 2> start, std::array<int, 2> end, const QColor &bg);
+    void TestHighlight_(int line, const char *file, KTextEditor::Range r, std::array<int, 2> start, std::array<int, 2> end);
 
     std::unique_ptr<EmulatedCommandBarSetUpAndTearDown> m_emulatedCommandBarSetUpAndTearDown;
 };
@@ -20,6 +20,7 @@
 #include <vimode/keyparser.h>
 
 #include <QMainWindow>
+#include <QSignalSpy>
 #include <QTest>
 
 using namespace KTextEditor;
@@ -888,6 +889,35 @@ void KeysTest::MacroTests()
     clearAllMacros();
     DoTest("XXXX\nXXXX\nXXXX\nXXXX", "qarOljq3@au", "OXXX\nXXXX\nXXXX\nXXXX");
 
+    // A counted macro is replayed as one batch: the cursor change is signalled once and
+    // the view is scrolled to the moved cursor once at the end.
+    {
+        ensureKateViewVisible();
+        QStringList lines;
+        for (int i = 0; i < 300; ++i) {
+            lines.append(QStringLiteral("line %1").arg(i));
+        }
+        const QString text = lines.join(QLatin1Char('\n'));
+
+        BeginTest(text);
+        TestPressKey(QStringLiteral("40j40j40j"));
+        const KTextEditor::Cursor typedCursor = kate_view->cursorPosition();
+        QVERIFY(typedCursor.line() > 0);
+
+        clearAllMacros();
+        BeginTest(text);
+        TestPressKey(QStringLiteral("qa40jqgg"));
+        QSignalSpy cursorPositionChangedSpy(kate_view, &KTextEditor::View::cursorPositionChanged);
+        TestPressKey(QStringLiteral("3@a"));
+        QCOMPARE(cursorPositionChangedSpy.count(), 1);
+        QCOMPARE(kate_view->cursorPosition(), typedCursor);
+        QVERIFY(kate_view->firstDisplayedLine() <= typedCursor.line());
+        QVERIFY(kate_view->lastDisplayedLine() >= typedCursor.line());
+        FinishTest(text.toUtf8().constData());
+        kate_view->hide();
+        mainWindow->hide();
+    }
+
     {
         EmulatedCommandBarSetUpAndTearDown vimStyleCommandBarTestsSetUpAndTearDown(vi_input_mode, kate_view, mainWindow);
         // Make sure we can macro-ise an interactive sed replace.
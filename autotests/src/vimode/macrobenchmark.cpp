@@ -0,0 +1,91 @@
+/*
+    SPDX-FileCopyrightText: KDE Developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "macrobenchmark.h"
+#include <katedocument.h>
+#include <kateview.h>
+
+#include <QTest>
+
+using namespace KTextEditor;
+
+QTEST_MAIN(MacroBenchmark)
+
+// append to each line and move down, the view has to follow the cursor all the way
+static constexpr int lines = 2000;
+static const QString macroKeys = QStringLiteral("A;\\escj");
+
+void MacroBenchmark::beginBenchmark()
+{
+    ensureKateViewVisible();
+    clearAllMacros();
+
+    QStringList text;
+    text.reserve(lines);
+    for (int i = 0; i < lines; ++i) {
+        text.append(QStringLiteral("    result += compute(value%1);").arg(i));
+    }
+    BeginTest(text.join(QLatin1Char('\n')));
+
+    // record on the first line, replay from the second one
+    TestPressKey(QStringLiteral("qa") + macroKeys + QStringLiteral("q"));
+    QCOMPARE(kate_view->cursorPosition().line(), 1);
+}
+
+void MacroBenchmark::finishBenchmark()
+{
+    QCOMPARE(kate_view->cursorPosition().line(), lines - 1);
+    QVERIFY(kate_document->line(lines - 2).endsWith(QLatin1Char(';')));
+    kate_view->hide();
+    mainWindow->hide();
+}
+
+void MacroBenchmark::benchmarkTypedKeys()
+{
+    // the keys dispatched one by one as if typed, each one updates the view
+    QBENCHMARK_ONCE {
+        beginBenchmark();
+        for (int i = 1; i < lines - 1; ++i) {
+            TestPressKey(macroKeys);
+        }
+    }
+    finishBenchmark();
+}
+
+void MacroBenchmark::benchmarkSingleReplays()
+{
+    // one replay per repetition, each one is a batch of its own
+    QBENCHMARK_ONCE {
+        beginBenchmark();
+        for (int i = 1; i < lines - 1; ++i) {
+            TestPressKey(QStringLiteral("@a"));
+        }
+    }
+    finishBenchmark();
+}
+
+void MacroBenchmark::benchmarkCountedReplay()
+{
+    // decoded once, all repetitions in one edit transaction and one view update
+    QBENCHMARK_ONCE {
+        beginBenchmark();
+        TestPressKey(QString::number(lines - 2) + QStringLiteral("@a"));
+    }
+    finishBenchmark();
+}
+
+void MacroBenchmark::benchmarkRepeatLastChange()
+{
+    QBENCHMARK_ONCE {
+        beginBenchmark();
+        for (int i = 1; i < lines - 1; ++i) {
+            TestPressKey(QStringLiteral(".j"));
+        }
+    }
+    finishBenchmark();
+}
+
+#include "moc_macrobenchmark.cpp"
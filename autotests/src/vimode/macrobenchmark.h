@@ -0,0 +1,27 @@
+/*
+    SPDX-FileCopyrightText: KDE Developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef MACRO_BENCHMARK_H
+#define MACRO_BENCHMARK_H
+
+#include "base.h"
+
+class MacroBenchmark : public BaseTest
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void benchmarkTypedKeys();
+    void benchmarkSingleReplays();
+    void benchmarkCountedReplay();
+    void benchmarkRepeatLastChange();
+
+private:
+    void beginBenchmark();
+    void finishBenchmark();
+};
+
+#endif /* MACRO_BENCHMARK_H */
@@ -9,4 +9,6 @@
 
 #cmakedefine01 HAVE_KAUTH
 
+#cmakedefine01 KATE_PERF_TRACING
+
 #endif
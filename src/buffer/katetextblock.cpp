@@ -9,6 +9,8 @@
 #include "katetextcursor.h"
 #include "katetextrange.h"
 
+#include <atomic>
+
 namespace Kate
 {
 TextBlock::TextBlock(TextBuffer *buffer, int index)
@@ -16,14 +18,14 @@ TextBlock::TextBlock(TextBuffer *buffer, int index)
     , m_blockIndex(index)
 {
     // reserve the block size
-    m_lines.reserve(BufferBlockSize);
+    m_lines->reserve(BufferBlockSize);
 }
 
 TextBlock::~TextBlock()
 {
     // blocks should be empty before they are deleted!
-    Q_ASSERT(m_lines.empty());
-    Q_ASSERT(m_cursors.empty());
+    Q_ASSERT(m_lines->empty());
+    Q_ASSERT(!hasCursors());
 
     // it only is a hint for ranges for this block, not the storage of them
 }
@@ -36,36 +38,42 @@ int TextBlock::startLine() const
 TextLine TextBlock::line(int line) const
 {
     // right input
-    Q_ASSERT(size_t(line) < m_lines.size());
+    Q_ASSERT(size_t(line) < m_lines->size());
     // get text line, at will bail out on out-of-range
-    return m_lines.at(line);
+    return m_lines->at(line);
 }
 
 void TextBlock::setLineMetaData(int line, const TextLine &textLine)
 {
     // right input
-    Q_ASSERT(size_t(line) < m_lines.size());
+    Q_ASSERT(size_t(line) < m_lines->size());
 
     // set stuff, at will bail out on out-of-range
-    const QString originalText = m_lines.at(line).text();
-    m_lines.at(line) = textLine;
-    m_lines.at(line).text() = originalText;
+    // attributes might change, bracket index must be recomputed
+    invalidateBrackets();
+    std::vector<TextLine> &textLines = mutableLines();
+    const QString originalText = textLines.at(line).text();
+    textLines.at(line) = textLine;
+    textLines.at(line).text() = originalText;
 }
 
 void TextBlock::appendLine(const QString &textOfLine)
 {
-    m_lines.emplace_back(textOfLine);
+    invalidateBrackets();
+    mutableLines().emplace_back(textOfLine);
 }
 
 void TextBlock::clearLines()
 {
-    m_lines.clear();
+    invalidateBrackets();
+    // snapshots keep the old lines alive
+    m_lines = std::make_shared<std::vector<TextLine>>();
 }
 
 void TextBlock::text(QString &text) const
 {
     // combine all lines
-    for (const auto &line : m_lines) {
+    for (const auto &line : *m_lines) {
         text.append(line.text());
         text.append(QLatin1Char('\n'));
     }
@@ -75,9 +83,10 @@ void TextBlock::wrapLine(const KTextEditor::Cursor position, int fixStartLinesSt
 {
     // calc internal line
     const int line = position.line() - startLine();
+    std::vector<TextLine> &textLines = mutableLines();
 
     // get text, copy, we might invalidate the reference
-    const QString text = m_lines.at(line).text();
+    const QString text = textLines.at(line).text();
 
     // check if valid column
     Q_ASSERT(position.column() >= 0);
@@ -85,28 +94,29 @@ void TextBlock::wrapLine(const KTextEditor::Cursor position, int fixStartLinesSt
     Q_ASSERT(fixStartLinesStartIndex == m_blockIndex);
 
     // create new line and insert it
-    m_lines.insert(m_lines.begin() + line + 1, TextLine());
+    invalidateBrackets();
+    textLines.insert(textLines.begin() + line + 1, TextLine());
 
     // cases for modification:
     // 1. line is wrapped in the middle
     // 2. if empty line is wrapped, mark new line as modified
     // 3. line-to-be-wrapped is already modified
-    if (position.column() > 0 || text.size() == 0 || m_lines.at(line).markedAsModified()) {
-        m_lines.at(line + 1).markAsModified(true);
-    } else if (m_lines.at(line).markedAsSavedOnDisk()) {
-        m_lines.at(line + 1).markAsSavedOnDisk(true);
+    if (position.column() > 0 || text.size() == 0 || textLines.at(line).markedAsModified()) {
+        textLines.at(line + 1).markAsModified(true);
+    } else if (textLines.at(line).markedAsSavedOnDisk()) {
+        textLines.at(line + 1).markAsSavedOnDisk(true);
     }
 
     // perhaps remove some text from previous line and append it
     if (position.column() < text.size()) {
         // text from old line moved first to new one
-        m_lines.at(line + 1).text() = text.right(text.size() - position.column());
+        textLines.at(line + 1).text() = text.right(text.size() - position.column());
 
         // now remove wrapped text from old line
-        m_lines.at(line).text().chop(text.size() - position.column());
+        textLines.at(line).text().chop(text.size() - position.column());
 
         // mark line as modified
-        m_lines.at(line).markAsModified(true);
+        textLines.at(line).markAsModified(true);
     }
 
     // fix all start lines
@@ -121,51 +131,55 @@ void TextBlock::wrapLine(const KTextEditor::Cursor position, int fixStartLinesSt
 
     // no cursors will leave or join this block
 
-    // no cursors in this block, no work to do..
-    if (m_cursors.empty()) {
+    // no cursors on or behind the wrapped line, no work to do..
+    if (size_t(line) >= m_cursorsByLine.size()) {
         return;
     }
 
-    // move all cursors on the line which has the text inserted
+    // cursors change their lines
+    invalidateMultiLineRanges();
+
     // remember all ranges modified, optimize for the standard case of a few ranges
     QVarLengthArray<TextRange *, 32> changedRanges;
-    for (TextCursor *cursor : m_cursors) {
-        // skip cursors on lines in front of the wrapped one!
-        if (cursor->lineInBlock() < line) {
-            continue;
+    const auto rememberRange = [&changedRanges](TextCursor *cursor) {
+        // remember range, if any, avoid double insert
+        auto range = cursor->kateRange();
+        if (range && !range->isValidityCheckRequired()) {
+            range->setValidityCheckRequired();
+            changedRanges.push_back(range);
         }
+    };
 
-        // either this is simple, line behind the wrapped one
-        if (cursor->lineInBlock() > line) {
+    // simple: cursors on lines behind the wrapped one move one line down
+    for (size_t i = line + 1; i < m_cursorsByLine.size(); ++i) {
+        for (TextCursor *cursor : m_cursorsByLine[i]) {
             // patch line of cursor
             cursor->m_line++;
+            rememberRange(cursor);
         }
+    }
+    m_cursorsByLine.insert(m_cursorsByLine.begin() + line + 1, std::vector<TextCursor *>());
 
-        // this is the wrapped line
-        else {
-            // skip cursors with too small column
-            if (cursor->column() <= position.column()) {
-                if (cursor->column() < position.column() || !cursor->m_moveOnInsert) {
-                    continue;
-                }
+    // move cursors behind the wrap position of the wrapped line to the new line, this keeps both sorted
+    auto &newLineCursors = m_cursorsByLine[line + 1];
+    std::erase_if(m_cursorsByLine[line], [&newLineCursors, &rememberRange, position](TextCursor *cursor) {
+        // skip cursors with too small column
+        if (cursor->column() <= position.column()) {
+            if (cursor->column() < position.column() || !cursor->m_moveOnInsert) {
+                return false;
             }
+        }
 
-            // move cursor
+        // patch line of cursor
+        cursor->m_line++;
 
-            // patch line of cursor
-            cursor->m_line++;
+        // patch column
+        cursor->m_column -= position.column();
 
-            // patch column
-            cursor->m_column -= position.column();
-        }
-
-        // remember range, if any, avoid double insert
-        auto range = cursor->kateRange();
-        if (range && !range->isValidityCheckRequired()) {
-            range->setValidityCheckRequired();
-            changedRanges.push_back(range);
-        }
-    }
+        newLineCursors.push_back(cursor);
+        rememberRange(cursor);
+        return true;
+    });
 
     // we might need to invalidate ranges or notify about their changes
     // checkValidity might trigger delete of the range!
@@ -177,6 +191,8 @@ void TextBlock::wrapLine(const KTextEditor::Cursor position, int fixStartLinesSt
 
 void TextBlock::unwrapLine(int line, TextBlock *previousBlock, int fixStartLinesStartIndex)
 {
+    std::vector<TextLine> &textLines = mutableLines();
+
     // two possibilities: either first line of this block or later line
     if (line == 0) {
         // we need previous block with at least one line
@@ -184,21 +200,24 @@ void TextBlock::unwrapLine(int line, TextBlock *previousBlock, int fixStartLines
         Q_ASSERT(previousBlock->lines() > 0);
 
         // move last line of previous block to this one, might result in empty block
-        const TextLine oldFirst = m_lines.at(0);
+        invalidateBrackets();
+        previousBlock->invalidateBrackets();
+        std::vector<TextLine> &previousLines = previousBlock->mutableLines();
+        const TextLine oldFirst = textLines.at(0);
         const int lastLineOfPreviousBlock = previousBlock->lines() - 1;
-        m_lines[0] = previousBlock->m_lines.back();
-        previousBlock->m_lines.erase(previousBlock->m_lines.begin() + (previousBlock->lines() - 1));
+        textLines[0] = previousLines.back();
+        previousLines.erase(previousLines.begin() + (previousBlock->lines() - 1));
 
-        m_buffer->m_blockSizes[m_blockIndex - 1] -= m_lines[0].length() + 1;
-        m_buffer->m_blockSizes[m_blockIndex] += m_lines[0].length();
+        m_buffer->m_blockSizes[m_blockIndex - 1] -= textLines[0].length() + 1;
+        m_buffer->m_blockSizes[m_blockIndex] += textLines[0].length();
 
-        const int oldSizeOfPreviousLine = m_lines[0].text().size();
+        const int oldSizeOfPreviousLine = textLines[0].text().size();
         if (oldFirst.length() > 0) {
             // append text
-            m_lines[0].text().append(oldFirst.text());
+            textLines[0].text().append(oldFirst.text());
 
             // mark line as modified, since text was appended
-            m_lines[0].markAsModified(true);
+            textLines[0].markAsModified(true);
         }
 
         // fix all start lines
@@ -212,8 +231,15 @@ void TextBlock::unwrapLine(int line, TextBlock *previousBlock, int fixStartLines
 
         // cursor and range handling below
 
-        // no cursors in this block and the previous one, no work to do..
-        if (m_cursors.empty() && previousBlock->m_cursors.empty()) {
+        // cursors of the moved line leave the previous block
+        std::vector<TextCursor *> movedCursors;
+        if (size_t(lastLineOfPreviousBlock) < previousBlock->m_cursorsByLine.size()) {
+            movedCursors = std::move(previousBlock->m_cursorsByLine[lastLineOfPreviousBlock]);
+            previousBlock->m_cursorsByLine.resize(lastLineOfPreviousBlock);
+        }
+
+        // no cursors on the unwrapped line, no work to do..
+        if (movedCursors.empty() && (m_cursorsByLine.empty() || m_cursorsByLine[0].empty())) {
             return;
         }
 
@@ -224,9 +250,8 @@ void TextBlock::unwrapLine(int line, TextBlock *previousBlock, int fixStartLines
             bool spansMultipleBlocks;
         };
         QVarLengthArray<ChangedRange, 32> changedRanges;
-        for (TextCursor *cursor : m_cursors) {
-            // this is the unwrapped line
-            if (cursor->lineInBlock() == 0) {
+        if (!m_cursorsByLine.empty()) {
+            for (TextCursor *cursor : m_cursorsByLine[0]) {
                 // patch column
                 cursor->m_column += oldSizeOfPreviousLine;
 
@@ -240,15 +265,13 @@ void TextBlock::unwrapLine(int line, TextBlock *previousBlock, int fixStartLines
         }
 
         // move cursors of the moved line from previous block to this block now
-        for (auto it = previousBlock->m_cursors.begin(); it != previousBlock->m_cursors.end();) {
-            auto cursor = *it;
-            if (cursor->lineInBlock() == lastLineOfPreviousBlock) {
+        if (!movedCursors.empty()) {
+            for (TextCursor *cursor : movedCursors) {
                 Kate::TextRange *range = cursor->kateRange();
                 // get the value before changing the block
                 const bool spansMultipleBlocks = range && range->spansMultipleBlocks();
                 cursor->m_line = 0;
                 cursor->m_block = this;
-                insertCursor(cursor);
 
                 // remember range, if any, avoid double insert
                 if (range && !range->isValidityCheckRequired()) {
@@ -256,19 +279,15 @@ void TextBlock::unwrapLine(int line, TextBlock *previousBlock, int fixStartLines
                     // the range might not span multiple blocks anymore
                     changedRanges.push_back({range, spansMultipleBlocks});
                 }
-
-                // mark the cursor to be removed from previous block
-                *it = nullptr;
-                it++;
-            } else {
-                // keep in previous block
-                ++it;
             }
-        }
 
-        std::erase_if(previousBlock->m_cursors, [](auto *c) {
-            return c == nullptr;
-        });
+            // keep the cursors of the first line sorted
+            auto &firstLineCursors = cursorsOnLine(0);
+            const auto firstInsertionPos = firstLineCursors.insert(firstLineCursors.end(), movedCursors.cbegin(), movedCursors.cend());
+            std::inplace_merge(firstLineCursors.begin(), firstInsertionPos, firstLineCursors.end());
+            invalidateMultiLineRanges();
+            previousBlock->invalidateMultiLineRanges();
+        }
 
         // fixup the ranges that might be effected, because they moved from last line to this block
         // we might need to invalidate ranges or notify about their changes
@@ -287,22 +306,23 @@ void TextBlock::unwrapLine(int line, TextBlock *previousBlock, int fixStartLines
     }
 
     m_buffer->m_blockSizes[m_blockIndex] -= 1;
+    invalidateBrackets();
 
     // easy: just move text to previous line and remove current one
-    const int oldSizeOfPreviousLine = m_lines.at(line - 1).length();
-    const int sizeOfCurrentLine = m_lines.at(line).length();
+    const int oldSizeOfPreviousLine = textLines.at(line - 1).length();
+    const int sizeOfCurrentLine = textLines.at(line).length();
     if (sizeOfCurrentLine > 0) {
-        m_lines.at(line - 1).text().append(m_lines.at(line).text());
+        textLines.at(line - 1).text().append(textLines.at(line).text());
     }
 
-    const bool lineChanged = (oldSizeOfPreviousLine > 0 && m_lines.at(line - 1).markedAsModified())
-        || (sizeOfCurrentLine > 0 && (oldSizeOfPreviousLine > 0 || m_lines.at(line).markedAsModified()));
-    m_lines.at(line - 1).markAsModified(lineChanged);
-    if (oldSizeOfPreviousLine == 0 && m_lines.at(line).markedAsSavedOnDisk()) {
-        m_lines.at(line - 1).markAsSavedOnDisk(true);
+    const bool lineChanged = (oldSizeOfPreviousLine > 0 && textLines.at(line - 1).markedAsModified())
+        || (sizeOfCurrentLine > 0 && (oldSizeOfPreviousLine > 0 || textLines.at(line).markedAsModified()));
+    textLines.at(line - 1).markAsModified(lineChanged);
+    if (oldSizeOfPreviousLine == 0 && textLines.at(line).markedAsSavedOnDisk()) {
+        textLines.at(line - 1).markAsSavedOnDisk(true);
     }
 
-    m_lines.erase(m_lines.begin() + line);
+    textLines.erase(textLines.begin() + line);
 
     // fix all start lines
     // we need to do this NOW, else the range update will FAIL!
@@ -314,35 +334,50 @@ void TextBlock::unwrapLine(int line, TextBlock *previousBlock, int fixStartLines
 
     // cursor and range handling below
 
-    // no cursors in this block, no work to do..
-    if (m_cursors.empty()) {
+    // no cursors on or behind the unwrapped line, no work to do..
+    if (size_t(line) >= m_cursorsByLine.size()) {
         return;
     }
 
+    // cursors change their lines
+    invalidateMultiLineRanges();
+
     // move all cursors because of the unwrapped line
     // remember all ranges modified, optimize for the standard case of a few ranges
     QVarLengthArray<TextRange *, 32> changedRanges;
-    for (TextCursor *cursor : m_cursors) {
-        // skip cursors in lines in front of removed one
-        if (cursor->lineInBlock() < line) {
-            continue;
-        }
-
-        // this is the unwrapped line
-        if (cursor->lineInBlock() == line) {
-            // patch column
-            cursor->m_column += oldSizeOfPreviousLine;
-        }
-
-        // patch line of cursor
-        cursor->m_line--;
-
+    const auto rememberRange = [&changedRanges](TextCursor *cursor) {
         // remember range, if any, avoid double insert
         auto range = cursor->kateRange();
         if (range && !range->isValidityCheckRequired()) {
             range->setValidityCheckRequired();
             changedRanges.push_back(range);
         }
+    };
+
+    // this is the unwrapped line, its cursors join the previous line
+    const std::vector<TextCursor *> unwrappedCursors = std::move(m_cursorsByLine[line]);
+    m_cursorsByLine.erase(m_cursorsByLine.begin() + line);
+    for (TextCursor *cursor : unwrappedCursors) {
+        // patch column and line of cursor
+        cursor->m_column += oldSizeOfPreviousLine;
+        cursor->m_line--;
+        rememberRange(cursor);
+    }
+
+    // cursors on lines behind the removed one move one line up
+    for (size_t i = line; i < m_cursorsByLine.size(); ++i) {
+        for (TextCursor *cursor : m_cursorsByLine[i]) {
+            // patch line of cursor
+            cursor->m_line--;
+            rememberRange(cursor);
+        }
+    }
+
+    // keep the cursors of the previous line sorted
+    if (!unwrappedCursors.empty()) {
+        auto &previousLineCursors = cursorsOnLine(line - 1);
+        const auto firstInsertionPos = previousLineCursors.insert(previousLineCursors.end(), unwrappedCursors.cbegin(), unwrappedCursors.cend());
+        std::inplace_merge(previousLineCursors.begin(), firstInsertionPos, previousLineCursors.end());
     }
 
     // we might need to invalidate ranges or notify about their changes
@@ -359,9 +394,11 @@ void TextBlock::insertText(const KTextEditor::Cursor position, const QString &te
     int line = position.line() - startLine();
 
     // get text
-    QString &textOfLine = m_lines.at(line).text();
+    std::vector<TextLine> &textLines = mutableLines();
+    QString &textOfLine = textLines.at(line).text();
     int oldLength = textOfLine.size();
-    m_lines.at(line).markAsModified(true);
+    textLines.at(line).markAsModified(true);
+    invalidateBrackets();
 
     // check if valid column
     Q_ASSERT(position.column() >= 0);
@@ -375,20 +412,15 @@ void TextBlock::insertText(const KTextEditor::Cursor position, const QString &te
 
     // cursor and range handling below
 
-    // no cursors in this block, no work to do..
-    if (m_cursors.empty()) {
+    // no cursors on this line, no work to do..
+    if (size_t(line) >= m_cursorsByLine.size()) {
         return;
     }
 
     // move all cursors on the line which has the text inserted
     // remember all ranges modified, optimize for the standard case of a few ranges
     QVarLengthArray<TextRange *, 32> changedRanges;
-    for (TextCursor *cursor : m_cursors) {
-        // skip cursors not on this line!
-        if (cursor->lineInBlock() != line) {
-            continue;
-        }
-
+    for (TextCursor *cursor : m_cursorsByLine[line]) {
         // skip cursors with too small column
         if (cursor->column() <= position.column()) {
             if (cursor->column() < position.column() || !cursor->m_moveOnInsert) {
@@ -428,7 +460,8 @@ void TextBlock::removeText(KTextEditor::Range range, QString &removedText)
     int line = range.start().line() - startLine();
 
     // get text
-    QString &textOfLine = m_lines.at(line).text();
+    std::vector<TextLine> &textLines = mutableLines();
+    QString &textOfLine = textLines.at(line).text();
     int oldLength = textOfLine.size();
 
     // check if valid column
@@ -442,27 +475,23 @@ void TextBlock::removeText(KTextEditor::Range range, QString &removedText)
 
     // remove text
     textOfLine.remove(range.start().column(), range.end().column() - range.start().column());
-    m_lines.at(line).markAsModified(true);
+    textLines.at(line).markAsModified(true);
+    invalidateBrackets();
 
     // notify the text history
     m_buffer->history().removeText(range, oldLength);
 
     // cursor and range handling below
 
-    // no cursors in this block, no work to do..
-    if (m_cursors.empty()) {
+    // no cursors on this line, no work to do..
+    if (size_t(line) >= m_cursorsByLine.size()) {
         return;
     }
 
     // move all cursors on the line which has the text removed
     // remember all ranges modified, optimize for the standard case of a few ranges
     QVarLengthArray<TextRange *, 32> changedRanges;
-    for (TextCursor *cursor : m_cursors) {
-        // skip cursors not on this line!
-        if (cursor->lineInBlock() != line) {
-            continue;
-        }
-
+    for (TextCursor *cursor : m_cursorsByLine[line]) {
         // skip cursors with too small column
         if (cursor->column() <= range.start().column()) {
             continue;
@@ -491,53 +520,184 @@ void TextBlock::removeText(KTextEditor::Range range, QString &removedText)
     }
 }
 
+void TextBlock::replaceText(std::span<const LineReplacement> replacements, std::span<QString> removedTexts)
+{
+    Q_ASSERT(replacements.size() == removedTexts.size());
+    const int blockStartLine = startLine();
+    invalidateBrackets();
+    std::vector<TextLine> &textLines = mutableLines();
+
+    // apply all replacements back to front, columns of the replacements in front stay valid that way
+    for (size_t i = replacements.size(); i > 0; --i) {
+        const LineReplacement &replacement = replacements[i - 1];
+        Q_ASSERT(replacement.line >= blockStartLine && (replacement.line - blockStartLine) < lines());
+
+        TextLine &textLine = textLines.at(replacement.line - blockStartLine);
+        QString &textOfLine = textLine.text();
+
+        // check if valid columns
+        Q_ASSERT(replacement.column >= 0);
+        Q_ASSERT(replacement.length >= 0);
+        Q_ASSERT(replacement.column + replacement.length <= textOfLine.size());
+
+        // remove text, same as removeText, but without cursor handling
+        if (replacement.length > 0) {
+            const int oldLength = textOfLine.size();
+            removedTexts[i - 1] = textOfLine.mid(replacement.column, replacement.length);
+            textOfLine.remove(replacement.column, replacement.length);
+            textLine.markAsModified(true);
+            m_buffer->history().removeText(
+                KTextEditor::Range(replacement.line, replacement.column, replacement.line, replacement.column + replacement.length),
+                oldLength);
+            ++m_buffer->m_revision;
+        }
+
+        // insert text, same as insertText, but without cursor handling
+        if (!replacement.text.isEmpty()) {
+            const int oldLength = textOfLine.size();
+            textOfLine.insert(replacement.column, replacement.text);
+            textLine.markAsModified(true);
+            m_buffer->history().insertText(KTextEditor::Cursor(replacement.line, replacement.column), replacement.text.size(), oldLength);
+            ++m_buffer->m_revision;
+        }
+    }
+
+    // cursor and range handling below
+
+    // no cursors in this block, no work to do..
+    if (m_cursorsByLine.empty()) {
+        return;
+    }
+
+    // move all cursors on the lines which got changed, only the cursors of these lines are visited
+    // remember all ranges modified, optimize for the standard case of a few ranges
+    QVarLengthArray<TextRange *, 32> changedRanges;
+    for (auto lineBegin = replacements.begin(); lineBegin != replacements.end();) {
+        // find the replacements for this line
+        const int lineInBlock = lineBegin->line - blockStartLine;
+        auto lineEnd = lineBegin;
+        int lineLengthBefore = textLines.at(lineInBlock).length();
+        while (lineEnd != replacements.end() && lineEnd->line == lineBegin->line) {
+            // compute back the line length before the batch, needed for the special cursor handling on insert
+            lineLengthBefore -= lineEnd->text.size() - lineEnd->length;
+            ++lineEnd;
+        }
+
+        // skip lines without cursors
+        if (size_t(lineInBlock) >= m_cursorsByLine.size()) {
+            lineBegin = lineEnd;
+            continue;
+        }
+
+        for (TextCursor *cursor : m_cursorsByLine[lineInBlock]) {
+            // replay the replacements of this line back to front, same semantics as removeText + insertText
+            const int oldColumn = cursor->m_column;
+            int lineLength = lineLengthBefore;
+            for (auto it = lineEnd; it != lineBegin;) {
+                --it;
+
+                // removal part
+                if (it->length > 0) {
+                    if (cursor->m_column > it->column) {
+                        if (cursor->m_column <= it->column + it->length) {
+                            cursor->m_column = it->column;
+                        } else {
+                            cursor->m_column -= it->length;
+                        }
+                    }
+                    lineLength -= it->length;
+                }
+
+                // insertion part
+                if (!it->text.isEmpty()) {
+                    const int newLineLength = lineLength + it->text.size();
+                    if (cursor->m_column > it->column || (cursor->m_column == it->column && cursor->m_moveOnInsert)) {
+                        if (cursor->m_column <= lineLength) {
+                            cursor->m_column += it->text.size();
+                        }
+
+                        // special handling if cursor behind the real line, e.g. non-wrapping cursor in block selection mode
+                        else if (cursor->m_column < newLineLength) {
+                            cursor->m_column = newLineLength;
+                        }
+                    }
+                    lineLength = newLineLength;
+                }
+            }
+
+            // cursor did not move, nothing to do
+            if (cursor->m_column == oldColumn) {
+                continue;
+            }
+
+            // remember range, if any, avoid double insert
+            // we only need to trigger checkValidity later if the range has feedback or might be invalidated
+            auto range = cursor->kateRange();
+            if (range && !range->isValidityCheckRequired() && (range->feedback() || range->start().line() == range->end().line())) {
+                range->setValidityCheckRequired();
+                changedRanges.push_back(range);
+            }
+        }
+
+        lineBegin = lineEnd;
+    }
+
+    // we might need to invalidate ranges or notify about their changes
+    // checkValidity might trigger delete of the range!
+    for (TextRange *range : std::as_const(changedRanges)) {
+        range->checkValidity();
+    }
+}
+
 void TextBlock::debugPrint(int blockIndex) const
 {
     // print all blocks
-    for (size_t i = 0; i < m_lines.size(); ++i) {
+    for (size_t i = 0; i < m_lines->size(); ++i) {
         printf("%4d - %4llu : %4llu : '%s'\n",
                blockIndex,
                (unsigned long long)startLine() + i,
-               (unsigned long long)m_lines.at(i).text().size(),
-               qPrintable(m_lines.at(i).text()));
+               (unsigned long long)m_lines->at(i).text().size(),
+               qPrintable(m_lines->at(i).text()));
     }
 }
 
 void TextBlock::splitBlock(int fromLine, TextBlock *newBlock)
 {
-    Q_ASSERT(newBlock->m_cursors.empty());
+    Q_ASSERT(!newBlock->hasCursors());
+    invalidateBrackets();
+    newBlock->invalidateBrackets();
+
     // move lines
-    auto myLinesToMoveBegin = m_lines.begin() + fromLine;
-    auto myLinesToMoveEnd = m_lines.end();
+    std::vector<TextLine> &textLines = mutableLines();
+    auto myLinesToMoveBegin = textLines.begin() + fromLine;
+    auto myLinesToMoveEnd = textLines.end();
     int blockSizeChange = myLinesToMoveEnd - myLinesToMoveBegin; // how many newlines
     std::for_each(myLinesToMoveBegin, myLinesToMoveEnd, [&blockSizeChange](const TextLine &line) -> void {
         blockSizeChange += line.length(); // how many non-newlines
     });
     m_buffer->m_blockSizes[m_blockIndex] -= blockSizeChange;
     m_buffer->m_blockSizes[newBlock->m_blockIndex] += blockSizeChange;
-    newBlock->m_lines.insert(newBlock->m_lines.cend(), std::make_move_iterator(myLinesToMoveBegin), std::make_move_iterator(myLinesToMoveEnd));
-    m_lines.resize(fromLine);
+    std::vector<TextLine> &newLines = newBlock->mutableLines();
+    newLines.insert(newLines.cend(), std::make_move_iterator(myLinesToMoveBegin), std::make_move_iterator(myLinesToMoveEnd));
+    textLines.resize(fromLine);
 
-    // move cursors
+    // move cursors, whole lines at once
     QSet<Kate::TextRange *> ranges;
-    for (auto it = m_cursors.begin(); it != m_cursors.end();) {
-        auto cursor = *it;
-        if (cursor->lineInBlock() >= fromLine) {
-            cursor->m_line = cursor->lineInBlock() - fromLine;
-            cursor->m_block = newBlock;
-
-            // add to new, remove from current
-            newBlock->m_cursors.push_back(cursor);
-            it = m_cursors.erase(it);
-            if (cursor->kateRange()) {
-                ranges.insert(cursor->kateRange());
+    if (size_t(fromLine) < m_cursorsByLine.size()) {
+        newBlock->m_cursorsByLine.assign(std::make_move_iterator(m_cursorsByLine.begin() + fromLine), std::make_move_iterator(m_cursorsByLine.end()));
+        m_cursorsByLine.resize(fromLine);
+        for (int line = 0; line < int(newBlock->m_cursorsByLine.size()); ++line) {
+            for (TextCursor *cursor : newBlock->m_cursorsByLine[line]) {
+                cursor->m_line = line;
+                cursor->m_block = newBlock;
+                if (cursor->kateRange()) {
+                    ranges.insert(cursor->kateRange());
+                }
             }
-        } else {
-            // keep in current
-            ++it;
         }
+        invalidateMultiLineRanges();
+        newBlock->invalidateMultiLineRanges();
     }
-    Q_ASSERT(std::is_sorted(newBlock->m_cursors.cbegin(), newBlock->m_cursors.cend()));
 
     for (auto range : std::as_const(ranges)) {
         if (range->spansMultipleBlocks()) {
@@ -550,85 +710,321 @@ void TextBlock::mergeBlock(TextBlock *targetBlock)
 {
     // This function moves everything from *this into *targetBlock.
     // *targetBlock exists before *this with no blocks between.
-    // Both this->m_cursors and targetBlock->m_cursors are sorted.
-
-    // Iterating m_cursors backwards to modify TextRange's m_end before m_start.
-    std::for_each(m_cursors.crbegin(),
-                  m_cursors.crend(),
-                  [targetBlockLines = targetBlock->lines(), targetBlock, m_buffer = m_buffer](TextCursor *cursor) -> void {
-                      cursor->m_line += targetBlockLines;
-                      cursor->m_block = targetBlock;
-                      TextRange *range = cursor->m_range;
-                      if (range && cursor == &range->m_end && targetBlock == range->m_start.m_block) {
-                          m_buffer->removeMultilineRange(range);
-                      }
-                  });
-    // move cursors
-    auto first_insertion_pos = targetBlock->m_cursors.insert(targetBlock->m_cursors.cend(), m_cursors.cbegin(), m_cursors.cend());
-    m_cursors.clear();
-    // keep targetBlock->m_cursors sorted
-    std::inplace_merge(targetBlock->m_cursors.begin(), first_insertion_pos, targetBlock->m_cursors.end());
-    Q_ASSERT(std::is_sorted(targetBlock->m_cursors.cbegin(), targetBlock->m_cursors.cend()));
-    // move lines
-    targetBlock->m_lines.insert(targetBlock->m_lines.cend(), std::make_move_iterator(m_lines.begin()), std::make_move_iterator(m_lines.end()));
-    m_lines.clear();
+    invalidateBrackets();
+    targetBlock->invalidateBrackets();
+
+    // ranges from the target block to this one will not span multiple blocks anymore,
+    // check this before any cursor changes its block
+    for (const auto &lineCursors : m_cursorsByLine) {
+        for (TextCursor *cursor : lineCursors) {
+            TextRange *range = cursor->m_range;
+            if (range && cursor == &range->m_end && targetBlock == range->m_start.m_block) {
+                m_buffer->removeMultilineRange(range);
+            }
+        }
+    }
+
+    // move cursors, our lines are appended to the lines of the target block
+    if (!m_cursorsByLine.empty()) {
+        const int targetBlockLines = targetBlock->lines();
+        for (const auto &lineCursors : m_cursorsByLine) {
+            for (TextCursor *cursor : lineCursors) {
+                cursor->m_line += targetBlockLines;
+                cursor->m_block = targetBlock;
+            }
+        }
+        targetBlock->m_cursorsByLine.resize(targetBlockLines);
+        targetBlock->m_cursorsByLine.insert(targetBlock->m_cursorsByLine.end(),
+                                            std::make_move_iterator(m_cursorsByLine.begin()),
+                                            std::make_move_iterator(m_cursorsByLine.end()));
+        m_cursorsByLine.clear();
+        invalidateMultiLineRanges();
+        targetBlock->invalidateMultiLineRanges();
+    }
+
+    // move lines, shared ones are copied, a snapshot may still read them
+    std::vector<TextLine> &targetLines = targetBlock->mutableLines();
+    if (sharesLines()) {
+        targetLines.insert(targetLines.cend(), m_lines->cbegin(), m_lines->cend());
+    } else {
+        targetLines.insert(targetLines.cend(), std::make_move_iterator(m_lines->begin()), std::make_move_iterator(m_lines->end()));
+    }
+    m_lines = std::make_shared<std::vector<TextLine>>();
 }
 
 void TextBlock::rangesForLine(const int line, KTextEditor::View *view, bool rangesWithAttributeOnly, QList<TextRange *> &outRanges) const
 {
-    const int lineInBlock = line - startLine(); // line number in block
-    for (TextCursor *cursor : std::as_const(m_cursors)) {
-        if (!cursor->kateRange()) {
-            continue;
-        }
-        TextRange *range = cursor->kateRange();
+    const auto wanted = [view, rangesWithAttributeOnly](TextRange *range) {
         if (rangesWithAttributeOnly && !range->hasAttribute()) {
-            continue;
+            return false;
         }
 
         // we want ranges for no view, but this one's attribute is only valid for views
         if (!view && range->attributeOnlyForViews()) {
-            continue;
+            return false;
         }
 
         // the range's attribute is not valid for this view
         if (range->view() && range->view() != view) {
-            continue;
+            return false;
         }
+        return true;
+    };
 
-        if (
-            // simple case
-            (cursor->lineInBlock() == lineInBlock) ||
-            // if line is in the range, ok
-            (range->startInternal().lineInternal() <= line && line <= range->endInternal().lineInternal())) {
+    // simple case: ranges starting or ending on this line
+    const int lineInBlock = line - startLine(); // line number in block
+    if (size_t(lineInBlock) < m_cursorsByLine.size()) {
+        for (TextCursor *cursor : m_cursorsByLine[lineInBlock]) {
+            TextRange *range = cursor->kateRange();
+            if (range && wanted(range)) {
+                outRanges.append(range);
+            }
+        }
+    }
+
+    // ranges inside this block that span this line, ranges spanning multiple blocks are handled by the buffer
+    for (TextRange *range : multiLineRanges()) {
+        if (range->m_start.m_line < lineInBlock && lineInBlock < range->m_end.m_line && wanted(range)) {
             outRanges.append(range);
         }
     }
 }
 
+static bool isIndexedBracket(QChar c)
+{
+    switch (c.unicode()) {
+    case u'(':
+    case u')':
+    case u'[':
+    case u']':
+    case u'{':
+    case u'}':
+        return true;
+    }
+    return false;
+}
+
+static QChar closingBracket(QChar open)
+{
+    switch (open.unicode()) {
+    case u'(':
+        return QLatin1Char(')');
+    case u'[':
+        return QLatin1Char(']');
+    case u'{':
+        return QLatin1Char('}');
+    }
+    return QChar();
+}
+
+static QChar openingBracket(QChar bracket)
+{
+    switch (bracket.unicode()) {
+    case u')':
+        return QLatin1Char('(');
+    case u']':
+        return QLatin1Char('[');
+    case u'}':
+        return QLatin1Char('{');
+    }
+    return bracket;
+}
+
+const std::vector<TextBlock::Bracket> &TextBlock::brackets() const
+{
+    if (m_bracketsValid) {
+        return m_brackets;
+    }
+
+    for (int lineInBlock = 0; lineInBlock < lines(); ++lineInBlock) {
+        const TextLine &textLine = (*m_lines)[lineInBlock];
+        const QString &text = textLine.text();
+        for (int column = 0; column < text.size(); ++column) {
+            const QChar c = text[column];
+            if (isIndexedBracket(c)) {
+                m_brackets.push_back({lineInBlock, column, textLine.attribute(column), c});
+            }
+        }
+    }
+
+    m_bracketsValid = true;
+    return m_brackets;
+}
+
+TextBlock::BracketBalance TextBlock::bracketBalance(QChar open, int attribute) const
+{
+    // ensure the index is there, that might clear the cached balances
+    const auto &allBrackets = brackets();
+
+    for (const auto &balance : m_bracketBalances) {
+        if (balance.open == open && balance.attribute == attribute) {
+            return balance;
+        }
+    }
+
+    BracketBalance balance;
+    balance.open = open;
+    balance.attribute = attribute;
+    const QChar close = closingBracket(open);
+
+    // forward: delta + minimal prefix
+    for (const auto &bracket : allBrackets) {
+        if (bracket.attribute != attribute) {
+            continue;
+        }
+        if (bracket.character == open) {
+            ++balance.delta;
+        } else if (bracket.character == close) {
+            --balance.delta;
+            balance.minPrefix = std::min(balance.minPrefix, balance.delta);
+        }
+    }
+
+    // backward: minimal suffix
+    int nesting = 0;
+    for (auto it = allBrackets.rbegin(); it != allBrackets.rend(); ++it) {
+        if (it->attribute != attribute) {
+            continue;
+        }
+        if (it->character == close) {
+            ++nesting;
+        } else if (it->character == open) {
+            --nesting;
+            balance.minSuffix = std::min(balance.minSuffix, nesting);
+        }
+    }
+
+    m_bracketBalances.push_back(balance);
+    return balance;
+}
+
+std::vector<TextBlock::BracketBalance> TextBlock::bracketBalances() const
+{
+    std::vector<BracketBalance> balances;
+    for (const auto &bracket : brackets()) {
+        const QChar open = openingBracket(bracket.character);
+        const auto known = std::find_if(balances.begin(), balances.end(), [open, &bracket](const BracketBalance &balance) {
+            return balance.open == open && balance.attribute == bracket.attribute;
+        });
+        if (known == balances.end()) {
+            balances.push_back(bracketBalance(open, bracket.attribute));
+        }
+    }
+    return balances;
+}
+
 void TextBlock::markModifiedLinesAsSaved()
 {
-    // mark all modified lines as saved
-    for (auto &textLine : m_lines) {
+    // mark all modified lines as saved, only copy shared lines if anything changes
+    const auto modified = [](const TextLine &textLine) {
+        return textLine.markedAsModified();
+    };
+    if (std::none_of(m_lines->cbegin(), m_lines->cend(), modified)) {
+        return;
+    }
+
+    for (auto &textLine : mutableLines()) {
         if (textLine.markedAsModified()) {
             textLine.markAsSavedOnDisk(true);
         }
     }
 }
 
+bool TextBlock::sharesLines() const
+{
+    // snapshots are only created in the thread owning the buffer, the count can't grow concurrently
+    if (m_lines.use_count() > 1) {
+        return true;
+    }
+
+    // the last snapshot might just have been released in another thread, see its reads first
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return false;
+}
+
+std::vector<TextLine> &TextBlock::mutableLines()
+{
+    if (sharesLines()) {
+        auto copy = std::make_shared<std::vector<TextLine>>();
+        copy->reserve(std::max(m_lines->size() + 1, size_t(BufferBlockSize)));
+        copy->assign(m_lines->cbegin(), m_lines->cend());
+        m_lines = std::move(copy);
+    }
+    return *m_lines;
+}
+
+std::vector<TextCursor *> &TextBlock::cursorsOnLine(int lineInBlock)
+{
+    Q_ASSERT(lineInBlock >= 0);
+    if (size_t(lineInBlock) >= m_cursorsByLine.size()) {
+        m_cursorsByLine.resize(lineInBlock + 1);
+    }
+    return m_cursorsByLine[lineInBlock];
+}
+
+bool TextBlock::hasCursors() const
+{
+    return std::any_of(m_cursorsByLine.cbegin(), m_cursorsByLine.cend(), [](const auto &lineCursors) {
+        return !lineCursors.empty();
+    });
+}
+
+std::vector<TextCursor *> TextBlock::takeCursors()
+{
+    std::vector<TextCursor *> cursors;
+    for (const auto &lineCursors : m_cursorsByLine) {
+        cursors.insert(cursors.end(), lineCursors.cbegin(), lineCursors.cend());
+    }
+    m_cursorsByLine.clear();
+    invalidateMultiLineRanges();
+    return cursors;
+}
+
+const std::vector<TextRange *> &TextBlock::multiLineRanges() const
+{
+    if (m_multiLineRangesValid) {
+        return m_multiLineRanges;
+    }
+
+    // find each range once, by its start cursor
+    for (const auto &lineCursors : m_cursorsByLine) {
+        for (TextCursor *cursor : lineCursors) {
+            TextRange *range = cursor->kateRange();
+            if (range && cursor == &range->m_start && range->m_end.m_block == this && range->m_end.m_line != cursor->m_line) {
+                m_multiLineRanges.push_back(range);
+            }
+        }
+    }
+
+    m_multiLineRangesValid = true;
+    return m_multiLineRanges;
+}
+
 void TextBlock::insertCursor(Kate::TextCursor *cursor)
 {
-    auto it = std::lower_bound(m_cursors.begin(), m_cursors.end(), cursor);
-    if (it == m_cursors.end() || cursor != *it) {
-        m_cursors.insert(it, cursor);
+    auto &cursors = cursorsOnLine(cursor->m_line);
+    auto it = std::lower_bound(cursors.begin(), cursors.end(), cursor);
+    if (it == cursors.end() || cursor != *it) {
+        cursors.insert(it, cursor);
+        if (cursor->kateRange()) {
+            invalidateMultiLineRanges();
+        }
     }
 }
 
 void TextBlock::removeCursor(Kate::TextCursor *cursor)
 {
-    auto it = std::lower_bound(m_cursors.begin(), m_cursors.end(), cursor);
-    if (it != m_cursors.end() && cursor == *it) {
-        m_cursors.erase(it);
+    // the cursor is stored on its current line
+    if (cursor->m_line < 0 || size_t(cursor->m_line) >= m_cursorsByLine.size()) {
+        return;
+    }
+    auto &cursors = m_cursorsByLine[cursor->m_line];
+    auto it = std::lower_bound(cursors.begin(), cursors.end(), cursor);
+    if (it != cursors.end() && cursor == *it) {
+        cursors.erase(it);
+        if (cursor->kateRange()) {
+            invalidateMultiLineRanges();
+        }
     }
 }
 }
@@ -14,6 +14,10 @@
 #include <ktexteditor/cursor.h>
 #include <ktexteditor_export.h>
 
+#include <memory>
+#include <span>
+#include <vector>
+
 namespace KTextEditor
 {
 class View;
@@ -25,6 +29,28 @@ class TextBuffer;
 class TextCursor;
 class TextRange;
 
+/**
+ * One replacement inside a single line, used for bulk edits.
+ * The text in [column, column + length) is replaced by text.
+ */
+struct LineReplacement {
+    int line = 0;
+    int column = 0;
+    int length = 0;
+    QString text;
+};
+
+/**
+ * All replacements of one line as one change, used to notify about bulk edits.
+ * The text removedText at column was replaced by insertedText.
+ */
+struct LineChange {
+    int line = 0;
+    int column = 0;
+    QString removedText;
+    QString insertedText;
+};
+
 /**
  * Class representing a text block.
  * This is used to build up a Kate::TextBuffer.
@@ -80,7 +106,7 @@ public:
     int lineLength(int line) const
     {
         Q_ASSERT(line >= startLine() && (line - startLine()) < lines());
-        return m_lines[line - startLine()].length();
+        return (*m_lines)[line - startLine()].length();
     }
 
     /**
@@ -100,7 +126,17 @@ public:
      */
     int lines() const
     {
-        return static_cast<int>(m_lines.size());
+        return static_cast<int>(m_lines->size());
+    }
+
+    /**
+     * Lines of this block for a snapshot, see TextBuffer::snapshot().
+     * They are never changed afterwards, the block copies them on its next change.
+     * @return lines of this block
+     */
+    std::shared_ptr<const std::vector<Kate::TextLine>> sharedLines() const
+    {
+        return m_lines;
     }
 
     /**
@@ -138,6 +174,16 @@ public:
      */
     void removeText(KTextEditor::Range range, QString &removedText);
 
+    /**
+     * Apply a batch of replacements, all of them must be on lines of this block.
+     * The replacements must be sorted by line and column and must not overlap,
+     * they are applied back to front, so all columns stay valid.
+     * Cursors are moved in one pass over the cursors of this block.
+     * @param replacements replacements to apply
+     * @param removedTexts will be filled with the removed text of each replacement, same size as replacements
+     */
+    void replaceText(std::span<const LineReplacement> replacements, std::span<QString> removedTexts);
+
     /**
      * Debug output, print whole block content with line numbers and line length
      * @param blockIndex index of this block in buffer
@@ -167,6 +213,69 @@ public:
      */
     KTEXTEDITOR_NO_EXPORT void rangesForLine(int line, KTextEditor::View *view, bool rangesWithAttributeOnly, QList<TextRange *> &outRanges) const;
 
+    /**
+     * One bracket inside this block, see brackets().
+     */
+    struct Bracket {
+        /**
+         * line in this block
+         */
+        int line;
+        int column;
+
+        /**
+         * highlighting attribute of the bracket, only meaningful if the line is highlighted
+         */
+        int attribute;
+        QChar character;
+    };
+
+    /**
+     * Nesting summary of one bracket kind with one attribute inside this block.
+     * Allows to skip whole blocks during bracket matching.
+     */
+    struct BracketBalance {
+        QChar open;
+        int attribute = 0;
+
+        /**
+         * number of opening minus number of closing brackets
+         */
+        int delta = 0;
+
+        /**
+         * minimal nesting reached scanning forward from the block start, opening brackets count +1, <= 0
+         */
+        int minPrefix = 0;
+
+        /**
+         * minimal nesting reached scanning backward from the block end, closing brackets count +1, <= 0
+         */
+        int minSuffix = 0;
+    };
+
+    /**
+     * All brackets of this block, sorted by line and column.
+     * Lazily computed and cached until the block changes.
+     * @return brackets of this block
+     */
+    const std::vector<Bracket> &brackets() const;
+
+    /**
+     * Nesting summary for the given bracket kind and attribute.
+     * Lazily computed and cached until the block changes.
+     * @param open opening bracket character of the kind
+     * @param attribute only take brackets with this attribute into account
+     * @return nesting summary
+     */
+    BracketBalance bracketBalance(QChar open, int attribute) const;
+
+    /**
+     * Nesting summaries for all bracket kinds and attributes inside this block.
+     * @return one summary for each bracket kind and attribute that occurs in this block
+     */
+    std::vector<BracketBalance> bracketBalances() const;
+
     /**
      * Flag all modified text lines as saved on disk.
      */
@@ -185,6 +294,63 @@ public:
     void removeCursor(Kate::TextCursor *cursor);
 
 private:
+    /**
+     * Are the lines shared with a snapshot?
+     * @return true if the lines must not be changed in place
+     */
+    bool sharesLines() const;
+
+    /**
+     * Lines of this block for a change, copies them first if they are shared with a snapshot.
+     * @return lines of this block, only valid until the next call
+     */
+    std::vector<Kate::TextLine> &mutableLines();
+
+    /**
+     * Cursors on the given line of this block, creates the bucket if needed.
+     * @param lineInBlock line in this block
+     * @return cursors on this line, sorted by address
+     */
+    std::vector<TextCursor *> &cursorsOnLine(int lineInBlock);
+
+    /**
+     * Are there any cursors in this block?
+     * @return true if at least one cursor is in this block
+     */
+    bool hasCursors() const;
+
+    /**
+     * Remove all cursors from this block, without touching the cursors.
+     * @return all cursors of this block
+     */
+    std::vector<TextCursor *> takeCursors();
+
+    /**
+     * Ranges with both cursors in this block on different lines, lazily computed and cached
+     * until cursors change their line or are added or removed.
+     * @return ranges spanning multiple lines inside this block
+     */
+    const std::vector<TextRange *> &multiLineRanges() const;
+
+    /**
+     * Drop the cached bracket index, must be called on any change of the lines.
+     */
+    void invalidateBrackets()
+    {
+        m_bracketsValid = false;
+        m_brackets.clear();
+        m_bracketBalances.clear();
+    }
+
+    /**
+     * Drop the cached multi-line ranges, must be called if cursors with ranges change their line or block.
+     */
+    void invalidateMultiLineRanges()
+    {
+        m_multiLineRangesValid = false;
+        m_multiLineRanges.clear();
+    }
+
     /**
      * parent text buffer
      */
@@ -196,15 +362,30 @@ private:
     int m_blockIndex;
 
     /**
-     * Lines contained in this buffer.
-     * We need no sharing, use STL.
+     * Lines contained in this block.
+     * Shared with snapshots, copy on write, see mutableLines().
+     */
+    std::shared_ptr<std::vector<Kate::TextLine>> m_lines = std::make_shared<std::vector<Kate::TextLine>>();
+
+    /**
+     * Cursors of this block, one bucket per line, each bucket sorted by address.
+     * Edits only need to look at the cursors of the lines they touch.
+     * Lines behind the last bucket have no cursors.
+     */
+    std::vector<std::vector<TextCursor *>> m_cursorsByLine;
+
+    /**
+     * Lazily computed ranges spanning multiple lines inside this block, see multiLineRanges().
      */
-    std::vector<Kate::TextLine> m_lines;
+    mutable std::vector<TextRange *> m_multiLineRanges;
+    mutable bool m_multiLineRangesValid = false;
 
     /**
-     * Set of cursors for this block.
+     * Lazily computed bracket index, see brackets() and bracketBalance().
      */
-    std::vector<TextCursor *> m_cursors;
+    mutable std::vector<Bracket> m_brackets;
+    mutable std::vector<BracketBalance> m_bracketBalances;
+    mutable bool m_bracketsValid = false;
 };
 }
 
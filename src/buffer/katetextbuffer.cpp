@@ -6,7 +6,9 @@
 #include "config.h"
 
 #include "katetextbuffer.h"
+#include "katetextdecorationlayer.h"
 #include "katetextloader.h"
+#include "katetextsnapshot.h"
 
 #include "katedocument.h"
 
@@ -81,7 +83,7 @@ TextBuffer::~TextBuffer()
     // invalidate all moving stuff
     std::vector<Kate::TextRange *> rangesWithFeedback;
     for (auto b : m_blocks) {
-        auto cursors = std::move(b->m_cursors);
+        const auto cursors = b->takeCursors();
         for (auto it = cursors.begin(); it != cursors.end(); ++it) {
             auto cursor = *it;
             // update the block
@@ -97,6 +99,13 @@ TextBuffer::~TextBuffer()
         }
     }
 
+    // decoration layers stay around without buffer
+    for (TextDecorationLayer *layer : m_decorationLayers) {
+        layer->reset(false);
+        layer->m_buffer = nullptr;
+    }
+    m_decorationLayers.clear();
+
     // uniquify ranges
     std::sort(rangesWithFeedback.begin(), rangesWithFeedback.end());
     auto it = std::unique(rangesWithFeedback.begin(), rangesWithFeedback.end());
@@ -120,9 +129,11 @@ void TextBuffer::invalidateRanges()
     std::vector<Kate::TextRange *> ranges;
     ranges.reserve(m_blocks.size());
     for (TextBlock *block : m_blocks) {
-        for (auto cursor : block->m_cursors) {
-            if (cursor->kateRange()) {
-                ranges.push_back(cursor->kateRange());
+        for (const auto &lineCursors : block->m_cursorsByLine) {
+            for (auto cursor : lineCursors) {
+                if (cursor->kateRange()) {
+                    ranges.push_back(cursor->kateRange());
+                }
             }
         }
     }
@@ -142,13 +153,18 @@ void TextBuffer::clear()
     m_multilineRanges.clear();
     invalidateRanges();
 
+    // decorations can't survive, the text history is cleared below
+    for (TextDecorationLayer *layer : m_decorationLayers) {
+        layer->reset(false);
+    }
+
     // new block for empty buffer
     TextBlock *newBlock = new TextBlock(this, 0);
     newBlock->appendLine(QString());
 
     // clean out all cursors and lines, move them to newBlock if not belonging to a range
     for (TextBlock *block : std::as_const(m_blocks)) {
-        auto cursors = std::move(block->m_cursors);
+        const auto cursors = block->takeCursors();
         for (auto it = cursors.begin(); it != cursors.end(); ++it) {
             auto cursor = *it;
             if (!cursor->kateRange()) {
@@ -156,14 +172,14 @@ void TextBuffer::clear()
                 cursor->m_block = newBlock;
                 // move the cursor into the target block
                 cursor->m_line = cursor->m_column = 0;
-                newBlock->m_cursors.push_back(cursor);
+                newBlock->cursorsOnLine(0).push_back(cursor);
                 // remove it and advance to next element
             }
             // skip cursors with ranges, we need to invalidate the ranges later
         }
         block->clearLines();
     }
-    std::sort(newBlock->m_cursors.begin(), newBlock->m_cursors.end());
+    std::sort(newBlock->cursorsOnLine(0).begin(), newBlock->cursorsOnLine(0).end());
 
     // kill all buffer blocks
     qDeleteAll(m_blocks);
@@ -201,6 +217,19 @@ TextLine TextBuffer::line(int line) const
     return m_blocks.at(blockIndex)->line(line - m_startLines[blockIndex]);
 }
 
+KTextEditor::TextSnapshot TextBuffer::snapshot() const
+{
+    auto d = std::make_shared<KTextEditor::TextSnapshotPrivate>();
+    d->revision = m_revision;
+    d->lines = m_lines;
+    d->startLines = m_startLines;
+    d->blocks.reserve(m_blocks.size());
+    for (const TextBlock *block : m_blocks) {
+        d->blocks.push_back(block->sharedLines());
+    }
+    return KTextEditor::TextSnapshotPrivate::create(std::move(d));
+}
+
 void TextBuffer::setLineMetaData(int line, const TextLine &textLine)
 {
     // get block, this will assert on invalid line
@@ -506,6 +535,332 @@ void TextBuffer::removeText(KTextEditor::Range range)
     Q_EMIT m_document->KTextEditor::Document::textRemoved(m_document, range, text);
 }
 
+std::vector<LineChange> TextBuffer::replaceText(std::span<const LineReplacement> replacements)
+{
+    // debug output for REAL low-level debugging
+    BUFFER_DEBUG << "replaceText" << replacements.size();
+
+    // only allowed if editing transaction running
+    Q_ASSERT(m_editingTransactions > 0);
+
+    // replacements must be sorted, the blocks rely on that
+    Q_ASSERT(std::is_sorted(replacements.begin(), replacements.end(), [](const LineReplacement &a, const LineReplacement &b) {
+        return a.line < b.line || (a.line == b.line && a.column < b.column);
+    }));
+
+    if (replacements.empty()) {
+        return {};
+    }
+    std::vector<QString> removedTexts(replacements.size());
+
+    const qint64 oldRevision = m_revision;
+
+    // let the blocks handle the replacements, back to front, each block once
+    size_t end = replacements.size();
+    while (end > 0) {
+        // get block, this will assert on invalid line
+        const int blockIndex = blockForLine(replacements[end - 1].line);
+        const int blockStartLine = m_startLines[blockIndex];
+        size_t begin = end - 1;
+        while (begin > 0 && replacements[begin - 1].line >= blockStartLine) {
+            --begin;
+        }
+
+        const auto blockReplacements = replacements.subspan(begin, end - begin);
+        const auto blockRemovedTexts = std::span<QString>(removedTexts).subspan(begin, end - begin);
+        m_blocks.at(blockIndex)->replaceText(blockReplacements, blockRemovedTexts);
+        for (size_t i = 0; i < blockReplacements.size(); ++i) {
+            m_blockSizes[blockIndex] += static_cast<int>(blockReplacements[i].text.size() - blockRemovedTexts[i].size());
+        }
+
+        end = begin;
+    }
+
+    // nothing did change, e.g. only empty replacements
+    std::vector<LineChange> lineChanges;
+    if (oldRevision == m_revision) {
+        return lineChanges;
+    }
+
+    // update changed line interval
+    if (replacements.front().line < m_editingMinimalLineChanged || m_editingMinimalLineChanged == -1) {
+        m_editingMinimalLineChanged = replacements.front().line;
+    }
+
+    if (replacements.back().line > m_editingMaximalLineChanged) {
+        m_editingMaximalLineChanged = replacements.back().line;
+    }
+
+    // merge the replacements of each line into one change from the first to the last replaced column,
+    // the text between the replacements is unchanged and taken from the new line
+    for (size_t i = 0; i < replacements.size();) {
+        const int line = replacements[i].line;
+        const QString lineText = this->line(line).text();
+        LineChange change{line, replacements[i].column, QString(), QString()};
+        int oldColumn = change.column;
+        int newColumn = change.column;
+        for (; i < replacements.size() && replacements[i].line == line; ++i) {
+            const int unchanged = replacements[i].column - oldColumn;
+            change.removedText += QStringView(lineText).mid(newColumn, unchanged);
+            change.removedText += removedTexts[i];
+            oldColumn = replacements[i].column + replacements[i].length;
+            newColumn += unchanged + replacements[i].text.size();
+        }
+        change.insertedText = lineText.mid(change.column, newColumn - change.column);
+        lineChanges.push_back(std::move(change));
+    }
+
+    // emit signals about done changes, the lines are independent of each other
+    for (const LineChange &change : lineChanges) {
+        if (!change.removedText.isEmpty()) {
+            const KTextEditor::Range range(change.line, change.column, change.line, change.column + change.removedText.size());
+            Q_EMIT m_document->KTextEditor::Document::textRemoved(m_document, range, change.removedText);
+        }
+        if (!change.insertedText.isEmpty()) {
+            Q_EMIT m_document->KTextEditor::Document::textInserted(m_document, KTextEditor::Cursor(change.line, change.column), change.insertedText);
+        }
+    }
+
+    return lineChanges;
+}
+
+static QChar oppositeBracket(QChar bracket)
+{
+    switch (bracket.unicode()) {
+    case u'(':
+        return QLatin1Char(')');
+    case u')':
+        return QLatin1Char('(');
+    case u'[':
+        return QLatin1Char(']');
+    case u']':
+        return QLatin1Char('[');
+    case u'{':
+        return QLatin1Char('}');
+    case u'}':
+        return QLatin1Char('{');
+    }
+    return QChar();
+}
+
+static bool isOpeningBracket(QChar bracket)
+{
+    return bracket == QLatin1Char('(') || bracket == QLatin1Char('[') || bracket == QLatin1Char('{');
+}
+
+KTextEditor::Cursor TextBuffer::findMatchingBracket(const KTextEditor::Cursor position,
+                                                    int minLine,
+                                                    int maxLine,
+                                                    const std::function<void(int)> &ensureHighlighted) const
+{
+    // get block, this will assert on invalid line
+    int blockIndex = blockForLine(position.line());
+    const TextBlock *block = m_blocks[blockIndex];
+
+    // the attributes of the brackets must be known up to the position, forward up to the end of the block
+    const QChar bracket = line(position.line()).at(position.column());
+    const bool forward = isOpeningBracket(bracket);
+    if (ensureHighlighted) {
+        ensureHighlighted(forward ? std::min(m_startLines[blockIndex] + block->lines() - 1, maxLine) : position.line());
+    }
+
+    // locate the start bracket in the index
+    const auto &startBrackets = block->brackets();
+    const int lineInBlock = position.line() - m_startLines[blockIndex];
+    const auto startIt =
+        std::lower_bound(startBrackets.begin(), startBrackets.end(), std::make_pair(lineInBlock, position.column()), [](const auto &bracket, const auto &pos) {
+            return std::make_pair(bracket.line, bracket.column) < pos;
+        });
+    if (startIt == startBrackets.end() || startIt->line != lineInBlock || startIt->column != position.column()) {
+        return KTextEditor::Cursor::invalid();
+    }
+
+    const int attribute = startIt->attribute;
+    const QChar opposite = oppositeBracket(bracket);
+    const QChar open = forward ? bracket : opposite;
+
+    // nesting of the same bracket kind we passed, match is found if we see the opposite with nesting 0
+    int nesting = 0;
+    auto scan = [&](const TextBlock::Bracket &candidate, int blockStartLine) {
+        const int line = blockStartLine + candidate.line;
+        if (line < minLine || line > maxLine || candidate.attribute != attribute) {
+            return false;
+        }
+        if (candidate.character == opposite) {
+            if (nesting == 0) {
+                return true;
+            }
+            --nesting;
+        } else if (candidate.character == bracket) {
+            ++nesting;
+        }
+        return false;
+    };
+
+    if (forward) {
+        // rest of the start block
+        for (auto it = startIt + 1; it != startBrackets.end(); ++it) {
+            if (scan(*it, m_startLines[blockIndex])) {
+                return KTextEditor::Cursor(m_startLines[blockIndex] + it->line, it->column);
+            }
+        }
+
+        // following blocks, highlighted only once the search gets there, skip the ones that can't contain the match
+        for (++blockIndex; blockIndex < int(m_blocks.size()) && m_startLines[blockIndex] <= maxLine; ++blockIndex) {
+            block = m_blocks[blockIndex];
+            const int blockStartLine = m_startLines[blockIndex];
+            const int blockEndLine = blockStartLine + block->lines() - 1;
+            if (ensureHighlighted) {
+                ensureHighlighted(std::min(blockEndLine, maxLine));
+            }
+
+            if (blockEndLine <= maxLine) {
+                const auto balance = block->bracketBalance(open, attribute);
+                if (nesting + balance.minPrefix >= 0) {
+                    nesting += balance.delta;
+                    continue;
+                }
+            }
+
+            for (const auto &candidate : block->brackets()) {
+                if (scan(candidate, blockStartLine)) {
+                    return KTextEditor::Cursor(blockStartLine + candidate.line, candidate.column);
+                }
+            }
+        }
+
+        return KTextEditor::Cursor::invalid();
+    }
+
+    // backward: front part of the start block
+    for (auto it = std::make_reverse_iterator(startIt); it != startBrackets.rend(); ++it) {
+        if (scan(*it, m_startLines[blockIndex])) {
+            return KTextEditor::Cursor(m_startLines[blockIndex] + it->line, it->column);
+        }
+    }
+
+    // blocks in front, skip the ones that can't contain the match
+    for (--blockIndex; blockIndex >= 0 && m_startLines[blockIndex] + m_blocks[blockIndex]->lines() - 1 >= minLine; --blockIndex) {
+        block = m_blocks[blockIndex];
+        const int blockStartLine = m_startLines[blockIndex];
+        if (blockStartLine >= minLine) {
+            const auto balance = block->bracketBalance(open, attribute);
+            if (nesting + balance.minSuffix >= 0) {
+                nesting -= balance.delta;
+                continue;
+            }
+        }
+
+        const auto &blockBrackets = block->brackets();
+        for (auto it = blockBrackets.rbegin(); it != blockBrackets.rend(); ++it) {
+            if (scan(*it, blockStartLine)) {
+                return KTextEditor::Cursor(blockStartLine + it->line, it->column);
+            }
+        }
+    }
+
+    return KTextEditor::Cursor::invalid();
+}
+
+KTextEditor::Range TextBuffer::findEnclosingBrackets(const KTextEditor::Cursor position,
+                                                     int minLine,
+                                                     int maxLine,
+                                                     const std::function<bool(int)> &isIgnoredAttribute,
+                                                     const std::function<void(int)> &ensureHighlighted) const
+{
+    // get block, this will assert on invalid line
+    int blockIndex = blockForLine(position.line());
+    if (ensureHighlighted) {
+        ensureHighlighted(position.line());
+    }
+
+    // closing brackets passed scanning backward, per bracket kind and attribute, the first opening
+    // bracket without a closing one in between encloses the position
+    struct Nesting {
+        QChar open;
+        int attribute;
+        int closed;
+    };
+    std::vector<Nesting> nestings;
+    auto nestingFor = [&nestings](QChar open, int attribute) -> int & {
+        for (auto &nesting : nestings) {
+            if (nesting.open == open && nesting.attribute == attribute) {
+                return nesting.closed;
+            }
+        }
+        nestings.push_back({open, attribute, 0});
+        return nestings.back().closed;
+    };
+
+    // returns the enclosing pair if the bracket is an opening one without closing one in front of the position
+    auto scan = [&](const TextBlock::Bracket &candidate, int blockStartLine) {
+        if (blockStartLine + candidate.line < minLine || isIgnoredAttribute(candidate.attribute)) {
+            return KTextEditor::Range::invalid();
+        }
+        const bool opening = isOpeningBracket(candidate.character);
+        int &closed = nestingFor(opening ? candidate.character : oppositeBracket(candidate.character), candidate.attribute);
+        if (!opening) {
+            ++closed;
+            return KTextEditor::Range::invalid();
+        }
+        if (closed > 0) {
+            --closed;
+            return KTextEditor::Range::invalid();
+        }
+
+        // an unclosed bracket, e.g. while typing, doesn't enclose anything, search further outside
+        const KTextEditor::Cursor start(blockStartLine + candidate.line, candidate.column);
+        const KTextEditor::Cursor end = findMatchingBracket(start, start.line(), maxLine, ensureHighlighted);
+        return end.isValid() ? KTextEditor::Range(start, end) : KTextEditor::Range::invalid();
+    };
+
+    // front part of the block of the position, copied as the forward search might highlight and so change the block
+    const int lineInBlock = position.line() - m_startLines[blockIndex];
+    const auto &blockBrackets = m_blocks[blockIndex]->brackets();
+    const auto endIt =
+        std::lower_bound(blockBrackets.begin(), blockBrackets.end(), std::make_pair(lineInBlock, position.column()), [](const auto &bracket, const auto &pos) {
+            return std::make_pair(bracket.line, bracket.column) < pos;
+        });
+    const std::vector<TextBlock::Bracket> frontBrackets(blockBrackets.begin(), endIt);
+    for (auto it = frontBrackets.rbegin(); it != frontBrackets.rend(); ++it) {
+        const KTextEditor::Range range = scan(*it, m_startLines[blockIndex]);
+        if (range.isValid()) {
+            return range;
+        }
+    }
+
+    // blocks in front, skip the ones without an opening bracket that stays unclosed
+    for (--blockIndex; blockIndex >= 0 && m_startLines[blockIndex] + m_blocks[blockIndex]->lines() - 1 >= minLine; --blockIndex) {
+        const TextBlock *block = m_blocks[blockIndex];
+        const int blockStartLine = m_startLines[blockIndex];
+        if (blockStartLine >= minLine) {
+            const auto balances = block->bracketBalances();
+            const bool skip = std::all_of(balances.begin(), balances.end(), [&](const TextBlock::BracketBalance &balance) {
+                return isIgnoredAttribute(balance.attribute) || nestingFor(balance.open, balance.attribute) + balance.minSuffix >= 0;
+            });
+            if (skip) {
+                for (const auto &balance : balances) {
+                    if (!isIgnoredAttribute(balance.attribute)) {
+                        nestingFor(balance.open, balance.attribute) -= balance.delta;
+                    }
+                }
+                continue;
+            }
+        }
+
+        // copied for the same reason as above
+        const std::vector<TextBlock::Bracket> brackets = block->brackets();
+        for (auto it = brackets.rbegin(); it != brackets.rend(); ++it) {
+            const KTextEditor::Range range = scan(*it, blockStartLine);
+            if (range.isValid()) {
+                return range;
+            }
+        }
+    }
+
+    return KTextEditor::Range::invalid();
+}
+
 int TextBuffer::blockForLine(int line) const
 {
     // only allow valid lines
@@ -644,6 +999,34 @@ void TextBuffer::debugPrint(const QString &title) const
     }
 }
 
+bool TextBuffer::readFile(const QString &filename, QStringList &lines, QByteArray &digest) const
+{
+    Kate::TextLoader file(filename, m_encodingProberType, m_lineLengthLimit);
+    if (!file.open(m_textCodec)) {
+        return false;
+    }
+
+    // any difference would change the buffer beyond its lines
+    bool tooLongLinesWrapped = false;
+    int longestLineLoaded = 0;
+    while (!file.eof()) {
+        int offset = 0;
+        int length = 0;
+        if (!file.readLine(offset, length, tooLongLinesWrapped, longestLineLoaded) || tooLongLinesWrapped) {
+            return false;
+        }
+        lines.append(QString(file.unicode() + offset, length));
+    }
+
+    if (lines.isEmpty() || file.textCodec() != m_textCodec || file.byteOrderMarkFound() != m_generateByteOrderMark
+        || (file.eol() != eolUnknown && file.eol() != m_endOfLineMode) || file.mimeTypeForFilterDev() != m_mimeTypeForFilterDev) {
+        return false;
+    }
+
+    digest = file.digest();
+    return true;
+}
+
 bool TextBuffer::load(const QString &filename, bool &encodingErrors, bool &tooLongLinesWrapped, int &longestLineLoaded, bool enforceTextCodec)
 {
     // fallback codec must exist
@@ -1085,6 +1468,10 @@ bool TextBuffer::hasMultlineRange(KTextEditor::MovingRange *range) const
 
 void TextBuffer::rangesForLine(int line, KTextEditor::View *view, bool rangesWithAttributeOnly, QList<TextRange *> &outRanges) const
 {
+    // buffers without a document, e.g. in the unit tests, have no counters
+    if (m_document) {
+        KATE_PERF_COUNT(m_document->perfCounters(), "rangesForLine calls", 1);
+    }
     outRanges.clear();
     // get block, this will assert on invalid line
     const int blockIndex = blockForLine(line);
@@ -10,14 +10,18 @@
 #include <QObject>
 #include <QSet>
 #include <QString>
+#include <QStringList>
 
 #include "katetextblock.h"
 #include "katetexthistory.h"
+#include <ktexteditor/textsnapshot.h>
 #include <ktexteditor_export.h>
 
 // encoding prober
 #include <KEncodingProber>
 
+#include <functional>
+
 namespace KTextEditor
 {
 class DocumentPrivate;
@@ -30,6 +34,7 @@ namespace Kate
 class TextRange;
 class TextCursor;
 class TextBlock;
+class TextDecorationLayer;
 
 constexpr int BufferBlockSize = 64;
 
@@ -42,6 +47,7 @@ class KTEXTEDITOR_EXPORT TextBuffer : public QObject
     friend class TextCursor;
     friend class TextRange;
     friend class TextBlock;
+    friend class TextDecorationLayer;
 
     Q_OBJECT
 
@@ -191,6 +197,17 @@ public:
      */
     virtual bool load(const QString &filename, bool &encodingErrors, bool &tooLongLinesWrapped, int &longestLineLoaded, bool enforceTextCodec);
 
+    /**
+     * Read the lines of the given file like load() with the current codec, the buffer stays untouched.
+     * Used to compare the file with the buffer, e.g. to reload only the changed lines.
+     * @param filename file to read
+     * @param lines will be filled with the lines of the file
+     * @param digest will be filled with the checksum of the file
+     * @return false on errors, encoding errors or too long lines and if codec, byte order mark,
+     *         end of line mode or compression of the file differ from the ones of the buffer
+     */
+    bool readFile(const QString &filename, QStringList &lines, QByteArray &digest) const;
+
     /**
      * Save the current buffer content to the given file.
      * Before calling this, setTextCodec and setFallbackTextCodec must have been used to set codec!
@@ -227,6 +244,14 @@ public:
      */
     TextLine line(int line) const;
 
+    /**
+     * Immutable copy of the current text, tagged with the current revision.
+     * Shares the lines with the blocks, the blocks copy them on their next change.
+     * The snapshot can be read in any thread.
+     * @return snapshot of the current text
+     */
+    KTextEditor::TextSnapshot snapshot() const;
+
     /**
      * Transfer all non text attributes for the given line from the given text line to the one in the buffer.
      * @param line line number to set attributes
@@ -234,6 +259,12 @@ public:
      */
     void setLineMetaData(int line, const TextLine &textLine);
 
+    /**
+     * Mark all modified lines as lines saved on disk (modified line system).
+     */
+    KTEXTEDITOR_NO_EXPORT
+    void markModifiedLinesAsSaved();
+
     /**
      * Retrieve length for @p line
      * @param line wanted line number
@@ -374,6 +405,50 @@ public:
      */
     virtual void removeText(KTextEditor::Range range);
 
+    /**
+     * Apply a batch of in-line replacements in one go.
+     * The replacements must be sorted by line and column and must not overlap.
+     * They are applied back to front, each block is visited only once and its cursors are moved in one pass.
+     * The textRemoved/textInserted signals are emitted once per changed line, from the first to the last
+     * replaced column, after all lines are changed.
+     * @param replacements replacements to apply, no line will be wrapped or unwrapped
+     * @return the changes of each changed line, sorted by line
+     */
+    std::vector<LineChange> replaceText(std::span<const LineReplacement> replacements);
+
+    /**
+     * Find the bracket matching the one at @p position using the per block bracket index.
+     * Only brackets with the same highlighting attribute as the one at @p position are taken into account,
+     * that skips brackets in comments and strings.
+     * Blocks without a match are skipped using their cached nesting summary, no line length matters,
+     * the costs grow with the number of blocks between the brackets.
+     * @param position position of the bracket to match, must be one of ()[]{}
+     * @param minLine don't search in lines in front of this one
+     * @param maxLine don't search in lines behind this one
+     * @param ensureHighlighted called with the last line the search needs the highlighting for, before the
+     *        search gets there, so highlighting is done block by block only as far as needed
+     * @return position of the matching bracket, invalid if none found
+     */
+    KTextEditor::Cursor
+    findMatchingBracket(const KTextEditor::Cursor position, int minLine, int maxLine, const std::function<void(int)> &ensureHighlighted = {}) const;
+
+    /**
+     * Find the innermost pair of brackets around @p position, of any kind, using the per block bracket index.
+     * Brackets only pair with brackets of the same highlighting attribute, opening brackets without
+     * a closing one are skipped.
+     * @param position position inside the brackets, a bracket at the position itself doesn't count
+     * @param minLine don't search for the opening bracket in lines in front of this one
+     * @param maxLine don't search for the closing bracket in lines behind this one
+     * @param isIgnoredAttribute returns true for attributes of brackets to ignore, e.g. comments and strings
+     * @param ensureHighlighted see findMatchingBracket()
+     * @return range from the opening to the closing bracket, invalid if none found
+     */
+    KTextEditor::Range findEnclosingBrackets(const KTextEditor::Cursor position,
+                                             int minLine,
+                                             int maxLine,
+                                             const std::function<bool(int)> &isIgnoredAttribute,
+                                             const std::function<void(int)> &ensureHighlighted = {}) const;
+
     /**
      * TextHistory of this buffer
      * @return text history for this buffer
@@ -446,12 +521,6 @@ private:
     KTEXTEDITOR_NO_EXPORT
     void notifyAboutRangeChange(KTextEditor::View *view, KTextEditor::LineRange lineRange, bool needsRepaint, TextRange *deletedRange = nullptr);
 
-    /**
-     * Mark all modified lines as lines saved on disk (modified line system).
-     */
-    KTEXTEDITOR_NO_EXPORT
-    void markModifiedLinesAsSaved();
-
     /**
      * Save the current buffer content to the given already opened device
      *
@@ -520,6 +589,15 @@ public:
     KTEXTEDITOR_NO_EXPORT void removeMultilineRange(TextRange *range);
     bool hasMultlineRange(KTextEditor::MovingRange *range) const;
 
+    /**
+     * Decoration layers of this buffer, e.g. for semantic highlighting.
+     * @return all layers, in order of creation
+     */
+    const std::vector<TextDecorationLayer *> &decorationLayers() const
+    {
+        return m_decorationLayers;
+    }
+
     //
     // checksum handling
     //
@@ -607,6 +685,11 @@ private:
      */
     std::vector<TextRange *> m_multilineRanges;
 
+    /**
+     * Decoration layers, they register themselves
+     */
+    std::vector<TextDecorationLayer *> m_decorationLayers;
+
     /**
      * Encoding prober type to use
      */
@@ -41,7 +41,8 @@ TextCursor::~TextCursor()
 
 void TextCursor::setPosition(const TextCursor &position)
 {
-    if (m_block && m_block != position.m_block) {
+    // blocks store their cursors per line, remove before the line changes
+    if (m_block) {
         m_block->removeCursor(this);
     }
 
@@ -91,13 +92,20 @@ void TextCursor::setPosition(KTextEditor::Cursor position, bool init)
         }
         m_block = m_buffer->m_blocks[m_buffer->blockForLine(position.line())];
         Q_ASSERT(m_block);
-        m_block->insertCursor(this);
         startLine = m_block->startLine();
+    } else if (position.line() - startLine != m_line) {
+        // blocks store their cursors per line, remove before the line changes
+        m_block->removeCursor(this);
+    } else {
+        // same line, only the column changes
+        m_column = position.column();
+        return;
     }
 
     // else: valid cursor
     m_line = position.line() - startLine;
     m_column = position.column();
+    m_block->insertCursor(this);
 }
 
 KTextEditor::Document *Kate::TextCursor::document() const
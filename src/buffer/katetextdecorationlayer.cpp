@@ -0,0 +1,187 @@
+/*
+    SPDX-FileCopyrightText: KDE Developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "katetextdecorationlayer.h"
+#include "katedocument.h"
+#include "katetextbuffer.h"
+
+#include <algorithm>
+
+namespace Kate
+{
+static bool decorationLessThan(const KTextEditor::Decoration &a, const KTextEditor::Decoration &b)
+{
+    return a.line < b.line || (a.line == b.line && a.column < b.column);
+}
+
+// range of the decorations on the given line
+static auto decorationsOnLine(std::vector<KTextEditor::Decoration> &decorations, int line)
+{
+    const auto begin = std::lower_bound(decorations.begin(), decorations.end(), line, [](const KTextEditor::Decoration &d, int line) {
+        return d.line < line;
+    });
+    const auto end = std::upper_bound(begin, decorations.end(), line, [](int line, const KTextEditor::Decoration &d) {
+        return line < d.line;
+    });
+    return std::make_pair(begin, end);
+}
+
+TextDecorationLayer::TextDecorationLayer(TextBuffer *buffer)
+    : m_buffer(buffer)
+{
+    m_buffer->m_decorationLayers.push_back(this);
+}
+
+TextDecorationLayer::~TextDecorationLayer()
+{
+    // buffer might be gone already
+    if (!m_buffer) {
+        return;
+    }
+
+    repaintDecoratedLines();
+    reset(true);
+    std::erase(m_buffer->m_decorationLayers, this);
+}
+
+KTextEditor::Document *TextDecorationLayer::document() const
+{
+    return m_buffer ? m_buffer->document() : nullptr;
+}
+
+void TextDecorationLayer::setAttributes(const QList<KTextEditor::Attribute::Ptr> &attributes)
+{
+    m_attributes = attributes;
+    repaintDecoratedLines();
+}
+
+void TextDecorationLayer::setDecorations(const QList<KTextEditor::Decoration> &decorations, qint64 revision)
+{
+    if (!m_buffer) {
+        return;
+    }
+
+    // the old decorations vanish
+    repaintDecoratedLines();
+    reset(true);
+
+    m_decorations.reserve(decorations.size());
+    for (const KTextEditor::Decoration &decoration : decorations) {
+        if (decoration.line >= 0 && decoration.column >= 0 && decoration.length > 0) {
+            m_decorations.push_back(decoration);
+        }
+    }
+    if (m_decorations.empty()) {
+        return;
+    }
+    std::sort(m_decorations.begin(), m_decorations.end(), decorationLessThan);
+
+    // keep the revision of the decorations around until they are moved to a newer one
+    m_revision = (revision == -1) ? m_buffer->history().revision() : revision;
+    m_buffer->history().lockRevision(m_revision);
+
+    repaintDecoratedLines();
+}
+
+void TextDecorationLayer::clear()
+{
+    repaintDecoratedLines();
+    reset(true);
+}
+
+QList<KTextEditor::Decoration> TextDecorationLayer::decorations(int line) const
+{
+    const auto decorations = decorationsForLine(line);
+    return QList<KTextEditor::Decoration>(decorations.begin(), decorations.end());
+}
+
+std::span<const KTextEditor::Decoration> TextDecorationLayer::decorationsForLine(int line) const
+{
+    updateToCurrentRevision();
+    const auto [begin, end] = decorationsOnLine(m_decorations, line);
+    return std::span<const KTextEditor::Decoration>(begin, end);
+}
+
+void TextDecorationLayer::updateToCurrentRevision() const
+{
+    // nothing to move?
+    if (!m_buffer || m_revision == -1) {
+        return;
+    }
+    TextHistory &history = m_buffer->history();
+    const qint64 revision = history.revision();
+    if (m_revision == revision) {
+        return;
+    }
+
+    // replay all edits since our revision, like for ranges that don't expand
+    bool anyEmpty = false;
+    for (qint64 rev = m_revision - history.m_firstHistoryEntryRevision + 1; rev <= revision - history.m_firstHistoryEntryRevision; ++rev) {
+        const TextHistory::Entry &entry = history.m_historyEntries.at(rev);
+        if (entry.type == TextHistory::Entry::NoChange) {
+            continue;
+        }
+
+        // only the decorations on the edited line change their columns, this keeps them sorted
+        const auto [lineBegin, lineEnd] = decorationsOnLine(m_decorations, entry.line);
+        for (auto it = lineBegin; it != lineEnd; ++it) {
+            int startLine = it->line;
+            int startColumn = it->column;
+            int endLine = it->line;
+            int endColumn = it->column + it->length;
+            entry.transformCursor(startLine, startColumn, true);
+            entry.transformCursor(endLine, endColumn, false);
+
+            // a wrap inside of the decoration keeps the part in front of it
+            it->line = startLine;
+            it->column = startColumn;
+            it->length = (startLine == endLine) ? (endColumn - startColumn) : (entry.column - startColumn);
+            anyEmpty = anyEmpty || it->length <= 0;
+        }
+
+        // all later lines just move
+        if (entry.type == TextHistory::Entry::WrapLine || entry.type == TextHistory::Entry::UnwrapLine) {
+            const int lineDelta = (entry.type == TextHistory::Entry::WrapLine) ? 1 : -1;
+            for (auto it = lineEnd; it != m_decorations.end(); ++it) {
+                it->line += lineDelta;
+            }
+        }
+    }
+
+    if (anyEmpty) {
+        std::erase_if(m_decorations, [](const KTextEditor::Decoration &decoration) {
+            return decoration.length <= 0;
+        });
+    }
+
+    // lock the new revision before the old one is released, that might drop history entries
+    history.lockRevision(revision);
+    history.unlockRevision(m_revision);
+    m_revision = revision;
+}
+
+void TextDecorationLayer::reset(bool unlockRevision)
+{
+    if (unlockRevision && m_buffer && m_revision != -1) {
+        m_buffer->history().unlockRevision(m_revision);
+    }
+    m_revision = -1;
+    m_decorations.clear();
+}
+
+void TextDecorationLayer::repaintDecoratedLines()
+{
+    if (!m_buffer || m_decorations.empty()) {
+        return;
+    }
+
+    updateToCurrentRevision();
+    if (!m_decorations.empty()) {
+        m_buffer->notifyAboutRangeChange(nullptr, KTextEditor::LineRange(m_decorations.front().line, m_decorations.back().line), true, nullptr);
+    }
+}
+
+}
@@ -0,0 +1,116 @@
+/*
+    SPDX-FileCopyrightText: KDE Developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef KATE_TEXTDECORATIONLAYER_H
+#define KATE_TEXTDECORATIONLAYER_H
+
+#include <ktexteditor/decorationlayer.h>
+#include <ktexteditor_export.h>
+
+#include <span>
+#include <vector>
+
+namespace Kate
+{
+class TextBuffer;
+
+/**
+ * Class representing a layer of decorations of a TextBuffer.
+ * The decorations are kept sorted by line and column at the revision they were last
+ * moved to. They are moved along the text history lazily, when they are needed at a
+ * newer revision, only the decorations on edited lines need more than a line shift.
+ */
+class KTEXTEDITOR_EXPORT TextDecorationLayer final : public KTextEditor::DecorationLayer
+{
+    friend class TextBuffer;
+
+public:
+    /**
+     * Construct an empty layer and register it in the buffer.
+     * @param buffer parent text buffer
+     */
+    explicit TextDecorationLayer(TextBuffer *buffer);
+
+    /**
+     * Unregister from the buffer and repaint the decorated lines.
+     */
+    ~TextDecorationLayer() override;
+
+    KTextEditor::Document *document() const override;
+
+    void setAttributes(const QList<KTextEditor::Attribute::Ptr> &attributes) override;
+
+    QList<KTextEditor::Attribute::Ptr> attributes() const override
+    {
+        return m_attributes;
+    }
+
+    /**
+     * Attribute for the given index of a decoration.
+     * @param attribute attribute index of a decoration
+     * @return attribute, nullptr for invalid indices
+     */
+    KTextEditor::Attribute::Ptr attribute(int attribute) const
+    {
+        return (attribute >= 0 && attribute < m_attributes.size()) ? m_attributes[attribute] : KTextEditor::Attribute::Ptr();
+    }
+
+    void setDecorations(const QList<KTextEditor::Decoration> &decorations, qint64 revision = -1) override;
+
+    void clear() override;
+
+    QList<KTextEditor::Decoration> decorations(int line) const override;
+
+    /**
+     * Decorations on the given line at the current revision, for the renderer.
+     * Only valid until the next change of the buffer or this layer.
+     * @param line line to look at
+     * @return decorations on this line, sorted by column
+     */
+    std::span<const KTextEditor::Decoration> decorationsForLine(int line) const;
+
+private:
+    /**
+     * Move the decorations to the current revision of the buffer.
+     */
+    void updateToCurrentRevision() const;
+
+    /**
+     * Drop all decorations and the locked revision.
+     * @param unlockRevision false if the text history was already cleared
+     */
+    void reset(bool unlockRevision);
+
+    /**
+     * Repaint the lines of all decorations in all views.
+     */
+    void repaintDecoratedLines();
+
+private:
+    /**
+     * parent text buffer, nullptr once the buffer is gone
+     */
+    TextBuffer *m_buffer;
+
+    /**
+     * attributes referenced by the decorations
+     */
+    QList<KTextEditor::Attribute::Ptr> m_attributes;
+
+    /**
+     * decorations sorted by line and column, valid at m_revision
+     */
+    mutable std::vector<KTextEditor::Decoration> m_decorations;
+
+    /**
+     * revision of the decorations, locked in the text history, -1 if there are none
+     */
+    mutable qint64 m_revision = -1;
+};
+
+}
+
+#endif
@@ -66,6 +66,7 @@ void TextFolding::clearFoldingRanges()
     // cleanup
     m_idToFoldingRange.clear();
     m_foldedFoldingRanges.clear();
+    invalidateHiddenLines();
     qDeleteAll(m_foldingRanges);
     m_foldingRanges.clear();
 
@@ -268,10 +269,8 @@ int TextFolding::visibleLines() const
         return visibleLines;
     }
 
-    // count all folded lines and subtract them from visible lines
-    for (FoldingRange *range : m_foldedFoldingRanges) {
-        visibleLines -= (range->end->line() - range->start->line());
-    }
+    // subtract all folded lines
+    visibleLines -= hiddenLinesBefore().back();
 
     // be done, assert we did no trash
     Q_ASSERT(visibleLines > 0);
@@ -283,38 +282,28 @@ int TextFolding::lineToVisibleLine(int line) const
     // valid input needed!
     Q_ASSERT(line >= 0);
 
-    // start with identity
-    int visibleLine = line;
-
     // skip if nothing folded or first line
     if (m_foldedFoldingRanges.isEmpty() || (line == 0)) {
-        return visibleLine;
+        return line;
     }
 
-    // walk over all folded ranges until we reach the line
-    // keep track of seen visible lines, for the case we want to convert a hidden line!
-    int seenVisibleLines = 0;
-    int lastLine = 0;
-    for (FoldingRange *range : m_foldedFoldingRanges) {
-        // abort if we reach our line!
-        if (range->start->line() >= line) {
-            break;
-        }
-
-        // count visible lines
-        seenVisibleLines += (range->start->line() - lastLine);
-        lastLine = range->end->line();
+    // count of folded ranges starting in front of our line
+    const auto begin = m_foldedFoldingRanges.begin();
+    const auto index = std::lower_bound(begin, m_foldedFoldingRanges.end(), line, compareRangeByLineWithStart) - begin;
+    if (index == 0) {
+        return line;
+    }
 
-        // we might be contained in the region, then we return last visible line
-        if (line <= range->end->line()) {
-            return seenVisibleLines;
-        }
+    const std::vector<int> &hiddenLines = hiddenLinesBefore();
 
-        // subtrace folded lines
-        visibleLine -= (range->end->line() - range->start->line());
+    // we might be contained in the region in front of us, then we return the visible line of its start
+    const FoldingRange *range = m_foldedFoldingRanges[index - 1];
+    if (line <= range->end->line()) {
+        return range->start->line() - hiddenLines[index - 1];
     }
 
-    // be done, assert we did no trash
+    // subtract folded lines
+    const int visibleLine = line - hiddenLines[index];
     Q_ASSERT(visibleLine >= 0);
     return visibleLine;
 }
@@ -324,40 +313,52 @@ int TextFolding::visibleLineToLine(int visibleLine) const
     // valid input needed!
     Q_ASSERT(visibleLine >= 0);
 
-    // start with identity
-    int line = visibleLine;
-
     // skip if nothing folded or first line
     if (m_foldedFoldingRanges.isEmpty() || (visibleLine == 0)) {
-        return line;
+        return visibleLine;
     }
 
-    // last visible line seen, as line in buffer
-    int seenVisibleLines = 0;
-    int lastLine = 0;
-    int lastLineVisibleLines = 0;
-    for (FoldingRange *range : m_foldedFoldingRanges) {
-        // else compute visible lines and move last seen
-        lastLineVisibleLines = seenVisibleLines;
-        seenVisibleLines += (range->start->line() - lastLine);
-
-        // bail out if enough seen
-        if (seenVisibleLines >= visibleLine) {
-            break;
+    // the visible line of the start of each folded range is monotone increasing
+    // search the first folded range that doesn't start in front of our visible line
+    const std::vector<int> &hiddenLines = hiddenLinesBefore();
+    qsizetype first = 0;
+    qsizetype count = m_foldedFoldingRanges.size();
+    while (count > 0) {
+        const qsizetype step = count / 2;
+        const qsizetype it = first + step;
+        if (m_foldedFoldingRanges[it]->start->line() - hiddenLines[it] < visibleLine) {
+            first = it + 1;
+            count -= step + 1;
+        } else {
+            count = step;
         }
+    }
+
+    // all lines hidden in front of this range are skipped
+    const int line = visibleLine + hiddenLines[first];
+    Q_ASSERT(line >= 0);
+    return line;
+}
 
-        lastLine = range->end->line();
+const std::vector<int> &TextFolding::hiddenLinesBefore() const
+{
+    // hidden lines of a range only change with its lines, any edit might do that
+    if (m_hiddenLinesValid && m_hiddenLinesRevision == m_buffer.revision()) {
+        return m_hiddenLinesBefore;
     }
 
-    // check if still no enough visible!
-    if (seenVisibleLines < visibleLine) {
-        lastLineVisibleLines = seenVisibleLines;
+    m_hiddenLinesBefore.resize(m_foldedFoldingRanges.size() + 1);
+    int hiddenLines = 0;
+    for (qsizetype i = 0; i < m_foldedFoldingRanges.size(); ++i) {
+        m_hiddenLinesBefore[i] = hiddenLines;
+        const FoldingRange *range = m_foldedFoldingRanges[i];
+        hiddenLines += range->end->line() - range->start->line();
     }
+    m_hiddenLinesBefore.back() = hiddenLines;
 
-    // compute visible line
-    line = (lastLine + (visibleLine - lastLineVisibleLines));
-    Q_ASSERT(line >= 0);
-    return line;
+    m_hiddenLinesRevision = m_buffer.revision();
+    m_hiddenLinesValid = true;
+    return m_hiddenLinesBefore;
 }
 
 QList<TextFolding::IdAndFlag> TextFolding::foldingRangesStartingOnLine(int line) const
@@ -459,6 +460,7 @@ void TextFolding::editEnd(int startLine, int endLine, std::function<bool(int)> i
         m_idToFoldingRange.remove((*foldIt)->id);
         delete *foldIt;
         foldIt = m_foldedFoldingRanges.erase(foldIt);
+        invalidateHiddenLines();
         anyUpdate = true;
     }
 
@@ -652,6 +654,7 @@ bool TextFolding::updateFoldedRangesForNewRange(TextFolding::FoldingRange *newRa
 
     // fixup folded ranges
     m_foldedFoldingRanges = newFoldedFoldingRanges;
+    invalidateHiddenLines();
 
     // folding changed!
     Q_EMIT foldingRangesChanged();
@@ -696,6 +699,7 @@ bool TextFolding::updateFoldedRangesForRemovedRange(TextFolding::FoldingRange *o
 
     // fixup folded ranges
     m_foldedFoldingRanges = newFoldedFoldingRanges;
+    invalidateHiddenLines();
 
     // folding changed!
     Q_EMIT foldingRangesChanged();
@@ -17,6 +17,7 @@
 #include <QObject>
 
 #include <functional>
+#include <vector>
 
 namespace Kate
 {
@@ -115,15 +116,15 @@ public:
 
     /**
      * Query number of visible lines.
-     * Very fast, if nothing is folded, else walks over all folded regions
-     * O(n) for n == number of folded ranges
+     * Very fast, if nothing is folded, else O(1) with up-to-date hidden line counts.
+     * After folding changes or buffer edits these are recomputed once, O(n) for n == number of folded ranges.
      */
     int visibleLines() const;
 
     /**
      * Convert a text buffer line to a visible line number.
-     * Very fast, if nothing is folded, else walks over all folded regions
-     * O(n) for n == number of folded ranges
+     * Very fast, if nothing is folded, else binary search over the folded regions
+     * O(log n) for n == number of folded ranges, see visibleLines() for the update costs
      * @param line line index in the text buffer
      * @return index in visible lines
      */
@@ -131,8 +132,8 @@ public:
 
     /**
      * Convert a visible line number to a line number in the text buffer.
-     * Very fast, if nothing is folded, else walks over all folded regions
-     * O(n) for n == number of folded ranges
+     * Very fast, if nothing is folded, else binary search over the folded regions
+     * O(log n) for n == number of folded ranges, see visibleLines() for the update costs
      * @param visibleLine visible line index
      * @return index in text buffer lines
      */
@@ -321,6 +322,23 @@ private:
     KTEXTEDITOR_NO_EXPORT
     void appendFoldedRanges(TextFolding::FoldingRange::Vector &newFoldedFoldingRanges, const TextFolding::FoldingRange::Vector &ranges) const;
 
+    /**
+     * Get the number of hidden lines in front of each folded range.
+     * Recomputed if the folded ranges or the buffer changed since the last call.
+     * @return prefix sums of hidden lines, one element more than m_foldedFoldingRanges, last one is the total
+     */
+    KTEXTEDITOR_NO_EXPORT
+    const std::vector<int> &hiddenLinesBefore() const;
+
+    /**
+     * Mark the hidden line counts as outdated, must be called on any change of m_foldedFoldingRanges.
+     */
+    KTEXTEDITOR_NO_EXPORT
+    void invalidateHiddenLines()
+    {
+        m_hiddenLinesValid = false;
+    }
+
     /**
      * Compare two ranges by their start cursor.
      * @param a first range
@@ -385,6 +403,23 @@ private:
      */
     FoldingRange::Vector m_foldedFoldingRanges;
 
+    /**
+     * prefix sums of hidden lines for the folded ranges, see hiddenLinesBefore()
+     * the hidden lines of a range only change if lines are inserted or removed inside of it,
+     * therefore the cache stays valid while scrolling and is recomputed once per buffer revision
+     */
+    mutable std::vector<int> m_hiddenLinesBefore;
+
+    /**
+     * buffer revision m_hiddenLinesBefore was computed for
+     */
+    mutable qint64 m_hiddenLinesRevision = -1;
+
+    /**
+     * are m_hiddenLinesBefore up-to-date with m_foldedFoldingRanges?
+     */
+    mutable bool m_hiddenLinesValid = false;
+
     /**
      * global id counter for the created ranges
      */
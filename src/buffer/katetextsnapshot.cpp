@@ -0,0 +1,112 @@
+/*
+    SPDX-FileCopyrightText: KDE Developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "katetextsnapshot.h"
+
+#include <algorithm>
+
+namespace KTextEditor
+{
+const Kate::TextLine *TextSnapshotPrivate::line(int line) const
+{
+    if (line < 0 || line >= lines) {
+        return nullptr;
+    }
+
+    // last block starting in front of or at the line
+    const auto it = std::upper_bound(startLines.cbegin(), startLines.cend(), line);
+    Q_ASSERT(it != startLines.cbegin());
+    const size_t blockIndex = (it - startLines.cbegin()) - 1;
+    return &blocks[blockIndex]->at(line - startLines[blockIndex]);
+}
+
+TextSnapshot::TextSnapshot() = default;
+
+TextSnapshot::TextSnapshot(std::shared_ptr<const TextSnapshotPrivate> d)
+    : d(std::move(d))
+{
+}
+
+TextSnapshot::~TextSnapshot() = default;
+TextSnapshot::TextSnapshot(const TextSnapshot &) = default;
+TextSnapshot::TextSnapshot(TextSnapshot &&) noexcept = default;
+TextSnapshot &TextSnapshot::operator=(const TextSnapshot &) = default;
+TextSnapshot &TextSnapshot::operator=(TextSnapshot &&) noexcept = default;
+
+bool TextSnapshot::isValid() const
+{
+    return bool(d);
+}
+
+qint64 TextSnapshot::revision() const
+{
+    return d ? d->revision : -1;
+}
+
+int TextSnapshot::lines() const
+{
+    return d ? d->lines : 0;
+}
+
+int TextSnapshot::lineLength(int line) const
+{
+    const Kate::TextLine *textLine = d ? d->line(line) : nullptr;
+    return textLine ? textLine->length() : -1;
+}
+
+QString TextSnapshot::line(int line) const
+{
+    const Kate::TextLine *textLine = d ? d->line(line) : nullptr;
+    return textLine ? textLine->text() : QString();
+}
+
+QString TextSnapshot::text() const
+{
+    if (!d) {
+        return QString();
+    }
+
+    QString text;
+    for (const auto &block : d->blocks) {
+        for (const Kate::TextLine &textLine : *block) {
+            text.append(textLine.text());
+            text.append(QLatin1Char('\n'));
+        }
+    }
+
+    // no newline behind the last line
+    text.chop(1);
+    return text;
+}
+
+QString TextSnapshot::text(KTextEditor::Range range) const
+{
+    if (!d || !range.isValid()) {
+        return QString();
+    }
+
+    QString text;
+    const int endLine = std::min(range.end().line(), d->lines - 1);
+    for (int line = range.start().line(); line <= endLine; ++line) {
+        const Kate::TextLine *textLine = d->line(line);
+        const int start = (line == range.start().line()) ? range.start().column() : 0;
+        const int end = (line == range.end().line()) ? range.end().column() : textLine->length();
+        text.append(textLine->string(start, end - start));
+        if (line < range.end().line()) {
+            text.append(QLatin1Char('\n'));
+        }
+    }
+    return text;
+}
+
+KTextEditor::Cursor TextSnapshot::documentEnd() const
+{
+    if (!d) {
+        return KTextEditor::Cursor::invalid();
+    }
+    return KTextEditor::Cursor(d->lines - 1, lineLength(d->lines - 1));
+}
+}
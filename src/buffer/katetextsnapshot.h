@@ -0,0 +1,56 @@
+/*
+    SPDX-FileCopyrightText: KDE Developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef KATE_TEXTSNAPSHOT_H
+#define KATE_TEXTSNAPSHOT_H
+
+#include "katetextline.h"
+
+#include <ktexteditor/textsnapshot.h>
+
+#include <memory>
+#include <vector>
+
+namespace KTextEditor
+{
+/**
+ * Data of a TextSnapshot, the lines of all blocks of a Kate::TextBuffer at one revision.
+ * The line vectors are shared with the blocks, see Kate::TextBlock::sharedLines().
+ */
+class TextSnapshotPrivate
+{
+public:
+    /**
+     * Wrap the data into a snapshot.
+     */
+    static TextSnapshot create(std::shared_ptr<const TextSnapshotPrivate> d)
+    {
+        return TextSnapshot(std::move(d));
+    }
+
+    /**
+     * Line of the snapshot.
+     * @param line wanted line number
+     * @return text line, nullptr if there is no such line
+     */
+    const Kate::TextLine *line(int line) const;
+
+    qint64 revision = -1;
+    int lines = 0;
+
+    /**
+     * start line of each block
+     */
+    std::vector<int> startLines;
+
+    /**
+     * lines of each block
+     */
+    std::vector<std::shared_ptr<const std::vector<Kate::TextLine>>> blocks;
+};
+}
+
+#endif
@@ -346,6 +346,8 @@ void KateSpellCheckConfigTab::apply()
     KateDocumentConfig::global()->setOnTheFlySpellCheck(settings.value(QStringLiteral("checkerEnabledByDefault"), false).toBool());
     KateDocumentConfig::global()->configEnd();
 
+    // e.g. the ignored words changed, check everything again
+    KTextEditor::EditorPrivate::self()->spellCheckManager()->reloadSettings();
     const auto docs = KTextEditor::EditorPrivate::self()->documents();
     for (KTextEditor::Document *doc : docs) {
         static_cast<KTextEditor::DocumentPrivate *>(doc)->refreshOnTheFlyCheck();
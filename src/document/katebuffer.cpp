@@ -18,12 +18,28 @@
 #include <KEncodingProber>
 #include <KLocalizedString>
 
+#include <QDataStream>
 #include <QDate>
+#include <QDir>
 #include <QFile>
 #include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
 #include <QStringEncoder>
 #include <QTextStream>
 
+// layout of the on-disk highlighting cache, bump the version on incompatible changes
+static constexpr quint32 highlightingCacheMagic = 0x4B544843; // KTHC
+static constexpr quint32 highlightingCacheVersion = 1;
+
+// oldest entries beyond this are removed
+static constexpr qsizetype highlightingCacheMaximalEntries = 128;
+
+static QString highlightingCacheDirectory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + QStringLiteral("/ktexteditor/highlighting/");
+}
+
 /**
  * Create an empty buffer. (with one block with one empty line)
  */
@@ -73,6 +89,9 @@ void KateBuffer::editEnd()
 
 void KateBuffer::updateHighlighting()
 {
+    // restored lines behind the edit might no longer match the highlighting state
+    m_lineRestored = restoredLines();
+
     // no highlighting, nothing to do
     if (!m_highlight) {
         return;
@@ -100,6 +119,7 @@ void KateBuffer::clear()
 
     // back to line 0 with hl
     m_lineHighlighted = 0;
+    m_lineRestored = 0;
 }
 
 bool KateBuffer::openFile(const QString &m_file, bool enforceTextCodec)
@@ -237,6 +257,16 @@ bool KateBuffer::saveFile(const QString &m_file)
 }
 
 void KateBuffer::ensureHighlighted(int line, int lookAhead)
+{
+    // restored from the highlighting cache? the state is only needed once we really highlight behind it
+    if (line < restoredLines()) {
+        return;
+    }
+
+    highlightUntil(line, lookAhead);
+}
+
+void KateBuffer::highlightUntil(int line, int lookAhead)
 {
     // valid line at all?
     if (line < 0 || line >= lines()) {
@@ -318,6 +348,143 @@ void KateBuffer::setHighlight(int hlMode)
 void KateBuffer::invalidateHighlighting()
 {
     m_lineHighlighted = 0;
+    m_lineRestored = 0;
+}
+
+int KateBuffer::restoredLines() const
+{
+    // lines from the first edit of a running transaction on might be outdated
+    const int minimalLineChanged = editingMinimalLineChanged();
+    return (minimalLineChanged == -1) ? m_lineRestored : qMin(m_lineRestored, minimalLineChanged);
+}
+
+bool KateBuffer::canUseHighlightingCache() const
+{
+    // indentation based folding needs the highlighting state, that can't be stored
+    return KateGlobalConfig::global()->highlightingCache() && m_highlight && !m_highlight->noHighlighting() && !m_highlight->foldingIndentationSensitive()
+        && !digest().isEmpty() && !m_brokenEncoding && !m_tooLongLinesWrapped;
+}
+
+void KateBuffer::saveHighlightingCache()
+{
+    // only the highlighting of the file on disk can be reused
+    if (!canUseHighlightingCache() || m_doc->isModified()) {
+        return;
+    }
+
+    // nothing new compared to the restored lines?
+    const int validLines = qMin(qMax(m_lineHighlighted, restoredLines()), lines());
+    if (validLines <= m_lineRestored) {
+        return;
+    }
+
+    QByteArray lineData;
+    {
+        QDataStream stream(&lineData, QIODevice::WriteOnly);
+        stream.setVersion(QDataStream::Qt_6_0);
+        for (int line = 0; line < validLines; ++line) {
+            const Kate::TextLine textLine = plainLine(line);
+            const quint8 foldingMarkers = (textLine.markedAsFoldingStartAttribute() ? 1 : 0) | (textLine.markedAsFoldingEndAttribute() ? 2 : 0);
+            stream << foldingMarkers << qint32(textLine.attributesList().size());
+            for (const Kate::TextLine::Attribute &attribute : textLine.attributesList()) {
+                stream << qint32(attribute.offset) << qint32(attribute.length) << qint32(attribute.attributeValue);
+            }
+        }
+    }
+
+    const QString directory = highlightingCacheDirectory();
+    if (!QDir().mkpath(directory)) {
+        return;
+    }
+
+    QSaveFile file(directory + QString::fromLatin1(digest().toHex()));
+    if (!file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+    stream << highlightingCacheMagic << highlightingCacheVersion << m_highlight->cacheKey() << qint32(lines()) << qint32(validLines) << qCompress(lineData);
+    if (!file.commit()) {
+        return;
+    }
+
+    // drop the oldest entries, newest are first
+    const QFileInfoList entries = QDir(directory).entryInfoList(QDir::Files, QDir::Time);
+    for (qsizetype i = highlightingCacheMaximalEntries; i < entries.size(); ++i) {
+        QFile::remove(entries.at(i).absoluteFilePath());
+    }
+}
+
+bool KateBuffer::restoreHighlightingCache()
+{
+    m_lineRestored = 0;
+    if (!canUseHighlightingCache()) {
+        return false;
+    }
+
+    QFile file(highlightingCacheDirectory() + QString::fromLatin1(digest().toHex()));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0;
+    quint32 version = 0;
+    stream >> magic >> version;
+    if (magic != highlightingCacheMagic || version != highlightingCacheVersion) {
+        return false;
+    }
+
+    QString cacheKey;
+    qint32 lineCount = 0;
+    qint32 validLines = 0;
+    QByteArray compressedLineData;
+    stream >> cacheKey >> lineCount >> validLines >> compressedLineData;
+    if (stream.status() != QDataStream::Ok || cacheKey != m_highlight->cacheKey() || lineCount != lines() || validLines > lines()
+        || validLines <= m_lineHighlighted) {
+        return false;
+    }
+
+    // read all lines first, a broken entry must not leave half restored lines behind
+    const QByteArray lineData = qUncompress(compressedLineData);
+    QDataStream lineStream(lineData);
+    lineStream.setVersion(QDataStream::Qt_6_0);
+    std::vector<Kate::TextLine> restored(validLines);
+    for (int line = 0; line < validLines; ++line) {
+        quint8 foldingMarkers = 0;
+        qint32 attributeCount = 0;
+        lineStream >> foldingMarkers >> attributeCount;
+        if (lineStream.status() != QDataStream::Ok || attributeCount < 0) {
+            return false;
+        }
+
+        Kate::TextLine &textLine = restored[line];
+        const int length = lineLength(line);
+        for (qint32 i = 0; i < attributeCount; ++i) {
+            qint32 offset = 0;
+            qint32 attributeLength = 0;
+            qint32 attributeValue = 0;
+            lineStream >> offset >> attributeLength >> attributeValue;
+            if (lineStream.status() != QDataStream::Ok || offset < 0 || attributeLength < 0 || offset + attributeLength > length) {
+                return false;
+            }
+            textLine.addAttribute(Kate::TextLine::Attribute(offset, attributeLength, attributeValue));
+        }
+        if (foldingMarkers & 1) {
+            textLine.markAsFoldingStartAttribute();
+        }
+        if (foldingMarkers & 2) {
+            textLine.markAsFoldingEndAttribute();
+        }
+    }
+
+    // the lines already highlighted for real stay untouched
+    for (int line = m_lineHighlighted; line < validLines; ++line) {
+        setLineMetaData(line, restored[line]);
+    }
+    m_lineRestored = validLines;
+    Q_EMIT tagLines({m_lineHighlighted, validLines});
+    return true;
 }
 
 void KateBuffer::doHighlight(int startLine, int endLine, bool invalidate)
@@ -327,6 +494,8 @@ void KateBuffer::doHighlight(int startLine, int endLine, bool invalidate)
         return;
     }
 
+    KATE_PERF_SCOPE(m_doc->perfCounters(), "highlight");
+
 #ifdef BUFFER_DEBUGGING
     QTime t;
     t.start();
@@ -375,6 +544,8 @@ void KateBuffer::doHighlight(int startLine, int endLine, bool invalidate)
         }
     }
 
+    KATE_PERF_COUNT(m_doc->perfCounters(), "highlighted lines", current_line - startLine);
+
     // perhaps we need to adjust the maximal highlighted line
     int oldHighlighted = m_lineHighlighted;
     if (ctxChanged || current_line > m_lineHighlighted) {
@@ -411,9 +582,9 @@ KateHighlighting::Foldings KateBuffer::computeFoldings(int line)
         return foldings;
     }
 
-    // ensure we did highlight at least until the previous line
+    // ensure we did highlight at least until the previous line, the foldings need its state
     if (line > 0) {
-        ensureHighlighted(line - 1, 0);
+        highlightUntil(line - 1, 0);
     }
 
     // highlight the given line with passed foldings vector to fill
@@ -175,13 +175,45 @@ public:
 
     /**
      * Update highlighting of given line @p line, if needed.
-     * If @p line is already highlighted, this function does nothing.
+     * If @p line is already highlighted or restored from the highlighting cache,
+     * this function does nothing.
      * If @p line is not highlighted, all lines up to line + lookAhead
      * are highlighted.
      * @param lookAhead also highlight these following lines
      */
     void ensureHighlighted(int line, int lookAhead = 64);
 
+    /**
+     * Number of lines at the start of the buffer with up-to-date highlighting.
+     * @return all lines in front of this one are highlighted
+     */
+    int highlightedLines() const
+    {
+        return m_lineHighlighted;
+    }
+
+    /**
+     * Number of lines at the start of the buffer with attributes and folding markers
+     * restored from the highlighting cache. Restored lines behind highlightedLines()
+     * have no highlighting state, they are highlighted for real once that is needed.
+     * @return all lines in front of this one have valid attributes
+     */
+    int restoredLines() const;
+
+    /**
+     * Store the attributes and folding markers of the highlighted lines in the on-disk
+     * highlighting cache, keyed by the digest of the file and the highlighting.
+     * Does nothing if the cache is disabled or the buffer differs from the file.
+     */
+    void saveHighlightingCache();
+
+    /**
+     * Restore the attributes and folding markers from the on-disk highlighting cache,
+     * if it has an entry for the loaded file and the current highlighting.
+     * @return true if any lines were restored
+     */
+    bool restoreHighlightingCache();
+
     /**
      * Unwrap given line.
      * @param line line to unwrap
@@ -257,6 +289,19 @@ private:
     KTEXTEDITOR_NO_EXPORT
     void doHighlight(int from, int to, bool invalidate);
 
+    /**
+     * Highlight all lines up to @p line + @p lookAhead for real,
+     * unlike ensureHighlighted() this ignores the restored lines.
+     */
+    KTEXTEDITOR_NO_EXPORT
+    void highlightUntil(int line, int lookAhead);
+
+    /**
+     * Is the on-disk highlighting cache usable for the current file and highlighting?
+     */
+    KTEXTEDITOR_NO_EXPORT
+    bool canUseHighlightingCache() const;
+
 Q_SIGNALS:
     /**
      * Emitted when the highlighting of a certain range has
@@ -298,6 +343,11 @@ private:
      * last line with valid highlighting
      */
     int m_lineHighlighted;
+
+    /**
+     * end of the lines restored from the highlighting cache, see restoredLines()
+     */
+    int m_lineRestored = 0;
 };
 
 #endif
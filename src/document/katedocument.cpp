@@ -286,6 +286,9 @@ KTextEditor::DocumentPrivate::~DocumentPrivate()
     delete m_onTheFlyChecker;
     m_onTheFlyChecker = nullptr;
 
+    // remember the highlighting for the next time this file is opened
+    m_buffer->saveHighlightingCache();
+
     clearDictionaryRanges();
 
     // Tell the world that we're about to close (== destruct)
@@ -305,10 +308,9 @@ KTextEditor::DocumentPrivate::~DocumentPrivate()
     m_views.clear();
 
     // clean up marks
-    for (auto &mark : std::as_const(m_marks)) {
+    for (KTextEditor::Mark *mark : m_marks.takeAll()) {
         delete mark;
     }
-    m_marks.clear();
 
     // de-register document early from global collections
     // otherwise we might "use" them again during destruction in a half-valid state
@@ -403,6 +405,9 @@ QWidget *KTextEditor::DocumentPrivate::widget()
 
 KTextEditor::View *KTextEditor::DocumentPrivate::createView(QWidget *parent, KTextEditor::MainWindow *mainWindow)
 {
+    // a view wants to paint the content right away
+    ensureLoaded();
+
     KTextEditor::ViewPrivate *newView = new KTextEditor::ViewPrivate(this, parent, mainWindow);
 
     if (m_fileChangedDialogsActivated) {
@@ -438,11 +443,14 @@ bool KTextEditor::DocumentPrivate::isEditingTransactionRunning() const
 
 QString KTextEditor::DocumentPrivate::text() const
 {
+    ensureLoaded();
     return m_buffer->text();
 }
 
 QString KTextEditor::DocumentPrivate::text(KTextEditor::Range range, bool blockwise) const
 {
+    ensureLoaded();
+
     if (!range.isValid()) {
         qCWarning(LOG_KTE) << "Text requested for invalid range" << range;
         return QString();
@@ -484,6 +492,7 @@ QString KTextEditor::DocumentPrivate::text(KTextEditor::Range range, bool blockw
 
 QChar KTextEditor::DocumentPrivate::characterAt(KTextEditor::Cursor position) const
 {
+    ensureLoaded();
     Kate::TextLine textLine = m_buffer->plainLine(position.line());
     return textLine.at(position.column());
 }
@@ -542,6 +551,8 @@ bool KTextEditor::DocumentPrivate::isValidTextPosition(KTextEditor::Cursor curso
 
 QStringList KTextEditor::DocumentPrivate::textLines(KTextEditor::Range range, bool blockwise) const
 {
+    ensureLoaded();
+
     QStringList ret;
 
     if (!range.isValid()) {
@@ -581,6 +592,7 @@ QStringList KTextEditor::DocumentPrivate::textLines(KTextEditor::Range range, bo
 
 QString KTextEditor::DocumentPrivate::line(int line) const
 {
+    ensureLoaded();
     Kate::TextLine l = m_buffer->plainLine(line);
     return l.text();
 }
@@ -592,8 +604,9 @@ bool KTextEditor::DocumentPrivate::setText(const QString &s)
     }
 
     std::vector<KTextEditor::Mark> msave;
-    msave.reserve(m_marks.size());
-    std::transform(m_marks.cbegin(), m_marks.cend(), std::back_inserter(msave), [](KTextEditor::Mark *mark) {
+    const auto marks = m_marks.marks();
+    msave.reserve(marks.size());
+    std::transform(marks.cbegin(), marks.cend(), std::back_inserter(msave), [](KTextEditor::Mark *mark) {
         return *mark;
     });
 
@@ -629,8 +642,9 @@ bool KTextEditor::DocumentPrivate::setText(const QStringList &text)
     }
 
     std::vector<KTextEditor::Mark> msave;
-    msave.reserve(m_marks.size());
-    std::transform(m_marks.cbegin(), m_marks.cend(), std::back_inserter(msave), [](KTextEditor::Mark *mark) {
+    const auto marks = m_marks.marks();
+    msave.reserve(marks.size());
+    std::transform(marks.cbegin(), marks.cend(), std::back_inserter(msave), [](KTextEditor::Mark *mark) {
         return *mark;
     });
 
@@ -908,6 +922,7 @@ bool KTextEditor::DocumentPrivate::removeLine(int line)
 
 qsizetype KTextEditor::DocumentPrivate::totalCharacters() const
 {
+    ensureLoaded();
     qsizetype l = 0;
     for (int i = 0; i < m_buffer->lines(); ++i) {
         l += m_buffer->lineLength(i);
@@ -917,21 +932,25 @@ qsizetype KTextEditor::DocumentPrivate::totalCharacters() const
 
 int KTextEditor::DocumentPrivate::lines() const
 {
+    ensureLoaded();
     return m_buffer->lines();
 }
 
 int KTextEditor::DocumentPrivate::lineLength(int line) const
 {
+    ensureLoaded();
     return m_buffer->lineLength(line);
 }
 
 qsizetype KTextEditor::DocumentPrivate::cursorToOffset(KTextEditor::Cursor c) const
 {
+    ensureLoaded();
     return m_buffer->cursorToOffset(c);
 }
 
 KTextEditor::Cursor KTextEditor::DocumentPrivate::offsetToCursor(qsizetype offset) const
 {
+    ensureLoaded();
     return m_buffer->offsetToCursor(offset);
 }
 
@@ -972,6 +991,8 @@ bool KTextEditor::DocumentPrivate::isLineTouched(int line) const
 //
 bool KTextEditor::DocumentPrivate::editStart()
 {
+    ensureLoaded();
+
     editSessionNumber++;
 
     if (editSessionNumber > 1) {
@@ -1355,6 +1376,73 @@ bool KTextEditor::DocumentPrivate::editRemoveText(int line, int col, int len)
     return true;
 }
 
+bool KTextEditor::DocumentPrivate::editReplaceText(std::vector<Kate::LineReplacement> replacements)
+{
+    // verbose debug
+    EDIT_DEBUG << "editReplaceText" << replacements.size();
+
+    if (!isReadWrite()) {
+        return false;
+    }
+
+    // drop invalid replacements and the ones that would change nothing, clamp lengths like editRemoveText does
+    std::erase_if(replacements, [this](Kate::LineReplacement &replacement) {
+        if (replacement.line < 0 || replacement.line >= lines() || replacement.column < 0 || replacement.length < 0) {
+            return true;
+        }
+        const int length = lineLength(replacement.line);
+        if (replacement.column > length) {
+            return true;
+        }
+        replacement.length = qMin(replacement.length, length - replacement.column);
+        return replacement.length == 0 && replacement.text.isEmpty();
+    });
+
+    // the buffer wants them sorted and without overlaps, insertions at the same position keep their order
+    std::stable_sort(replacements.begin(), replacements.end(), [](const Kate::LineReplacement &a, const Kate::LineReplacement &b) {
+        return a.line < b.line || (a.line == b.line && a.column < b.column);
+    });
+    for (size_t i = 1; i < replacements.size(); ++i) {
+        const auto &previous = replacements[i - 1];
+        if (previous.line == replacements[i].line && previous.column + previous.length > replacements[i].column) {
+            qCWarning(LOG_KTE) << "editReplaceText: skipping overlapping replacement at" << replacements[i].line << replacements[i].column;
+            replacements.erase(replacements.begin() + i);
+            --i;
+        }
+    }
+
+    // nothing to do, do nothing!
+    if (replacements.empty()) {
+        return true;
+    }
+
+    editStart();
+
+    // the whole batch is one undo item
+    m_undoManager->slotTextReplaced(replacements);
+
+    // remember last change cursor
+    m_editLastChangeStartCursor = KTextEditor::Cursor(replacements.front().line, replacements.front().column);
+
+    // replace text in all lines in one go
+    const std::vector<Kate::LineChange> lineChanges = m_buffer->replaceText(replacements);
+
+    // one notification per line, the lines are independent of each other
+    for (const Kate::LineChange &change : lineChanges) {
+        if (!change.removedText.isEmpty()) {
+            Q_EMIT textRemoved(this,
+                               KTextEditor::Range(change.line, change.column, change.line, change.column + change.removedText.size()),
+                               change.removedText);
+        }
+        if (!change.insertedText.isEmpty()) {
+            Q_EMIT textInsertedRange(this, KTextEditor::Range(change.line, change.column, change.line, change.column + change.insertedText.size()));
+        }
+    }
+
+    editEnd();
+    return true;
+}
+
 bool KTextEditor::DocumentPrivate::editMarkLineAutoWrapped(int line, bool autowrapped)
 {
     // verbose debug
@@ -1405,25 +1493,8 @@ bool KTextEditor::DocumentPrivate::editWrapLine(int line, int col, bool newLine,
     if (!nextLineValid || newLine) {
         m_buffer->wrapLine(KTextEditor::Cursor(line, col));
 
-        QVarLengthArray<KTextEditor::Mark *, 8> list;
-        for (const auto &mark : std::as_const(m_marks)) {
-            if (mark->line >= line) {
-                if ((col == 0) || (mark->line > line)) {
-                    list.push_back(mark);
-                }
-            }
-        }
-
-        for (const auto &mark : list) {
-            m_marks.take(mark->line);
-        }
-
-        for (const auto &mark : list) {
-            mark->line++;
-            m_marks.insert(mark->line, mark);
-        }
-
-        if (!list.empty()) {
+        // the mark of the wrapped line only moves along if the whole line moves
+        if (m_marks.shiftLines((col == 0) ? line : line + 1, 1)) {
             Q_EMIT marksChanged(this);
         }
 
@@ -1481,31 +1552,20 @@ bool KTextEditor::DocumentPrivate::editUnWrapLine(int line, bool removeLine, int
         m_buffer->unwrapLine(line + 1);
     }
 
-    QVarLengthArray<KTextEditor::Mark *, 8> list;
-    for (const auto &mark : std::as_const(m_marks)) {
-        if (mark->line >= line + 1) {
-            list.push_back(mark);
-        }
-
-        if (mark->line == line + 1) {
-            auto m = m_marks.take(line);
-            if (m) {
-                mark->type |= m->type;
-                delete m;
-            }
+    // the mark of the unwrapped line takes over the mark of the line it is appended to
+    bool marksMoved = false;
+    if (auto mark = m_marks.take(line + 1)) {
+        if (auto m = m_marks.take(line)) {
+            mark->type |= m->type;
+            delete m;
         }
+        mark->line = line;
+        m_marks.insert(mark);
+        marksMoved = true;
     }
+    marksMoved = m_marks.shiftLines(line + 2, -1) || marksMoved;
 
-    for (const auto &mark : list) {
-        m_marks.take(mark->line);
-    }
-
-    for (const auto &mark : list) {
-        mark->line--;
-        m_marks.insert(mark->line, mark);
-    }
-
-    if (!list.isEmpty()) {
+    if (marksMoved) {
         Q_EMIT marksChanged(this);
     }
 
@@ -1551,23 +1611,7 @@ bool KTextEditor::DocumentPrivate::editInsertLine(int line, const QString &s, bo
     // insert text
     m_buffer->insertText(KTextEditor::Cursor(line, 0), s);
 
-    QVarLengthArray<KTextEditor::Mark *, 8> list;
-    for (const auto &mark : std::as_const(m_marks)) {
-        if (mark->line >= line) {
-            list.push_back(mark);
-        }
-    }
-
-    for (const auto &mark : list) {
-        m_marks.take(mark->line);
-    }
-
-    for (const auto &mark : list) {
-        mark->line++;
-        m_marks.insert(mark->line, mark);
-    }
-
-    if (!list.isEmpty()) {
+    if (m_marks.shiftLines(line, 1)) {
         Q_EMIT marksChanged(this);
     }
 
@@ -1636,32 +1680,11 @@ bool KTextEditor::DocumentPrivate::editRemoveLines(int from, int to)
         }
     }
 
-    QVarLengthArray<int, 8> rmark;
-    QVarLengthArray<KTextEditor::Mark *, 8> list;
-
-    for (KTextEditor::Mark *mark : std::as_const(m_marks)) {
-        int line = mark->line;
-        if (line > to) {
-            list << mark;
-        } else if (line >= from) {
-            rmark << line;
-        }
-    }
-
-    for (int line : rmark) {
-        delete m_marks.take(line);
-    }
-
-    for (auto mark : list) {
-        m_marks.take(mark->line);
-    }
-
-    for (auto mark : list) {
-        mark->line -= to - from + 1;
-        m_marks.insert(mark->line, mark);
+    for (KTextEditor::Mark *mark : m_marks.takeLines(from, to)) {
+        delete mark;
     }
 
-    if (!list.isEmpty()) {
+    if (m_marks.shiftLines(to + 1, -(to - from + 1))) {
         Q_EMIT marksChanged(this);
     }
 
@@ -1728,6 +1751,8 @@ void KTextEditor::DocumentPrivate::redo()
 QList<KTextEditor::Range>
 KTextEditor::DocumentPrivate::searchText(KTextEditor::Range range, const QString &pattern, const KTextEditor::SearchOptions options) const
 {
+    KATE_PERF_SCOPE(m_perfCounters, "search");
+
     const bool escapeSequences = options.testFlag(KTextEditor::EscapeSequences);
     const bool regexMode = options.testFlag(KTextEditor::Regex);
     const bool backwards = options.testFlag(KTextEditor::Backwards);
@@ -1763,6 +1788,12 @@ KTextEditor::DocumentPrivate::searchText(KTextEditor::Range range, const QString
     result.append(match);
     return result;
 }
+
+QList<KTextEditor::Range> KTextEditor::DocumentPrivate::searchText(KTextEditor::Range range, const KateRegExpSearchPattern &pattern, bool backwards) const
+{
+    KATE_PERF_SCOPE(m_perfCounters, "search");
+    return KateRegExpSearch(this).search(pattern, range, backwards);
+}
 // END
 
 QWidget *KTextEditor::DocumentPrivate::dialogParent()
@@ -1947,9 +1978,13 @@ void KTextEditor::DocumentPrivate::readSessionConfig(const KConfigGroup &kconfig
         // restore the url
         QUrl url(kconfig.readEntry("URL"));
 
-        // open the file if url valid
+        // open the file if url valid, local files are only read once needed
         if (!url.isEmpty() && url.isValid()) {
-            openUrl(url);
+            if (url.isLocalFile() && m_views.isEmpty() && !flags.contains(QStringLiteral("SkipLazyLoad"))) {
+                deferLoad(url);
+            } else {
+                openUrl(url);
+            }
         } else {
             completed(); // perhaps this should be emitted at the end of this function
         }
@@ -1960,6 +1995,9 @@ void KTextEditor::DocumentPrivate::readSessionConfig(const KConfigGroup &kconfig
     // restore if set by user, too!
     if (!flags.contains(QStringLiteral("SkipMode")) && kconfig.hasKey("Mode Set By User")) {
         updateFileType(kconfig.readEntry("Mode"), true /* set by user */);
+        if (m_deferredLoad) {
+            m_deferredLoad->mode = m_fileType;
+        }
     }
 
     if (!flags.contains(QStringLiteral("SkipHighlighting"))) {
@@ -1970,6 +2008,9 @@ void KTextEditor::DocumentPrivate::readSessionConfig(const KConfigGroup &kconfig
             if (mode >= 0) {
                 // restore if set by user, too! see bug 332605, otherwise we loose the hl later again on save
                 m_buffer->setHighlight(mode);
+                if (m_deferredLoad) {
+                    m_deferredLoad->highlighting = mode;
+                }
             }
         }
     }
@@ -1982,8 +2023,12 @@ void KTextEditor::DocumentPrivate::readSessionConfig(const KConfigGroup &kconfig
 
     // Restore Bookmarks
     const QList<int> marks = kconfig.readEntry("Bookmarks", QList<int>());
-    for (int i = 0; i < marks.count(); i++) {
-        addMark(marks.at(i), KTextEditor::DocumentPrivate::markType01);
+    if (m_deferredLoad) {
+        m_deferredLoad->bookmarks = marks;
+    } else {
+        for (int i = 0; i < marks.count(); i++) {
+            addMark(marks.at(i), KTextEditor::DocumentPrivate::markType01);
+        }
     }
 }
 
@@ -2031,22 +2076,64 @@ void KTextEditor::DocumentPrivate::writeSessionConfig(KConfigGroup &kconfig, con
 
     // Save Bookmarks
     QList<int> marks;
-    for (const auto &mark : std::as_const(m_marks)) {
+    for (KTextEditor::Mark *mark : m_marks.marks()) {
         if (mark->type & KTextEditor::Document::markType01) {
             marks.push_back(mark->line);
         }
     }
 
+    if (m_deferredLoad) {
+        marks = m_deferredLoad->bookmarks;
+    }
+
     if (!marks.isEmpty()) {
         kconfig.writeEntry("Bookmarks", marks);
     }
 }
 
+void KTextEditor::DocumentPrivate::deferLoad(const QUrl &url)
+{
+    if (!closeUrl()) {
+        return;
+    }
+
+    // url and mode are known without reading the file, the views show the right name and icon
+    m_deferredLoad = std::make_unique<DeferredLoad>();
+    m_deferredLoad->url = url;
+    setUrl(url);
+    updateFileType(KTextEditor::EditorPrivate::self()->modeManager()->fileType(this, url.toLocalFile()));
+
+    KTextEditor::EditorPrivate::self()->scheduleDeferredLoad(this);
+}
+
+void KTextEditor::DocumentPrivate::loadDeferred()
+{
+    // take the state first, anything called while opening must not load again
+    const std::unique_ptr<DeferredLoad> deferred = std::move(m_deferredLoad);
+    KTextEditor::EditorPrivate::self()->cancelDeferredLoad(this);
+
+    // for the outside this is no new file, like a reload no aboutToClose and no reset of the mode
+    m_reloading = true;
+    openUrl(deferred->url);
+    m_reloading = false;
+
+    if (!deferred->mode.isEmpty()) {
+        updateFileType(deferred->mode, true /* set by user */);
+    }
+    if (deferred->highlighting >= 0) {
+        m_buffer->setHighlight(deferred->highlighting);
+    }
+    for (int line : deferred->bookmarks) {
+        addMark(line, KTextEditor::DocumentPrivate::markType01);
+    }
+}
+
 // END KTextEditor::SessionConfigInterface and KTextEditor::ParameterizedSessionConfigInterface stuff
 
 uint KTextEditor::DocumentPrivate::mark(int line)
 {
-    KTextEditor::Mark *m = m_marks.value(line);
+    ensureLoaded();
+    KTextEditor::Mark *m = m_marks.mark(line);
     if (!m) {
         return 0;
     }
@@ -2087,7 +2174,7 @@ void KTextEditor::DocumentPrivate::addMark(int line, uint markType)
         return;
     }
 
-    if ((mark = m_marks.value(line))) {
+    if ((mark = m_marks.mark(line))) {
         // Remove bits already set
         markType &= ~mark->type;
 
@@ -2101,7 +2188,7 @@ void KTextEditor::DocumentPrivate::addMark(int line, uint markType)
         mark = new KTextEditor::Mark;
         mark->line = line;
         mark->type = markType;
-        m_marks.insert(line, mark);
+        m_marks.insert(mark);
     }
 
     // Emit with a mark having only the types added.
@@ -2121,11 +2208,10 @@ void KTextEditor::DocumentPrivate::removeMark(int line, uint markType)
         return;
     }
 
-    auto it = m_marks.find(line);
-    if (it == m_marks.end()) {
+    KTextEditor::Mark *mark = m_marks.mark(line);
+    if (!mark) {
         return;
     }
-    KTextEditor::Mark *mark = it.value();
 
     // Remove bits not set
     markType &= mark->type;
@@ -2144,7 +2230,7 @@ void KTextEditor::DocumentPrivate::removeMark(int line, uint markType)
     Q_EMIT markChanged(this, temp, MarkRemoved);
 
     if (mark->type == 0) {
-        m_marks.erase(it);
+        m_marks.take(line);
         delete mark;
     }
 
@@ -2155,12 +2241,13 @@ void KTextEditor::DocumentPrivate::removeMark(int line, uint markType)
 
 const QHash<int, KTextEditor::Mark *> &KTextEditor::DocumentPrivate::marks()
 {
-    return m_marks;
+    ensureLoaded();
+    return m_marks.hash();
 }
 
 void KTextEditor::DocumentPrivate::requestMarkTooltip(int line, QPoint position)
 {
-    KTextEditor::Mark *mark = m_marks.value(line);
+    KTextEditor::Mark *mark = m_marks.mark(line);
     if (!mark) {
         return;
     }
@@ -2172,7 +2259,7 @@ void KTextEditor::DocumentPrivate::requestMarkTooltip(int line, QPoint position)
 bool KTextEditor::DocumentPrivate::handleMarkClick(int line)
 {
     bool handled = false;
-    KTextEditor::Mark *mark = m_marks.value(line);
+    KTextEditor::Mark *mark = m_marks.mark(line);
     if (!mark) {
         Q_EMIT markClicked(this, KTextEditor::Mark{.line = line, .type = 0}, handled);
     } else {
@@ -2185,7 +2272,7 @@ bool KTextEditor::DocumentPrivate::handleMarkClick(int line)
 bool KTextEditor::DocumentPrivate::handleMarkContextMenu(int line, QPoint position)
 {
     bool handled = false;
-    KTextEditor::Mark *mark = m_marks.value(line);
+    KTextEditor::Mark *mark = m_marks.mark(line);
     if (!mark) {
         Q_EMIT markContextMenuRequested(this, KTextEditor::Mark{.line = line, .type = 0}, position, handled);
     } else {
@@ -2201,8 +2288,7 @@ void KTextEditor::DocumentPrivate::clearMarks()
      * work on a copy as deletions below might trigger the use
      * of m_marks
      */
-    const QHash<int, KTextEditor::Mark *> marksCopy = m_marks;
-    m_marks.clear();
+    const auto marksCopy = m_marks.takeAll();
 
     for (const auto &m : marksCopy) {
         Q_EMIT markChanged(this, *m, MarkRemoved);
@@ -2398,6 +2484,9 @@ bool KTextEditor::DocumentPrivate::openFile()
     //
     if (success) {
         readVariables();
+
+        // the highlighting is final now, reuse the cached one of this file if possible
+        m_buffer->restoreHighlightingCache();
     }
 
     //
@@ -2871,6 +2960,13 @@ bool KTextEditor::DocumentPrivate::closeUrl()
         return false;
     }
 
+    // a session file not loaded yet is just forgotten, before anyone reacting
+    // to aboutToClose() can trigger the load
+    if (m_deferredLoad) {
+        m_deferredLoad.reset();
+        KTextEditor::EditorPrivate::self()->cancelDeferredLoad(this);
+    }
+
     // Tell the world that we're about to go ahead with the close
     if (!m_reloading) {
         Q_EMIT aboutToClose(this);
@@ -2904,6 +3000,9 @@ bool KTextEditor::DocumentPrivate::closeUrl()
     // remove all marks
     clearMarks();
 
+    // remember the highlighting for the next time this file is opened
+    m_buffer->saveHighlightingCache();
+
     // clear the buffer
     m_buffer->clear();
 
@@ -3258,7 +3357,6 @@ void KTextEditor::DocumentPrivate::typeChars(KTextEditor::ViewPrivate *view, QSt
         // should only respond to main cursor text changes
         view->completionWidget()->setIgnoreBufferSignals(true);
         const auto &sc = view->secondaryCursors();
-        KTextEditor::Cursor lastInsertionCursor = KTextEditor::Cursor::invalid();
         const bool hasClosingBracket = !closingBracket.isNull();
         const QString closingChar = closingBracket;
 
@@ -3267,24 +3365,86 @@ void KTextEditor::DocumentPrivate::typeChars(KTextEditor::ViewPrivate *view, QSt
             KTextEditor::Cursor freezedPos;
         };
         std::vector<FreezedCursor> freezedCursors;
-        for (auto it = sc.begin(); it != sc.end(); ++it) {
-            auto pos = it->cursor();
-            if (it != sc.begin() && pos == std::prev(it)->cursor()) {
-                freezedCursors.push_back({std::prev(it)->pos.get(), std::prev(it)->cursor()});
+        if (!hasClosingBracket && !sc.empty() && !chars.contains(QLatin1Char('\n'))) {
+            // plain typing: insert the text at all secondary cursors in one batch, that is one pass over the buffer
+            // instead of one full insertText round trip per cursor
+            struct TypedCursor {
+                Kate::TextCursor *cursor;
+                KTextEditor::Cursor pos;
+            };
+            std::vector<TypedCursor> cursors;
+            cursors.reserve(sc.size());
+            for (const auto &c : sc) {
+                cursors.push_back({c.pos.get(), c.cursor()});
             }
+            std::stable_sort(cursors.begin(), cursors.end(), [](const TypedCursor &a, const TypedCursor &b) {
+                return a.pos < b.pos;
+            });
+
+            // the buffer moves cursors at the same position together, spread them as if the text was typed at one cursor after the other
+            // cursors behind the line end don't move with the text typed in front of them, like for insertText() the line is filled up to them
+            const int typedLength = chars.size();
+            std::vector<Kate::LineReplacement> replacements;
+            replacements.reserve(cursors.size());
+            std::vector<KTextEditor::Cursor> typedPositions;
+            typedPositions.reserve(cursors.size());
+            int line = -1;
+            int length = 0;
+            int insertedInLine = 0;
+            for (const TypedCursor &c : cursors) {
+                if (c.pos.line() != line) {
+                    line = c.pos.line();
+                    length = lineLength(line);
+                    insertedInLine = 0;
+                }
 
-            lastInsertionCursor = pos;
-            insertText(pos, chars);
-            pos = it->cursor();
+                if (c.pos.column() <= length) {
+                    replacements.push_back({.line = line, .column = c.pos.column(), .length = 0, .text = chars});
+                    insertedInLine += typedLength;
+                    typedPositions.emplace_back(line, c.pos.column() + insertedInLine);
+                    continue;
+                }
 
-            if (it->cursor() == view->cursorPosition()) {
-                freezedCursors.push_back({it->pos.get(), it->cursor()});
+                const int column = std::max(c.pos.column(), length + insertedInLine);
+                const QString text = QString(column - length - insertedInLine, QLatin1Char(' ')) + chars;
+                if (!replacements.empty() && replacements.back().line == line && replacements.back().column == length) {
+                    replacements.back().text += text;
+                } else {
+                    replacements.push_back({.line = line, .column = length, .length = 0, .text = text});
+                }
+                insertedInLine += text.size();
+                typedPositions.emplace_back(line, column + typedLength);
             }
+            editReplaceText(std::move(replacements));
+
+            for (size_t i = 0; i < cursors.size(); ++i) {
+                cursors[i].cursor->setPosition(typedPositions[i]);
+                if (typedPositions[i] == view->cursorPosition()) {
+                    freezedCursors.push_back({cursors[i].cursor, typedPositions[i]});
+                }
+            }
+        } else {
+            for (auto it = sc.begin(); it != sc.end(); ++it) {
+                auto pos = it->cursor();
+                if (it != sc.begin() && pos == std::prev(it)->cursor()) {
+                    freezedCursors.push_back({std::prev(it)->pos.get(), std::prev(it)->cursor()});
+                }
+
+                insertText(pos, chars);
+                pos = it->cursor();
 
-            const auto nextChar = view->document()->text({pos, pos + Cursor{0, 1}}).trimmed();
-            if (hasClosingBracket && !skipAutoBrace(closingBracket, pos) && (nextChar.isEmpty() || !nextChar.at(0).isLetterOrNumber())) {
-                insertText(it->cursor(), closingChar);
-                it->pos->setPosition(pos);
+                if (it->cursor() == view->cursorPosition()) {
+                    freezedCursors.push_back({it->pos.get(), it->cursor()});
+                }
+
+                if (!hasClosingBracket || skipAutoBrace(closingBracket, pos)) {
+                    continue;
+                }
+                const auto nextChar = view->document()->text({pos, pos + Cursor{0, 1}}).trimmed();
+                if (nextChar.isEmpty() || !nextChar.at(0).isLetterOrNumber()) {
+                    insertText(it->cursor(), closingChar);
+                    it->pos->setPosition(pos);
+                }
             }
         }
 
@@ -3536,9 +3696,7 @@ KTextEditor::Cursor KTextEditor::DocumentPrivate::backspaceAtCursor(KTextEditor:
                     backspaceWidth = 2;
                 }
             } else {
-                if (auto l = view->textLayout(c)) {
-                    backspaceWidth = col - l->previousCursorPosition(c.column());
-                }
+                backspaceWidth = col - view->previousCursorPosition(c);
             }
 
             beginCursor.setColumn(col - backspaceWidth);
@@ -3639,7 +3797,7 @@ void KTextEditor::DocumentPrivate::del(KTextEditor::ViewPrivate *view, const KTe
     }
 
     if (c.column() < m_buffer->lineLength(c.line())) {
-        KTextEditor::Cursor endCursor(c.line(), view->textLayout(c)->nextCursorPosition(c.column()));
+        KTextEditor::Cursor endCursor(c.line(), view->nextCursorPosition(c));
         removeText(KTextEditor::Range(c, endCursor));
     } else if (c.line() < lastLine()) {
         removeText(KTextEditor::Range(c.line(), c.column(), c.line() + 1, 0));
@@ -4586,43 +4744,55 @@ KTextEditor::Range KTextEditor::DocumentPrivate::findMatchingBracket(const KText
         return KTextEditor::Range::invalid();
     }
 
-    const int searchDir = isStartBracket(bracket) ? 1 : -1;
-    uint nesting = 0;
-
-    const int minLine = qMax(range.start().line() - maxLines, 0);
-    const int maxLine = qMin(range.start().line() + maxLines, documentEnd().line());
+    // the bracket index needs up-to-date highlighting to skip brackets in comments and strings
+    // lines already highlighted are searched without limit, new highlighting is limited to maxLines
+    // and only done as far as the search gets
+    const int maxLine = qMin(qMax(range.start().line() + maxLines, m_buffer->highlightedLines() - 1), documentEnd().line());
+    const auto ensureHighlighted = [this](int line) {
+        m_buffer->ensureHighlighted(line, 0);
+    };
+    const KTextEditor::Cursor match = m_buffer->findMatchingBracket(range.start(), 0, maxLine, ensureHighlighted);
+    if (!match.isValid()) {
+        return KTextEditor::Range::invalid();
+    }
 
     range.setEnd(range.start());
-    KTextEditor::DocumentCursor cursor(this);
-    cursor.setPosition(range.start());
-    int validAttr = kateTextLine(cursor.line()).attribute(cursor.column());
+    if (isStartBracket(bracket)) { // forward
+        range.setEnd(match);
+    } else {
+        range.setStart(match);
+    }
+    return range;
+}
 
-    while (cursor.line() >= minLine && cursor.line() <= maxLine) {
-        if (!cursor.move(searchDir)) {
-            return KTextEditor::Range::invalid();
-        }
+KTextEditor::Range KTextEditor::DocumentPrivate::findEnclosingBrackets(const KTextEditor::Cursor position, int maxLines)
+{
+    if (maxLines < 0 || position.line() < 0 || position.line() >= lines()) {
+        return KTextEditor::Range::invalid();
+    }
 
-        Kate::TextLine textLine = kateTextLine(cursor.line());
-        if (textLine.attribute(cursor.column()) == validAttr) {
-            // Check for match
-            QChar c = textLine.at(cursor.column());
-            if (c == opposite) {
-                if (nesting == 0) {
-                    if (searchDir > 0) { // forward
-                        range.setEnd(cursor.toCursor());
-                    } else {
-                        range.setStart(cursor.toCursor());
-                    }
-                    return range;
-                }
-                nesting--;
-            } else if (c == bracket) {
-                nesting++;
-            }
+    // brackets in comments and strings don't enclose code
+    const auto isIgnoredAttribute = [this](int attribute) {
+        switch (highlight()->defaultStyleForAttribute(attribute)) {
+        case KSyntaxHighlighting::Theme::TextStyle::Comment:
+        case KSyntaxHighlighting::Theme::TextStyle::CommentVar:
+        case KSyntaxHighlighting::Theme::TextStyle::Documentation:
+        case KSyntaxHighlighting::Theme::TextStyle::Char:
+        case KSyntaxHighlighting::Theme::TextStyle::String:
+        case KSyntaxHighlighting::Theme::TextStyle::VerbatimString:
+        case KSyntaxHighlighting::Theme::TextStyle::SpecialString:
+            return true;
+        default:
+            return false;
         }
-    }
+    };
 
-    return KTextEditor::Range::invalid();
+    // same limits as for findMatchingBracket()
+    const int maxLine = qMin(qMax(position.line() + maxLines, m_buffer->highlightedLines() - 1), documentEnd().line());
+    const auto ensureHighlighted = [this](int line) {
+        m_buffer->ensureHighlighted(line, 0);
+    };
+    return m_buffer->findEnclosingBrackets(position, 0, maxLine, isIgnoredAttribute, ensureHighlighted);
 }
 
 // helper: remove \r and \n from visible document name (bug #170876)
@@ -4945,6 +5115,12 @@ bool KTextEditor::DocumentPrivate::documentReload()
         return false;
     }
 
+    // nothing read yet, loading is as good as reloading
+    if (m_deferredLoad) {
+        ensureLoaded();
+        return true;
+    }
+
     // If we are modified externally clear undo and redo
     // Why:
     // Our checksum() is already updated at this point by
@@ -4963,9 +5139,16 @@ bool KTextEditor::DocumentPrivate::documentReload()
 
     Q_EMIT aboutToReload(this);
 
+    // keep everything not changed on disk, the views, cursors and highlighting stay as they are
+    if (reloadChangedLines()) {
+        Q_EMIT reloaded(this);
+        return true;
+    }
+
     QVarLengthArray<KateDocumentTmpMark> tmp;
-    tmp.reserve(m_marks.size());
-    std::transform(m_marks.cbegin(), m_marks.cend(), std::back_inserter(tmp), [this](KTextEditor::Mark *mark) {
+    const auto marks = m_marks.marks();
+    tmp.reserve(marks.size());
+    std::transform(marks.cbegin(), marks.cend(), std::back_inserter(tmp), [this](KTextEditor::Mark *mark) {
         return KateDocumentTmpMark{.line = line(mark->line), .mark = *mark};
     });
 
@@ -5037,8 +5220,81 @@ bool KTextEditor::DocumentPrivate::documentReload()
     return true;
 }
 
+bool KTextEditor::DocumentPrivate::reloadChangedLines()
+{
+    // only a document showing the file on disk as it was loaded can be updated in place
+    if (!url().isLocalFile() || localFilePath().isEmpty() || isModified() || !isReadWrite() || m_userSetEncodingForNextReload || m_buffer->brokenEncoding()
+        || m_buffer->tooLongLinesWrapped() || !QFileInfo(localFilePath()).isFile()) {
+        return false;
+    }
+
+    QStringList newLines;
+    QByteArray digest;
+    if (!m_buffer->readFile(localFilePath(), newLines, digest)) {
+        return false;
+    }
+
+    // lines equal at the start and at the end stay untouched
+    const int oldLines = lines();
+    const int newLinesCount = newLines.size();
+    int prefix = 0;
+    while (prefix < oldLines && prefix < newLinesCount && m_buffer->plainLine(prefix).text() == newLines.at(prefix)) {
+        ++prefix;
+    }
+    int suffix = 0;
+    while (suffix < oldLines - prefix && suffix < newLinesCount - prefix
+           && m_buffer->plainLine(oldLines - 1 - suffix).text() == newLines.at(newLinesCount - 1 - suffix)) {
+        ++suffix;
+    }
+
+    // replace the lines in between, the edit moves everything behind them like any other edit
+    if (prefix < oldLines || prefix < newLinesCount) {
+        const QString changedText = QStringList(newLines.begin() + prefix, newLines.end() - suffix).join(QLatin1Char('\n'));
+        const bool hasNewLines = prefix + suffix < newLinesCount;
+        KTextEditor::Range range;
+        QString text;
+        if (suffix > 0) {
+            range = KTextEditor::Range(prefix, 0, oldLines - suffix, 0);
+            text = hasNewLines ? changedText + QLatin1Char('\n') : QString();
+        } else if (prefix > 0) {
+            range = KTextEditor::Range(KTextEditor::Cursor(prefix - 1, lineLength(prefix - 1)), documentEnd());
+            text = hasNewLines ? QLatin1Char('\n') + changedText : QString();
+        } else {
+            range = documentRange();
+            text = changedText;
+        }
+
+        editStart();
+        replaceText(range, text);
+        editEnd();
+
+        // nothing to undo, like after a complete reload
+        m_undoManager->clearUndo();
+        m_undoManager->clearRedo();
+    }
+
+    // the buffer is the file on disk now, the changed lines show up as saved
+    m_buffer->setDigest(digest);
+    m_buffer->markModifiedLinesAsSaved();
+    setModified(false);
+    readVariables();
+
+    Q_EMIT loaded(this);
+
+    if (m_modOnHd) {
+        m_modOnHd = false;
+        m_modOnHdReason = OnDiskUnmodified;
+        m_prevModOnHdReason = OnDiskUnmodified;
+        Q_EMIT modifiedOnDisk(this, m_modOnHd, m_modOnHdReason);
+    }
+
+    repaintViews(true);
+    return true;
+}
+
 bool KTextEditor::DocumentPrivate::documentSave()
 {
+    ensureLoaded();
     if (!url().isValid() || !isReadWrite()) {
         return documentSaveAs();
     }
@@ -5048,6 +5304,7 @@ bool KTextEditor::DocumentPrivate::documentSave()
 
 bool KTextEditor::DocumentPrivate::documentSaveAs()
 {
+    ensureLoaded();
     const QUrl saveUrl = getSaveFileUrl(i18n("Save File"));
     if (saveUrl.isEmpty()) {
         return false;
@@ -5058,6 +5315,7 @@ bool KTextEditor::DocumentPrivate::documentSaveAs()
 
 bool KTextEditor::DocumentPrivate::documentSaveAsWithEncoding(const QString &encoding)
 {
+    ensureLoaded();
     const QUrl saveUrl = getSaveFileUrl(i18n("Save File"));
     if (saveUrl.isEmpty()) {
         return false;
@@ -5069,6 +5327,7 @@ bool KTextEditor::DocumentPrivate::documentSaveAsWithEncoding(const QString &enc
 
 void KTextEditor::DocumentPrivate::documentSaveCopyAs()
 {
+    ensureLoaded();
     const QUrl saveUrl = getSaveFileUrl(i18n("Save Copy of File"));
     if (saveUrl.isEmpty()) {
         return;
@@ -5661,6 +5920,7 @@ void KTextEditor::DocumentPrivate::slotDelayedHandleModOnHd()
 
 QByteArray KTextEditor::DocumentPrivate::checksum() const
 {
+    ensureLoaded();
     return m_buffer->digest();
 }
 
@@ -5721,8 +5981,10 @@ void KTextEditor::DocumentPrivate::removeTrailingSpacesAndAddNewLineAtEof()
     editStart();
 
     // handle trailing space striping if needed
+    // collect all removals first and apply them in one bulk edit
     const int lines = this->lines();
     if (remove != 0) {
+        std::vector<Kate::LineReplacement> removals;
         for (int line = 0; line < lines; ++line) {
             Kate::TextLine textline = plainKateTextLine(line);
 
@@ -5733,10 +5995,11 @@ void KTextEditor::DocumentPrivate::removeTrailingSpacesAndAddNewLineAtEof()
                 const int p = textline.lastChar() + 1;
                 const int l = textline.length() - p;
                 if (l > 0) {
-                    editRemoveText(line, p, l);
+                    removals.push_back({line, p, l, QString()});
                 }
             }
         }
+        editReplaceText(std::move(removals));
     }
 
     // add a trailing empty line if we want a final line break
@@ -5776,17 +6039,17 @@ void KTextEditor::DocumentPrivate::removeTrailingSpacesAndAddNewLineAtEof()
 
 void KTextEditor::DocumentPrivate::removeAllTrailingSpaces()
 {
-    editStart();
+    std::vector<Kate::LineReplacement> removals;
     const int lines = this->lines();
     for (int line = 0; line < lines; ++line) {
         const Kate::TextLine textline = plainKateTextLine(line);
         const int p = textline.lastChar() + 1;
         const int l = textline.length() - p;
         if (l > 0) {
-            editRemoveText(line, p, l);
+            removals.push_back({line, p, l, QString()});
         }
     }
-    editEnd();
+    editReplaceText(std::move(removals));
 }
 
 bool KTextEditor::DocumentPrivate::updateFileType(const QString &newType, bool user)
@@ -5917,12 +6180,14 @@ KateHighlighting *KTextEditor::DocumentPrivate::highlight() const
 
 Kate::TextLine KTextEditor::DocumentPrivate::kateTextLine(int i)
 {
+    ensureLoaded();
     m_buffer->ensureHighlighted(i);
     return m_buffer->plainLine(i);
 }
 
 Kate::TextLine KTextEditor::DocumentPrivate::plainKateTextLine(int i)
 {
+    ensureLoaded();
     return m_buffer->plainLine(i);
 }
 
@@ -5946,6 +6211,8 @@ void KTextEditor::DocumentPrivate::setUndoMergeAllEdits(bool merge)
 // BEGIN KTextEditor::MovingInterface
 KTextEditor::MovingCursor *KTextEditor::DocumentPrivate::newMovingCursor(KTextEditor::Cursor position, KTextEditor::MovingCursor::InsertBehavior insertBehavior)
 {
+    // loading later would invalidate the cursor
+    ensureLoaded();
     return new Kate::TextCursor(m_buffer, position, insertBehavior);
 }
 
@@ -5953,6 +6220,7 @@ KTextEditor::MovingRange *KTextEditor::DocumentPrivate::newMovingRange(KTextEdit
                                                                        KTextEditor::MovingRange::InsertBehaviors insertBehaviors,
                                                                        KTextEditor::MovingRange::EmptyBehavior emptyBehavior)
 {
+    ensureLoaded();
     return new Kate::TextRange(m_buffer, range, insertBehaviors, emptyBehavior);
 }
 
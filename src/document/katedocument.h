@@ -21,6 +21,9 @@
 
 #include <span>
 
+#include "katemarkindex.h"
+#include "kateperf.h"
+
 class KJob;
 class KateTemplateHandler;
 namespace KTextEditor
@@ -39,6 +42,7 @@ namespace Kate
 {
 class SwapFile;
 class TextLine;
+struct LineReplacement;
 }
 
 class KateBuffer;
@@ -56,6 +60,7 @@ class KateDocumentTest;
 
 class KateAutoIndent;
 class KateModOnHdPrompt;
+class KateRegExpSearchPattern;
 class KToggleAction;
 
 /**
@@ -246,6 +251,17 @@ public:
      */
     bool editRemoveText(int line, int col, int len);
 
+    /**
+     * Replace text inside many lines in one go, e.g. for whole-document transformations.
+     * Moves cursors like a sequence of editRemoveText/editInsertText calls, but all buffer blocks are
+     * visited only once, the batch is one undo item and textRemoved/textInsertedRange are emitted
+     * once per changed line, covering all its replacements.
+     * Replacements need not be sorted, overlapping ones are skipped.
+     * @param replacements in-line replacements to apply
+     * @return true on success
+     */
+    bool editReplaceText(std::vector<Kate::LineReplacement> replacements);
+
     /**
      * Mark @p line as @p autowrapped. This is necessary if static word warp is
      * enabled, because we have to know whether to insert a new line or add the
@@ -386,6 +402,12 @@ protected:
 public:
     QList<KTextEditor::Range> searchText(KTextEditor::Range range, const QString &pattern, const KTextEditor::SearchOptions options) const;
 
+    /**
+     * Regular expression search with an already compiled pattern.
+     * Use this for repeated searches with the same pattern.
+     */
+    QList<KTextEditor::Range> searchText(KTextEditor::Range range, const KateRegExpSearchPattern &pattern, bool backwards = false) const;
+
 private:
     /**
      * Return a widget suitable to be used as a dialog parent.
@@ -481,6 +503,7 @@ public:
      *  "SkipMode" => don't save/restore the mode
      *  "SkipHighlighting" => don't save/restore the highlighting
      *  "SkipEncoding" => don't save/restore the encoding
+     *  "SkipLazyLoad" => load a local file right away, see ensureLoaded()
      *
      * \param config read the session settings from this KConfigGroup
      * \param flags additional flags
@@ -498,6 +521,58 @@ public:
      */
     void writeSessionConfig(KConfigGroup &config, const QSet<QString> &flags = QSet<QString>()) override;
 
+    /**
+     * Load the file restored by readSessionConfig() now, if that didn't happen yet.
+     *
+     * A local file restored from a session is not read right away: url, encoding, mode and
+     * bookmarks are known, the buffer stays empty until a view is created, an API caller
+     * needs the content or the editor gets to it in the background.
+     */
+    void ensureLoaded() const
+    {
+        if (Q_UNLIKELY(m_deferredLoad)) {
+            const_cast<DocumentPrivate *>(this)->loadDeferred();
+        }
+    }
+
+    /**
+     * \return true if the file of this document is not loaded yet, see ensureLoaded()
+     */
+    bool isLoadDeferred() const
+    {
+        return bool(m_deferredLoad);
+    }
+
+private:
+    /**
+     * Remember the session file to open later, instead of openUrl().
+     */
+    void deferLoad(const QUrl &url);
+
+    /**
+     * Open the remembered session file and apply the remembered settings.
+     */
+    void loadDeferred();
+
+    /**
+     * State of a session file not loaded yet.
+     */
+    struct DeferredLoad {
+        QUrl url;
+
+        /**
+         * mode and highlighting set by the user, openUrl() would reset them
+         */
+        QString mode;
+        int highlighting = -1;
+
+        /**
+         * bookmarks, the empty buffer has no lines for them
+         */
+        QList<int> bookmarks;
+    };
+    std::unique_ptr<DeferredLoad> m_deferredLoad;
+
     //
     // KTextEditor::MarkInterface
     //
@@ -526,13 +601,22 @@ public Q_SLOTS:
 public:
     uint mark(int line) override;
     const QHash<int, KTextEditor::Mark *> &marks() override;
+
+    /**
+     * Ordered index of all marks, prefer it over marks() for ordered or line range access.
+     */
+    const KateMarkIndex &markIndex() const
+    {
+        return m_marks;
+    }
+
     QString markDescription(Document::MarkTypes) const override;
     virtual QColor markColor(Document::MarkTypes) const;
     uint editableMarks() const override;
     QIcon markIcon(Document::MarkTypes markType) const override;
 
 private:
-    QHash<int, KTextEditor::Mark *> m_marks;
+    KateMarkIndex m_marks;
     QHash<int, QIcon> m_markIcons;
     QHash<int, QString> m_markDescriptions;
     uint m_editableMarks = markType01;
@@ -938,8 +1022,25 @@ private:
     bool removeStartLineCommentFromSelection(KTextEditor::Range, int attrib, bool toggleComment);
 
 public:
+    /**
+     * Find the bracket matching the one at or in front of @p start.
+     * Uses the bracket index of the buffer, lines that are already highlighted are
+     * always searched, @p maxLines only limits how far new highlighting is done.
+     * @param start cursor next to a bracket
+     * @param maxLines highlight at most that many lines behind @p start to find a match
+     * @return range from bracket to matching bracket, invalid if none found
+     */
     KTextEditor::Range findMatchingBracket(const KTextEditor::Cursor start, int maxLines);
 
+    /**
+     * Find the innermost pair of brackets around @p position, e.g. to highlight the current scope.
+     * Brackets in comments and strings are ignored, limits like for findMatchingBracket().
+     * @param position cursor inside of the brackets
+     * @param maxLines highlight at most that many lines behind @p position to find the closing bracket
+     * @return range from the opening to the closing bracket, invalid if none found
+     */
+    KTextEditor::Range findEnclosingBrackets(const KTextEditor::Cursor position, int maxLines);
+
 public:
     QString documentName() const override;
 
@@ -986,6 +1087,13 @@ public:
     QUrl getSaveFileUrl(const QString &dialogTitle, QWidget *dialogParent = nullptr);
 
 private:
+    /**
+     * Reload by replacing only the lines that differ from the file on disk.
+     * Unchanged lines keep their highlighting, marks and moving cursors.
+     * @return false if the document must be loaded again completely
+     */
+    bool reloadChangedLines();
+
     // helper to handle the embedded notification for externally modified files
     QPointer<KateModOnHdPrompt> m_modOnHdHandler;
 
@@ -1315,6 +1423,20 @@ private:
 public:
     Kate::SwapFile *swapFile();
 
+    /**
+     * Performance counters of this document, see KATE_PERF_SCOPE.
+     * Mutable, as const operations like searching are measured, too.
+     */
+    KatePerf::Counters &perfCounters() const
+    {
+        return m_perfCounters;
+    }
+
+private:
+    mutable KatePerf::Counters m_perfCounters;
+
+public:
+
     // helpers for scripting and codefolding
     KSyntaxHighlighting::Theme::TextStyle defStyleNum(int line, int column);
     bool isComment(int line, int column);
@@ -0,0 +1,260 @@
+/*
+    SPDX-FileCopyrightText: KDE Developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "katemarkindex.h"
+
+#include <ktexteditor/document.h>
+
+KateMarkIndex::~KateMarkIndex()
+{
+    deleteNodes(m_root);
+}
+
+KTextEditor::Mark *KateMarkIndex::mark(int line) const
+{
+    int pendingShift = 0;
+    for (const Node *node = m_root; node;) {
+        const int nodeLine = node->line + pendingShift;
+        if (nodeLine == line) {
+            node->mark->line = line;
+            return node->mark;
+        }
+        pendingShift += node->pendingShift;
+        node = (line < nodeLine) ? node->left : node->right;
+    }
+    return nullptr;
+}
+
+KTextEditor::Mark *KateMarkIndex::next(int line) const
+{
+    // the last node we went left at is the nearest behind the line
+    const Node *found = nullptr;
+    int foundLine = 0;
+    int pendingShift = 0;
+    for (const Node *node = m_root; node;) {
+        const int nodeLine = node->line + pendingShift;
+        pendingShift += node->pendingShift;
+        if (line < nodeLine) {
+            found = node;
+            foundLine = nodeLine;
+            node = node->left;
+        } else {
+            node = node->right;
+        }
+    }
+
+    if (!found) {
+        return nullptr;
+    }
+    found->mark->line = foundLine;
+    return found->mark;
+}
+
+KTextEditor::Mark *KateMarkIndex::previous(int line) const
+{
+    // the last node we went right at is the nearest in front of the line
+    const Node *found = nullptr;
+    int foundLine = 0;
+    int pendingShift = 0;
+    for (const Node *node = m_root; node;) {
+        const int nodeLine = node->line + pendingShift;
+        pendingShift += node->pendingShift;
+        if (nodeLine < line) {
+            found = node;
+            foundLine = nodeLine;
+            node = node->right;
+        } else {
+            node = node->left;
+        }
+    }
+
+    if (!found) {
+        return nullptr;
+    }
+    found->mark->line = foundLine;
+    return found->mark;
+}
+
+void KateMarkIndex::insert(KTextEditor::Mark *mark)
+{
+    Q_ASSERT(mark);
+    Q_ASSERT(!this->mark(mark->line));
+
+    Node *node = new Node;
+    node->mark = mark;
+    node->line = mark->line;
+    node->priority = nextPriority();
+
+    const auto [front, back] = split(m_root, mark->line);
+    m_root = merge(merge(front, node), back);
+    ++m_size;
+    invalidateHash();
+}
+
+KTextEditor::Mark *KateMarkIndex::take(int line)
+{
+    const auto marks = takeLines(line, line);
+    Q_ASSERT(marks.size() <= 1);
+    return marks.empty() ? nullptr : marks.front();
+}
+
+std::vector<KTextEditor::Mark *> KateMarkIndex::takeLines(int startLine, int endLine)
+{
+    std::vector<KTextEditor::Mark *> marks;
+    if (startLine > endLine) {
+        return marks;
+    }
+
+    const auto [front, rest] = split(m_root, startLine);
+    const auto [middle, back] = split(rest, endLine + 1);
+    collect(middle, 0, startLine, endLine, marks);
+    deleteNodes(middle);
+    m_root = merge(front, back);
+
+    m_size -= marks.size();
+    if (!marks.empty()) {
+        invalidateHash();
+    }
+    return marks;
+}
+
+std::vector<KTextEditor::Mark *> KateMarkIndex::takeAll()
+{
+    std::vector<KTextEditor::Mark *> marks = this->marks();
+    deleteNodes(m_root);
+    m_root = nullptr;
+    m_size = 0;
+    invalidateHash();
+    return marks;
+}
+
+bool KateMarkIndex::shiftLines(int line, int delta)
+{
+    const auto [front, back] = split(m_root, line);
+    shiftNode(back, delta);
+    m_root = merge(front, back);
+
+    if (!back || delta == 0) {
+        return false;
+    }
+    invalidateHash();
+    return true;
+}
+
+std::vector<KTextEditor::Mark *> KateMarkIndex::marks(int startLine, int endLine) const
+{
+    std::vector<KTextEditor::Mark *> marks;
+    collect(m_root, 0, startLine, endLine, marks);
+    return marks;
+}
+
+const QHash<int, KTextEditor::Mark *> &KateMarkIndex::hash() const
+{
+    if (!m_hashValid) {
+        m_hash.reserve(m_size);
+        for (KTextEditor::Mark *mark : marks()) {
+            m_hash.insert(mark->line, mark);
+        }
+        m_hashValid = true;
+    }
+    return m_hash;
+}
+
+void KateMarkIndex::shiftNode(Node *node, int delta)
+{
+    if (node) {
+        node->line += delta;
+        node->pendingShift += delta;
+    }
+}
+
+void KateMarkIndex::pushDown(Node *node)
+{
+    if (node->pendingShift) {
+        shiftNode(node->left, node->pendingShift);
+        shiftNode(node->right, node->pendingShift);
+        node->pendingShift = 0;
+    }
+}
+
+std::pair<KateMarkIndex::Node *, KateMarkIndex::Node *> KateMarkIndex::split(Node *node, int line)
+{
+    if (!node) {
+        return {nullptr, nullptr};
+    }
+
+    pushDown(node);
+    if (node->line < line) {
+        const auto [front, back] = split(node->right, line);
+        node->right = front;
+        return {node, back};
+    }
+
+    const auto [front, back] = split(node->left, line);
+    node->left = back;
+    return {front, node};
+}
+
+KateMarkIndex::Node *KateMarkIndex::merge(Node *left, Node *right)
+{
+    if (!left) {
+        return right;
+    }
+    if (!right) {
+        return left;
+    }
+
+    // higher priority stays on top
+    if (left->priority > right->priority) {
+        pushDown(left);
+        left->right = merge(left->right, right);
+        return left;
+    }
+
+    pushDown(right);
+    right->left = merge(left, right->left);
+    return right;
+}
+
+void KateMarkIndex::collect(const Node *node, int pendingShift, int startLine, int endLine, std::vector<KTextEditor::Mark *> &marks)
+{
+    if (!node) {
+        return;
+    }
+
+    // skip subtrees outside of the requested lines
+    const int nodeLine = node->line + pendingShift;
+    pendingShift += node->pendingShift;
+    if (startLine < nodeLine) {
+        collect(node->left, pendingShift, startLine, endLine, marks);
+    }
+    if (startLine <= nodeLine && nodeLine <= endLine) {
+        node->mark->line = nodeLine;
+        marks.push_back(node->mark);
+    }
+    if (nodeLine < endLine) {
+        collect(node->right, pendingShift, startLine, endLine, marks);
+    }
+}
+
+void KateMarkIndex::deleteNodes(Node *node)
+{
+    if (!node) {
+        return;
+    }
+    deleteNodes(node->left);
+    deleteNodes(node->right);
+    delete node;
+}
+
+quint32 KateMarkIndex::nextPriority()
+{
+    // xorshift32, good enough to keep the treap balanced
+    m_randomState ^= m_randomState << 13;
+    m_randomState ^= m_randomState >> 17;
+    m_randomState ^= m_randomState << 5;
+    return m_randomState;
+}
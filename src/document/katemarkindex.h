@@ -0,0 +1,199 @@
+/*
+    SPDX-FileCopyrightText: KDE Developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef KATE_MARKINDEX_H
+#define KATE_MARKINDEX_H
+
+#include <ktexteditor_export.h>
+
+#include <QHash>
+
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace KTextEditor
+{
+class Mark;
+}
+
+/**
+ * Ordered index of the marks of a document by line.
+ *
+ * The marks are kept in a treap sorted by line. Each node only stores its line
+ * without the pending shifts of its ancestors, that way all marks behind an inserted
+ * or removed line are moved in O(log n), no matter how many marks there are.
+ *
+ * The line member of a mark is only updated when the mark is handed out,
+ * code must not rely on it for marks it keeps around.
+ */
+class KTEXTEDITOR_EXPORT KateMarkIndex
+{
+public:
+    KateMarkIndex() = default;
+
+    /**
+     * Deletes the index, not the marks.
+     */
+    ~KateMarkIndex();
+
+    KateMarkIndex(const KateMarkIndex &) = delete;
+    KateMarkIndex &operator=(const KateMarkIndex &) = delete;
+
+    bool isEmpty() const
+    {
+        return !m_root;
+    }
+
+    qsizetype size() const
+    {
+        return m_size;
+    }
+
+    /**
+     * Mark on the given line.
+     * @param line line to look at
+     * @return mark on this line, nullptr if there is none
+     */
+    KTextEditor::Mark *mark(int line) const;
+
+    /**
+     * Nearest mark behind the given line.
+     * @param line line to look behind
+     * @return mark with the smallest line greater than \p line, nullptr if there is none
+     */
+    KTextEditor::Mark *next(int line) const;
+
+    /**
+     * Nearest mark in front of the given line.
+     * @param line line to look in front of
+     * @return mark with the largest line less than \p line, nullptr if there is none
+     */
+    KTextEditor::Mark *previous(int line) const;
+
+    /**
+     * @return mark on the first line with a mark, nullptr if there are no marks
+     */
+    KTextEditor::Mark *first() const
+    {
+        return next(std::numeric_limits<int>::min());
+    }
+
+    /**
+     * @return mark on the last line with a mark, nullptr if there are no marks
+     */
+    KTextEditor::Mark *last() const
+    {
+        return previous(std::numeric_limits<int>::max());
+    }
+
+    /**
+     * Add a mark on its line, that line must have no mark yet.
+     * @param mark mark to add, still owned by the caller
+     */
+    void insert(KTextEditor::Mark *mark);
+
+    /**
+     * Remove the mark of the given line from the index.
+     * @param line line of the mark
+     * @return removed mark, nullptr if there is none
+     */
+    KTextEditor::Mark *take(int line);
+
+    /**
+     * Remove the marks on the lines [startLine, endLine] from the index.
+     * @return removed marks, sorted by line
+     */
+    std::vector<KTextEditor::Mark *> takeLines(int startLine, int endLine);
+
+    /**
+     * Remove all marks from the index.
+     * @return removed marks, sorted by line
+     */
+    std::vector<KTextEditor::Mark *> takeAll();
+
+    /**
+     * Move all marks on the given line and behind by \p delta lines.
+     * For a negative \p delta, the lines the marks move to must have no marks.
+     * @param line first line to move
+     * @param delta number of lines to move the marks down, negative moves up
+     * @return true if any mark was moved
+     */
+    bool shiftLines(int line, int delta);
+
+    /**
+     * Marks on the lines [startLine, endLine], e.g. for the visible lines.
+     * @return marks sorted by line
+     */
+    std::vector<KTextEditor::Mark *> marks(int startLine = 0, int endLine = std::numeric_limits<int>::max()) const;
+
+    /**
+     * All marks by line, for KTextEditor::Document::marks().
+     * Built on demand and cached until the next change of the index.
+     */
+    const QHash<int, KTextEditor::Mark *> &hash() const;
+
+private:
+    struct Node {
+        KTextEditor::Mark *mark = nullptr;
+
+        /**
+         * line of the mark, without the pending shifts of the ancestors
+         */
+        int line = 0;
+
+        /**
+         * shift of all descendants, not yet pushed down to the children
+         */
+        int pendingShift = 0;
+
+        quint32 priority = 0;
+        Node *left = nullptr;
+        Node *right = nullptr;
+    };
+
+    static void shiftNode(Node *node, int delta);
+    static void pushDown(Node *node);
+
+    /**
+     * Split into the nodes with lines in front of \p line and the others.
+     */
+    static std::pair<Node *, Node *> split(Node *node, int line);
+
+    /**
+     * Merge two treaps, all lines of \p left must be in front of the lines of \p right.
+     */
+    static Node *merge(Node *left, Node *right);
+
+    /**
+     * Collect the marks of the given lines, their line members are updated.
+     */
+    static void collect(const Node *node, int pendingShift, int startLine, int endLine, std::vector<KTextEditor::Mark *> &marks);
+
+    static void deleteNodes(Node *node);
+
+    quint32 nextPriority();
+
+    void invalidateHash()
+    {
+        m_hashValid = false;
+        m_hash.clear();
+    }
+
+private:
+    Node *m_root = nullptr;
+    qsizetype m_size = 0;
+
+    /**
+     * state of the xorshift generator for the node priorities
+     */
+    quint32 m_randomState = 2463534242U;
+
+    mutable QHash<int, KTextEditor::Mark *> m_hash;
+    mutable bool m_hashValid = true;
+};
+
+#endif
@@ -11,100 +11,237 @@
 #include "exporter.h"
 #include "abstractexporter.h"
 #include "htmlexporter.h"
+#include "katebuffer.h"
+#include "katedocument.h"
+#include "katerenderer.h"
+#include "katesyntaxmanager.h"
+#include "kateview.h"
 
-#include <ktexteditor/document.h>
-#include <ktexteditor/view.h>
+#include <ktexteditor/message.h>
 
 #include <KLocalizedString>
 
+#include <QAction>
 #include <QApplication>
 #include <QClipboard>
-#include <QFileDialog>
+#include <QFile>
 #include <QMimeData>
+#include <QTimer>
+
+KateExporter::KateExporter(KTextEditor::View *view)
+    : QObject(view)
+    , m_view(view)
+{
+}
+
+KateExporter::~KateExporter()
+{
+    // the exporter writes its footer to the output, the output to the file
+    m_exporter.reset();
+    m_output.reset();
+    delete m_progressMessage;
+}
 
 void KateExporter::exportToClipboard()
 {
-    if (!m_view->selection()) {
+    if (!m_view->selection() || isRunning()) {
+        Q_EMIT finished(false);
         return;
     }
 
-    QMimeData *data = new QMimeData();
+    m_output = std::make_unique<QTextStream>(&m_clipboardText, QIODevice::WriteOnly);
+    startExport(true);
+}
 
-    QString s;
-    QTextStream output(&s, QIODevice::WriteOnly);
-    exportData(true, output);
+void KateExporter::exportToFile(const QString &file)
+{
+    if (isRunning()) {
+        Q_EMIT finished(false);
+        return;
+    }
 
-    data->setHtml(s);
-    data->setText(s);
+    m_file = std::make_unique<QFile>(file);
+    if (!m_file->open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        m_file.reset();
+        Q_EMIT finished(false);
+        return;
+    }
 
-    QApplication::clipboard()->setMimeData(data);
+    m_output = std::make_unique<QTextStream>(m_file.get());
+    startExport(false);
 }
 
-void KateExporter::exportToFile(const QString &file)
+void KateExporter::cancel()
 {
-    QFile savefile(file);
-    if (!savefile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    if (!isRunning()) {
         return;
     }
 
-    QTextStream outputStream(&savefile);
-    exportData(false, outputStream);
+    m_canceled = true;
+    finishExport();
 }
 
-void KateExporter::exportData(const bool useSelection, QTextStream &output)
+void KateExporter::startExport(const bool useSelection)
 {
-    const KTextEditor::Range range = useSelection ? m_view->selectionRange() : m_view->document()->documentRange();
-    const bool blockwise = useSelection ? m_view->blockSelection() : false;
+    m_range = useSelection ? m_view->selectionRange() : m_view->document()->documentRange();
+    m_blockwise = useSelection ? m_view->blockSelection() : false;
+    m_line = m_range.start().line();
+    m_canceled = false;
 
-    if ((blockwise || range.onSingleLine()) && (range.start().column() > range.end().column())) {
-        return;
+    if ((m_blockwise || m_range.onSingleLine()) && (m_range.start().column() > m_range.end().column())) {
+        m_canceled = true;
+    }
+
+    // files get a style sheet, the clipboard keeps inline styles as many applications ignore style sheets when pasting
+    QList<KTextEditor::Attribute::Ptr> classAttributes;
+    auto *view = qobject_cast<KTextEditor::ViewPrivate *>(m_view);
+    if (!useSelection && view) {
+        classAttributes = view->renderer()->attributes();
     }
 
     /// TODO: add more exporters
-    std::unique_ptr<AbstractExporter> exporter = std::make_unique<HTMLExporter>(m_view, output, !useSelection);
+    m_exporter = std::make_unique<HTMLExporter>(m_view, *m_output, !useSelection, classAttributes);
+
+    if (m_canceled) {
+        finishExport();
+        return;
+    }
+
+    if (m_inChunks) {
+        // the later chunks read the live document: stop in time if it goes away, if the text changes
+        // below the fixed range or if the highlighting is replaced and with it the exported attributes
+        KTextEditor::Document *doc = m_view->document();
+        m_connections.push_back(connect(doc, &KTextEditor::Document::aboutToClose, this, &KateExporter::cancel));
+        m_connections.push_back(connect(doc, &KTextEditor::Document::textChanged, this, &KateExporter::cancel));
+        m_connections.push_back(connect(doc, &KTextEditor::Document::highlightingModeChanged, this, &KateExporter::cancel));
+        m_connections.push_back(connect(KateHlManager::self(), &KateHlManager::changed, this, &KateExporter::cancel));
+    }
+    exportChunk();
+}
+
+void KateExporter::exportChunk()
+{
+    // canceled since this chunk was scheduled?
+    if (!isRunning()) {
+        return;
+    }
+
+    KTextEditor::Document *doc = m_view->document();
+    const int lastLine = qMin(m_range.end().line(), doc->lines() - 1);
+    const int chunkEnd = m_inChunks ? qMin(m_line + m_chunkLines - 1, lastLine) : lastLine;
+
+    // highlight the whole chunk ahead of the writer instead of asking the buffer line by line
+    if (auto *docPrivate = qobject_cast<KTextEditor::DocumentPrivate *>(doc)) {
+        docPrivate->buffer().ensureHighlighted(chunkEnd, 0);
+    }
+
+    for (; m_line <= chunkEnd; ++m_line) {
+        exportLine(m_line);
+    }
+
+    if (m_line > lastLine) {
+        finishExport();
+        return;
+    }
+
+    const int lines = lastLine - m_range.start().line() + 1;
+    const int exportedLines = m_line - m_range.start().line();
+    Q_EMIT progress(exportedLines, lines);
+
+    // progress signal handlers might have canceled us
+    if (!isRunning()) {
+        return;
+    }
+    updateProgressMessage(exportedLines, lines);
+    QTimer::singleShot(0, this, &KateExporter::exportChunk);
+}
+
+void KateExporter::exportLine(int i)
+{
+    const QString &line = m_view->document()->line(i);
+
+    const QList<KTextEditor::AttributeBlock> attribs = m_view->lineAttributes(i);
 
     const KTextEditor::Attribute::Ptr noAttrib(nullptr);
 
-    for (int i = range.start().line(); (i <= range.end().line()) && (i < m_view->document()->lines()); ++i) {
-        const QString &line = m_view->document()->line(i);
+    int lineStart = 0;
+    int remainingChars = line.length();
+    if (m_blockwise || m_range.onSingleLine()) {
+        lineStart = m_range.start().column();
+        remainingChars = m_range.columnWidth();
+    } else if (i == m_range.start().line()) {
+        lineStart = m_range.start().column();
+    } else if (i == m_range.end().line()) {
+        remainingChars = m_range.end().column();
+    }
 
-        const QList<KTextEditor::AttributeBlock> attribs = m_view->lineAttributes(i);
+    int handledUntil = lineStart;
 
-        int lineStart = 0;
-        int remainingChars = line.length();
-        if (blockwise || range.onSingleLine()) {
-            lineStart = range.start().column();
-            remainingChars = range.columnWidth();
-        } else if (i == range.start().line()) {
-            lineStart = range.start().column();
-        } else if (i == range.end().line()) {
-            remainingChars = range.end().column();
+    for (const KTextEditor::AttributeBlock &block : attribs) {
+        // honor (block-) selections
+        if (block.start + block.length <= lineStart) {
+            continue;
+        } else if (block.start >= lineStart + remainingChars) {
+            break;
         }
-
-        int handledUntil = lineStart;
-
-        for (const KTextEditor::AttributeBlock &block : attribs) {
-            // honor (block-) selections
-            if (block.start + block.length <= lineStart) {
-                continue;
-            } else if (block.start >= lineStart + remainingChars) {
-                break;
-            }
-            int start = qMax(block.start, lineStart);
-            if (start > handledUntil) {
-                exporter->exportText(line.mid(handledUntil, start - handledUntil), noAttrib);
-            }
-            int length = qMin(block.length, remainingChars);
-            exporter->exportText(line.mid(start, length), block.attribute);
-            handledUntil = start + length;
+        int start = qMax(block.start, lineStart);
+        if (start > handledUntil) {
+            m_exporter->exportText(line.mid(handledUntil, start - handledUntil), noAttrib);
         }
+        int length = qMin(block.length, remainingChars);
+        m_exporter->exportText(line.mid(start, length), block.attribute);
+        handledUntil = start + length;
+    }
 
-        if (handledUntil < lineStart + remainingChars) {
-            exporter->exportText(line.mid(handledUntil, remainingChars), noAttrib);
-        }
+    if (handledUntil < lineStart + remainingChars) {
+        m_exporter->exportText(line.mid(handledUntil, remainingChars), noAttrib);
+    }
+
+    m_exporter->closeLine(i == m_range.end().line());
+}
 
-        exporter->closeLine(i == range.end().line());
+void KateExporter::finishExport()
+{
+    for (const auto &connection : m_connections) {
+        disconnect(connection);
+    }
+    m_connections.clear();
+
+    // writes the footer
+    m_exporter.reset();
+    m_output->flush();
+    m_output.reset();
+
+    if (m_file) {
+        m_file.reset();
+    } else if (!m_canceled) {
+        QMimeData *data = new QMimeData();
+        data->setHtml(m_clipboardText);
+        data->setText(m_clipboardText);
+        QApplication::clipboard()->setMimeData(data);
     }
+    m_clipboardText.clear();
+
+    delete m_progressMessage;
+
+    Q_EMIT finished(!m_canceled);
+}
+
+void KateExporter::updateProgressMessage(int exportedLines, int lines)
+{
+    const QString text = i18n("Exporting as HTML: %1%", qint64(exportedLines) * 100 / qMax(lines, 1));
+    if (m_progressMessage) {
+        m_progressMessage->setText(text);
+        return;
+    }
+
+    m_progressMessage = new KTextEditor::Message(text, KTextEditor::Message::Information);
+    m_progressMessage->setView(m_view);
+
+    QAction *cancelAction = new QAction(QIcon::fromTheme(QStringLiteral("dialog-cancel")), i18n("&Cancel"), nullptr);
+    cancelAction->setToolTip(i18n("Stops the export, the lines exported so far are kept."));
+    m_progressMessage->addAction(cancelAction, false);
+    connect(cancelAction, &QAction::triggered, this, &KateExporter::cancel);
 
-    output.flush();
+    m_view->document()->postMessage(m_progressMessage);
 }
@@ -7,27 +7,104 @@
 #ifndef EXPORTERPLUGINVIEW_H
 #define EXPORTERPLUGINVIEW_H
 
+#include <ktexteditor_export.h>
+
+#include <KTextEditor/Range>
 #include <KTextEditor/View>
 
+#include <QPointer>
 #include <QTextStream>
 
-class KateExporter
+#include <memory>
+#include <vector>
+
+class AbstractExporter;
+class QFile;
+
+namespace KTextEditor
+{
+class Message;
+}
+
+/**
+ * Exports the selection to the clipboard or the whole document to a file as HTML.
+ *
+ * By default an export blocks until it is done. With setExportInChunks() it instead
+ * exports a limited number of lines at a time from the event loop, reports its progress
+ * and can be canceled, which keeps the UI responsive for huge documents.
+ */
+class KTEXTEDITOR_EXPORT KateExporter : public QObject
 {
+    Q_OBJECT
+
 public:
-    explicit KateExporter(KTextEditor::View *view)
-        : m_view(view)
-    {
-    }
+    explicit KateExporter(KTextEditor::View *view);
+    ~KateExporter() override;
 
     void exportToClipboard();
     void exportToFile(const QString &file);
 
+    /**
+     * Export \p chunkLines lines at a time from the event loop, shows a message with the
+     * progress and a cancel button in the view while running. Must be set before starting
+     * the export.
+     */
+    void setExportInChunks(bool inChunks, int chunkLines = 5000)
+    {
+        m_inChunks = inChunks;
+        m_chunkLines = qMax(chunkLines, 1);
+    }
+
+    /**
+     * Is an export in chunks still running?
+     */
+    bool isRunning() const
+    {
+        return m_exporter != nullptr;
+    }
+
+    /**
+     * Stop a running export, finished() is emitted without success.
+     * For the clipboard nothing is copied, a file keeps the lines exported so far.
+     * Editing the document, closing it or changing its highlighting cancels a running export in chunks.
+     */
+    void cancel();
+
+Q_SIGNALS:
+    /**
+     * Emitted after each chunk of an export in chunks.
+     */
+    void progress(int exportedLines, int lines);
+
+    /**
+     * Emitted exactly once for each export, \p success is false if it was canceled
+     * or could not be started at all.
+     */
+    void finished(bool success);
+
 private:
-    /// TODO: maybe make this scriptable for additional exporters?
-    void exportData(const bool useSelction, QTextStream &output);
+    void startExport(const bool useSelection);
+    void exportChunk();
+    void exportLine(int i);
+    void finishExport();
+    void updateProgressMessage(int exportedLines, int lines);
 
 private:
     KTextEditor::View *m_view;
+    bool m_inChunks = false;
+    int m_chunkLines = 5000;
+
+    /// state of the running export
+    KTextEditor::Range m_range = KTextEditor::Range::invalid();
+    bool m_blockwise = false;
+    bool m_canceled = false;
+    int m_line = 0;
+    std::unique_ptr<QFile> m_file;
+    QString m_clipboardText;
+    std::unique_ptr<QTextStream> m_output;
+    std::unique_ptr<AbstractExporter> m_exporter;
+    QPointer<KTextEditor::Message> m_progressMessage;
+    std::vector<QMetaObject::Connection> m_connections;
 };
 
 #endif
@@ -33,10 +33,24 @@ static QString toHtmlRgbaString(const QColor &color)
     return rgba;
 }
 
-HTMLExporter::HTMLExporter(KTextEditor::View *view, QTextStream &output, const bool encapsulate)
+HTMLExporter::HTMLExporter(KTextEditor::View *view,
+                           QTextStream &output,
+                           const bool encapsulate,
+                           const QList<KTextEditor::Attribute::Ptr> &classAttributes)
     : AbstractExporter(view, output, encapsulate)
 {
     if (m_encapsulate) {
+        // one class per distinct look, many attributes of a highlighting look the same
+        QString styleSheet;
+        for (const KTextEditor::Attribute::Ptr &attrib : classAttributes) {
+            const QString style = styleDeclarations(attrib);
+            if (!style.isEmpty() && !m_classes.contains(style)) {
+                const QString cssClass = QStringLiteral("s%1").arg(m_classes.size());
+                m_classes.insert(style, cssClass);
+                styleSheet += QLatin1Char('.') + cssClass + QLatin1String(" { ") + style + QLatin1String(" }\n");
+            }
+        }
+
         // let's write the HTML header :
         m_output << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
         m_output << "<!DOCTYPE html PUBLIC \"-//W3C//DTD XHTML 1.0 Strict//EN\" \"DTD/xhtml1-strict.dtd\">\n";
@@ -46,6 +60,9 @@ HTMLExporter::HTMLExporter(KTextEditor::View *view, QTextStream &output, const b
         m_output << "<meta name=\"Generator\" content=\"Kate, the KDE Advanced Text Editor\" />\n";
         // for the title, we write the name of the file (/usr/local/emmanuel/myfile.cpp -> myfile.cpp)
         m_output << "<title>" << view->document()->documentName() << "</title>\n";
+        if (!styleSheet.isEmpty()) {
+            m_output << "<style type=\"text/css\">\n" << styleSheet << "</style>\n";
+        }
         m_output << "</head>\n";
 
         // tell in comment which highlighting was used!
@@ -69,6 +86,7 @@ HTMLExporter::HTMLExporter(KTextEditor::View *view, QTextStream &output, const b
 
 HTMLExporter::~HTMLExporter()
 {
+    flushRun();
     m_output << "</pre>\n";
 
     if (m_encapsulate) {
@@ -84,49 +102,102 @@ void HTMLExporter::openLine()
 
 void HTMLExporter::closeLine(const bool lastLine)
 {
+    flushRun();
     if (!lastLine) {
         // we are inside a <pre>, so a \n is a new line
         m_output << "\n";
-        m_output.flush();
     }
 }
 
 void HTMLExporter::exportText(const QString &text, const KTextEditor::Attribute::Ptr &attrib)
+{
+    const Tags &tags = tagsFor(attrib);
+    if (tags.open != m_runTags.open) {
+        flushRun();
+        m_runTags = tags;
+    }
+    m_runText += text;
+}
+
+QString HTMLExporter::styleDeclarations(const KTextEditor::Attribute::Ptr &attrib) const
 {
     if (!attrib || !attrib->hasAnyProperty() || attrib == m_defaultAttribute) {
-        m_output << text.toHtmlEscaped();
-        return;
+        return QString();
     }
 
+    QString style;
     if (attrib->fontBold()) {
-        m_output << "<b>";
+        style += QLatin1String("font-weight:bold;");
     }
     if (attrib->fontItalic()) {
-        m_output << "<i>";
+        style += QLatin1String("font-style:italic;");
     }
+    if (attrib->hasProperty(QTextCharFormat::ForegroundBrush)
+        && (!m_defaultAttribute || attrib->foreground().color() != m_defaultAttribute->foreground().color())) {
+        style += QLatin1String("color:") + toHtmlRgbaString(attrib->foreground().color()) + QLatin1Char(';');
+    }
+    if (attrib->hasProperty(QTextCharFormat::BackgroundBrush)
+        && (!m_defaultAttribute || attrib->background().color() != m_defaultAttribute->background().color())) {
+        style += QLatin1String("background:") + toHtmlRgbaString(attrib->background().color()) + QLatin1Char(';');
+    }
+    return style;
+}
 
-    bool writeForeground = attrib->hasProperty(QTextCharFormat::ForegroundBrush)
-        && (!m_defaultAttribute || attrib->foreground().color() != m_defaultAttribute->foreground().color());
-    bool writeBackground = attrib->hasProperty(QTextCharFormat::BackgroundBrush)
-        && (!m_defaultAttribute || attrib->background().color() != m_defaultAttribute->background().color());
+const HTMLExporter::Tags &HTMLExporter::tagsFor(const KTextEditor::Attribute::Ptr &attrib)
+{
+    const auto it = m_tags.constFind(attrib.constData());
+    if (it != m_tags.cend()) {
+        return it.value();
+    }
 
-    if (writeForeground || writeBackground) {
-        m_output << QStringLiteral("<span style='%1%2'>")
-                        .arg(writeForeground ? QString(QLatin1String("color:") + toHtmlRgbaString(attrib->foreground().color()) + QLatin1Char(';')) : QString())
-                        .arg(writeBackground ? QString(QLatin1String("background:") + toHtmlRgbaString(attrib->background().color()) + QLatin1Char(';'))
-                                             : QString());
+    Tags tags;
+    tags.attribute = attrib;
+    const QString style = styleDeclarations(attrib);
+    const auto cssClass = m_classes.constFind(style);
+    if (cssClass != m_classes.cend()) {
+        tags.open = QStringLiteral("<span class=\"%1\">").arg(cssClass.value());
+        tags.close = QStringLiteral("</span>");
+    } else if (!style.isEmpty()) {
+        // inline styles, like the bold and italic markup for the clipboard
+        if (attrib->fontBold()) {
+            tags.open += QLatin1String("<b>");
+        }
+        if (attrib->fontItalic()) {
+            tags.open += QLatin1String("<i>");
+        }
+
+        bool writeForeground = attrib->hasProperty(QTextCharFormat::ForegroundBrush)
+            && (!m_defaultAttribute || attrib->foreground().color() != m_defaultAttribute->foreground().color());
+        bool writeBackground = attrib->hasProperty(QTextCharFormat::BackgroundBrush)
+            && (!m_defaultAttribute || attrib->background().color() != m_defaultAttribute->background().color());
+
+        if (writeForeground || writeBackground) {
+            tags.open += QStringLiteral("<span style='%1%2'>")
+                             .arg(writeForeground ? QString(QLatin1String("color:") + toHtmlRgbaString(attrib->foreground().color()) + QLatin1Char(';'))
+                                                  : QString())
+                             .arg(writeBackground ? QString(QLatin1String("background:") + toHtmlRgbaString(attrib->background().color()) + QLatin1Char(';'))
+                                                  : QString());
+            tags.close += QLatin1String("</span>");
+        }
+        if (attrib->fontItalic()) {
+            tags.close += QLatin1String("</i>");
+        }
+        if (attrib->fontBold()) {
+            tags.close += QLatin1String("</b>");
+        }
     }
 
-    m_output << text.toHtmlEscaped();
+    return m_tags.insert(attrib.constData(), tags).value();
+}
 
-    if (writeBackground || writeForeground) {
-        m_output << "</span>";
-    }
-    if (attrib->fontItalic()) {
-        m_output << "</i>";
-    }
-    if (attrib->fontBold()) {
-        m_output << "</b>";
+void HTMLExporter::flushRun()
+{
+    if (m_runText.isEmpty()) {
+        return;
     }
-    m_output.flush();
+
+    m_output << m_runTags.open << m_runText.toHtmlEscaped() << m_runTags.close;
+
+    // keep the capacity for the next run
+    m_runText.truncate(0);
 }
@@ -9,16 +9,45 @@
 
 #include "abstractexporter.h"
 
+#include <QHash>
+
 /// TODO: add abstract interface for future exporters
 class HTMLExporter : public AbstractExporter
 {
 public:
-    HTMLExporter(KTextEditor::View *view, QTextStream &output, const bool withHeaderFooter = false);
+    /// If \p classAttributes is not empty and a header is written, the header contains a style sheet
+    /// with one CSS class per distinct look of these attributes and the text refers to the classes
+    /// instead of repeating inline styles for every run.
+    HTMLExporter(KTextEditor::View *view,
+                 QTextStream &output,
+                 const bool withHeaderFooter = false,
+                 const QList<KTextEditor::Attribute::Ptr> &classAttributes = QList<KTextEditor::Attribute::Ptr>());
     ~HTMLExporter() override;
 
     void openLine() override;
     void closeLine(const bool lastLine) override;
     void exportText(const QString &text, const KTextEditor::Attribute::Ptr &attrib) override;
+
+private:
+    struct Tags {
+        QString open;
+        QString close;
+        /// keeps the attribute alive, its address must not be reused while it is a key of m_tags
+        KTextEditor::Attribute::Ptr attribute;
+    };
+
+    QString styleDeclarations(const KTextEditor::Attribute::Ptr &attrib) const;
+    const Tags &tagsFor(const KTextEditor::Attribute::Ptr &attrib);
+    void flushRun();
+
+    /// style declarations => CSS class name
+    QHash<QString, QString> m_classes;
+    /// cache of the tags of all attributes seen so far
+    QHash<const KTextEditor::Attribute *, Tags> m_tags;
+
+    /// adjacent text with the same look is written as one run
+    Tags m_runTags;
+    QString m_runText;
 };
 
 #endif
@@ -0,0 +1,134 @@
+/*
+    SPDX-FileCopyrightText: KDE Developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef KTEXTEDITOR_DECORATIONLAYER_H
+#define KTEXTEDITOR_DECORATIONLAYER_H
+
+#include <ktexteditor/attribute.h>
+#include <ktexteditor_export.h>
+
+#include <QList>
+
+namespace KTextEditor
+{
+class Document;
+
+/*!
+ * \class KTextEditor::Decoration
+ * \inmodule KTextEditor
+ * \inheaderfile KTextEditor/DecorationLayer
+ *
+ * \brief One decorated span of text in a DecorationLayer.
+ *
+ * A decoration is bound to one line, \c attribute is the index of its attribute in
+ * DecorationLayer::attributes().
+ *
+ * \since 6.30
+ */
+struct Decoration {
+    int line = -1;
+    int column = -1;
+    int length = 0;
+    int attribute = -1;
+
+    friend bool operator==(const Decoration &, const Decoration &) = default;
+};
+
+/*!
+ * \class KTextEditor::DecorationLayer
+ * \inmodule KTextEditor
+ * \inheaderfile KTextEditor/DecorationLayer
+ *
+ * \brief A layer of many lightweight decorations of a Document, e.g. semantic tokens.
+ *
+ * \ingroup kte_group_moving_classes
+ *
+ * A DecorationLayer attributes lots of small spans of text at once. Unlike one
+ * MovingRange per span, the decorations of a layer are just packed values, they
+ * are moved along with the edits of the document lazily, once per revision,
+ * right before they are needed for rendering.
+ *
+ * Create a new DecorationLayer like this:
+ * \code
+ * std::unique_ptr<KTextEditor::DecorationLayer> layer(aDocument->newDecorationLayer());
+ * layer->setAttributes({keywordAttribute, typeAttribute});
+ * layer->setDecorations(tokens, revisionOfTokens);
+ * \endcode
+ *
+ * The ownership of the layer is passed to the user. When finished with a DecorationLayer,
+ * simply delete it.
+ *
+ * Decorations are painted above the syntax highlighting and below the attributes of
+ * MovingRange%s. On reload of the document all decorations are removed.
+ *
+ * \sa Document::newDecorationLayer()
+ * \since 6.30
+ */
+class KTEXTEDITOR_EXPORT DecorationLayer
+{
+public:
+    /*!
+     * Destruct the decoration layer, its decorations are removed from the document.
+     */
+    virtual ~DecorationLayer();
+
+    /*!
+     * Returns the document this layer belongs to, nullptr if the document was deleted.
+     */
+    virtual Document *document() const = 0;
+
+    /*!
+     * Set the attributes the decorations refer to by index.
+     * This will trigger a repaint of the decorated lines.
+     *
+     * \a attributes attributes of this layer
+     */
+    virtual void setAttributes(const QList<Attribute::Ptr> &attributes) = 0;
+
+    /*!
+     * Returns the attributes the decorations refer to by index.
+     */
+    virtual QList<Attribute::Ptr> attributes() const = 0;
+
+    /*!
+     * Replace all decorations of this layer.
+     * The decorations of one layer must not overlap, decorations without length are ignored.
+     *
+     * If the decorations were computed for an older revision, that revision must still be
+     * locked, see Document::lockRevision(). They are transformed to the current revision
+     * like ranges that don't expand, decorations that become empty are removed.
+     *
+     * \a decorations new decorations, in any order
+     *
+     * \a revision revision the decorations belong to, default of -1 is the current revision
+     *
+     */
+    virtual void setDecorations(const QList<Decoration> &decorations, qint64 revision = -1) = 0;
+
+    /*!
+     * Remove all decorations of this layer.
+     */
+    virtual void clear() = 0;
+
+    /*!
+     * Returns the decorations on the given \a line at the current revision, sorted by column.
+     */
+    virtual QList<Decoration> decorations(int line) const = 0;
+
+protected:
+    /*!
+     * For inherited class only.
+     */
+    DecorationLayer();
+
+public:
+    DecorationLayer(const DecorationLayer &) = delete;
+    DecorationLayer &operator=(const DecorationLayer &) = delete;
+};
+
+}
+
+#endif
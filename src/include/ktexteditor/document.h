@@ -14,6 +14,7 @@
 #include <ktexteditor/movingcursor.h>
 #include <ktexteditor/movingrange.h>
 #include <ktexteditor/range.h>
+#include <ktexteditor/textsnapshot.h>
 
 // our main baseclass of the KTextEditor::Document
 #include <KParts/ReadWritePart>
@@ -32,6 +33,7 @@ class MainWindow;
 class Message;
 class View;
 class AnnotationModel;
+class DecorationLayer;
 
 /*!
    \enum KTextEditor::SearchOption
@@ -1584,6 +1586,30 @@ public:
                                 qint64 fromRevision,
                                 qint64 toRevision = -1) = 0;
 
+    /*!
+     * Create a new decoration layer for this document, e.g. to show the semantic tokens
+     * of a language server without one MovingRange per token.
+     * Ownership of the layer that is returned belongs to the caller.
+     *
+     * Returns new decoration layer for the document
+     *
+     * \sa KTextEditor::DecorationLayer
+     * \since 6.30
+     */
+    DecorationLayer *newDecorationLayer();
+
+    /*!
+     * Take an immutable snapshot of the current text, e.g. to process it in another thread.
+     * Taking a snapshot is cheap, the snapshot shares the lines with the document,
+     * following edits only copy the lines around them.
+     *
+     * Returns snapshot of the text at the current revision()
+     *
+     * \sa KTextEditor::TextSnapshot
+     * \since 6.30
+     */
+    TextSnapshot snapshot() const;
+
 Q_SIGNALS:
 
 #if KTEXTEDITOR_ENABLE_DEPRECATED_SINCE(6, 9)
@@ -11,6 +11,7 @@
 #include <ktexteditor_export.h>
 
 #include <ktexteditor/inlinenote.h>
+#include <ktexteditor/linerange.h>
 
 namespace KTextEditor
 {
@@ -24,6 +25,9 @@ namespace KTextEditor
  * InlineNoteProvider is a object that can be queried for inline notes in the
  * view. It emits signals when the notes change and should be queried again.
  *
+ * Views cache the notes of a line and their sizes. Lines are only queried
+ * again after they were edited or the provider emitted one of its signals for them.
+ *
  * \sa KTextEditor::View
  * \since 5.50
  */
@@ -167,6 +171,17 @@ Q_SIGNALS:
      */
     void inlineNotesChanged(int line);
 
+    /*!
+     * The provider should emit the signal inlineNotesRangeChanged() whenever
+     * InlineNote%s on several lines changed, e.g. after new hints arrived
+     * for the visible part of the document.
+     *
+     * Unlike inlineNotesReset(), only the \a lineRange is queried again.
+     *
+     * \since 6.30
+     */
+    void inlineNotesRangeChanged(KTextEditor::LineRange lineRange);
+
 private:
     class InlineNoteProviderPrivate *const d = nullptr;
 };
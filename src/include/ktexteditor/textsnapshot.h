@@ -0,0 +1,116 @@
+/*
+    SPDX-FileCopyrightText: KDE Developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef KTEXTEDITOR_TEXTSNAPSHOT_H
+#define KTEXTEDITOR_TEXTSNAPSHOT_H
+
+#include <ktexteditor/cursor.h>
+#include <ktexteditor/range.h>
+#include <ktexteditor_export.h>
+
+#include <QString>
+
+#include <memory>
+
+namespace KTextEditor
+{
+class TextSnapshotPrivate;
+
+/*!
+ * \class KTextEditor::TextSnapshot
+ * \inmodule KTextEditor
+ * \inheaderfile KTextEditor/TextSnapshot
+ *
+ * \brief An immutable copy of the text of a Document at one revision.
+ *
+ * A snapshot shares the lines with the document, taking one is cheap and doesn't
+ * depend on the size of the document. Later edits of the document only copy the
+ * few lines around the change, the snapshot keeps the text it was taken with.
+ *
+ * Unlike the Document, a snapshot may be read from any thread, e.g. to search or
+ * analyze the text in the background without blocking the editing:
+ * \code
+ * const KTextEditor::TextSnapshot snapshot = aDocument->snapshot();
+ * QThreadPool::globalInstance()->start([snapshot]() {
+ *     for (int line = 0; line < snapshot.lines(); ++line) {
+ *         analyze(snapshot.line(line));
+ *     }
+ * });
+ * \endcode
+ *
+ * Copies of a snapshot are cheap, they share the same data. Results computed for a
+ * snapshot can be mapped to the current text with Document::transformRange() if the
+ * revision() was locked with Document::lockRevision() before.
+ *
+ * \sa Document::snapshot()
+ * \since 6.30
+ */
+class KTEXTEDITOR_EXPORT TextSnapshot
+{
+public:
+    /*!
+     * Construct an invalid snapshot without any lines.
+     */
+    TextSnapshot();
+
+    ~TextSnapshot();
+    TextSnapshot(const TextSnapshot &);
+    TextSnapshot(TextSnapshot &&) noexcept;
+    TextSnapshot &operator=(const TextSnapshot &);
+    TextSnapshot &operator=(TextSnapshot &&) noexcept;
+
+    /*!
+     * Returns true if this snapshot was taken from a document.
+     */
+    bool isValid() const;
+
+    /*!
+     * Returns the revision of the document this snapshot was taken at, -1 if invalid.
+     *
+     * \sa Document::revision()
+     */
+    qint64 revision() const;
+
+    /*!
+     * Returns the number of lines, a valid snapshot has at least one line.
+     */
+    int lines() const;
+
+    /*!
+     * Returns the length of the given \a line, -1 if there is no such line.
+     */
+    int lineLength(int line) const;
+
+    /*!
+     * Returns the text of the given \a line, an empty string if there is no such line.
+     */
+    QString line(int line) const;
+
+    /*!
+     * Returns the whole text, lines separated by '\n'.
+     */
+    QString text() const;
+
+    /*!
+     * Returns the text in the given \a range, lines separated by '\n'.
+     */
+    QString text(KTextEditor::Range range) const;
+
+    /*!
+     * Returns the end of the text, an invalid cursor if the snapshot is invalid.
+     */
+    KTextEditor::Cursor documentEnd() const;
+
+private:
+    friend class TextSnapshotPrivate;
+    explicit TextSnapshot(std::shared_ptr<const TextSnapshotPrivate> d);
+
+    std::shared_ptr<const TextSnapshotPrivate> d;
+};
+
+}
+
+#endif
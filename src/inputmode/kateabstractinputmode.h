@@ -71,6 +71,12 @@ public:
 
     virtual QString bookmarkLabel(int line) const = 0;
 
+    /**
+     * Search matches in \p line the renderer shall paint as an overlay, e.g. for vi hlsearch.
+     * Called during layout and painting of the line, must be cheap.
+     */
+    virtual QList<KTextEditor::Range> searchHighlightsForLine(int line) = 0;
+
     /* functions that are currently view private, but vi-mode needs to access them */
 public:
     void updateCursor(const KTextEditor::Cursor newCursor);
@@ -264,7 +264,10 @@ KateVi::EmulatedCommandBar *KateViInputMode::viModeEmulatedCommandBar()
 
 void KateViInputMode::updateRendererConfig()
 {
-    m_viModeManager->searcher()->updateHighlightColors();
+    // the hlsearch matches are painted by the renderer, only the match of the command bar has its own colors
+    if (m_viModeEmulatedCommandBar) {
+        m_viModeEmulatedCommandBar->updateMatchHighlightColors();
+    }
 }
 
 bool KateViInputMode::keyPress(QKeyEvent *e)
@@ -277,7 +280,10 @@ bool KateViInputMode::keyPress(QKeyEvent *e)
     }
 
     if (m_viModeManager->handleKeypress(e)) {
-        Q_EMIT view()->viewModeChanged(view(), viewMode());
+        // replayed batches emit this once at their end
+        if (!m_viModeManager->isExecutingBatch()) {
+            Q_EMIT view()->viewModeChanged(view(), viewMode());
+        }
         return true;
     }
 
@@ -309,6 +315,11 @@ QString KateViInputMode::bookmarkLabel(int line) const
     return m_viModeManager->marks()->getMarksOnTheLine(line);
 }
 
+QList<KTextEditor::Range> KateViInputMode::searchHighlightsForLine(int line)
+{
+    return m_viModeManager->searcher()->highlightsForLine(line);
+}
+
 void KateViInputMode::setCaretStyle(const KTextEditor::caretStyles caret)
 {
     if (m_caret != caret) {
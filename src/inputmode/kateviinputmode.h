@@ -67,6 +67,7 @@ public:
     void launchInteractiveCommand(const QString &command) override;
 
     QString bookmarkLabel(int line) const override;
+    QList<KTextEditor::Range> searchHighlightsForLine(int line) override;
 
 public:
     void showViModeEmulatedCommandBar();
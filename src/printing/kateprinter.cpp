@@ -15,6 +15,7 @@
 #include "kateview.h"
 
 #include <KConfigGroup>
+#include <KLocalizedString>
 #include <KSharedConfig>
 
 #include <QApplication>
@@ -23,6 +24,7 @@
 #include <QPrintDialog>
 #include <QPrintPreviewDialog>
 #include <QPrinter>
+#include <QProgressDialog>
 
 #include "printconfigwidgets.h"
 #include "printpainter.h"
@@ -124,9 +126,18 @@ static bool print(KTextEditor::DocumentPrivate *doc, KTextEditor::ViewPrivate *v
     painter.setFooterFormat(kphf->footerFormat());
 
     delete printDialog;
-    painter.paint(printer);
 
-    return true;
+    // keep the application responsive while printing many pages, the progress only shows up if it takes a while
+    QProgressDialog progress(i18n("Printing %1…", doc->documentName()), i18n("Cancel"), 0, 0, parentWidget);
+    progress.setWindowModality(Qt::WindowModal);
+    progress.setMinimumDuration(1000);
+    painter.paint(printer, [&progress](int printedPages, int pages) {
+        progress.setMaximum(pages);
+        progress.setValue(printedPages);
+        return !progress.wasCanceled();
+    });
+
+    return !progress.wasCanceled();
 }
 
 // END KatePrinterPrivate
@@ -150,10 +161,11 @@ bool KatePrinter::printPreview(KTextEditor::DocumentPrivate *doc, KTextEditor::V
         preview.resize(dialogParent->window()->size() * 0.75);
     }
 
-    QObject::connect(&preview, &QPrintPreviewDialog::paintRequested, &preview, [doc, view](QPrinter *printer) {
-        PrintPainter p(doc, view);
-        p.setColorScheme(QStringLiteral("Printing"));
-        p.paint(printer);
+    // one painter for all requests, it keeps the page breaks as long as the page setup doesn't change
+    PrintPainter painter(doc, view);
+    painter.setColorScheme(QStringLiteral("Printing"));
+    QObject::connect(&preview, &QPrintPreviewDialog::paintRequested, &preview, [&painter](QPrinter *printer) {
+        painter.paint(printer);
     });
     return preview.exec();
 }
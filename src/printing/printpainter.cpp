@@ -22,47 +22,17 @@
 #include <KUser>
 
 #include <QPainter>
+#include <QPicture>
 #include <QPrinter>
 
 using namespace KatePrinter;
 
-class KatePrinter::PageLayout
-{
-public:
-    PageLayout()
-        : headerTagList()
-        , footerTagList()
-        , selectionRange()
-    {
-    }
-
-    uint pageWidth = 0;
-    uint pageHeight = 0;
-    uint headerWidth = 0;
-    uint maxWidth = 0;
-    uint maxHeight = 0;
-    int xstart = 0; // beginning point for painting lines
-    int innerMargin = 0;
-
-    bool selectionOnly = false;
-
-    uint firstline = 0;
-    uint lastline = 0;
-
-    // Header/Footer Page
-    uint headerHeight = 0;
-    QStringList headerTagList;
-    uint footerHeight = 0;
-    QStringList footerTagList;
-
-    KTextEditor::Range selectionRange;
-};
-
 PrintPainter::PrintPainter(KTextEditor::DocumentPrivate *doc, KTextEditor::ViewPrivate *view)
     : m_view(view)
     , m_doc(doc)
     , m_printGuide(false)
     , m_printLineNumbers(false)
+    , m_dontPrintFoldedCode(false)
     , m_useHeader(false)
     , m_useFooter(false)
     , m_useBackground(false)
@@ -94,6 +64,9 @@ PrintPainter::~PrintPainter()
 void PrintPainter::setTextFont(const QFont &font)
 {
     m_renderer->config()->setFont(font);
+
+    // changed font requires cache updates
+    updateCache();
 }
 
 void PrintPainter::setUseBox(const bool on)
@@ -160,56 +133,179 @@ void PrintPainter::setColorScheme(const QString &scheme)
 void PrintPainter::updateCache()
 {
     m_fontHeight = m_renderer->fontHeight();
+    m_maxCharWidth = m_renderer->currentFontMetrics().maxWidth();
 
     // figure out the horizontal space required
     QString s = QStringLiteral("%1 ").arg(m_doc->lines());
     s.fill(QLatin1Char('5'), -1); // some non-fixed fonts haven't equally wide numbers
     // FIXME calculate which is actually the widest...
     m_lineNumberWidth = m_renderer->currentFontMetrics().boundingRect(s).width();
+
+    // other metrics, other page breaks
+    m_viewLineCounts.clear();
+    m_pages.clear();
 }
 
-void PrintPainter::paint(QPrinter *printer) const
+void PrintPainter::paint(QPrinter *printer, const ProgressCallback &progress) const
 {
-    QPainter painter(printer);
     PageLayout pl;
-
     configure(printer, pl);
 
-    uint lineCount = pl.firstline;
+    // page breaks first, without painting anything
+    const QList<PageStart> &pages = paginate(pl);
+    const int totalPages = pages.size();
+
+    substitutePageCount(pl, totalPages);
+
+    const int firstPage = qMax(printer->fromPage(), 1);
+    const int lastPage = (printer->toPage() > 0) ? qMin(printer->toPage(), totalPages) : totalPages;
+
+    // lay out and paint only the requested pages
+    QPainter painter(printer);
+    for (int page = firstPage; page <= lastPage; ++page) {
+        if (page > firstPage) {
+            printer->newPage();
+            painter.resetTransform();
+        }
+
+        qCDebug(LOG_KTE) << "Painting page" << page << "of" << totalPages << "starting with line" << pages[page - 1].line;
+        paintPage(painter, page, pages[page - 1], pl);
+
+        if (progress && !progress(page - firstPage + 1, lastPage - firstPage + 1)) {
+            printer->abort();
+            break;
+        }
+    }
+
+    painter.end();
+}
+
+void PrintPainter::substitutePageCount(PageLayout &pl, const int pages) const
+{
+    // now that we know the total number of pages, substitute "%P" in both tag lists
+    const QString re(QStringLiteral("%P"));
+    for (QString &tag : pl.headerTagList) {
+        tag.replace(re, QString::number(pages));
+    }
+    for (QString &tag : pl.footerTagList) {
+        tag.replace(re, QString::number(pages));
+    }
+}
+
+bool PrintPainter::skipLine(const uint line) const
+{
+    return m_dontPrintFoldedCode && !m_renderer->folding().isLineVisible(line);
+}
+
+uint PrintPainter::contentTop(const uint page, const PageLayout &pl) const
+{
+    // header, box and guide are all fixed height, paint them once into nothing to know where the text starts
+    QPicture picture;
+    QPainter painter(&picture);
     uint y = 0;
-    uint currentPage = (printer->fromPage() == 0) ? 1 : printer->fromPage();
-    bool pageStarted = true;
-    uint remainder = 0;
+    paintNewPage(painter, page, y, pl);
+    return y;
+}
 
-    auto &f = m_renderer->folding();
+uint PrintPainter::viewLineCount(const uint line, const PageLayout &pl) const
+{
+    const auto it = m_viewLineCounts.constFind(line);
+    if (it != m_viewLineCounts.cend()) {
+        return it.value();
+    }
 
-    // On to draw something :-)
-    while (lineCount <= pl.lastline) {
+    // lines that are short even with the widest glyphs for all characters can't wrap, no need to lay them out
+    // the factor of two leaves room for bold and italic attributes
+    const Kate::TextLine textLine = m_renderer->doc()->plainKateTextLine(line);
+    if (qint64(textLine.virtualLength(m_renderer->doc()->config()->tabWidth())) * m_maxCharWidth * 2 <= pl.maxWidth) {
+        return 1;
+    }
+
+    KateLineLayout rangeptr;
+    rangeptr.setLine(m_renderer->folding(), line);
+    m_renderer->layoutLine(m_renderer->doc()->kateTextLine(rangeptr.line()), &rangeptr, (int)pl.maxWidth, false);
+    const uint count = rangeptr.viewLineCount();
+    m_viewLineCounts.insert(line, count);
+    return count;
+}
+
+const QList<PrintPainter::PageStart> &PrintPainter::paginate(const PageLayout &pl) const
+{
+    PaginationKey key;
+    key.maxWidth = pl.maxWidth;
+    key.maxHeight = pl.maxHeight;
+    key.firstline = pl.firstline;
+    key.lastline = pl.lastline;
+    key.firstPageTop = contentTop(1, pl);
+    key.pageTop = contentTop(2, pl);
+    key.fontHeight = m_fontHeight;
+    key.dontPrintFoldedCode = m_dontPrintFoldedCode;
+    key.revision = m_doc->revision();
+
+    if (key == m_paginationKey && !m_pages.isEmpty()) {
+        return m_pages;
+    }
+
+    // view line counts stay valid as long as the width and the text are the same
+    if (key.maxWidth != m_paginationKey.maxWidth || key.fontHeight != m_paginationKey.fontHeight || key.revision != m_paginationKey.revision) {
+        m_viewLineCounts.clear();
+    }
+    m_paginationKey = key;
+    m_pages.clear();
+
+    // same steps as painting, see paintPage() and paintLine()
+    uint line = pl.firstline;
+    uint y = key.firstPageTop;
+    uint remainder = 0;
+    m_pages.append({line, remainder});
+    while (line <= pl.lastline) {
         if (y + m_fontHeight > pl.maxHeight) {
-            if ((int)currentPage == printer->toPage()) { // we've reached the page break of last page to be printed
+            // not even one line fits on a page, give up instead of adding empty pages forever
+            if (key.pageTop + m_fontHeight > pl.maxHeight) {
                 break;
             }
-            printer->newPage();
-            painter.resetTransform();
-            currentPage++;
-            pageStarted = true;
-            y = 0;
+            m_pages.append({line, remainder});
+            y = key.pageTop;
+        }
+
+        if (!skipLine(line)) {
+            const uint lines = viewLineCount(line, pl);
+            uint proceedLines = lines;
+            if (remainder) {
+                proceedLines = qMin((pl.maxHeight - y) / m_fontHeight, remainder);
+                remainder -= proceedLines;
+            } else if (y + m_fontHeight * lines > pl.maxHeight) {
+                remainder = lines - ((pl.maxHeight - y) / m_fontHeight);
+            }
+            y += m_fontHeight * proceedLines;
         }
 
-        if (pageStarted) {
-            qCDebug(LOG_KTE) << "Starting new page," << lineCount << "lines up to now.";
-            paintNewPage(painter, currentPage, y, pl);
-            pageStarted = false;
-            painter.translate(pl.xstart, y);
+        if (!remainder) {
+            line++;
         }
+    }
+
+    return m_pages;
+}
 
-        const bool skipLine = m_dontPrintFoldedCode && !f.isLineVisible(lineCount);
+void PrintPainter::paintPage(QPainter &painter, const uint page, const PageStart &start, const PageLayout &pl) const
+{
+    uint lineCount = start.line;
+    uint remainder = start.remainder;
+    uint y = 0;
+
+    paintNewPage(painter, page, y, pl);
+    painter.translate(pl.xstart, y);
+
+    // On to draw something :-)
+    while (lineCount <= pl.lastline && y + m_fontHeight <= pl.maxHeight) {
+        const bool skip = skipLine(lineCount);
 
-        if (!skipLine && m_printLineNumbers /*&& ! startCol*/) { // don't repeat!
+        if (!skip && m_printLineNumbers /*&& ! startCol*/) { // don't repeat!
             paintLineNumber(painter, lineCount, pl);
         }
 
-        if (!skipLine) {
+        if (!skip) {
             paintLine(painter, lineCount, y, remainder, pl);
         }
 
@@ -217,8 +313,6 @@ void PrintPainter::paint(QPrinter *printer) const
             lineCount++;
         }
     }
-
-    painter.end();
 }
 
 void PrintPainter::configure(const QPrinter *printer, PageLayout &pl) const
@@ -340,55 +434,6 @@ void PrintPainter::configure(const QPrinter *printer, PageLayout &pl) const
         // maxheight too..
         pl.maxHeight -= m_boxWidth;
     }
-
-    int pageHeight = pl.maxHeight;
-    if (m_useHeader) {
-        pageHeight -= pl.headerHeight + pl.innerMargin;
-    }
-    if (m_useFooter) {
-        pageHeight -= pl.footerHeight + pl.innerMargin;
-    }
-
-    const int linesPerPage = pageHeight / m_fontHeight;
-
-    if (printer->fromPage() > 0) {
-        pl.firstline = (printer->fromPage() - 1) * linesPerPage;
-    }
-
-    // now that we know the vertical amount of space needed,
-    // it is possible to calculate the total number of pages
-    // if needed, that is if any header/footer tag contains "%P".
-    if (!pl.headerTagList.filter(QStringLiteral("%P")).isEmpty() || !pl.footerTagList.filter(QStringLiteral("%P")).isEmpty()) {
-        qCDebug(LOG_KTE) << "'%P' found! calculating number of pages...";
-
-        // calculate total layouted lines in the document
-        int totalLines = 0;
-        // TODO: right now ignores selection printing
-        for (unsigned int i = pl.firstline; i <= pl.lastline; ++i) {
-            KateLineLayout rangeptr;
-            rangeptr.setLine(m_renderer->folding(), i);
-            m_renderer->layoutLine(m_renderer->doc()->kateTextLine(rangeptr.line()), &rangeptr, (int)pl.maxWidth, false);
-            totalLines += rangeptr.viewLineCount();
-        }
-
-        const int totalPages = (totalLines / linesPerPage) + ((totalLines % linesPerPage) > 0 ? 1 : 0);
-
-        // TODO: add space for guide if required
-        //         if ( useGuide )
-        //           _lt += (guideHeight + (fontHeight /2)) / fontHeight;
-
-        // substitute both tag lists
-        QString re(QStringLiteral("%P"));
-        QStringList::Iterator it;
-
-        for (it = pl.headerTagList.begin(); it != pl.headerTagList.end(); ++it) {
-            it->replace(re, QString::number(totalPages));
-        }
-
-        for (it = pl.footerTagList.begin(); it != pl.footerTagList.end(); ++it) {
-            (*it).replace(re, QString::number(totalPages));
-        }
-    }
 }
 
 void PrintPainter::paintNewPage(QPainter &painter, const uint currentPage, uint &y, const PageLayout &pl) const
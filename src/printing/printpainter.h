@@ -10,9 +10,17 @@
 #ifndef KATE_PRINT_PAINTER_H
 #define KATE_PRINT_PAINTER_H
 
+#include <ktexteditor/range.h>
+#include <ktexteditor_export.h>
+
 #include <QColor>
 #include <QFont>
+#include <QHash>
+#include <QList>
 #include <QString>
+#include <QStringList>
+
+#include <functional>
 
 namespace KTextEditor
 {
@@ -22,6 +30,7 @@ class ViewPrivate;
 
 class QPrinter;
 class QPainter;
+class PrintPainterTest;
 
 class KateRenderer;
 
@@ -29,17 +38,37 @@ namespace Kate
 {
 class TextFolding;
 }
-namespace KTextEditor
-{
-class Range;
-}
-
 namespace KatePrinter
 {
-class PageLayout;
+class PageLayout
+{
+public:
+    uint pageWidth = 0;
+    uint pageHeight = 0;
+    uint headerWidth = 0;
+    uint maxWidth = 0;
+    uint maxHeight = 0;
+    int xstart = 0; // beginning point for painting lines
+    int innerMargin = 0;
+
+    bool selectionOnly = false;
+
+    uint firstline = 0;
+    uint lastline = 0;
+
+    // Header/Footer Page
+    uint headerHeight = 0;
+    QStringList headerTagList;
+    uint footerHeight = 0;
+    QStringList footerTagList;
+
+    KTextEditor::Range selectionRange;
+};
 
-class PrintPainter
+class KTEXTEDITOR_EXPORT PrintPainter
 {
+    friend class ::PrintPainterTest;
+
 public:
     PrintPainter(KTextEditor::DocumentPrivate *doc, KTextEditor::ViewPrivate *view);
     ~PrintPainter();
@@ -47,7 +76,18 @@ public:
     PrintPainter(const PrintPainter &) = delete;
     PrintPainter &operator=(const PrintPainter &) = delete;
 
-    void paint(QPrinter *printer) const;
+    /**
+     * Called after each printed page, return false to abort printing.
+     */
+    using ProgressCallback = std::function<bool(int printedPages, int pages)>;
+
+    /**
+     * Paint the pages of the printer's page range. The document is paginated first
+     * without painting anything, then only the requested pages are laid out and painted.
+     * The pagination is kept as long as the page geometry and the document don't change,
+     * so painting again, e.g. for the print preview, doesn't need to lay out all lines again.
+     */
+    void paint(QPrinter *printer, const ProgressCallback &progress = ProgressCallback()) const;
 
     // Attributes
     void setColorScheme(const QString &scheme);
@@ -113,6 +153,39 @@ public:
     }
 
 private:
+    /// first line of a page and how many of its view lines are still to print, 0 if the whole line
+    struct PageStart {
+        uint line;
+        uint remainder;
+    };
+
+    /// everything the page breaks depend on
+    struct PaginationKey {
+        uint maxWidth = 0;
+        uint maxHeight = 0;
+        uint firstline = 0;
+        uint lastline = 0;
+        uint firstPageTop = 0;
+        uint pageTop = 0;
+        int fontHeight = 0;
+        bool dontPrintFoldedCode = false;
+        qint64 revision = -1;
+
+        bool operator==(const PaginationKey &other) const
+        {
+            return maxWidth == other.maxWidth && maxHeight == other.maxHeight && firstline == other.firstline && lastline == other.lastline
+                && firstPageTop == other.firstPageTop && pageTop == other.pageTop && fontHeight == other.fontHeight
+                && dontPrintFoldedCode == other.dontPrintFoldedCode && revision == other.revision;
+        }
+    };
+
+    const QList<PageStart> &paginate(const PageLayout &pl) const;
+    void substitutePageCount(PageLayout &pl, const int pages) const;
+    uint contentTop(const uint page, const PageLayout &pl) const;
+    uint viewLineCount(const uint line, const PageLayout &pl) const;
+    bool skipLine(const uint line) const;
+    void paintPage(QPainter &painter, const uint page, const PageStart &start, const PageLayout &pl) const;
+
     void paintLineNumber(QPainter &painter, const uint number, const PageLayout &pl) const;
     void paintLine(QPainter &painter, const uint line, uint &y, uint &remainder, const PageLayout &pl) const;
     void paintNewPage(QPainter &painter, const uint currentPage, uint &y, const PageLayout &pl) const;
@@ -159,7 +232,13 @@ private:
     KateRenderer *m_renderer;
 
     int m_fontHeight;
+    int m_maxCharWidth;
     uint m_lineNumberWidth;
+
+    /* Pagination cache */
+    mutable PaginationKey m_paginationKey;
+    mutable QList<PageStart> m_pages;
+    mutable QHash<uint, uint> m_viewLineCounts;
 };
 
 }
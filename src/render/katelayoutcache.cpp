@@ -242,6 +242,7 @@ void KateLayoutCache::updateViewCache(const KTextEditor::Cursor startPos, int ne
 KateLineLayout *KateLayoutCache::line(int realLine, int virtualLine)
 {
     if (auto l = m_lineLayouts.find(realLine)) {
+        KATE_PERF_COUNT(m_renderer->view()->perfCounters(), "layout cache hits", 1);
         // ensure line is OK
         Q_ASSERT(l->line() == realLine);
         Q_ASSERT(realLine < m_renderer->doc()->lines());
@@ -253,8 +254,11 @@ KateLineLayout *KateLayoutCache::line(int realLine, int virtualLine)
         const Kate::TextLine textLine = acceptDirtyLayouts() ? m_renderer->doc()->plainKateTextLine(l->line()) : m_renderer->doc()->kateTextLine(l->line());
 
         if (l->layout().lineCount() <= 0) {
-            m_renderer->layoutLine(textLine, l, wrap() ? m_viewWidth : -1, enableLayoutCache);
+            layoutLine(textLine, l);
         } else if (l->layoutDirty && !acceptDirtyLayouts()) {
+            layoutLine(textLine, l);
+        } else if (enableLayoutCache && l->isGeometryOnly()) {
+            // we want to paint it now
             m_renderer->layoutLine(textLine, l, wrap() ? m_viewWidth : -1, enableLayoutCache);
         }
 
@@ -267,6 +271,8 @@ KateLineLayout *KateLayoutCache::line(int realLine, int virtualLine)
         return nullptr;
     }
 
+    KATE_PERF_COUNT(m_renderer->view()->perfCounters(), "layout cache misses", 1);
+
     void *memory = m_allocator.allocate(sizeof(KateLineLayout), alignof(KateLineLayout));
     auto *l = new (memory) KateLineLayout;
 
@@ -274,7 +280,7 @@ KateLineLayout *KateLayoutCache::line(int realLine, int virtualLine)
 
     // because it may not have the syntax highlighting applied, allow layoutLine to use plainLines...
     const Kate::TextLine textLine = acceptDirtyLayouts() ? m_renderer->doc()->plainKateTextLine(l->line()) : m_renderer->doc()->kateTextLine(l->line());
-    m_renderer->layoutLine(textLine, l, wrap() ? m_viewWidth : -1, enableLayoutCache);
+    layoutLine(textLine, l);
     Q_ASSERT(l->isValid());
 
     if (acceptDirtyLayouts()) {
@@ -286,6 +292,32 @@ KateLineLayout *KateLayoutCache::line(int realLine, int virtualLine)
     return l;
 }
 
+void KateLayoutCache::layoutLine(const Kate::TextLine &textLine, KateLineLayout *l)
+{
+    // lines outside of the view are only needed for geometry queries, e.g. by cursor movement
+    // lines inside might get painted before the next view cache update, they always get a real layout
+    if (!enableLayoutCache && !inViewCache(l->line()) && m_renderer->layoutLineGeometry(textLine, l, wrap() ? m_viewWidth : -1)) {
+        return;
+    }
+
+    m_renderer->layoutLine(textLine, l, wrap() ? m_viewWidth : -1, enableLayoutCache);
+}
+
+bool KateLayoutCache::inViewCache(int realLine) const
+{
+    const auto first = std::find_if(m_textLayouts.begin(), m_textLayouts.end(), [](const KateTextLayout &l) {
+        return l.isValid();
+    });
+    if (first == m_textLayouts.end()) {
+        return false;
+    }
+
+    const auto last = std::find_if(m_textLayouts.rbegin(), m_textLayouts.rend(), [](const KateTextLayout &l) {
+        return l.isValid();
+    });
+    return first->line() <= realLine && realLine <= last->line();
+}
+
 KateTextLayout KateLayoutCache::textLayout(const KTextEditor::Cursor realCursor)
 {
     return textLayout(realCursor.line(), viewLine(realCursor));
@@ -506,6 +538,19 @@ void KateLayoutCache::relayoutLines(int startRealLine, int endRealLine)
     m_lineLayouts.relayoutLines(startRealLine, endRealLine);
 }
 
+bool KateLayoutCache::relayoutLongLines(int startX, int endX)
+{
+    bool relayout = false;
+    for (const auto &textLayout : m_textLayouts) {
+        KateLineLayout *l = textLayout.kateLineLayout();
+        if (l && l->isWindowed() && !l->layoutDirty && !l->windowCovers(startX, endX)) {
+            l->layoutDirty = true;
+            relayout = true;
+        }
+    }
+    return relayout;
+}
+
 bool KateLayoutCache::acceptDirtyLayouts() const
 {
     return m_acceptDirtyLayouts;
@@ -16,6 +16,11 @@
 
 class KateRenderer;
 
+namespace Kate
+{
+class TextLine;
+}
+
 class KateLineLayoutMap
 {
 public:
@@ -28,6 +33,13 @@ public:
 
     void relayoutLines(int startRealLine, int endRealLine);
 
+    /**
+     * Mark the long lines of the view cache as dirty that did not lay out the
+     * x range [startX, endX], see KateLineLayout::isWindowed().
+     * @return true, if any line needs a new layout
+     */
+    bool relayoutLongLines(int startX, int endX);
+
     void slotEditDone(KateRenderer *renderer, int fromLine, int toLine, int shiftAmount, std::vector<KateTextLayout> &textLayouts);
 
     KateLineLayout *find(int i);
@@ -129,6 +141,10 @@ public:
     // END
 
 private:
+    // lays out the line, without shaping if we can, see KateRenderer::layoutLineGeometry()
+    void layoutLine(const Kate::TextLine &textLine, KateLineLayout *l);
+    bool inViewCache(int realLine) const;
+
     void wrapLine(KTextEditor::Document *, const KTextEditor::Cursor position);
     void unwrapLine(KTextEditor::Document *, int line);
     void insertText(KTextEditor::Document *, const KTextEditor::Cursor position, const QString &text);
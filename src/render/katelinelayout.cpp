@@ -13,9 +13,147 @@
 
 #include "katepartdebug.h"
 
+#include <algorithm>
+#include <cmath>
+
+KateLineMetrics::KateLineMetrics(const QString &text, const QFontMetricsF &fontMetrics, qreal tabStopDistance)
+    : m_text(text)
+    , m_fontMetrics(fontMetrics)
+    , m_tabStopDistance(tabStopDistance > 0 ? tabStopDistance : 80)
+{
+    for (size_t c = 0; c < m_asciiAdvances.size(); ++c) {
+        m_asciiAdvances[c] = m_fontMetrics.horizontalAdvance(QChar(char16_t(c)));
+    }
+
+    // the checkpoints are computed on demand, a window at the start of the line doesn't walk the rest
+    m_checkpoints.push_back(0);
+}
+
+bool KateLineMetrics::isFor(const QString &text, const QFontMetricsF &fontMetrics, qreal tabStopDistance) const
+{
+    // an unchanged line still shares its data with us, no need to compare the text
+    return m_text.constData() == text.constData() && m_text.size() == text.size() && m_fontMetrics == fontMetrics
+        && m_tabStopDistance == (tabStopDistance > 0 ? tabStopDistance : 80);
+}
+
+qreal KateLineMetrics::width() const
+{
+    return cursorToX(length());
+}
+
+void KateLineMetrics::computeCheckpoint(int checkpoint) const
+{
+    while (int(m_checkpoints.size()) <= checkpoint) {
+        const int start = (int(m_checkpoints.size()) - 1) * CheckpointDistance;
+        const int end = std::min(start + CheckpointDistance, length());
+        qreal x = m_checkpoints.back();
+        for (int column = start; column < end; ++column) {
+            x += advance(column, x);
+        }
+        m_checkpoints.push_back(x);
+    }
+}
+
+qreal KateLineMetrics::advance(int column, qreal x) const
+{
+    const QChar c = m_text.at(column);
+    if (c.unicode() < m_asciiAdvances.size()) {
+        if (c == QLatin1Char('\t')) {
+            return (std::floor(x / m_tabStopDistance) + 1) * m_tabStopDistance - x;
+        }
+        return m_asciiAdvances[c.unicode()];
+    }
+
+    if (!isCursorPosition(column)) {
+        // combining marks and the second half of surrogate pairs take no extra space
+        return 0;
+    }
+
+    if (c.isHighSurrogate() && column + 1 < m_text.size()) {
+        return m_fontMetrics.horizontalAdvance(m_text.mid(column, 2));
+    }
+    return m_fontMetrics.horizontalAdvance(c);
+}
+
+qreal KateLineMetrics::cursorToX(int column) const
+{
+    column = qBound(0, column, length());
+    int i = column / CheckpointDistance;
+    computeCheckpoint(i);
+    qreal x = m_checkpoints[i];
+    for (i *= CheckpointDistance; i < column; ++i) {
+        x += advance(i, x);
+    }
+    return x;
+}
+
+int KateLineMetrics::xToCursor(qreal x) const
+{
+    if (x <= 0) {
+        return 0;
+    }
+
+    // walk only up to the first checkpoint behind x
+    const int lastCheckpoint = length() / CheckpointDistance;
+    while (m_checkpoints.back() <= x && int(m_checkpoints.size()) <= lastCheckpoint) {
+        computeCheckpoint(int(m_checkpoints.size()));
+    }
+
+    const auto it = std::upper_bound(m_checkpoints.begin(), m_checkpoints.end(), x);
+    const int checkpoint = std::max(0, int(std::distance(m_checkpoints.begin(), it)) - 1);
+    int column = checkpoint * CheckpointDistance;
+    qreal columnX = m_checkpoints[checkpoint];
+    while (column < length()) {
+        // like QTextLine::xToCursor, snap to the nearest character boundary
+        const qreal columnAdvance = advance(column, columnX);
+        if (x < columnX + columnAdvance / 2) {
+            break;
+        }
+        columnX += columnAdvance;
+        ++column;
+    }
+
+    while (!isCursorPosition(column)) {
+        --column;
+    }
+    return column;
+}
+
+bool KateLineMetrics::isCursorPosition(int column) const
+{
+    if (column <= 0 || column >= length()) {
+        return true;
+    }
+
+    const QChar c = m_text.at(column);
+    if (c.isLowSurrogate() && m_text.at(column - 1).isHighSurrogate()) {
+        return false;
+    }
+    return !c.isMark();
+}
+
+int KateLineMetrics::nextCursorPosition(int column) const
+{
+    column = qBound(0, column + 1, length());
+    while (!isCursorPosition(column)) {
+        ++column;
+    }
+    return column;
+}
+
+int KateLineMetrics::previousCursorPosition(int column) const
+{
+    column = qBound(0, column - 1, length());
+    while (!isCursorPosition(column)) {
+        --column;
+    }
+    return column;
+}
+
 KateLineLayout::KateLineLayout()
     : m_line(-1)
     , m_virtualLine(-1)
+    , m_layout(std::make_shared<QTextLayout>())
 {
 }
 
@@ -24,8 +162,13 @@ void KateLineLayout::clear()
     m_line = -1;
     m_virtualLine = -1;
     shiftX = 0;
+    resetWindow();
     // not touching dirty
-    m_layout.clearLayout();
+    if (m_layout.use_count() > 1) {
+        m_layout = std::make_shared<QTextLayout>();
+    } else {
+        m_layout->clearLayout();
+    }
     // not touching layout dirty
 }
 
@@ -69,18 +212,104 @@ bool KateLineLayout::isValid() const
     return line() != -1 && layout().lineCount() > 0;
 }
 
+QTextLayout &KateLineLayout::modifiableLayout()
+{
+    // never modify a layout others still look at
+    if (m_layout.use_count() > 1) {
+        m_layout = std::make_shared<QTextLayout>();
+    }
+    return *m_layout;
+}
+
 void KateLineLayout::endLayout()
 {
-    m_layout.endLayout();
-    layoutDirty = m_layout.lineCount() <= 0;
+    resetWindow();
+    m_layout->endLayout();
+    layoutDirty = m_layout->lineCount() <= 0;
     m_dirtyList.clear();
-    if (m_layout.lineCount() > 0) {
-        for (int i = 0; i < qMax(1, m_layout.lineCount()); ++i) {
+    if (m_layout->lineCount() > 0) {
+        for (int i = 0; i < qMax(1, m_layout->lineCount()); ++i) {
             m_dirtyList.append(true);
         }
     }
 }
 
+void KateLineLayout::adoptLayout(std::shared_ptr<QTextLayout> layout)
+{
+    Q_ASSERT(layout);
+    resetWindow();
+    m_layout = std::move(layout);
+    layoutDirty = m_layout->lineCount() <= 0;
+    m_dirtyList.clear();
+    if (m_layout->lineCount() > 0) {
+        m_dirtyList.fill(true, m_layout->lineCount());
+    }
+}
+
+void KateLineLayout::setWindow(std::unique_ptr<KateLineMetrics> metrics, int start, int end)
+{
+    Q_ASSERT(metrics && 0 <= start && start <= end && end <= metrics->length());
+    Q_ASSERT(m_layout->text().size() == end - start);
+    m_metrics = std::move(metrics);
+    m_windowStart = start;
+    m_windowEnd = end;
+}
+
+void KateLineLayout::setGeometryOnly(std::unique_ptr<KateLineMetrics> metrics)
+{
+    setWindow(std::move(metrics), 0, 0);
+    m_geometryOnly = true;
+}
+
+std::unique_ptr<KateLineMetrics> KateLineLayout::takeMetrics()
+{
+    auto metrics = std::move(m_metrics);
+    resetWindow();
+    return metrics;
+}
+
+void KateLineLayout::resetWindow()
+{
+    m_metrics.reset();
+    m_windowStart = 0;
+    m_windowEnd = 0;
+    m_geometryOnly = false;
+}
+
+bool KateLineLayout::windowCovers(int startX, int endX) const
+{
+    if (!isWindowed()) {
+        return true;
+    }
+
+    // nothing to lay out left of the line, right of it only if the window ends before the line end
+    startX = qMax(startX, 0);
+    return (m_windowStart == 0 || m_metrics->cursorToX(m_windowStart) <= startX)
+        && (m_windowEnd == m_metrics->length() || m_metrics->cursorToX(m_windowEnd) >= endX);
+}
+
+int KateLineLayout::nextCursorPosition(int column) const
+{
+    if (!isWindowed()) {
+        return m_layout->nextCursorPosition(column);
+    }
+    if (column < m_windowStart || column >= m_windowEnd) {
+        return m_metrics->nextCursorPosition(column);
+    }
+    return m_layout->nextCursorPosition(column - m_windowStart) + m_windowStart;
+}
+
+int KateLineLayout::previousCursorPosition(int column) const
+{
+    if (!isWindowed()) {
+        return m_layout->previousCursorPosition(column);
+    }
+    if (column <= m_windowStart || column > m_windowEnd) {
+        return m_metrics->previousCursorPosition(column);
+    }
+    return m_layout->previousCursorPosition(column - m_windowStart) + m_windowStart;
+}
+
 void KateLineLayout::invalidateLayout()
 {
     layoutDirty = true;
@@ -107,7 +336,7 @@ KTextEditor::Cursor KateLineLayout::start() const
 
 int KateLineLayout::viewLineCount() const
 {
-    return m_layout.lineCount();
+    return m_layout->lineCount();
 }
 
 KateTextLayout KateLineLayout::viewLine(int viewLine)
@@ -122,10 +351,14 @@ KateTextLayout KateLineLayout::viewLine(int viewLine)
 
 int KateLineLayout::width() const
 {
+    if (isWindowed()) {
+        return (int)m_metrics->width();
+    }
+
     int width = 0;
 
-    for (int i = 0; i < m_layout.lineCount(); ++i) {
-        width = qMax((int)m_layout.lineAt(i).naturalTextWidth(), width);
+    for (int i = 0; i < m_layout->lineCount(); ++i) {
+        width = qMax((int)m_layout->lineAt(i).naturalTextWidth(), width);
     }
 
     return width;
@@ -147,8 +380,8 @@ int KateLineLayout::viewLineForColumn(int column) const
 {
     int len = 0;
     int i = 0;
-    for (; i < m_layout.lineCount() - 1; ++i) {
-        len += m_layout.lineAt(i).textLength();
+    for (; i < m_layout->lineCount() - 1; ++i) {
+        len += m_layout->lineAt(i).textLength();
         if (column < len) {
             return i;
         }
@@ -158,5 +391,5 @@ int KateLineLayout::viewLineForColumn(int column) const
 
 bool KateLineLayout::isRightToLeft() const
 {
-    return m_layout.textOption().textDirection() == Qt::RightToLeft;
+    return m_layout->textOption().textDirection() == Qt::RightToLeft;
 }
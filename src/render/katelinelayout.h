@@ -8,10 +8,15 @@
 #ifndef _KATE_LINELAYOUT_H_
 #define _KATE_LINELAYOUT_H_
 
+#include <QFontMetricsF>
 #include <QTextLayout>
 
 #include <ktexteditor/cursor.h>
 
+#include <array>
+#include <memory>
+#include <vector>
+
 namespace KTextEditor
 {
 class DocumentPrivate;
@@ -23,6 +28,53 @@ class TextFolding;
 class KateTextLayout;
 class KateRenderer;
 
+/**
+ * Geometry of a single unwrapped left-to-right line computed from font metrics
+ * instead of shaping it. Used for very long lines, where only a window around the
+ * visible area is laid out, see KateRenderer::layoutLine().
+ */
+class KateLineMetrics
+{
+public:
+    KateLineMetrics(const QString &text, const QFontMetricsF &fontMetrics, qreal tabStopDistance);
+
+    /**
+     * Are these the metrics of the given unchanged line text?
+     * Allows to keep them over new layouts of the line, e.g. after horizontal scrolling.
+     */
+    bool isFor(const QString &text, const QFontMetricsF &fontMetrics, qreal tabStopDistance) const;
+
+    int length() const
+    {
+        return m_text.size();
+    }
+
+    // walks the whole line the first time it is called
+    qreal width() const;
+
+    qreal cursorToX(int column) const;
+    int xToCursor(qreal x) const;
+
+    bool isCursorPosition(int column) const;
+    int nextCursorPosition(int column) const;
+    int previousCursorPosition(int column) const;
+
+private:
+    qreal advance(int column, qreal x) const;
+
+    // compute all checkpoints up to the given one
+    void computeCheckpoint(int checkpoint) const;
+
+    // we remember the x position every CheckpointDistance columns
+    static constexpr int CheckpointDistance = 256;
+
+    QString m_text;
+    QFontMetricsF m_fontMetrics;
+    qreal m_tabStopDistance;
+    std::array<qreal, 128> m_asciiAdvances;
+    mutable std::vector<qreal> m_checkpoints;
+};
+
 class KateLineLayout
 {
 public:
@@ -66,16 +118,65 @@ public:
 
     const QTextLayout &layout() const
     {
-        return m_layout;
+        return *m_layout;
     }
 
     // just used to generate a new layout together with endLayout
-    QTextLayout &modifiableLayout()
+    // detaches from a layout shared via the KateShapedLayoutCache
+    QTextLayout &modifiableLayout();
+
+    void endLayout();
+
+    // the layout object, for sharing it via the KateShapedLayoutCache
+    const std::shared_ptr<QTextLayout> &sharedLayout() const
     {
         return m_layout;
     }
 
-    void endLayout();
+    // use an already finished layout instead of calling modifiableLayout() + endLayout()
+    void adoptLayout(std::shared_ptr<QTextLayout> layout);
+
+    /**
+     * Long line mode: the layout only contains the columns [windowStart(), windowEnd())
+     * of the line, positioned at their real x offset. Everything outside of the
+     * window is computed from the line metrics.
+     * Must be called after endLayout().
+     */
+    void setWindow(std::unique_ptr<KateLineMetrics> metrics, int start, int end);
+    bool isWindowed() const
+    {
+        return m_metrics != nullptr;
+    }
+    int windowStart() const
+    {
+        return m_windowStart;
+    }
+    int windowEnd() const
+    {
+        return m_windowEnd;
+    }
+    const KateLineMetrics *metrics() const
+    {
+        return m_metrics.get();
+    }
+    // take the metrics to reuse them for the next layout of the line
+    std::unique_ptr<KateLineMetrics> takeMetrics();
+    /**
+     * Geometry only: nothing of the line is laid out, see KateRenderer::layoutLineGeometry().
+     * Must be called after endLayout().
+     */
+    void setGeometryOnly(std::unique_ptr<KateLineMetrics> metrics);
+    bool isGeometryOnly() const
+    {
+        return m_geometryOnly;
+    }
+
+    // is the x range [startX, endX] of the line laid out?
+    bool windowCovers(int startX, int endX) const;
+
+    // cursor movement, handles long line mode
+    int nextCursorPosition(int column) const;
+    int previousCursorPosition(int column) const;
     void invalidateLayout();
 
     bool layoutDirty = true;
@@ -93,11 +194,18 @@ private:
     // Disable copy
     KateLineLayout(const KateLineLayout &copy);
 
+    void resetWindow();
+
     int m_line;
     int m_virtualLine;
 
-    QTextLayout m_layout;
+    std::shared_ptr<QTextLayout> m_layout;
     QList<bool> m_dirtyList;
+
+    std::unique_ptr<KateLineMetrics> m_metrics;
+    int m_windowStart = 0;
+    int m_windowEnd = 0;
+    bool m_geometryOnly = false;
 };
 
 #endif
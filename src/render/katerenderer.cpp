@@ -13,13 +13,18 @@
 #include "katerenderer.h"
 
 #include "inlinenotedata.h"
+#include "kateabstractinputmode.h"
 #include "katebuffer.h"
 #include "katedocument.h"
 #include "kateextendedattribute.h"
+#include "kateglobal.h"
 #include "katehighlight.h"
 #include "katerenderrange.h"
+#include "kateshapedlayoutcache.h"
+#include "katetextdecorationlayer.h"
 #include "katetextlayout.h"
 #include "kateview.h"
+#include "kateviewinternal.h"
 
 #include "ktexteditor/attribute.h"
 #include "ktexteditor/inlinenote.h"
@@ -28,13 +33,18 @@
 #include "katepartdebug.h"
 
 #include <QBrush>
+#include <QFontInfo>
 #include <QPaintEngine>
 #include <QPainter>
 #include <QPainterPath>
 #include <QRegularExpression>
 #include <QStack>
+#include <QVarLengthArray>
 #include <QtMath> // qCeil
 
+#include <algorithm>
+#include <cmath>
+
 static const QChar tabChar(QLatin1Char('\t'));
 static const QChar spaceChar(QLatin1Char(' '));
 static const QChar nbSpaceChar(0xa0); // non-breaking space
@@ -68,6 +78,11 @@ KateRenderer::KateRenderer(KTextEditor::DocumentPrivate *doc, Kate::TextFolding
 void KateRenderer::updateAttributes()
 {
     m_attributes = m_doc->highlight()->attributes(config()->schema());
+
+    // search highlights of the input mode, in the colors of our theme
+    m_searchHighlightAttribute = KTextEditor::Attribute::Ptr(new KTextEditor::Attribute());
+    m_searchHighlightAttribute->setBackground(config()->searchHighlightColor());
+    m_searchHighlightAttribute->setForeground(attribute(KSyntaxHighlighting::Theme::TextStyle::Normal)->foreground().color());
 }
 
 const KTextEditor::Attribute::Ptr &KateRenderer::attribute(uint pos) const
@@ -412,18 +427,60 @@ static bool rangeLessThanForRenderer(const Kate::TextRange *a, const Kate::TextR
     return a->start().toCursor() < b->start().toCursor();
 }
 
-QList<QTextLayout::FormatRange> KateRenderer::decorationsForLine(const Kate::TextLine &textLine, int line, bool skipSelections) const
+QList<QTextLayout::FormatRange>
+KateRenderer::decorationsForLine(const Kate::TextLine &textLine, int line, bool skipSelections, int startColumn, int endColumn) const
 {
+    // only the wanted columns, for very long lines that is a small window of them
+    startColumn = qBound(0, startColumn, textLine.length());
+    endColumn = (endColumn < 0) ? textLine.length() : qBound(startColumn, endColumn, textLine.length());
+    const bool fullLine = startColumn == 0 && endColumn == textLine.length();
+    const KTextEditor::Range columns(line, startColumn, line, endColumn);
+
     // limit number of attributes we can highlight in reasonable time
     const int limitOfRanges = 1024;
     auto rangesWithAttributes = m_doc->buffer().rangesForLine(line, m_printerFriendly ? nullptr : m_view, true);
+    if (!fullLine) {
+        rangesWithAttributes.removeIf([columns](const Kate::TextRange *range) {
+            return !range->toRange().overlaps(columns);
+        });
+    }
     if (rangesWithAttributes.size() > limitOfRanges) {
         rangesWithAttributes.clear();
     }
 
+    // search matches the input mode wants to see, e.g. vi hlsearch, not printed
+    KateAbstractInputMode *inputMode = m_printerFriendly ? nullptr : m_view->currentInputMode();
+    QList<KTextEditor::Range> searchHighlights = inputMode ? inputMode->searchHighlightsForLine(line) : QList<KTextEditor::Range>();
+    if (!fullLine) {
+        searchHighlights.removeIf([columns](KTextEditor::Range range) {
+            return !range.overlaps(columns);
+        });
+    }
+
+    // decorations of layers like semantic highlighting, they are not printed either
+    QVarLengthArray<std::pair<const Kate::TextDecorationLayer *, std::span<const KTextEditor::Decoration>>, 4> layerDecorations;
+    if (!m_printerFriendly) {
+        for (const Kate::TextDecorationLayer *layer : m_doc->buffer().decorationLayers()) {
+            auto decorations = layer->decorationsForLine(line);
+            if (!fullLine) {
+                // sorted by column, skip those ending before the window
+                const auto first = std::find_if(decorations.begin(), decorations.end(), [startColumn](const KTextEditor::Decoration &decoration) {
+                    return decoration.column + decoration.length > startColumn;
+                });
+                const auto last = std::lower_bound(first, decorations.end(), endColumn, [](const KTextEditor::Decoration &decoration, int column) {
+                    return decoration.column < column;
+                });
+                decorations = decorations.subspan(first - decorations.begin(), last - first);
+            }
+            if (!decorations.empty()) {
+                layerDecorations.push_back({layer, decorations.first(std::min<size_t>(decorations.size(), limitOfRanges))});
+            }
+        }
+    }
+
     // Don't compute the highlighting if there isn't going to be any highlighting
     const auto &al = textLine.attributesList();
-    if (al.empty() && rangesWithAttributes.empty() && !m_view->selection()) {
+    if (al.empty() && layerDecorations.empty() && rangesWithAttributes.empty() && searchHighlights.empty() && !m_view->selection()) {
         return QList<QTextLayout::FormatRange>();
     }
 
@@ -431,9 +488,23 @@ QList<QTextLayout::FormatRange> KateRenderer::decorationsForLine(const Kate::Tex
     RenderRangeVector renderRanges;
     if (!al.empty()) {
         auto &currentRange = renderRanges.pushNewRange();
-        for (int i = 0; i < std::min<int>(al.size(), limitOfRanges); ++i) {
-            if (al[i].length > 0 && al[i].attributeValue > 0) {
-                currentRange.addRange(KTextEditor::Range(KTextEditor::Cursor(line, al[i].offset), al[i].length), specificAttribute(al[i].attributeValue));
+        // the attributes are sorted and don't overlap, start with the first one reaching into the window
+        auto it = std::lower_bound(al.begin(), al.end(), startColumn, [](const Kate::TextLine::Attribute &attribute, int column) {
+            return attribute.offset + attribute.length <= column;
+        });
+        for (int added = 0; it != al.end() && it->offset < endColumn && added < limitOfRanges; ++it, ++added) {
+            if (it->length > 0 && it->attributeValue > 0) {
+                currentRange.addRange(KTextEditor::Range(KTextEditor::Cursor(line, it->offset), it->length), specificAttribute(it->attributeValue));
+            }
+        }
+    }
+
+    // Add the decoration layers above the inbuilt highlighting, each one like a range
+    for (const auto &[layer, decorations] : layerDecorations) {
+        auto &currentRange = renderRanges.pushNewRange();
+        for (const KTextEditor::Decoration &decoration : decorations) {
+            if (KTextEditor::Attribute::Ptr attribute = layer->attribute(decoration.attribute)) {
+                currentRange.addRange(KTextEditor::Range(line, decoration.column, line, decoration.column + decoration.length), std::move(attribute));
             }
         }
     }
@@ -475,6 +546,14 @@ QList<QTextLayout::FormatRange> KateRenderer::decorationsForLine(const Kate::Tex
         renderRanges.pushNewRange().addRange(*kateRange, std::move(attribute));
     }
 
+    // Add the search highlights above all other ranges, only the selection wins
+    if (!searchHighlights.empty()) {
+        auto &currentRange = renderRanges.pushNewRange();
+        for (const KTextEditor::Range &range : searchHighlights) {
+            currentRange.addRange(range, m_searchHighlightAttribute);
+        }
+    }
+
     // Add selection highlighting if we're creating the selection decorations
     if (!skipSelections && ((m_view && showSelections() && m_view->selection()) || (m_view && m_view->blockSelection()))) {
         auto &currentRange = renderRanges.pushNewRange();
@@ -502,8 +581,8 @@ QList<QTextLayout::FormatRange> KateRenderer::decorationsForLine(const Kate::Tex
     }
 
     // Calculate the range which we need to iterate in order to get the highlighting for just this line
-    KTextEditor::Cursor currentPosition = KTextEditor::Cursor(line, 0);
-    const KTextEditor::Cursor endPosition = KTextEditor::Cursor(line + 1, 0);
+    KTextEditor::Cursor currentPosition = KTextEditor::Cursor(line, startColumn);
+    const KTextEditor::Cursor endPosition = fullLine ? KTextEditor::Cursor(line + 1, 0) : KTextEditor::Cursor(line, endColumn);
 
     // Background formats have lower priority so they get overridden by selection
     const KTextEditor::Range selectionRange = m_view->selectionRange();
@@ -526,8 +605,10 @@ QList<QTextLayout::FormatRange> KateRenderer::decorationsForLine(const Kate::Tex
         QTextLayout::FormatRange fr;
         fr.start = currentPosition.column();
 
-        if (nextPosition < endPosition || endPosition.line() <= line) {
+        if (nextPosition < endPosition) {
             fr.length = nextPosition.column() - currentPosition.column();
+        } else if (endPosition.line() <= line) {
+            fr.length = endPosition.column() - currentPosition.column();
 
         } else {
             // before we did here +1 to force background drawing at the end of the line when it's warranted
@@ -609,16 +690,16 @@ void KateRenderer::paintTextBackground(QPainter &paint, KateLineLayout *layout,
                     if (rtl) {
                         // For rtl, Rect starts at 0 and ends at selection start
                         sx = 0;
-                        width = kateLayout.lineLayout().cursorToX(s);
+                        width = kateLayout.cursorToX(s);
                     } else {
-                        sx = kateLayout.lineLayout().cursorToX(s);
+                        sx = kateLayout.cursorToX(s);
                     }
                 } else if (l == endViewLine) {
                     if (rtl) {
                         // Drawing will start at selection end, and end at the view border
-                        sx = kateLayout.lineLayout().cursorToX(e);
+                        sx = kateLayout.cursorToX(e);
                     } else {
-                        width = kateLayout.lineLayout().cursorToX(e);
+                        width = kateLayout.cursorToX(e);
                     }
                 }
 
@@ -698,7 +779,10 @@ void KateRenderer::paintTextLine(QPainter &paint,
             paint.setPen(attribute(KSyntaxHighlighting::Theme::TextStyle::Normal)->foreground().color());
 
             // Draw text background
-            const auto decos = decorationsForLine(textLine, range->line(), /*skipSelections=*/!drawSelection);
+            // for very long lines only the laid out window
+            const auto decos = range->isWindowed()
+                ? decorationsForLine(textLine, range->line(), /*skipSelections=*/!drawSelection, range->windowStart(), range->windowEnd())
+                : decorationsForLine(textLine, range->line(), /*skipSelections=*/!drawSelection);
             paintTextBackground(paint, range, decos, xStart);
 
             // Draw the text :)
@@ -734,28 +818,30 @@ void KateRenderer::paintTextLine(QPainter &paint,
 
             // draw an open box to mark non-breaking spaces
             const QString &text = textLine.text();
+            // for very long lines don't search behind the laid out window
+            const QStringView searchText = QStringView(text).first(range->isWindowed() ? std::min(line.endCol(), range->windowEnd()) : line.endCol());
             int y = lineHeight() * i + m_fontAscent - fm.strikeOutPos();
-            int nbSpaceIndex = text.indexOf(nbSpaceChar, line.lineLayout().xToCursor(xStart));
+            int nbSpaceIndex = searchText.indexOf(nbSpaceChar, line.xToCursor(xStart));
 
-            while (nbSpaceIndex != -1 && nbSpaceIndex < line.endCol()) {
-                int x = line.lineLayout().cursorToX(nbSpaceIndex);
+            while (nbSpaceIndex != -1) {
+                int x = line.cursorToX(nbSpaceIndex);
                 if (x > xEnd) {
                     break;
                 }
                 paintNonBreakSpace(paint, x - xStart, y);
-                nbSpaceIndex = text.indexOf(nbSpaceChar, nbSpaceIndex + 1);
+                nbSpaceIndex = searchText.indexOf(nbSpaceChar, nbSpaceIndex + 1);
             }
 
             // draw tab stop indicators
             if (showTabs()) {
-                int tabIndex = text.indexOf(tabChar, line.lineLayout().xToCursor(xStart));
-                while (tabIndex != -1 && tabIndex < line.endCol()) {
-                    int x = line.lineLayout().cursorToX(tabIndex);
+                int tabIndex = searchText.indexOf(tabChar, line.xToCursor(xStart));
+                while (tabIndex != -1) {
+                    int x = line.cursorToX(tabIndex);
                     if (x > xEnd) {
                         break;
                     }
                     paintTabstop(paint, x - xStart + spaceWidth() / 2.0, y);
-                    tabIndex = text.indexOf(tabChar, tabIndex + 1);
+                    tabIndex = searchText.indexOf(tabChar, tabIndex + 1);
                 }
             }
 
@@ -772,8 +858,8 @@ void KateRenderer::paintTextLine(QPainter &paint,
                     int start = isRTL ? xEnd : xStart;
                     int end = isRTL ? xStart : xEnd;
 
-                    spaceIndex = std::min(line.lineLayout().xToCursor(end), spaceIndex);
-                    int visibleStart = line.lineLayout().xToCursor(start);
+                    spaceIndex = std::min(line.xToCursor(end), spaceIndex);
+                    int visibleStart = line.xToCursor(start);
 
                     for (; spaceIndex >= line.startCol(); --spaceIndex) {
                         if (!text.at(spaceIndex).isSpace()) {
@@ -798,7 +884,7 @@ void KateRenderer::paintTextLine(QPainter &paint,
                     // reverse because we want to look at the spaces at the beginning of line first
                     for (auto rit = spacePositions.rbegin(); rit != spacePositions.rend(); ++rit) {
                         const int spaceIdx = *rit;
-                        qreal x = line.lineLayout().cursorToX(spaceIdx) - xStart;
+                        qreal x = line.cursorToX(spaceIdx) - xStart;
                         int dir = 1; // 1 == ltr, -1 == rtl
                         if (range->layout().textOption().alignment() == Qt::AlignRight) {
                             dir = -1;
@@ -839,12 +925,12 @@ void KateRenderer::paintTextLine(QPainter &paint,
 
                 static const QRegularExpression nonPrintableSpacesRegExp(
                     QStringLiteral("[\\x{0000}-\\x{0008}\\x{000A}-\\x{001F}\\x{2000}-\\x{200F}\\x{2028}-\\x{202F}\\x{205F}-\\x{2064}\\x{206A}-\\x{206F}]"));
-                QRegularExpressionMatchIterator i = nonPrintableSpacesRegExp.globalMatch(text, line.lineLayout().xToCursor(xStart));
+                QRegularExpressionMatchIterator i = nonPrintableSpacesRegExp.globalMatchView(searchText, line.xToCursor(xStart));
 
                 while (i.hasNext()) {
                     const int charIndex = i.next().capturedStart();
 
-                    const int x = line.lineLayout().cursorToX(charIndex);
+                    const int x = line.cursorToX(charIndex);
                     if (x > xEnd) {
                         break;
                     }
@@ -921,11 +1007,11 @@ void KateRenderer::paintTextLine(QPainter &paint,
             // If the text is ltr or rtl + dyn wrap, get the X from column
             qreal x;
             if (dir == Qt::LeftToRight || (dir == Qt::RightToLeft && m_view->dynWordWrap())) {
-                x = range->viewLine(viewLine).lineLayout().cursorToX(column) - xStart;
+                x = range->viewLine(viewLine).cursorToX(column) - xStart;
             } else /* rtl + dynWordWrap == false */ {
                 // if text is rtl and dynamic wrap is false, the x offsets are in the opposite
                 // direction i.e., [0] == biggest offset, [1] = next
-                x = range->viewLine(viewLine).lineLayout().cursorToX(textLine.length() - column) - xStart;
+                x = range->viewLine(viewLine).cursorToX(textLine.length() - column) - xStart;
             }
             int textLength = textLine.length();
             if (column == 0 || column < textLength) {
@@ -977,8 +1063,15 @@ void KateRenderer::paintCaret(KTextEditor::Cursor cursor, KateLineLayout *range,
         return;
     }
 
+    // long line mode: carets outside of the laid out window are not visible
+    if (range->isWindowed() && (cursor.column() < range->windowStart() || cursor.column() > range->windowEnd())) {
+        return;
+    }
+
+    // column and length relative to the laid out text
+    const int column = cursor.column() - range->windowStart();
     const int lineLength = range->layout().text().length();
-    const QTextLine line = range->layout().lineForTextPosition(qMin(cursor.column(), lineLength));
+    const QTextLine line = range->layout().lineForTextPosition(qMin(column, lineLength));
 
     // Determine the color
     QColor color = m_caretOverrideColor;
@@ -986,7 +1079,7 @@ void KateRenderer::paintCaret(KTextEditor::Cursor cursor, KateLineLayout *range,
         // search for the FormatRange that includes the cursor
         const auto formatRanges = range->layout().formats();
         for (const QTextLayout::FormatRange &r : formatRanges) {
-            if ((r.start <= cursor.column()) && ((r.start + r.length) > cursor.column())) {
+            if ((r.start <= column) && ((r.start + r.length) > column)) {
                 // check for Qt::NoBrush, as the returned color is black() and no invalid QColor
                 QBrush foregroundBrush = r.format.foreground();
                 if (foregroundBrush != Qt::NoBrush) {
@@ -1003,8 +1096,8 @@ void KateRenderer::paintCaret(KTextEditor::Cursor cursor, KateLineLayout *range,
 
     // Default caret width and heights (character-wide block)
     int caretWidth = spaceWidth();
-    if (line.isValid() && cursor.column() < lineLength) {
-        caretWidth = abs(int(line.cursorToX(cursor.column() + 1) - line.cursorToX(cursor.column())));
+    if (line.isValid() && column < lineLength) {
+        caretWidth = abs(int(line.cursorToX(column + 1) - line.cursorToX(column)));
     }
     int caretHeight = lineHeight();
 
@@ -1030,13 +1123,13 @@ void KateRenderer::paintCaret(KTextEditor::Cursor cursor, KateLineLayout *range,
     paint.save();
     paint.setPen(QPen(color, caretWidth));
 
-    if (cursor.column() <= lineLength) {
+    if (column <= lineLength) {
         // Ensure correct cursor placement for RTL text
         if (range->layout().textOption().textDirection() == Qt::RightToLeft) {
             xStart += caretWidth;
         }
         qreal width = 0;
-        if (cursor.column() < lineLength) {
+        if (column < lineLength) {
             const auto inlineNotes = m_view->inlineNotes(range->line());
             for (const auto &inlineNoteData : inlineNotes) {
                 KTextEditor::InlineNote inlineNote(inlineNoteData);
@@ -1045,7 +1138,7 @@ void KateRenderer::paintCaret(KTextEditor::Cursor cursor, KateLineLayout *range,
                 }
             }
         }
-        drawCursor(range->layout(), &paint, QPoint(-xStart - width, lineHeight() - caretHeight), cursor.column(), caretWidth, caretHeight);
+        drawCursor(range->layout(), &paint, QPoint(-xStart - width, lineHeight() - caretHeight), column, caretWidth, caretHeight);
     } else {
         // Off the end of the line... must be block mode. Draw the caret ourselves.
         const KateTextLayout &lastLine = range->viewLine(range->viewLineCount() - 1);
@@ -1134,6 +1227,7 @@ void KateRenderer::updateFontHeight()
     // cache font + metrics
     m_font = config()->baseFont();
     m_fontMetrics = QFontMetricsF(m_font);
+    m_fontFixedPitch = QFontInfo(m_font).fixedPitch();
 
     // ensure minimal height of one pixel to not fall in the div by 0 trap somewhere
     //
@@ -1177,11 +1271,6 @@ void KateRenderer::layoutLine(Kate::TextLine textLine, KateLineLayout *lineLayou
 {
     // if maxwidth == -1 we have no wrap
 
-    QTextLayout &l = lineLayout->modifiableLayout();
-    l.setText(textLine.text());
-    l.setFont(m_font);
-    l.setCacheEnabled(cacheLayout);
-
     // Initial setup of the QTextLayout.
 
     // Tab width
@@ -1220,7 +1309,18 @@ void KateRenderer::layoutLine(Kate::TextLine textLine, KateLineLayout *lineLayou
         opt.setTextDirection(Qt::LeftToRight);
     }
 
-    l.setTextOption(opt);
+    QVarLengthArray<KateInlineNoteData, 8> inlineNotes;
+    if (!isPrinterFriendly() && m_view) {
+        inlineNotes = m_view->inlineNotes(lineLayout->line());
+    }
+
+    // shaping minified code or data in full makes scrolling and cursor movement crawl
+    // without dynamic wrap we know where everything is from the metrics of a fixed pitch font
+    if (maxwidth == -1 && m_view && !isPrinterFriendly() && inlineNotes.isEmpty() && textLine.length() > LongLineLength
+        && opt.textDirection() == Qt::LeftToRight && m_fontFixedPitch) {
+        layoutLongLine(textLine, lineLayout, opt, skipSelections, cacheLayout);
+        return;
+    }
 
     // Syntax highlighting, inbuilt and arbitrary
     QList<QTextLayout::FormatRange> decorations = decorationsForLine(textLine, lineLayout->line(), skipSelections);
@@ -1231,28 +1331,58 @@ void KateRenderer::layoutLine(Kate::TextLine textLine, KateLineLayout *lineLayou
 
     int firstLineOffset = 0;
 
-    if (!isPrinterFriendly() && m_view) {
-        const auto inlineNotes = m_view->inlineNotes(lineLayout->line());
-        for (const KateInlineNoteData &noteData : inlineNotes) {
-            const KTextEditor::InlineNote inlineNote(noteData);
-            const int column = inlineNote.position().column();
-            int width = inlineNote.width();
-
-            // Make space for every inline note.
-            // If it is on column 0 (at the beginning of the line), we must offset the first line.
-            // If it is inside the text, we use absolute letter spacing to create space for it between the two letters.
-            // If it is outside of the text, we don't have to make space for it.
-            if (column == 0) {
-                firstLineOffset = width;
-            } else if (column < l.text().length()) {
-                QTextCharFormat text_char_format;
-                const qreal caretWidth = caretStyle() == KTextEditor::caretStyles::Line ? 2.0 : 0.0;
-                text_char_format.setFontLetterSpacing(width + caretWidth);
-                text_char_format.setFontLetterSpacingType(QFont::AbsoluteSpacing);
-                decorations.append(QTextLayout::FormatRange{.start = column - 1, .length = 1, .format = text_char_format});
+    for (const KateInlineNoteData &noteData : inlineNotes) {
+        const KTextEditor::InlineNote inlineNote(noteData);
+        const int column = inlineNote.position().column();
+        int width = inlineNote.width();
+
+        // Make space for every inline note.
+        // If it is on column 0 (at the beginning of the line), we must offset the first line.
+        // If it is inside the text, we use absolute letter spacing to create space for it between the two letters.
+        // If it is outside of the text, we don't have to make space for it.
+        if (column == 0) {
+            firstLineOffset = width;
+        } else if (column < textLine.length()) {
+            QTextCharFormat text_char_format;
+            const qreal caretWidth = caretStyle() == KTextEditor::caretStyles::Line ? 2.0 : 0.0;
+            text_char_format.setFontLetterSpacing(width + caretWidth);
+            text_char_format.setFontLetterSpacingType(QFont::AbsoluteSpacing);
+            decorations.append(QTextLayout::FormatRange{.start = column - 1, .length = 1, .format = text_char_format});
+        }
+    }
+
+    // identical lines are shaped only once, for all views
+    // printing and the temporary layouts of previews and the like stay private
+    KateShapedLayoutCache *const shapedLayoutCache = (cacheLayout && m_view && !isPrinterFriendly()) ? KTextEditor::EditorPrivate::self()->shapedLayoutCache() : nullptr;
+    KateShapedLayoutCache::Key shapedLayoutKey;
+    if (shapedLayoutCache) {
+        shapedLayoutKey = KateShapedLayoutCache::Key{.text = textLine.text(),
+                                                     .formats = decorations,
+                                                     .font = m_font,
+                                                     .flags = opt.flags(),
+                                                     .alignment = opt.alignment(),
+                                                     .direction = opt.textDirection(),
+                                                     .wrapMode = opt.wrapMode(),
+                                                     .tabStopDistance = opt.tabStopDistance(),
+                                                     .maxWidth = maxwidth,
+                                                     .firstLineOffset = firstLineOffset,
+                                                     .lineHeight = lineHeight(),
+                                                     .fontAscent = m_fontAscent,
+                                                     .dynWordWrapAlignIndent = m_view->config()->dynWordWrapAlignIndent()};
+        if (const auto *entry = shapedLayoutCache->find(shapedLayoutKey)) {
+            if (entry->shiftX) {
+                lineLayout->shiftX = *entry->shiftX;
             }
+            lineLayout->adoptLayout(entry->layout);
+            return;
         }
     }
+
+    QTextLayout &l = lineLayout->modifiableLayout();
+    l.setText(textLine.text());
+    l.setFont(m_font);
+    l.setCacheEnabled(cacheLayout);
+    l.setTextOption(opt);
     l.setFormats(decorations);
 
     // Begin layouting
@@ -1260,6 +1390,7 @@ void KateRenderer::layoutLine(Kate::TextLine textLine, KateLineLayout *lineLayou
 
     int height = 0;
     int shiftX = 0;
+    std::optional<int> computedShiftX;
 
     bool needShiftX = (maxwidth != -1) && m_view && (m_view->config()->dynWordWrapAlignIndent() > 0);
 
@@ -1298,6 +1429,7 @@ void KateRenderer::layoutLine(Kate::TextLine textLine, KateLineLayout *lineLayou
             maxwidth -= shiftX;
 
             lineLayout->shiftX = shiftX;
+            computedShiftX = shiftX;
         }
 
         height += lineHeight();
@@ -1305,6 +1437,113 @@ void KateRenderer::layoutLine(Kate::TextLine textLine, KateLineLayout *lineLayou
 
     // will end layout and trigger that we mark the layout as changed
     lineLayout->endLayout();
+
+    if (shapedLayoutCache) {
+        shapedLayoutCache->insert(std::move(shapedLayoutKey), {.layout = lineLayout->sharedLayout(), .shiftX = computedShiftX});
+    }
+}
+
+bool KateRenderer::layoutLineGeometry(const Kate::TextLine &textLine, KateLineLayout *lineLayout, int maxwidth) const
+{
+    if (maxwidth != -1 || !m_view || isPrinterFriendly() || !m_fontFixedPitch) {
+        return false;
+    }
+
+    // anything but printable ASCII might need fallback fonts, combining or bidi handling
+    const QString &text = textLine.text();
+    const bool isPlainAscii = std::all_of(text.begin(), text.end(), [](QChar c) {
+        return c == QLatin1Char('\t') || (c.unicode() >= 0x20 && c.unicode() < 0x7f);
+    });
+    if (!isPlainAscii || !m_view->inlineNotes(lineLayout->line()).isEmpty()) {
+        return false;
+    }
+
+    const qreal tabStopDistance = m_tabWidth * m_fontMetrics.horizontalAdvance(spaceChar);
+    auto metrics = std::make_unique<KateLineMetrics>(text, m_fontMetrics, tabStopDistance);
+
+    // an empty layout, just to have the line geometry
+    QTextOption opt;
+    opt.setFlags(QTextOption::IncludeTrailingSpaces);
+    opt.setTabStopDistance(tabStopDistance);
+    opt.setAlignment(Qt::AlignLeft);
+    opt.setTextDirection(Qt::LeftToRight);
+
+    QTextLayout &l = lineLayout->modifiableLayout();
+    l.setText(QString());
+    l.setFont(m_font);
+    l.setTextOption(opt);
+    l.clearFormats();
+
+    l.beginLayout();
+    QTextLine line = l.createLine();
+    line.setLineWidth(INT_MAX);
+    // we include the leading, this must match the ::updateFontHeight code!
+    line.setLeadingIncluded(true);
+    line.setPosition(QPointF(0, -line.ascent() + m_fontAscent));
+    lineLayout->endLayout();
+
+    lineLayout->setGeometryOnly(std::move(metrics));
+    return true;
+}
+
+void KateRenderer::layoutLongLine(const Kate::TextLine &textLine, KateLineLayout *lineLayout, QTextOption opt, bool skipSelections, bool cacheLayout) const
+{
+    // the metrics of the last layout stay valid as long as the line is unchanged, e.g. while scrolling horizontally
+    std::unique_ptr<KateLineMetrics> metrics = lineLayout->takeMetrics();
+    if (!metrics || !metrics->isFor(textLine.text(), m_fontMetrics, opt.tabStopDistance())) {
+        metrics = std::make_unique<KateLineMetrics>(textLine.text(), m_fontMetrics, opt.tabStopDistance());
+    }
+
+    // the visible area plus one view width to each side, small scrolls need no new layout
+    const KateViewInternal *viewInternal = m_view->getViewInternal();
+    const int margin = qMax(viewInternal->width(), 1000);
+    const int visibleStartX = viewInternal->startX();
+    const int start = metrics->xToCursor(visibleStartX - margin);
+    const int end = qMax(start, metrics->nextCursorPosition(metrics->xToCursor(visibleStartX + viewInternal->width() + margin)));
+    const qreal startX = metrics->cursorToX(start);
+
+    // tab stops are relative to the start of the layout, shift them to match the full line
+    const QStringView windowText = QStringView(textLine.text()).mid(start, end - start);
+    if (windowText.contains(QLatin1Char('\t'))) {
+        const qreal tabStopDistance = opt.tabStopDistance() > 0 ? opt.tabStopDistance() : 80;
+        const qreal firstTabStop = (std::floor(startX / tabStopDistance) + 1) * tabStopDistance - startX;
+        const qreal windowWidth = metrics->cursorToX(end) - startX;
+        QList<qreal> tabStops;
+        for (qreal tabStop = firstTabStop; tabStop <= windowWidth + tabStopDistance; tabStop += tabStopDistance) {
+            tabStops.push_back(tabStop);
+        }
+        opt.setTabArray(tabStops);
+    }
+
+    // only the attributes inside of the window, backgrounds are drawn separately
+    const QList<QTextLayout::FormatRange> decorations = decorationsForLine(textLine, lineLayout->line(), skipSelections, start, end);
+    // only the attributes inside of the window
+    QList<QTextLayout::FormatRange> formats;
+    for (const auto &range : decorations) {
+        const int rangeStart = qMax(range.start, start);
+        const int rangeEnd = qMin(range.start + range.length, end);
+        if (rangeStart < rangeEnd) {
+            formats.append(QTextLayout::FormatRange{.start = rangeStart - start, .length = rangeEnd - rangeStart, .format = range.format});
+            formats.back().format.clearBackground();
+        }
+    }
+
+    QTextLayout &l = lineLayout->modifiableLayout();
+    l.setText(windowText.toString());
+    l.setFont(m_font);
+    l.setCacheEnabled(cacheLayout);
+    l.setTextOption(opt);
+    l.setFormats(formats);
+
+    l.beginLayout();
+    QTextLine line = l.createLine();
+    line.setLineWidth(INT_MAX);
+    // we include the leading, this must match the ::updateFontHeight code!
+    line.setLeadingIncluded(true);
+    line.setPosition(QPointF(startX, -line.ascent() + m_fontAscent));
+    lineLayout->endLayout();
+
+    lineLayout->setWindow(std::move(metrics), start, end);
 }
 
 // 1) QString::isRightToLeft() sux
@@ -1355,7 +1594,7 @@ qreal KateRenderer::cursorToX(const KateTextLayout &range, const KTextEditor::Cu
 
     qreal x = 0;
     if (range.lineLayout().width() > 0) {
-        x = range.lineLayout().cursorToX(pos.column());
+        x = range.cursorToX(pos.column());
     }
 
     if (const int over = pos.column() - range.endCol(); returnPastLine && over > 0) {
@@ -1368,7 +1607,7 @@ qreal KateRenderer::cursorToX(const KateTextLayout &range, const KTextEditor::Cu
 KTextEditor::Cursor KateRenderer::xToCursor(const KateTextLayout &range, int x, bool returnPastLine) const
 {
     Q_ASSERT(range.isValid());
-    KTextEditor::Cursor ret(range.line(), range.lineLayout().xToCursor(x));
+    KTextEditor::Cursor ret(range.line(), range.xToCursor(x));
 
     // Do not wrap to the next line. (bug #423253)
     if (range.wrap() && ret.column() >= range.endCol() && range.length() > 0) {
@@ -278,6 +278,21 @@ public:
      */
     void layoutLine(Kate::TextLine textLine, KateLineLayout *line, int maxwidth = -1, bool cacheLayout = false, bool skipSelections = false) const;
 
+    /**
+     * Lines longer than this are only laid out around the visible area if possible,
+     * see KateLineLayout::isWindowed().
+     */
+    static constexpr int LongLineLength = 4096;
+
+    /**
+     * Fast path for geometry queries like cursor movement: for unwrapped printable ASCII
+     * lines in a fixed pitch font, compute the geometry from the font metrics and skip the
+     * shaping, see KateLineLayout::isGeometryOnly().
+     * Such layouts can't be painted, use layoutLine() for that.
+     * @return false, if the line needs a real layout
+     */
+    bool layoutLineGeometry(const Kate::TextLine &textLine, KateLineLayout *lineLayout, int maxwidth = -1) const;
+
     /**
      * This is a smaller QString::isRightToLeft(). It's also marked as internal to kate
      * instead of internal to Qt, so we can modify. This method searches for the first
@@ -294,8 +309,11 @@ public:
      * The ultimate decoration creation function.
      *
      * \param selectionsOnly return decorations for selections and/or dynamic highlighting.
+     * \param startColumn, endColumn only decorations for the columns [startColumn, endColumn)
+     *        are computed, e.g. for the laid out window of a very long line, -1 is the line end.
      */
-    QList<QTextLayout::FormatRange> decorationsForLine(const Kate::TextLine &textLine, int line, bool skipSelections = false) const;
+    QList<QTextLayout::FormatRange>
+    decorationsForLine(const Kate::TextLine &textLine, int line, bool skipSelections = false, int startColumn = 0, int endColumn = -1) const;
 
     // Width calculators
     qreal spaceWidth() const;
@@ -392,6 +410,14 @@ public:
     const AttributePtr &attribute(uint pos) const;
     AttributePtr specificAttribute(int context) const;
 
+    /**
+     * All attributes of the current highlighting, indexed like attribute().
+     */
+    const QList<AttributePtr> &attributes() const
+    {
+        return m_attributes;
+    }
+
     /**
      * Paints a range of text into @a d. This function is mainly used to paint the pixmap
      * when dragging text.
@@ -408,6 +434,12 @@ public:
     void paintSelection(QPaintDevice *d, int startLine, int xStart, int endLine, int xEnd, int viewWidth, qreal scale = 1.0);
 
 private:
+    /**
+     * Long line mode of layoutLine(): shape only the columns around the horizontally
+     * visible area of the view, the remaining geometry is computed from the font metrics.
+     */
+    void layoutLongLine(const Kate::TextLine &textLine, KateLineLayout *lineLayout, QTextOption opt, bool skipSelections, bool cacheLayout) const;
+
     /**
      * Paint a trailing space on position (x, y).
      */
@@ -468,6 +500,9 @@ private:
 
     QList<AttributePtr> m_attributes;
 
+    // attribute for KateAbstractInputMode::searchHighlightsForLine(), see updateAttributes()
+    KTextEditor::Attribute::Ptr m_searchHighlightAttribute;
+
     /**
      * Configuration
      */
@@ -491,6 +526,11 @@ private:
      * cached font metrics
      */
     QFontMetricsF m_fontMetrics;
+
+    /**
+     * cached: is the font fixed pitch? needed for the layout free paths
+     */
+    bool m_fontFixedPitch = false;
 };
 
 #endif
@@ -0,0 +1,59 @@
+/*
+    SPDX-FileCopyrightText: KDE Developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "kateshapedlayoutcache.h"
+
+#include <QHash>
+
+namespace
+{
+/**
+ * Rough size of a shaped layout: glyph indices, advances, offsets and the
+ * attribute arrays of QTextEngine are a few dozen bytes per character.
+ */
+qsizetype estimatedCost(const KateShapedLayoutCache::Key &key)
+{
+    return 256 + key.text.size() * 40 + key.formats.size() * 64;
+}
+}
+
+size_t qHash(const KateShapedLayoutCache::Key &key, size_t seed) noexcept
+{
+    // formats are only hashed by position, equality does the full compare
+    seed = qHashMulti(seed, key.text, key.font, key.maxWidth, key.firstLineOffset);
+    for (const auto &format : key.formats) {
+        seed = qHashMulti(seed, format.start, format.length);
+    }
+    return seed;
+}
+
+KateShapedLayoutCache::KateShapedLayoutCache(qsizetype maxCost)
+    : m_cache(maxCost)
+{
+}
+
+const KateShapedLayoutCache::Entry *KateShapedLayoutCache::find(const Key &key)
+{
+    const Entry *entry = m_cache.object(key);
+    if (entry) {
+        ++m_hits;
+    } else {
+        ++m_misses;
+    }
+    return entry;
+}
+
+void KateShapedLayoutCache::insert(Key key, Entry entry)
+{
+    Q_ASSERT(entry.layout);
+    const qsizetype cost = estimatedCost(key);
+    m_cache.insert(std::move(key), new Entry(std::move(entry)), cost);
+}
+
+void KateShapedLayoutCache::clear()
+{
+    m_cache.clear();
+}
@@ -0,0 +1,134 @@
+/*
+    SPDX-FileCopyrightText: KDE Developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef KATESHAPEDLAYOUTCACHE_H
+#define KATESHAPEDLAYOUTCACHE_H
+
+#include <ktexteditor_export.h>
+
+#include <QCache>
+#include <QFont>
+#include <QList>
+#include <QTextLayout>
+#include <QTextOption>
+
+#include <memory>
+#include <optional>
+
+/**
+ * Editor wide cache of fully shaped and broken line layouts.
+ *
+ * Shaping a line is the most expensive part of KateRenderer::layoutLine, but the
+ * result only depends on the line text, the attribute ranges applied to it, the
+ * font, the text option (tab width, direction, wrap mode) and the wrap width.
+ * Log files and generated code often contain many identical lines, and several
+ * views of the same document lay out the same lines again, so the finished
+ * QTextLayout is shared between all KateLineLayout objects with an equal key.
+ *
+ * Shared layouts are immutable, KateLineLayout detaches before it lays out again.
+ * The cache is bounded by an estimated memory cost, least recently used layouts
+ * are evicted first.
+ */
+class KTEXTEDITOR_EXPORT KateShapedLayoutCache
+{
+public:
+    /**
+     * Everything that influences the shaping and line breaking of a layout.
+     */
+    struct Key {
+        QString text;
+        QList<QTextLayout::FormatRange> formats;
+        QFont font;
+        QTextOption::Flags flags;
+        Qt::Alignment alignment;
+        Qt::LayoutDirection direction = Qt::LeftToRight;
+        QTextOption::WrapMode wrapMode = QTextOption::WrapAtWordBoundaryOrAnywhere;
+        qreal tabStopDistance = 0;
+        int maxWidth = -1;
+        int firstLineOffset = 0;
+        int lineHeight = 0;
+        qreal fontAscent = 0;
+        int dynWordWrapAlignIndent = 0;
+
+        friend bool operator==(const Key &a, const Key &b) = default;
+    };
+
+    /**
+     * Cached layout together with the dynamic wrap indentation computed for it.
+     */
+    struct Entry {
+        std::shared_ptr<QTextLayout> layout;
+        std::optional<int> shiftX;
+    };
+
+    /**
+     * Default memory limit, in bytes of estimated layout size.
+     */
+    static constexpr qsizetype DefaultMaxCost = 32 * 1024 * 1024;
+
+    explicit KateShapedLayoutCache(qsizetype maxCost = DefaultMaxCost);
+
+    /**
+     * Lookup a layout, counts a hit or a miss.
+     * @return cached entry or nullptr
+     */
+    const Entry *find(const Key &key);
+
+    /**
+     * Remember a finished layout. The layout must not be modified afterwards.
+     */
+    void insert(Key key, Entry entry);
+
+    void clear();
+
+    qsizetype maxCost() const
+    {
+        return m_cache.maxCost();
+    }
+
+    void setMaxCost(qsizetype maxCost)
+    {
+        m_cache.setMaxCost(maxCost);
+    }
+
+    /**
+     * Estimated memory used by the cached layouts.
+     */
+    qsizetype totalCost() const
+    {
+        return m_cache.totalCost();
+    }
+
+    qsizetype count() const
+    {
+        return m_cache.count();
+    }
+
+    quint64 hits() const
+    {
+        return m_hits;
+    }
+
+    quint64 misses() const
+    {
+        return m_misses;
+    }
+
+    void resetStatistics()
+    {
+        m_hits = 0;
+        m_misses = 0;
+    }
+
+private:
+    QCache<Key, Entry> m_cache;
+    quint64 m_hits = 0;
+    quint64 m_misses = 0;
+};
+
+size_t qHash(const KateShapedLayoutCache::Key &key, size_t seed = 0) noexcept;
+
+#endif
@@ -15,7 +15,8 @@ KateTextLayout::KateTextLayout(KateLineLayout *line, int viewLine)
     , m_startX(m_viewLine ? -1 : 0)
 {
     if (isValid()) {
-        m_textLayout = m_lineLayout->layout().lineAt(m_viewLine);
+        m_layout = m_lineLayout->sharedLayout();
+        m_textLayout = m_layout->lineAt(m_viewLine);
     }
 }
 
@@ -125,6 +126,11 @@ int KateTextLayout::startCol() const
         return 0;
     }
 
+    // long line mode: we always represent the full line
+    if (m_lineLayout->isWindowed()) {
+        return 0;
+    }
+
     return lineLayout().textStart();
 }
 
@@ -145,7 +151,7 @@ int KateTextLayout::endCol(bool indicateEOL) const
         }
     }
 
-    return startCol() + m_textLayout.textLength();
+    return startCol() + length();
 }
 
 KTextEditor::Cursor KateTextLayout::end(bool indicateEOL) const
@@ -159,6 +165,10 @@ int KateTextLayout::length() const
         return 0;
     }
 
+    if (m_lineLayout->isWindowed()) {
+        return m_lineLayout->metrics()->length();
+    }
+
     return m_textLayout.textLength();
 }
 
@@ -202,7 +212,7 @@ int KateTextLayout::endX() const
         return 0;
     }
 
-    return startX() + (int)m_textLayout.naturalTextWidth();
+    return startX() + width();
 }
 
 int KateTextLayout::width() const
@@ -211,9 +221,38 @@ int KateTextLayout::width() const
         return 0;
     }
 
+    if (m_lineLayout->isWindowed()) {
+        return (int)m_lineLayout->metrics()->width();
+    }
+
     return (int)m_textLayout.naturalTextWidth();
 }
 
+qreal KateTextLayout::cursorToX(int column) const
+{
+    const KateLineLayout *l = m_lineLayout;
+    if (l && l->isWindowed() && (column < l->windowStart() || column > l->windowEnd())) {
+        return l->metrics()->cursorToX(column);
+    }
+
+    return m_textLayout.cursorToX(column - (l ? l->windowStart() : 0));
+}
+
+int KateTextLayout::xToCursor(qreal x) const
+{
+    const KateLineLayout *l = m_lineLayout;
+    if (l && l->isWindowed()) {
+        const int start = l->windowStart();
+        const int end = l->windowEnd();
+        if ((start > 0 && x < l->metrics()->cursorToX(start)) || (end < l->metrics()->length() && x > l->metrics()->cursorToX(end))) {
+            return l->metrics()->xToCursor(x);
+        }
+        return m_textLayout.xToCursor(x) + start;
+    }
+
+    return m_textLayout.xToCursor(x);
+}
+
 KateTextLayout KateTextLayout::invalid()
 {
     return KateTextLayout();
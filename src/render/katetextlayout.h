@@ -62,6 +62,14 @@ public:
     bool isDirty() const;
     bool setDirty(bool dirty = true);
 
+    /**
+     * Column to x position and back, like the QTextLine functions of lineLayout(),
+     * but with columns of the document line. Use these instead of lineLayout(),
+     * in long line mode only a window of the line is laid out.
+     */
+    qreal cursorToX(int column) const;
+    int xToCursor(qreal x) const;
+
     int startX() const;
     int endX() const;
     int width() const;
@@ -83,6 +91,8 @@ public:
 
 private:
     KateLineLayout *m_lineLayout;
+    // keeps the layout m_textLayout points into alive, the line layout might switch to another one
+    std::shared_ptr<QTextLayout> m_layout;
     QTextLine m_textLayout;
 
     int m_viewLine;
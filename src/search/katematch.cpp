@@ -19,7 +19,16 @@ KateMatch::KateMatch(KTextEditor::DocumentPrivate *document, KTextEditor::Search
 
 KTextEditor::Range KateMatch::searchText(KTextEditor::Range range, const QString &pattern)
 {
-    m_resultRanges = m_document->searchText(range, pattern, m_options);
+    if (m_options.testFlag(KTextEditor::Regex)) {
+        const QRegularExpression::PatternOptions patternOptions =
+            m_options.testFlag(KTextEditor::CaseInsensitive) ? QRegularExpression::CaseInsensitiveOption : QRegularExpression::NoPatternOption;
+        if (m_regExp.pattern() != pattern || m_regExp.options() != patternOptions) {
+            m_regExp = KateRegExpSearchPattern(pattern, patternOptions);
+        }
+        m_resultRanges = m_document->searchText(range, m_regExp, m_options.testFlag(KTextEditor::Backwards));
+    } else {
+        m_resultRanges = m_document->searchText(range, pattern, m_options);
+    }
 
     return m_resultRanges[0];
 }
@@ -10,6 +10,8 @@
 
 #include <memory>
 
+#include "kateregexpsearch.h"
+
 #include <ktexteditor/document.h>
 #include <ktexteditor/movingrange.h>
 
@@ -39,6 +41,11 @@ private:
     const KTextEditor::SearchOptions m_options;
     QList<KTextEditor::Range> m_resultRanges;
 
+    /**
+     * compiled pattern for regex mode, reused as long as the pattern doesn't change
+     */
+    KateRegExpSearchPattern m_regExp;
+
     /**
      * moving range to track replace changes
      * kept for later reuse
@@ -11,6 +11,10 @@
 #include "katepartdebug.h" // for LOG_KTE
 
 #include <ktexteditor/document.h>
+
+#include <algorithm>
+#include <limits>
+#include <vector>
 // END  includes
 
 // Turn debug messages on/off here
@@ -153,261 +157,727 @@ KateRegExpSearch::KateRegExpSearch(const KTextEditor::Document *document)
 {
 }
 
-// helper structs for captures re-construction
-struct TwoViewCursor {
-    int index;
-    int line;
-    int col;
-};
-
-struct IndexPair {
-    int openIndex;
-    int closeIndex;
-};
-
-QList<KTextEditor::Range>
-KateRegExpSearch::search(const QString &pattern, KTextEditor::Range inputRange, bool backwards, QRegularExpression::PatternOptions options)
+namespace
 {
-    // Save regexes to avoid reconstructing regexes all the time
-    static QRegularExpression preRegex;
-    static QRegularExpression repairedRegex;
+/**
+ * Conservative estimation of the number of line feeds a match of a pattern can contain.
+ * Counts everything that might match a line feed, any construct or escape that is not
+ * fully understood counts as unbounded.
+ * Only used to limit what needs to be repainted or searched again around a change,
+ * the search itself doesn't depend on it, see KateRegExpSearch::searchMultiLine().
+ */
+class LineSpanParser
+{
+public:
+    static constexpr int Unbounded = -1;
 
-    // Returned if no matches are found
-    QList<KTextEditor::Range> noResult(1, KTextEditor::Range::invalid());
+    LineSpanParser(QStringView pattern, bool dotMatchesLineFeed)
+        : m_pattern(pattern)
+        , m_dotMatchesLineFeed(dotMatchesLineFeed)
+    {
+    }
 
-    // Note that some methods in vimode (e.g. Searcher::findPatternWorker) rely on the
-    // this method returning here if 'pattern' is empty.
-    if (pattern.isEmpty() || inputRange.isEmpty() || !inputRange.isValid()) {
-        return noResult;
+    int parse()
+    {
+        const int lines = alternatives();
+
+        // unbalanced parentheses or something we don't understand
+        if (!atEnd() || m_unsupported) {
+            return Unbounded;
+        }
+        return lines;
     }
 
-    // Always enable Unicode support
-    options |= QRegularExpression::UseUnicodePropertiesOption;
+private:
+    // larger spans are as good as unbounded
+    static constexpr int MaxLines = 100000;
 
-    if (preRegex.pattern() != pattern || preRegex.patternOptions() != options) {
-        preRegex = QRegularExpression(pattern, options);
+    static int add(int a, int b)
+    {
+        if (a == Unbounded || b == Unbounded || a + b > MaxLines) {
+            return Unbounded;
+        }
+        return a + b;
     }
 
-    // If repairPattern() is called on an invalid regex pattern it may cause asserts
-    // in QString (e.g. if the pattern is just '\\', pattern.size() is 1, and repaierPattern
-    // expects at least one character after a '\')
-    if (!preRegex.isValid()) {
-        return noResult;
+    static int multiply(int lines, int count)
+    {
+        if (lines == 0) {
+            return 0;
+        }
+        if (lines == Unbounded || count == Unbounded || qint64(lines) * count > MaxLines) {
+            return Unbounded;
+        }
+        return lines * count;
     }
 
-    // detect pattern type (single- or mutli-line)
-    bool stillMultiLine;
-    const QString repairedPattern = repairPattern(pattern, stillMultiLine);
+    static int maximum(int a, int b)
+    {
+        return (a == Unbounded || b == Unbounded) ? Unbounded : std::max(a, b);
+    }
 
-    // Enable multiline mode, so that the ^ and $ metacharacters in the pattern
-    // are allowed to match, respectively, immediately after and immediately
-    // before any newline in the subject string, as well as at the very beginning
-    // and at the very end of the subject string (see QRegularExpression docs).
-    //
-    // Whole lines are passed to QRegularExpression, so that e.g. if the inputRange
-    // ends in the middle of a line, then a '$' won't match at that position. And
-    // matches that are out of the inputRange are rejected.
-    if (stillMultiLine) {
-        options |= QRegularExpression::MultilineOption;
+    static bool isHexDigit(QChar c)
+    {
+        return c.isDigit() || (c.toLower() >= QLatin1Char('a') && c.toLower() <= QLatin1Char('f'));
     }
 
-    // check if anything changed at all
-    if (repairedRegex.pattern() != repairedPattern || repairedRegex.patternOptions() != options) {
-        repairedRegex.setPattern(repairedPattern);
-        repairedRegex.setPatternOptions(options);
+    static bool isOption(QChar c)
+    {
+        return c != QChar() && QStringView(u"imnsxJU-^").contains(c);
     }
-    if (!repairedRegex.isValid()) {
-        return noResult;
+
+    bool atEnd() const
+    {
+        return m_pos >= m_pattern.size();
     }
 
-    const int rangeStartLine = inputRange.start().line();
-    const int rangeStartCol = inputRange.start().column();
+    QChar peek(qsizetype ahead = 0) const
+    {
+        return (m_pos + ahead < m_pattern.size()) ? m_pattern[m_pos + ahead] : QChar();
+    }
 
-    const int rangeEndLine = inputRange.end().line();
-    const int rangeEndCol = inputRange.end().column();
+    void skipPast(QChar c)
+    {
+        while (!atEnd() && m_pattern[m_pos++] != c) { }
+    }
 
-    if (stillMultiLine) {
-        const int rangeLineCount = rangeEndLine - rangeStartLine + 1;
-        FAST_DEBUG("regular expression search (lines " << rangeStartLine << ".." << rangeEndLine << ")");
+    int alternatives()
+    {
+        int lines = sequence();
+        while (peek() == QLatin1Char('|')) {
+            ++m_pos;
+            lines = maximum(lines, sequence());
+        }
+        return lines;
+    }
 
-        const int docLineCount = m_document->lines();
-        // nothing to do...
-        if (rangeStartLine >= docLineCount) {
-            return noResult;
+    int sequence()
+    {
+        int lines = 0;
+        while (!atEnd() && peek() != QLatin1Char('|') && peek() != QLatin1Char(')')) {
+            lines = add(lines, quantified(atom()));
         }
+        return lines;
+    }
 
-        QList<int> lineLens(rangeLineCount);
-        int maxMatchOffset = 0;
+    int quantified(int lines)
+    {
+        int maxCount = 1;
+        switch (peek().unicode()) {
+        case L'*':
+        case L'+':
+            ++m_pos;
+            maxCount = Unbounded;
+            break;
 
-        // all lines in the input range
-        QString wholeRange;
-        for (int i = 0; i < rangeLineCount; ++i) {
-            const int docLineIndex = rangeStartLine + i;
-            if (docLineIndex < 0 || docLineCount <= docLineIndex) { // invalid index
-                return noResult;
-            }
+        case L'?':
+            ++m_pos;
+            break;
 
-            const QString textLine = m_document->line(docLineIndex);
-            lineLens[i] = textLine.length();
-            wholeRange.append(textLine);
-
-            // This check is needed as some parts in vimode rely on this behaviour.
-            // We add an '\n' as a delimiter between lines in the range; but never after the
-            // last line as that would add an '\n' that isn't there in the original text,
-            // and can skew search results or hit an assert when accessing lineLens later
-            // in the code.
-            if (i != (rangeLineCount - 1)) {
-                wholeRange.append(QLatin1Char('\n'));
+        case L'{': {
+            // {n}, {n,}, {n,m} or {,m}, everything else is a literal brace
+            qsizetype pos = m_pos + 1;
+            auto readNumber = [this, &pos]() {
+                int number = -1;
+                while (pos < m_pattern.size() && m_pattern[pos].isDigit()) {
+                    number = std::min(std::max(number, 0) * 10 + m_pattern[pos].digitValue(), MaxLines);
+                    ++pos;
+                }
+                return number;
+            };
+            const int minCount = readNumber();
+            maxCount = minCount;
+            bool hasComma = false;
+            if (pos < m_pattern.size() && m_pattern[pos] == QLatin1Char(',')) {
+                hasComma = true;
+                ++pos;
+                maxCount = readNumber();
             }
+            if ((minCount < 0 && maxCount < 0) || (!hasComma && minCount < 0) || pos >= m_pattern.size() || m_pattern[pos] != QLatin1Char('}')) {
+                return lines;
+            }
+            m_pos = pos + 1;
+            break;
+        }
 
-            // lineLens.at(i) + 1, because '\n' was added
-            maxMatchOffset += (i == rangeEndLine) ? rangeEndCol : lineLens.at(i) + 1;
+        default:
+            return lines;
+        }
 
-            FAST_DEBUG("  line" << i << "has length" << lineLens.at(i));
+        // lazy or possessive
+        if (peek() == QLatin1Char('?') || peek() == QLatin1Char('+')) {
+            ++m_pos;
         }
+        return multiply(lines, maxCount);
+    }
 
-        FAST_DEBUG("Max. match offset" << maxMatchOffset);
+    int atom()
+    {
+        switch (m_pattern[m_pos++].unicode()) {
+        case L'(':
+            return group();
+        case L'[':
+            return characterClass();
+        case L'\\':
+            return escape(false);
+        case L'.':
+            return m_dotMatchesLineFeed ? 1 : 0;
+        case L'\n':
+            return 1;
+        default:
+            return 0;
+        }
+    }
 
-        QRegularExpressionMatch match;
-        bool found = false;
-        QRegularExpressionMatchIterator iter = repairedRegex.globalMatch(wholeRange, rangeStartCol);
+    int groupBody()
+    {
+        const int lines = alternatives();
+        if (atEnd()) {
+            m_unsupported = true;
+            return Unbounded;
+        }
 
-        if (backwards) {
-            while (iter.hasNext()) {
-                QRegularExpressionMatch curMatch = iter.next();
-                if (curMatch.capturedEnd() <= maxMatchOffset) {
-                    match.swap(curMatch);
-                    found = true;
+        // skip ')'
+        ++m_pos;
+        return lines;
+    }
+
+    int group()
+    {
+        // verbs like (*FAIL), everything with an argument or a pattern inside like (*plb:...) is not understood
+        if (peek() == QLatin1Char('*')) {
+            ++m_pos;
+            while (peek().isUpper() || peek() == QLatin1Char('_')) {
+                ++m_pos;
+            }
+            if (peek() != QLatin1Char(')')) {
+                m_unsupported = true;
+                return Unbounded;
+            }
+            ++m_pos;
+            return 0;
+        }
+
+        if (peek() != QLatin1Char('?')) {
+            return groupBody();
+        }
+        ++m_pos;
+
+        switch (peek().unicode()) {
+        case L'#':
+            skipPast(QLatin1Char(')'));
+            return 0;
+
+        case L':':
+        case L'|':
+        case L'>':
+        case L'=':
+        case L'!':
+            ++m_pos;
+            return groupBody();
+
+        case L'<':
+            ++m_pos;
+            if (peek() == QLatin1Char('=') || peek() == QLatin1Char('!')) {
+                ++m_pos;
+                return groupBody();
+            }
+            skipPast(QLatin1Char('>'));
+            return groupBody();
+
+        case L'\'':
+            ++m_pos;
+            skipPast(QLatin1Char('\''));
+            return groupBody();
+
+        case L'P':
+            if (peek(1) == QLatin1Char('<')) {
+                skipPast(QLatin1Char('>'));
+                return groupBody();
+            }
+            break;
+
+        default:
+            // inline options, for the rest of the group or for a non-capturing group
+            if (isOption(peek())) {
+                while (isOption(peek())) {
+                    const QChar option = m_pattern[m_pos++];
+                    if (option == QLatin1Char('s')) {
+                        m_dotMatchesLineFeed = true;
+                    } else if (option == QLatin1Char('x')) {
+                        // comments could contain anything
+                        m_unsupported = true;
+                    }
+                }
+                if (peek() == QLatin1Char(':')) {
+                    ++m_pos;
+                    return groupBody();
+                }
+                if (peek() == QLatin1Char(')')) {
+                    ++m_pos;
+                    return 0;
                 }
             }
-        } else { /* forwards */
-            QRegularExpressionMatch curMatch;
-            if (iter.hasNext()) {
-                curMatch = iter.next();
+            break;
+        }
+
+        // recursion, subroutine calls, conditionals, callouts, named back references
+        m_unsupported = true;
+        return Unbounded;
+    }
+
+    int characterClass()
+    {
+        // the previous literal, for ranges
+        constexpr int NoLiteral = -1;
+        constexpr int UnknownLiteral = -2;
+
+        int lines = 0;
+        if (peek() == QLatin1Char('^')) {
+            ++m_pos;
+            lines = 1;
+        }
+
+        // a leading ']' is a literal
+        if (peek() == QLatin1Char(']')) {
+            ++m_pos;
+        }
+
+        int previous = NoLiteral;
+        while (!atEnd()) {
+            const QChar c = m_pattern[m_pos++];
+            if (c == QLatin1Char(']')) {
+                return lines;
             }
-            if (curMatch.capturedEnd() <= maxMatchOffset) {
-                match.swap(curMatch);
-                found = true;
+
+            if (c == QLatin1Char('\\')) {
+                if (escape(true) != 0) {
+                    lines = 1;
+                }
+                previous = UnknownLiteral;
+            } else if (c == QLatin1Char('[') && peek() == QLatin1Char(':') && m_pattern.indexOf(u":]", m_pos + 1) >= 0) {
+                // POSIX classes like [:space:]
+                const qsizetype end = m_pattern.indexOf(u":]", m_pos + 1);
+                const QStringView name = m_pattern.mid(m_pos + 1, end - m_pos - 1);
+                if (name.startsWith(QLatin1Char('^')) || name == QLatin1String("space") || name == QLatin1String("cntrl") || name == QLatin1String("ascii")) {
+                    lines = 1;
+                }
+                m_pos = end + 2;
+                previous = NoLiteral;
+            } else if (c == QLatin1Char('-') && previous != NoLiteral && !atEnd() && peek() != QLatin1Char(']')) {
+                // range, escaped ends are not decoded, be conservative then
+                const QChar end = m_pattern[m_pos++];
+                if (end == QLatin1Char('\\')) {
+                    escape(true);
+                    lines = 1;
+                } else if (previous == UnknownLiteral || (previous <= L'\n' && end.unicode() >= L'\n')) {
+                    lines = 1;
+                }
+                previous = NoLiteral;
+            } else {
+                if (c == QLatin1Char('\n')) {
+                    lines = 1;
+                }
+                previous = c.unicode();
             }
         }
 
-        if (!found) {
-            // no match
-            FAST_DEBUG("not found");
-            return noResult;
-        }
-
-        // Capture groups: save opening and closing indices and build a map,
-        // the correct values will be written into it later
-        QMap<int, TwoViewCursor *> indicesToCursors;
-        const int numCaptures = repairedRegex.captureCount();
-        QList<IndexPair> indexPairs(numCaptures + 1);
-        for (int c = 0; c <= numCaptures; ++c) {
-            const int openIndex = match.capturedStart(c);
-            IndexPair &pair = indexPairs[c];
-            if (openIndex == -1) {
-                // An invalid index indicates an empty capture group
-                pair.openIndex = -1;
-                pair.closeIndex = -1;
-                FAST_DEBUG("capture []");
+        // unterminated
+        m_unsupported = true;
+        return Unbounded;
+    }
+
+    int escape(bool insideClass)
+    {
+        if (atEnd()) {
+            return 0;
+        }
+
+        const QChar c = m_pattern[m_pos++];
+        switch (c.unicode()) {
+        case L'n':
+        case L'v':
+        case L'R':
+        case L's':
+        case L'S':
+        case L'W':
+        case L'D':
+        case L'H':
+        case L'X':
+        case L'C':
+            return 1;
+
+        case L'x':
+            if (peek() == QLatin1Char('{')) {
+                skipPast(QLatin1Char('}'));
             } else {
-                const int closeIndex = match.capturedEnd(c);
-                pair.openIndex = openIndex;
-                pair.closeIndex = closeIndex;
-                FAST_DEBUG("capture [" << pair.openIndex << ".." << pair.closeIndex << "]");
-
-                // each key no more than once
-                if (!indicesToCursors.contains(openIndex)) {
-                    TwoViewCursor *twoViewCursor = new TwoViewCursor;
-                    twoViewCursor->index = openIndex;
-                    indicesToCursors.insert(openIndex, twoViewCursor);
-                    FAST_DEBUG("  capture group start index added: " << openIndex);
+                for (int i = 0; i < 2 && isHexDigit(peek()); ++i) {
+                    ++m_pos;
+                }
+            }
+            return 1;
+
+        case L'o':
+            skipPast(QLatin1Char('}'));
+            return 1;
+
+        case L'c':
+            if (!atEnd()) {
+                ++m_pos;
+            }
+            return 1;
+
+        case L'p':
+        case L'P':
+            if (peek() == QLatin1Char('{')) {
+                skipPast(QLatin1Char('}'));
+            } else if (!atEnd()) {
+                ++m_pos;
+            }
+            return 1;
+
+        case L'Q': {
+            // literal text up to \E
+            int lines = 0;
+            while (!atEnd()) {
+                if (peek() == QLatin1Char('\\') && peek(1) == QLatin1Char('E')) {
+                    m_pos += 2;
+                    break;
                 }
-                if (!indicesToCursors.contains(closeIndex)) {
-                    TwoViewCursor *twoViewCursor = new TwoViewCursor;
-                    twoViewCursor->index = closeIndex;
-                    indicesToCursors.insert(closeIndex, twoViewCursor);
-                    FAST_DEBUG("  capture group end index added: " << closeIndex);
+                if (m_pattern[m_pos++] == QLatin1Char('\n')) {
+                    ++lines;
                 }
             }
+            return lines;
         }
 
-        // find out where they belong
-        int curRelLine = 0;
-        int curRelCol = 0;
-        int curRelIndex = 0;
-
-        for (TwoViewCursor *twoViewCursor : std::as_const(indicesToCursors)) {
-            // forward to index, save line/col
-            const int index = twoViewCursor->index;
-            FAST_DEBUG("resolving position" << index);
-
-            while (curRelIndex <= index) {
-                FAST_DEBUG("walk pos (" << curRelLine << "," << curRelCol << ") = " << curRelIndex << "relative, steps more to go" << index - curRelIndex);
-
-                const int curRelLineLen = lineLens.at(curRelLine);
-                const int curLineRemainder = curRelLineLen - curRelCol;
-                const int lineFeedIndex = curRelIndex + curLineRemainder;
-                if (index <= lineFeedIndex) {
-                    if (index == lineFeedIndex) {
-                        // on this line _at_ line feed
-                        FAST_DEBUG("  on line feed");
-                        const int absLine = curRelLine + rangeStartLine;
-                        twoViewCursor->line = absLine;
-                        twoViewCursor->col = curRelLineLen;
-
-                        // advance to next line
-                        const int advance = (index - curRelIndex) + 1;
-                        ++curRelLine;
-                        curRelCol = 0;
-                        curRelIndex += advance;
-                    } else { // index < lineFeedIndex
-                        // on this line _before_ line feed
-                        FAST_DEBUG("  before line feed");
-                        const int diff = (index - curRelIndex);
-                        const int absLine = curRelLine + rangeStartLine;
-                        const int absCol = curRelCol + diff;
-                        twoViewCursor->line = absLine;
-                        twoViewCursor->col = absCol;
-
-                        // advance on same line
-                        const int advance = diff + 1;
-                        curRelCol += advance;
-                        curRelIndex += advance;
+        case L'N':
+            // any character but a line feed, \N{U+000A} is a character code
+            if (peek() == QLatin1Char('{')) {
+                m_unsupported = true;
+                return Unbounded;
+            }
+            return 0;
+
+        // character types, anchors and character codes that never match a line feed
+        case L'w':
+        case L'd':
+        case L'h':
+        case L'V':
+        case L'b':
+        case L'B':
+        case L'A':
+        case L'z':
+        case L'Z':
+        case L'G':
+        case L'K':
+        case L'E':
+        case L't':
+        case L'r':
+        case L'f':
+        case L'e':
+        case L'a':
+            return 0;
+
+        default:
+            if (c.isDigit()) {
+                // octal character code
+                if (c == QLatin1Char('0') || insideClass) {
+                    for (int i = 0; i < 2 && peek() >= QLatin1Char('0') && peek() <= QLatin1Char('7'); ++i) {
+                        ++m_pos;
                     }
-                    FAST_DEBUG("position(" << twoViewCursor->line << "," << twoViewCursor->col << ")");
-                } else { // if (index > lineFeedIndex)
-                    // not on this line
-                    // advance to next line
-                    FAST_DEBUG("  not on this line");
-                    ++curRelLine;
-                    curRelCol = 0;
-                    const int advance = curLineRemainder + 1;
-                    curRelIndex += advance;
+                    return 1;
+                }
+
+                // back reference, might repeat any text
+                while (peek().isDigit()) {
+                    ++m_pos;
                 }
+                return Unbounded;
+            }
+
+            // escaped punctuation is a literal, any other escape, e.g. \g or \k, is not understood
+            if (c.isLetterOrNumber() || c.unicode() > 127) {
+                m_unsupported = true;
+                return Unbounded;
             }
+            return 0;
         }
+    }
+
+private:
+    const QStringView m_pattern;
+    qsizetype m_pos = 0;
+    bool m_dotMatchesLineFeed;
+    bool m_unsupported = false;
+};
 
-        // build result array
-        QList<KTextEditor::Range> result(numCaptures + 1, KTextEditor::Range::invalid());
-        for (int y = 0; y <= numCaptures; y++) {
-            IndexPair &pair = indexPairs[y];
-            if (!(pair.openIndex == -1 || pair.closeIndex == -1)) {
-                const TwoViewCursor *const openCursors = indicesToCursors.value(pair.openIndex);
-                const TwoViewCursor *const closeCursors = indicesToCursors.value(pair.closeIndex);
-                const int startLine = openCursors->line;
-                const int startCol = openCursors->col;
-                const int endLine = closeCursors->line;
-                const int endCol = closeCursors->col;
-                FAST_DEBUG("range " << y << ": (" << startLine << ", " << startCol << ")..(" << endLine << ", " << endCol << ")");
-                result[y] = KTextEditor::Range(startLine, startCol, endLine, endCol);
+/**
+ * Consecutive lines of a document joined by '\n', the text multi-line patterns are matched against.
+ * Optionally with the '\n' that follows the last line, if more lines follow.
+ */
+class SearchWindow
+{
+public:
+    SearchWindow(const KTextEditor::Document *document, int firstLine, int lastLine, bool trailingLineFeed)
+        : m_firstLine(firstLine)
+    {
+        m_lineStarts.reserve(lastLine - firstLine + 2);
+        for (int line = firstLine; line <= lastLine; ++line) {
+            if (line != firstLine) {
+                m_text.append(QLatin1Char('\n'));
             }
+            m_lineStarts.push_back(m_text.size());
+            m_text.append(document->line(line));
         }
 
-        // free structs allocated for indicesToCursors
-        qDeleteAll(indicesToCursors);
+        // the next line starts after the line feed
+        if (trailingLineFeed) {
+            m_text.append(QLatin1Char('\n'));
+            m_lineStarts.push_back(m_text.size());
+        }
+    }
+
+    const QString &text() const
+    {
+        return m_text;
+    }
+
+    /**
+     * Offset in text() of the given position, lines behind the window start behind its end.
+     */
+    int offset(int line, int column = 0) const
+    {
+        const int index = line - m_firstLine;
+        return (index < int(m_lineStarts.size())) ? (m_lineStarts[index] + column) : (m_text.size() + 1);
+    }
 
+    KTextEditor::Cursor cursor(int offset) const
+    {
+        const int index = std::upper_bound(m_lineStarts.begin(), m_lineStarts.end(), offset) - m_lineStarts.begin() - 1;
+        return KTextEditor::Cursor(m_firstLine + index, offset - m_lineStarts[index]);
+    }
+
+    QList<KTextEditor::Range> ranges(const QRegularExpressionMatch &match) const
+    {
+        QList<KTextEditor::Range> result(match.regularExpression().captureCount() + 1, KTextEditor::Range::invalid());
+        for (int i = 0; i < result.size(); ++i) {
+            // an invalid index indicates an empty capture group
+            if (match.capturedStart(i) != -1) {
+                result[i] = KTextEditor::Range(cursor(match.capturedStart(i)), cursor(match.capturedEnd(i)));
+            }
+        }
         return result;
+    }
+
+private:
+    const int m_firstLine;
+    QString m_text;
+    std::vector<int> m_lineStarts;
+};
+
+/**
+ * Lines multi-line searches look at in one step, if the pattern allows it.
+ */
+constexpr int SearchWindowLines = 1024;
+
+/**
+ * Whether matches of the pattern might depend on text in front of the window start or on
+ * the subject start, i.e. it contains lookbehinds, verbs or anchors for the subject start/end.
+ * Errs on the side of true, e.g. for escaped backslashes in front of such characters.
+ */
+bool needsWholeRange(const QString &pattern)
+{
+    return pattern.contains(QLatin1String("(?<=")) || pattern.contains(QLatin1String("(?<!")) || pattern.contains(QLatin1String("(*"))
+        || pattern.contains(QLatin1String("\\A")) || pattern.contains(QLatin1String("\\G")) || pattern.contains(QLatin1String("\\Z"))
+        || pattern.contains(QLatin1String("\\z"));
+}
+}
+
+QList<KTextEditor::Range> KateRegExpSearch::searchMultiLine(const QRegularExpression &regex, KTextEditor::Range inputRange, bool backwards) const
+{
+    // Returned if no matches are found
+    const QList<KTextEditor::Range> noResult(1, KTextEditor::Range::invalid());
+
+    const int rangeStartLine = inputRange.start().line();
+    const int rangeEndLine = inputRange.end().line();
+    FAST_DEBUG("regular expression search (lines " << rangeStartLine << ".." << rangeEndLine << ")");
+
+    // nothing to do...
+    if (rangeStartLine < 0 || rangeEndLine >= m_document->lines()) {
+        return noResult;
+    }
+
+    // Instead of the whole range, only a window of lines is matched at once.
+    // PCRE reports a partial match if it would need to look behind the end of the window,
+    // then we retry with more lines. Patterns that might look in front of the window
+    // start or depend on where the subject starts get the whole range as one window.
+    int windowLines = needsWholeRange(regex.pattern()) ? (rangeEndLine - rangeStartLine + 1) : SearchWindowLines;
+
+    if (!backwards) {
+        // find the first match starting at or behind line/column
+        int line = rangeStartLine;
+        int column = inputRange.start().column();
+        while (true) {
+            const int lastLine = std::min(rangeEndLine, line + windowLines - 1);
+            const bool complete = lastLine == rangeEndLine;
+            const SearchWindow window(m_document, line, lastLine, !complete);
+
+            const auto matchType = complete ? QRegularExpression::NormalMatch : QRegularExpression::PartialPreferFirstMatch;
+            const QRegularExpressionMatch match = regex.match(window.text(), window.offset(line, column), matchType);
+            if (match.hasMatch()) {
+                // matches at the trailing line feed are found again with the next lines
+                if (window.cursor(match.capturedStart()).line() <= lastLine) {
+                    return (window.cursor(match.capturedEnd()) <= inputRange.end()) ? window.ranges(match) : noResult;
+                }
+            } else if (match.hasPartialMatch()) {
+                // no match in front of the partial one, continue there with more lines if needed
+                const KTextEditor::Cursor partialStart = window.cursor(match.capturedStart());
+                if (partialStart.line() == line) {
+                    windowLines = std::min(2 * windowLines, std::numeric_limits<int>::max() / 4);
+                }
+                line = partialStart.line();
+                column = partialStart.column();
+                continue;
+            }
+
+            if (complete) {
+                FAST_DEBUG("not found");
+                return noResult;
+            }
+            line = lastLine + 1;
+            column = 0;
+        }
+    }
+
+    // find the last match, walking the windows from the end
+    // the chain restarts at each window, like the single-line search does for each line,
+    // this only makes a difference for overlapping matches crossing the window border
+    // a match starting in the window might reach up to the range end, PCRE tells us with
+    // a partial match if it needs lines behind the window and we retry with more of them
+    int lastStartLine = rangeEndLine;
+    while (lastStartLine >= rangeStartLine) {
+        const int firstStartLine = std::max(rangeStartLine, lastStartLine - windowLines + 1);
+        int lastLine = lastStartLine;
+        while (true) {
+            const bool complete = lastLine == rangeEndLine;
+            const SearchWindow window(m_document, firstStartLine, lastLine, !complete);
+
+            const int startOffset = window.offset(firstStartLine, (firstStartLine == rangeStartLine) ? inputRange.start().column() : 0);
+            const int endOffset = window.offset(lastStartLine + 1);
+
+            const auto matchType = complete ? QRegularExpression::NormalMatch : QRegularExpression::PartialPreferFirstMatch;
+            QRegularExpressionMatchIterator iter = regex.globalMatch(window.text(), startOffset, matchType);
+            QRegularExpressionMatch match;
+            bool partial = false;
+            while (iter.hasNext()) {
+                QRegularExpressionMatch curMatch = iter.next();
+                if (curMatch.capturedStart() >= endOffset) {
+                    break;
+                }
+                if (curMatch.hasPartialMatch()) {
+                    partial = true;
+                    break;
+                }
+                if (window.cursor(curMatch.capturedEnd()) <= inputRange.end()) {
+                    match.swap(curMatch);
+                }
+            }
+
+            if (partial) {
+                lastLine = std::min(rangeEndLine, lastLine + (lastLine - firstStartLine + 1));
+                continue;
+            }
+            if (match.hasMatch()) {
+                return window.ranges(match);
+            }
+            break;
+        }
+        lastStartLine = firstStartLine - 1;
+    }
+
+    FAST_DEBUG("not found");
+    return noResult;
+}
+
+KateRegExpSearchPattern::KateRegExpSearchPattern(const QString &pattern, QRegularExpression::PatternOptions options)
+    : m_pattern(pattern)
+    , m_options(options)
+{
+    if (pattern.isEmpty()) {
+        return;
+    }
+
+    // Always enable Unicode support
+    options |= QRegularExpression::UseUnicodePropertiesOption;
+
+    // If repairPattern() is called on an invalid regex pattern it may cause asserts
+    // in QString (e.g. if the pattern is just '\\', pattern.size() is 1, and repaierPattern
+    // expects at least one character after a '\')
+    if (!QRegularExpression(pattern, options).isValid()) {
+        return;
+    }
+
+    // detect pattern type (single- or mutli-line)
+    const QString repairedPattern = KateRegExpSearch::repairPattern(pattern, m_multiLine);
+
+    // Enable multiline mode, so that the ^ and $ metacharacters in the pattern
+    // are allowed to match, respectively, immediately after and immediately
+    // before any newline in the subject string, as well as at the very beginning
+    // and at the very end of the subject string (see QRegularExpression docs).
+    //
+    // Whole lines are passed to QRegularExpression, so that e.g. if the inputRange
+    // ends in the middle of a line, then a '$' won't match at that position. And
+    // matches that are out of the inputRange are rejected.
+    if (m_multiLine) {
+        options |= QRegularExpression::MultilineOption;
+    }
+
+    m_regex = QRegularExpression(repairedPattern, options);
+    m_valid = m_regex.isValid();
+
+    // compile now, including the JIT, the regex is shared read-only afterwards
+    if (m_valid) {
+        m_regex.optimize();
+    }
+
+    if (m_valid && m_multiLine) {
+        m_lineSpan = (options & QRegularExpression::ExtendedPatternSyntaxOption)
+            ? LineSpanParser::Unbounded
+            : LineSpanParser(repairedPattern, options & QRegularExpression::DotMatchesEverythingOption).parse();
+    }
+}
+
+QList<KTextEditor::Range>
+KateRegExpSearch::search(const QString &pattern, KTextEditor::Range inputRange, bool backwards, QRegularExpression::PatternOptions options) const
+{
+    // Keep the last pattern per thread to avoid recompiling it for repeated searches
+    thread_local KateRegExpSearchPattern lastPattern;
+
+    // Note that some methods in vimode (e.g. Searcher::findPatternWorker) rely on the
+    // this method returning here if 'pattern' is empty.
+    if (pattern.isEmpty() || inputRange.isEmpty() || !inputRange.isValid()) {
+        return {KTextEditor::Range::invalid()};
+    }
+
+    if (lastPattern.pattern() != pattern || lastPattern.options() != options) {
+        lastPattern = KateRegExpSearchPattern(pattern, options);
+    }
+    return search(lastPattern, inputRange, backwards);
+}
+
+QList<KTextEditor::Range> KateRegExpSearch::search(const KateRegExpSearchPattern &pattern, KTextEditor::Range inputRange, bool backwards) const
+{
+    // Returned if no matches are found
+    QList<KTextEditor::Range> noResult(1, KTextEditor::Range::invalid());
+
+    if (!pattern.isValid() || inputRange.isEmpty() || !inputRange.isValid()) {
+        return noResult;
+    }
+
+    const QRegularExpression &repairedRegex = pattern.regularExpression();
+    if (pattern.isMultiLine()) {
+        return searchMultiLine(repairedRegex, inputRange, backwards);
     } else {
         // single-line regex search (forwards and backwards)
         const int rangeStartCol = inputRange.start().column();
@@ -20,6 +20,88 @@ namespace KTextEditor
 class Document;
 }
 
+/**
+ * Regular expression prepared for KateRegExpSearch.
+ *
+ * The pattern is checked, repaired for the line based search and compiled, including the JIT,
+ * once on construction. Afterwards the object is immutable, copies are cheap and searches in
+ * different threads can use it at the same time.
+ */
+class KTEXTEDITOR_EXPORT KateRegExpSearchPattern
+{
+public:
+    /**
+     * Construct an invalid pattern.
+     */
+    KateRegExpSearchPattern() = default;
+
+    /**
+     * Prepare \p pattern for searching.
+     *
+     * \param pattern text to search for
+     * \param options QRegularExpression pattern options, we will internally add QRegularExpression::UseUnicodePropertiesOption
+     *        and QRegularExpression::MultilineOption for multi-line patterns
+     */
+    explicit KateRegExpSearchPattern(const QString &pattern, QRegularExpression::PatternOptions options = QRegularExpression::NoPatternOption);
+
+    /**
+     * The pattern as passed to the constructor.
+     */
+    const QString &pattern() const
+    {
+        return m_pattern;
+    }
+
+    /**
+     * The options as passed to the constructor.
+     */
+    QRegularExpression::PatternOptions options() const
+    {
+        return m_options;
+    }
+
+    /**
+     * Non-empty and valid pattern?
+     */
+    bool isValid() const
+    {
+        return m_valid;
+    }
+
+    /**
+     * Can matches of this pattern span multiple lines?
+     */
+    bool isMultiLine() const
+    {
+        return m_multiLine;
+    }
+
+    /**
+     * Conservative estimation of the number of line feeds a match can contain,
+     * 0 for single-line patterns, -1 if it is not bounded.
+     */
+    int lineSpan() const
+    {
+        return m_lineSpan;
+    }
+
+    /**
+     * The repaired and compiled regular expression that is matched against the text.
+     */
+    const QRegularExpression &regularExpression() const
+    {
+        return m_regex;
+    }
+
+private:
+    QString m_pattern;
+    QRegularExpression::PatternOptions m_options = QRegularExpression::NoPatternOption;
+    QRegularExpression m_regex;
+    bool m_valid = false;
+    bool m_multiLine = false;
+    int m_lineSpan = 0;
+};
+
 /**
  * Object to help to search for regexp.
  * This should be NO QObject, it is created to often!
@@ -58,7 +140,19 @@ public:
     QList<KTextEditor::Range> search(const QString &pattern,
                                      KTextEditor::Range inputRange,
                                      bool backwards = false,
-                                     QRegularExpression::PatternOptions options = QRegularExpression::NoPatternOption);
+                                     QRegularExpression::PatternOptions options = QRegularExpression::NoPatternOption) const;
+
+    /**
+     * Search for the prepared \p pattern inside the range \p inputRange.
+     * Callers that search repeatedly shall keep the KateRegExpSearchPattern around,
+     * then the pattern is compiled only once. Doesn't touch any global state.
+     *
+     * \param pattern prepared pattern to search for
+     * \param inputRange Range to search in
+     * \param backwards if \e true, the search will be backwards
+     * \return see search() above
+     */
+    QList<KTextEditor::Range> search(const KateRegExpSearchPattern &pattern, KTextEditor::Range inputRange, bool backwards = false) const;
 
     /**
      * Returns a modified version of text where escape sequences are resolved, e.g. "\\n" to "\n".
@@ -111,9 +205,25 @@ private:
     KTEXTEDITOR_NO_EXPORT
     static QString repairPattern(const QString &pattern, bool &stillMultiLine);
 
+    /**
+     * Implementation of search() for patterns that can match line feeds.
+     * Matches a sliding window of lines instead of the whole range.
+     * Only matches that end inside of \p inputRange are found, like for single-line patterns.
+     *
+     * \param regex the repaired regular expression
+     * \param inputRange Range to search in
+     * \param backwards if \e true, the search will be backwards
+     * \return see search()
+     */
+    KTEXTEDITOR_NO_EXPORT
+    QList<KTextEditor::Range> searchMultiLine(const QRegularExpression &regex, KTextEditor::Range inputRange, bool backwards) const;
+
 private:
     const KTextEditor::Document *const m_document;
     class ReplacementStream;
+
+    // uses repairPattern()
+    friend class KateRegExpSearchPattern;
 };
 
 #endif
@@ -1632,12 +1632,11 @@ void KateSearchBar::enterIncrementalMode()
 bool KateSearchBar::clearHighlights()
 {
     // Remove ScrollBarMarks
-    const QHash<int, KTextEditor::Mark *> &marks = m_view->document()->marks();
-    QHashIterator<int, KTextEditor::Mark *> i(marks);
-    while (i.hasNext()) {
-        i.next();
-        if (i.value()->type & KTextEditor::Document::SearchMatch) {
-            m_view->document()->removeMark(i.value()->line, KTextEditor::Document::SearchMatch);
+    // work on a copy of the marks, the removing will modify the index otherwise
+    const auto marks = m_view->doc()->markIndex().marks();
+    for (KTextEditor::Mark *mark : marks) {
+        if (mark->type & KTextEditor::Document::SearchMatch) {
+            m_view->doc()->removeMark(mark->line, KTextEditor::Document::SearchMatch);
         }
     }
 
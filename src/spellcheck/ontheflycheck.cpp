@@ -9,6 +9,8 @@
 #include <QRegularExpression>
 #include <QTimer>
 
+#include <algorithm>
+
 #include "katebuffer.h"
 #include "kateconfig.h"
 #include "kateglobal.h"
@@ -19,24 +21,9 @@
 
 #define ON_THE_FLY_DEBUG qCDebug(LOG_KTE)
 
-namespace
-{
-inline KateOnTheFlyChecker::SpellCheckItem invalidSpellCheckQueueItem()
-{
-    return KateOnTheFlyChecker::SpellCheckItem(nullptr, QString());
-}
-
-bool operator==(const KateOnTheFlyChecker::SpellCheckItem &l, const KateOnTheFlyChecker::SpellCheckItem &r)
-{
-    return l.range == r.range && l.dictionary == r.dictionary;
-}
-}
-
 KateOnTheFlyChecker::KateOnTheFlyChecker(KTextEditor::DocumentPrivate *document)
     : QObject(document)
     , m_document(document)
-    , m_backgroundChecker(nullptr)
-    , m_currentlyCheckedItem(invalidSpellCheckQueueItem())
     , m_refreshView(nullptr)
 {
     ON_THE_FLY_DEBUG << "created";
@@ -146,24 +133,21 @@ void KateOnTheFlyChecker::handleInsertedText(KTextEditor::Range range)
     KTextEditor::Range consideredRange = range;
     ON_THE_FLY_DEBUG << m_document << range;
 
-    bool spellCheckInProgress = m_currentlyCheckedItem != invalidSpellCheckQueueItem();
-
-    if (spellCheckInProgress) {
-        KTextEditor::MovingRange *spellCheckRange = m_currentlyCheckedItem.range;
+    bool spellCheckInProgress = false;
+    for (CheckedItem &checkedItem : m_currentlyCheckedItems) {
+        KTextEditor::MovingRange *spellCheckRange = checkedItem.item.range;
+        if (!spellCheckRange) {
+            continue;
+        }
         if (spellCheckRange->contains(consideredRange)) {
             consideredRange = *spellCheckRange;
-            stopCurrentSpellCheck();
-            deleteMovingRangeQuickly(spellCheckRange);
-        } else if (consideredRange.contains(*spellCheckRange)) {
-            stopCurrentSpellCheck();
-            deleteMovingRangeQuickly(spellCheckRange);
-        } else if (consideredRange.overlaps(*spellCheckRange)) {
+        } else if (consideredRange.contains(*spellCheckRange) || consideredRange.overlaps(*spellCheckRange)) {
             consideredRange.expandToRange(*spellCheckRange);
-            stopCurrentSpellCheck();
-            deleteMovingRangeQuickly(spellCheckRange);
         } else {
-            spellCheckInProgress = false;
+            continue;
         }
+        dropCurrentlyCheckedRange(checkedItem);
+        spellCheckInProgress = true;
     }
     for (auto i = m_spellCheckQueue.begin(); i != m_spellCheckQueue.end();) {
         KTextEditor::MovingRange *spellCheckRange = (*i).range;
@@ -252,22 +236,23 @@ void KateOnTheFlyChecker::handleRemovedText(KTextEditor::Range range)
             ++i;
         }
     }
-    bool spellCheckInProgress = m_currentlyCheckedItem != invalidSpellCheckQueueItem();
+    bool spellCheckInProgress = false;
     const bool emptyAtStart = m_spellCheckQueue.isEmpty();
-    if (spellCheckInProgress) {
-        KTextEditor::MovingRange *spellCheckRange = m_currentlyCheckedItem.range;
+    for (CheckedItem &checkedItem : m_currentlyCheckedItems) {
+        KTextEditor::MovingRange *spellCheckRange = checkedItem.item.range;
+        if (!spellCheckRange) {
+            continue;
+        }
         ON_THE_FLY_DEBUG << *spellCheckRange;
         if (m_document->documentRange().contains(*spellCheckRange) && (rangesAdjacent(*spellCheckRange, range) || spellCheckRange->contains(range))
             && !spellCheckRange->isEmpty()) {
             rangesToReCheck.push_back(*spellCheckRange);
             ON_THE_FLY_DEBUG << "added the range " << *spellCheckRange;
-            stopCurrentSpellCheck();
-            deleteMovingRangeQuickly(spellCheckRange);
+            dropCurrentlyCheckedRange(checkedItem);
+            spellCheckInProgress = true;
         } else if (spellCheckRange->isEmpty()) {
-            stopCurrentSpellCheck();
-            deleteMovingRangeQuickly(spellCheckRange);
-        } else {
-            spellCheckInProgress = false;
+            dropCurrentlyCheckedRange(checkedItem);
+            spellCheckInProgress = true;
         }
     }
     for (QList<KTextEditor::Range>::iterator i = rangesToReCheck.begin(); i != rangesToReCheck.end(); ++i) {
@@ -316,9 +301,10 @@ void KateOnTheFlyChecker::freeDocument()
         deleteMovingRangeQuickly(movingRange);
         i = m_spellCheckQueue.erase(i);
     }
-    if (m_currentlyCheckedItem != invalidSpellCheckQueueItem()) {
-        KTextEditor::MovingRange *movingRange = m_currentlyCheckedItem.range;
-        deleteMovingRangeQuickly(movingRange);
+    for (CheckedItem &checkedItem : m_currentlyCheckedItems) {
+        if (checkedItem.item.range) {
+            dropCurrentlyCheckedRange(checkedItem);
+        }
     }
     stopCurrentSpellCheck();
 
@@ -332,7 +318,7 @@ void KateOnTheFlyChecker::freeDocument()
 
 void KateOnTheFlyChecker::performSpellCheck()
 {
-    if (m_currentlyCheckedItem != invalidSpellCheckQueueItem()) {
+    if (!m_currentlyCheckedItems.isEmpty()) {
         ON_THE_FLY_DEBUG << "exited as a check is currently in progress";
         return;
     }
@@ -340,52 +326,31 @@ void KateOnTheFlyChecker::performSpellCheck()
         ON_THE_FLY_DEBUG << "exited as there is nothing to do";
         return;
     }
-    m_currentlyCheckedItem = m_spellCheckQueue.takeFirst();
 
-    KTextEditor::MovingRange *spellCheckRange = m_currentlyCheckedItem.range;
-    const QString &language = m_currentlyCheckedItem.dictionary;
-    ON_THE_FLY_DEBUG << "for the range " << *spellCheckRange;
-    // clear all the highlights that are currently present in the range that
-    // is supposed to be checked
-    const QList<KTextEditor::MovingRange *> highlightsList = installedMovingRanges(*spellCheckRange); // make a copy!
-    deleteMovingRanges(highlightsList);
+    // check a batch of queued ranges at once in the background, the text is decoded here
+    // and the ranges are only updated once the results arrive, if the text is still the same
+    static const qsizetype maximumBatchSize = 64;
+    QList<KateSpellCheckManager::TextToCheck> texts;
+    while (!m_spellCheckQueue.isEmpty() && m_currentlyCheckedItems.size() < maximumBatchSize) {
+        CheckedItem checkedItem;
+        checkedItem.item = m_spellCheckQueue.takeFirst();
+        KTextEditor::MovingRange *spellCheckRange = checkedItem.item.range;
+        ON_THE_FLY_DEBUG << "for the range " << *spellCheckRange;
 
-    m_currentDecToEncOffsetList.clear();
-    KateSpellCheckManager::OffsetList encToDecOffsetList;
-    QString text = KateSpellCheckManager::decodeCharacters(m_document, *spellCheckRange, m_currentDecToEncOffsetList, encToDecOffsetList);
-    ON_THE_FLY_DEBUG << "next spell checking" << text;
-    if (text.isEmpty()) { // passing an empty string to Sonnet can lead to a bad allocation exception
-        spellCheckDone(); // (bug 225867)
-        return;
-    }
-    if (m_speller.language() != language) {
-        m_speller.setLanguage(language);
-    }
-    if (!m_backgroundChecker) {
-        m_backgroundChecker = new Sonnet::BackgroundChecker(m_speller, this);
-        connect(m_backgroundChecker, &Sonnet::BackgroundChecker::misspelling, this, &KateOnTheFlyChecker::misspelling);
-        connect(m_backgroundChecker, &Sonnet::BackgroundChecker::done, this, &KateOnTheFlyChecker::spellCheckDone);
-
-        KateSpellCheckManager *m_spellCheckManager = KTextEditor::EditorPrivate::self()->spellCheckManager();
-        connect(m_spellCheckManager, &KateSpellCheckManager::wordAddedToDictionary, this, &KateOnTheFlyChecker::addToDictionary);
-        connect(m_spellCheckManager, &KateSpellCheckManager::wordIgnored, this, &KateOnTheFlyChecker::addToSession);
-    }
-    m_backgroundChecker->setSpeller(m_speller);
-    m_backgroundChecker->setText(text); // don't call 'start()' after this!
-}
+        checkedItem.text = m_document->text(*spellCheckRange);
+        KateSpellCheckManager::OffsetList encToDecOffsetList;
+        const QString text = KateSpellCheckManager::decodeCharacters(m_document, *spellCheckRange, checkedItem.decToEncOffsetList, encToDecOffsetList);
+        ON_THE_FLY_DEBUG << "next spell checking" << text;
 
-void KateOnTheFlyChecker::addToDictionary(const QString &word)
-{
-    if (m_backgroundChecker) {
-        m_backgroundChecker->addWordToPersonal(word);
+        texts.push_back({text, checkedItem.item.dictionary});
+        m_currentlyCheckedItems.push_back(checkedItem);
     }
-}
 
-void KateOnTheFlyChecker::addToSession(const QString &word)
-{
-    if (m_backgroundChecker) {
-        m_backgroundChecker->addWordToSession(word);
-    }
+    const quint64 spellCheck = ++m_currentSpellCheck;
+    const auto done = [this, spellCheck](const QList<KateSpellCheckManager::MisspellingList> &misspellingLists) {
+        spellCheckDone(spellCheck, misspellingLists);
+    };
+    KTextEditor::EditorPrivate::self()->spellCheckManager()->checkSpelling(texts, this, done);
 }
 
 void KateOnTheFlyChecker::removeRangeFromEverything(KTextEditor::MovingRange *movingRange)
@@ -414,20 +379,27 @@ void KateOnTheFlyChecker::removeRangeFromEverything(KTextEditor::MovingRange *mo
 
 bool KateOnTheFlyChecker::removeRangeFromCurrentSpellCheck(KTextEditor::MovingRange *range)
 {
-    if (m_currentlyCheckedItem != invalidSpellCheckQueueItem() && m_currentlyCheckedItem.range == range) {
-        stopCurrentSpellCheck();
-        return true;
+    for (CheckedItem &checkedItem : m_currentlyCheckedItems) {
+        if (checkedItem.item.range == range) {
+            // the result for this range is ignored, the range itself is deleted by the caller
+            checkedItem.item.range = nullptr;
+            return true;
+        }
     }
     return false;
 }
 
+void KateOnTheFlyChecker::dropCurrentlyCheckedRange(CheckedItem &checkedItem)
+{
+    deleteMovingRangeQuickly(checkedItem.item.range);
+    checkedItem.item.range = nullptr;
+}
+
 void KateOnTheFlyChecker::stopCurrentSpellCheck()
 {
-    m_currentDecToEncOffsetList.clear();
-    m_currentlyCheckedItem = invalidSpellCheckQueueItem();
-    if (m_backgroundChecker) {
-        m_backgroundChecker->stop();
-    }
+    // the results of the running check will be ignored
+    m_currentlyCheckedItems.clear();
+    ++m_currentSpellCheck;
 }
 
 bool KateOnTheFlyChecker::removeRangeFromSpellCheckQueue(KTextEditor::MovingRange *range)
@@ -548,56 +520,91 @@ KTextEditor::Range KateOnTheFlyChecker::findWordBoundaries(const KTextEditor::Cu
     return KTextEditor::Range(boundaryStart, boundaryEnd);
 }
 
-void KateOnTheFlyChecker::misspelling(const QString &word, int start)
+void KateOnTheFlyChecker::spellCheckDone(quint64 spellCheck, const QList<KateSpellCheckManager::MisspellingList> &misspellingLists)
 {
-    if (m_currentlyCheckedItem == invalidSpellCheckQueueItem()) {
-        ON_THE_FLY_DEBUG << "exited as no spell check is taking place";
+    ON_THE_FLY_DEBUG << "on-the-fly spell check done, queue length " << m_spellCheckQueue.size();
+    if (spellCheck != m_currentSpellCheck) {
+        ON_THE_FLY_DEBUG << "exited as the spell check was stopped";
         return;
     }
-    int translatedStart = KateSpellCheckManager::computePositionWrtOffsets(m_currentDecToEncOffsetList, start);
-    //   ON_THE_FLY_DEBUG << "misspelled " << word
-    //                                     << " at line "
-    //                                     << *m_currentlyCheckedItem.first
-    //                                     << " column " << start;
+    Q_ASSERT(misspellingLists.size() == m_currentlyCheckedItems.size());
 
-    KTextEditor::MovingRange *spellCheckRange = m_currentlyCheckedItem.range;
-    int line = spellCheckRange->start().line();
-    int rangeStart = spellCheckRange->start().column();
-    int translatedEnd = KateSpellCheckManager::computePositionWrtOffsets(m_currentDecToEncOffsetList, start + word.length());
+    const QList<CheckedItem> checkedItems = m_currentlyCheckedItems;
+    stopCurrentSpellCheck();
 
-    KTextEditor::MovingRange *movingRange =
-        m_document->newMovingRange(KTextEditor::Range(line, rangeStart + translatedStart, line, rangeStart + translatedEnd));
-    movingRange->setFeedback(this);
-    KTextEditor::Attribute *attribute = new KTextEditor::Attribute();
-    attribute->setUnderlineStyle(QTextCharFormat::SpellCheckUnderline);
-    attribute->setUnderlineColor(KateRendererConfig::global()->spellingMistakeLineColor());
+    for (qsizetype i = 0; i < checkedItems.size(); ++i) {
+        const CheckedItem &checkedItem = checkedItems[i];
+        KTextEditor::MovingRange *movingRange = checkedItem.item.range;
+        if (!movingRange) {
+            continue;
+        }
 
-    // don't print this range
-    movingRange->setAttributeOnlyForViews(true);
+        // changed since the text was decoded, the modification is not handled yet
+        if (m_document->text(*movingRange) != checkedItem.text) {
+            addToSpellCheckQueue(movingRange, checkedItem.item.dictionary);
+            continue;
+        }
 
-    movingRange->setAttribute(KTextEditor::Attribute::Ptr(attribute));
-    m_misspelledList.push_back(SpellCheckItem(movingRange, m_currentlyCheckedItem.dictionary));
+        updateMisspellings(checkedItem, misspellingLists[i]);
+        deleteMovingRangeQuickly(movingRange);
+    }
 
-    if (m_backgroundChecker) {
-        m_backgroundChecker->continueChecking();
+    if (!m_spellCheckQueue.empty()) {
+        QTimer::singleShot(0, this, &KateOnTheFlyChecker::performSpellCheck);
     }
 }
 
-void KateOnTheFlyChecker::spellCheckDone()
+void KateOnTheFlyChecker::updateMisspellings(const CheckedItem &checkedItem, const KateSpellCheckManager::MisspellingList &misspellings)
 {
-    ON_THE_FLY_DEBUG << "on-the-fly spell check done, queue length " << m_spellCheckQueue.size();
-    if (m_currentlyCheckedItem == invalidSpellCheckQueueItem()) {
-        return;
+    const KTextEditor::Range checkedRange = checkedItem.item.range->toRange();
+    const QString &dictionary = checkedItem.item.dictionary;
+    const int line = checkedRange.start().line();
+    const int rangeStart = checkedRange.start().column();
+
+    QList<KTextEditor::Range> misspelledRanges;
+    misspelledRanges.reserve(misspellings.size());
+    for (const auto &[start, length] : misspellings) {
+        const int translatedStart = KateSpellCheckManager::computePositionWrtOffsets(checkedItem.decToEncOffsetList, start);
+        const int translatedEnd = KateSpellCheckManager::computePositionWrtOffsets(checkedItem.decToEncOffsetList, start + length);
+        misspelledRanges.push_back(KTextEditor::Range(line, rangeStart + translatedStart, line, rangeStart + translatedEnd));
     }
-    KTextEditor::MovingRange *movingRange = m_currentlyCheckedItem.range;
-    stopCurrentSpellCheck();
-    deleteMovingRangeQuickly(movingRange);
 
-    if (!m_spellCheckQueue.empty()) {
-        QTimer::singleShot(0, this, &KateOnTheFlyChecker::performSpellCheck);
+    // keep the misspellings that are still there, that avoids flicker and the
+    // recreation of the moving ranges, only the changed ones are replaced
+    QList<KTextEditor::MovingRange *> toDelete;
+    for (const SpellCheckItem &item : std::as_const(m_misspelledList)) {
+        if (!item.range->overlaps(checkedRange)) {
+            continue;
+        }
+        const auto it = std::find(misspelledRanges.begin(), misspelledRanges.end(), item.range->toRange());
+        if (it != misspelledRanges.end() && item.dictionary == dictionary) {
+            misspelledRanges.erase(it);
+        } else {
+            toDelete.push_back(item.range);
+        }
+    }
+    deleteMovingRanges(toDelete);
+
+    for (const KTextEditor::Range &range : std::as_const(misspelledRanges)) {
+        addMisspelledRange(range, dictionary);
     }
 }
 
+void KateOnTheFlyChecker::addMisspelledRange(KTextEditor::Range range, const QString &dictionary)
+{
+    KTextEditor::MovingRange *movingRange = m_document->newMovingRange(range);
+    movingRange->setFeedback(this);
+    KTextEditor::Attribute *attribute = new KTextEditor::Attribute();
+    attribute->setUnderlineStyle(QTextCharFormat::SpellCheckUnderline);
+    attribute->setUnderlineColor(KateRendererConfig::global()->spellingMistakeLineColor());
+
+    // don't print this range
+    movingRange->setAttributeOnlyForViews(true);
+
+    movingRange->setAttribute(KTextEditor::Attribute::Ptr(attribute));
+    m_misspelledList.push_back(SpellCheckItem(movingRange, dictionary));
+}
+
 QList<KTextEditor::MovingRange *> KateOnTheFlyChecker::installedMovingRanges(KTextEditor::Range range) const
 {
     ON_THE_FLY_DEBUG << range;
@@ -722,32 +729,30 @@ void KateOnTheFlyChecker::queueSpellCheckVisibleRange(KTextEditor::ViewPrivate *
         return;
     }
 
-    // clear all the highlights that are currently present in the range that
-    // is supposed to be checked, necessary due to highlighting
-    const QList<KTextEditor::MovingRange *> highlightsList = installedMovingRanges(intersection);
-    deleteMovingRanges(highlightsList);
-
-    QList<KateSpellCheckManager::RangeAndDictionary> spellCheckRanges =
+    const QList<KateSpellCheckManager::RangeAndDictionary> spellCheckRanges =
         KTextEditor::EditorPrivate::self()->spellCheckManager()->spellCheckRanges(m_document, intersection, true);
-    // we queue them up in reverse
-    QListIterator<KateSpellCheckManager::RangeAndDictionary> i(spellCheckRanges);
-    i.toBack();
-    while (i.hasPrevious()) {
-        KateSpellCheckManager::RangeAndDictionary p = i.previous();
-        queueLineSpellCheck(p.range, p.dictionary);
-    }
+    queueSpellCheckRanges(intersection, spellCheckRanges);
 }
 
 void KateOnTheFlyChecker::queueLineSpellCheck(KTextEditor::DocumentPrivate *kateDocument, int line)
 {
     const KTextEditor::Range range = KTextEditor::Range(line, 0, line, kateDocument->lineLength(line));
-    // clear all the highlights that are currently present in the range that
-    // is supposed to be checked, necessary due to highlighting
+    const auto spellCheckRanges = KTextEditor::EditorPrivate::self()->spellCheckManager()->spellCheckRanges(kateDocument, range, true);
+    queueSpellCheckRanges(range, spellCheckRanges);
+}
 
-    const QList<KTextEditor::MovingRange *> highlightsList = installedMovingRanges(range);
+void KateOnTheFlyChecker::queueSpellCheckRanges(KTextEditor::Range range, const QList<KateSpellCheckManager::RangeAndDictionary> &spellCheckRanges)
+{
+    // clear the highlights in 'range' that are no longer inside of a range to check,
+    // necessary due to highlighting, the others are updated once their range is checked
+    QList<KTextEditor::MovingRange *> highlightsList = installedMovingRanges(range);
+    std::erase_if(highlightsList, [&spellCheckRanges](KTextEditor::MovingRange *movingRange) {
+        return std::any_of(spellCheckRanges.begin(), spellCheckRanges.end(), [movingRange](const KateSpellCheckManager::RangeAndDictionary &p) {
+            return p.range.contains(movingRange->toRange());
+        });
+    });
     deleteMovingRanges(highlightsList);
 
-    auto spellCheckRanges = KTextEditor::EditorPrivate::self()->spellCheckManager()->spellCheckRanges(kateDocument, range, true);
     // we queue them up in reverse
     QListIterator<KateSpellCheckManager::RangeAndDictionary> i(spellCheckRanges);
     i.toBack();
@@ -15,17 +15,12 @@
 #include <QString>
 #include <map>
 
-#include <sonnet/speller.h>
-
 #include "katedocument.h"
 #include "spellcheck.h"
 
-namespace Sonnet
-{
-class BackgroundChecker;
-}
+#include <ktexteditor_export.h>
 
-class KateOnTheFlyChecker : public QObject, private KTextEditor::MovingRangeFeedback
+class KTEXTEDITOR_EXPORT KateOnTheFlyChecker : public QObject, private KTextEditor::MovingRangeFeedback
 {
     enum ModificationType {
         TEXT_INSERTED = 0,
@@ -61,15 +56,24 @@ public:
         QString dictionary;
     };
 
+    /**
+     * A range of the running spell check, together with the snapshot of the text it was
+     * decoded from and the offsets of that decoding. The range is nullptr once it was
+     * removed from the spell check, e.g. after an edit inside of it.
+     **/
+    struct CheckedItem {
+        SpellCheckItem item;
+        QString text;
+        KateSpellCheckManager::OffsetList decToEncOffsetList;
+    };
+
 protected:
     KTextEditor::DocumentPrivate *const m_document;
-    Sonnet::Speller m_speller;
     QList<SpellCheckItem> m_spellCheckQueue;
-    Sonnet::BackgroundChecker *m_backgroundChecker;
-    SpellCheckItem m_currentlyCheckedItem;
+    QList<CheckedItem> m_currentlyCheckedItems;
+    quint64 m_currentSpellCheck = 0;
     QList<SpellCheckItem> m_misspelledList;
     ModificationList m_modificationList;
-    KateSpellCheckManager::OffsetList m_currentDecToEncOffsetList;
     std::map<KTextEditor::View *, KTextEditor::Range> m_displayRangeMap;
 
     void freeDocument();
@@ -81,6 +85,7 @@ protected:
     void queueLineSpellCheck(KTextEditor::Range range, const QString &dictionary);
     void queueSpellCheckVisibleRange(KTextEditor::Range range);
     void queueSpellCheckVisibleRange(KTextEditor::ViewPrivate *view, KTextEditor::Range range);
+    void queueSpellCheckRanges(KTextEditor::Range range, const QList<KateSpellCheckManager::RangeAndDictionary> &spellCheckRanges);
 
     void addToSpellCheckQueue(KTextEditor::Range range, const QString &dictionary);
     void addToSpellCheckQueue(KTextEditor::MovingRange *range, const QString &dictionary);
@@ -90,6 +95,7 @@ protected:
 
     virtual void removeRangeFromEverything(KTextEditor::MovingRange *range);
     bool removeRangeFromCurrentSpellCheck(KTextEditor::MovingRange *range);
+    void dropCurrentlyCheckedRange(CheckedItem &checkedItem);
     bool removeRangeFromSpellCheckQueue(KTextEditor::MovingRange *range);
     void rangeEmpty(KTextEditor::MovingRange *range) override;
     void rangeInvalid(KTextEditor::MovingRange *range) override;
@@ -105,10 +111,9 @@ protected:
 
 protected:
     void performSpellCheck();
-    void addToDictionary(const QString &word);
-    void addToSession(const QString &word);
-    void misspelling(const QString &word, int start);
-    void spellCheckDone();
+    void spellCheckDone(quint64 spellCheck, const QList<KateSpellCheckManager::MisspellingList> &misspellingLists);
+    void updateMisspellings(const CheckedItem &checkedItem, const KateSpellCheckManager::MisspellingList &misspellings);
+    void addMisspelledRange(KTextEditor::Range range, const QString &dictionary);
 
     void viewDestroyed(QObject *obj);
     void addView(KTextEditor::Document *document, KTextEditor::View *view);
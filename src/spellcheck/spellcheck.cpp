@@ -7,6 +7,8 @@
 #include "spellcheck.h"
 
 #include <QHash>
+#include <QPointer>
+#include <QTextBoundaryFinder>
 #include <QTimer>
 #include <QtAlgorithms>
 
@@ -149,7 +151,12 @@ KateSpellCheckManager::KateSpellCheckManager(QObject *parent)
 {
 }
 
-KateSpellCheckManager::~KateSpellCheckManager() = default;
+KateSpellCheckManager::~KateSpellCheckManager()
+{
+    // running checks use the cache and the spellers
+    m_threadPool.clear();
+    m_threadPool.waitForDone();
+}
 
 QStringList KateSpellCheckManager::suggestions(const QString &word, const QString &dictionary)
 {
@@ -160,20 +167,166 @@ QStringList KateSpellCheckManager::suggestions(const QString &word, const QStrin
 
 void KateSpellCheckManager::ignoreWord(const QString &word, const QString &dictionary)
 {
-    Sonnet::Speller speller;
-    speller.setLanguage(dictionary);
-    speller.addToSession(word);
+    {
+        DictionarySpeller &dictionarySpeller = speller(dictionary);
+        QMutexLocker locker(&dictionarySpeller.mutex);
+        dictionarySpeller.speller.addToSession(word);
+        m_cache.remove(dictionary, word);
+    }
     Q_EMIT wordIgnored(word);
 }
 
 void KateSpellCheckManager::addToDictionary(const QString &word, const QString &dictionary)
 {
-    Sonnet::Speller speller;
-    speller.setLanguage(dictionary);
-    speller.addToPersonal(word);
+    {
+        DictionarySpeller &dictionarySpeller = speller(dictionary);
+        QMutexLocker locker(&dictionarySpeller.mutex);
+        dictionarySpeller.speller.addToPersonal(word);
+        m_cache.remove(dictionary, word);
+    }
     Q_EMIT wordAddedToDictionary(word);
 }
 
+KateSpellCheckManager::DictionarySpeller &KateSpellCheckManager::speller(const QString &dictionary)
+{
+    QMutexLocker locker(&m_spellersMutex);
+    auto &speller = m_spellers[dictionary];
+    if (!speller) {
+        speller = std::make_unique<DictionarySpeller>(dictionary);
+    }
+    return *speller;
+}
+
+KateSpellCheckManager::DictionarySpeller *KateSpellCheckManager::existingSpeller(const QString &dictionary)
+{
+    QMutexLocker locker(&m_spellersMutex);
+    const auto it = m_spellers.find(dictionary);
+    return (it != m_spellers.end()) ? it->second.get() : nullptr;
+}
+
+void KateSpellCheckManager::checkSpelling(const QList<TextToCheck> &texts,
+                                          QObject *receiver,
+                                          const std::function<void(const QList<MisspellingList> &)> &done)
+{
+    // create the missing spellers here, they must not be created in the thread pool
+    for (const TextToCheck &text : texts) {
+        speller(text.dictionary);
+    }
+
+    m_threadPool.start([this, texts, receiver = QPointer<QObject>(receiver), done]() {
+        QList<MisspellingList> misspellingLists;
+        misspellingLists.reserve(texts.size());
+        for (const TextToCheck &text : texts) {
+            misspellingLists.push_back(misspellings(text.text, text.dictionary));
+        }
+
+        QMetaObject::invokeMethod(
+            this,
+            [receiver, done, misspellingLists]() {
+                if (receiver) {
+                    done(misspellingLists);
+                }
+            },
+            Qt::QueuedConnection);
+    });
+}
+
+bool KateSpellCheckManager::isMisspelled(const QString &word, const QString &dictionary, DictionarySpeller &speller)
+{
+    std::optional<bool> misspelled = m_cache.isMisspelled(dictionary, word);
+    if (!misspelled) {
+        // remember the result while still locked, a concurrent ignoreWord() must win
+        QMutexLocker locker(&speller.mutex);
+        misspelled = speller.speller.isMisspelled(word);
+        m_cache.insert(dictionary, word, *misspelled);
+    }
+    return *misspelled;
+}
+
+KateSpellCheckManager::MisspellingList KateSpellCheckManager::misspellings(const QString &text, const QString &dictionary)
+{
+    MisspellingList misspellings;
+
+    // created by checkSpelling() before the check was started
+    DictionarySpeller *speller = existingSpeller(dictionary);
+    if (!speller) {
+        return misspellings;
+    }
+
+    bool skipAllCaps = false;
+    bool skipRunTogether = false;
+    {
+        QMutexLocker locker(&speller->mutex);
+        skipAllCaps = !speller->speller.testAttribute(Sonnet::Speller::CheckUppercase);
+        skipRunTogether = speller->speller.testAttribute(Sonnet::Speller::SkipRunTogether);
+    }
+
+    // the same words as Sonnet's tokenizer checks, see Sonnet::WordTokenizer
+    QTextBoundaryFinder finder(QTextBoundaryFinder::Word, text);
+    const QStringView textView(text);
+    bool inAddress = false;
+    int start = 0;
+    while (finder.toNextBoundary() != -1) {
+        const int end = finder.position();
+        const bool isWord = finder.boundaryReasons() & QTextBoundaryFinder::EndOfItem;
+        const int wordStart = start;
+        start = end;
+        if (!isWord) {
+            continue;
+        }
+
+        // e-mail addresses and URLs are skipped, from a word directly in front of '@' or "://" up to the next space
+        if (inAddress && wordStart > 0 && text.at(wordStart - 1).isSpace()) {
+            inAddress = false;
+        }
+        const QStringView behind = textView.mid(end);
+        if (behind.startsWith(QLatin1Char('@')) || behind.startsWith(QLatin1String("://"))) {
+            inAddress = true;
+        }
+
+        // like Sonnet, only words starting with a letter are checked
+        QString word = text.mid(wordStart, end - wordStart);
+        if (inAddress || word.isEmpty() || !word.at(0).isLetter() || (skipAllCaps && word == word.toUpper())) {
+            continue;
+        }
+
+        // the dictionaries only know the typewriter apostrophe, e.g. in "don't"
+        const int length = word.size();
+        word.replace(QChar(0x2019), QLatin1Char('\''));
+
+        if (!isMisspelled(word, dictionary, *speller) || (skipRunTogether && isRunTogether(word, dictionary, *speller))) {
+            continue;
+        }
+        misspellings.push_back(QPair<int, int>(wordStart, length));
+    }
+    return misspellings;
+}
+
+bool KateSpellCheckManager::isRunTogether(const QString &word, const QString &dictionary, DictionarySpeller &speller)
+{
+    // two correctly spelled words written without a space, e.g. "helloworld"
+    static const int minimalLength = 2;
+    for (int split = minimalLength; split <= word.size() - minimalLength; ++split) {
+        if (!isMisspelled(word.left(split), dictionary, speller) && !isMisspelled(word.mid(split), dictionary, speller)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void KateSpellCheckManager::reloadSettings()
+{
+    // the spellers read the settings once, the cached results depend on them, e.g. on the ignore list
+    {
+        QMutexLocker locker(&m_spellersMutex);
+        for (auto &[dictionary, speller] : m_spellers) {
+            QMutexLocker spellerLocker(&speller->mutex);
+            speller->speller.restore();
+        }
+    }
+    m_cache.clear();
+}
+
 QList<KTextEditor::Range> KateSpellCheckManager::rangeDifference(KTextEditor::Range r1, KTextEditor::Range r2)
 {
     Q_ASSERT(r1.contains(r2));
@@ -8,14 +8,22 @@
 #define SPELLCHECK_H
 
 #include <QList>
+#include <QMutex>
 #include <QObject>
 #include <QPair>
 #include <QString>
+#include <QThreadPool>
+
+#include <functional>
+#include <map>
+#include <memory>
 
 #include <ktexteditor/document.h>
 #include <sonnet/backgroundchecker.h>
 #include <sonnet/speller.h>
 
+#include "spellcheckcache.h"
+
 namespace KTextEditor
 {
 class DocumentPrivate;
@@ -46,8 +54,8 @@ public:
 
 Q_SIGNALS:
     /**
-     * These signals are used to propagate the dictionary changes to the
-     * BackgroundChecker instance in other components (e.g. onTheFlyChecker).
+     * These signals are used to propagate the dictionary changes to
+     * other components, the shared word cache is already updated.
      */
     void wordAddedToDictionary(const QString &word);
     void wordIgnored(const QString &word);
@@ -69,8 +77,90 @@ public:
 
     static void replaceCharactersEncodedIfNecessary(const QString &newWord, KTextEditor::DocumentPrivate *doc, KTextEditor::Range replacementRange);
 
+    /**
+     * Decoded text of a range to check in the background, see decodeCharacters().
+     **/
+    struct TextToCheck {
+        QString text;
+        QString dictionary;
+    };
+
+    /**
+     * Misspelled words of a checked text, as start and length in that text.
+     **/
+    typedef QList<QPair<int, int>> MisspellingList;
+
+    /**
+     * Check the given texts on the thread pool of the manager. The words are looked up in
+     * the cache shared by all documents first, only the others are passed to the dictionaries.
+     * 'done' is called with the misspellings of each text in the thread of the manager,
+     * unless 'receiver' is gone by then.
+     **/
+    void checkSpelling(const QList<TextToCheck> &texts, QObject *receiver, const std::function<void(const QList<MisspellingList> &)> &done);
+
+    KateSpellCheckCache &cache()
+    {
+        return m_cache;
+    }
+
+    /**
+     * Apply changed spell checking settings, the cached results are dropped.
+     **/
+    void reloadSettings();
+
 private:
     static void trimRange(KTextEditor::DocumentPrivate *doc, KTextEditor::Range &r);
+
+    /**
+     * Speller of one dictionary, a dictionary is not reentrant, so lookups in it are serialized.
+     * Different dictionaries are used in parallel.
+     **/
+    struct DictionarySpeller {
+        explicit DictionarySpeller(const QString &dictionary)
+            : speller(dictionary)
+        {
+        }
+
+        QMutex mutex;
+        Sonnet::Speller speller;
+    };
+
+    /**
+     * Misspelled words of the given text, called from the thread pool.
+     **/
+    MisspellingList misspellings(const QString &text, const QString &dictionary);
+
+    /**
+     * Look up a single word, in the cache first, called from the thread pool.
+     **/
+    bool isMisspelled(const QString &word, const QString &dictionary, DictionarySpeller &speller);
+
+    /**
+     * Is the word made of two correctly spelled words? Called from the thread pool.
+     **/
+    bool isRunTogether(const QString &word, const QString &dictionary, DictionarySpeller &speller);
+
+    /**
+     * Speller for the given dictionary, created if needed.
+     * Only called in the thread of the manager, Sonnet::Speller must not be created in the thread pool.
+     **/
+    DictionarySpeller &speller(const QString &dictionary);
+
+    /**
+     * Existing speller for the given dictionary or nullptr, for the thread pool.
+     **/
+    DictionarySpeller *existingSpeller(const QString &dictionary);
+
+private:
+    KateSpellCheckCache m_cache;
+
+    /**
+     * guards m_spellers itself, the spellers are never removed before the manager is destroyed
+     **/
+    QMutex m_spellersMutex;
+    std::map<QString, std::unique_ptr<DictionarySpeller>> m_spellers;
+
+    QThreadPool m_threadPool;
 };
 
 #endif
@@ -0,0 +1,87 @@
+/*
+    SPDX-FileCopyrightText: KDE Developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "spellcheckcache.h"
+
+KateSpellCheckCache::KateSpellCheckCache(qsizetype capacity)
+    : m_capacity(qMax(qsizetype(1), capacity))
+{
+}
+
+std::optional<bool> KateSpellCheckCache::isMisspelled(const QString &dictionary, const QString &word)
+{
+    QMutexLocker locker(&m_mutex);
+    const auto dictionaryIt = m_dictionaries.find(dictionary);
+    if (dictionaryIt == m_dictionaries.end()) {
+        return std::nullopt;
+    }
+
+    Dictionary &cache = dictionaryIt->second;
+    const auto it = cache.index.constFind(word);
+    if (it == cache.index.cend()) {
+        return std::nullopt;
+    }
+
+    // move to the front, list iterators stay valid
+    cache.words.splice(cache.words.begin(), cache.words, *it);
+    return (*it)->second;
+}
+
+void KateSpellCheckCache::insert(const QString &dictionary, const QString &word, bool misspelled)
+{
+    QMutexLocker locker(&m_mutex);
+    Dictionary &cache = m_dictionaries[dictionary];
+    const auto it = cache.index.constFind(word);
+    if (it != cache.index.cend()) {
+        (*it)->second = misspelled;
+        cache.words.splice(cache.words.begin(), cache.words, *it);
+        return;
+    }
+
+    cache.words.emplace_front(word, misspelled);
+    cache.index.insert(word, cache.words.begin());
+
+    // drop the least recently used word
+    if (cache.index.size() > m_capacity) {
+        cache.index.remove(cache.words.back().first);
+        cache.words.pop_back();
+    }
+}
+
+void KateSpellCheckCache::remove(const QString &dictionary, const QString &word)
+{
+    QMutexLocker locker(&m_mutex);
+    const auto dictionaryIt = m_dictionaries.find(dictionary);
+    if (dictionaryIt == m_dictionaries.end()) {
+        return;
+    }
+
+    Dictionary &cache = dictionaryIt->second;
+    const auto it = cache.index.constFind(word);
+    if (it != cache.index.cend()) {
+        cache.words.erase(*it);
+        cache.index.erase(it);
+    }
+}
+
+void KateSpellCheckCache::clear(const QString &dictionary)
+{
+    QMutexLocker locker(&m_mutex);
+    m_dictionaries.erase(dictionary);
+}
+
+void KateSpellCheckCache::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_dictionaries.clear();
+}
+
+qsizetype KateSpellCheckCache::size(const QString &dictionary) const
+{
+    QMutexLocker locker(&m_mutex);
+    const auto dictionaryIt = m_dictionaries.find(dictionary);
+    return (dictionaryIt == m_dictionaries.end()) ? 0 : dictionaryIt->second.index.size();
+}
@@ -0,0 +1,84 @@
+/*
+    SPDX-FileCopyrightText: KDE Developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef SPELLCHECKCACHE_H
+#define SPELLCHECKCACHE_H
+
+#include <ktexteditor_export.h>
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+
+#include <list>
+#include <map>
+#include <optional>
+#include <utility>
+
+/**
+ * Results of the dictionaries for single words, shared by all documents.
+ *
+ * Each dictionary keeps at most the given number of words, the least recently used ones
+ * are dropped first. All methods are thread-safe, the cache is used by the background
+ * spell checks.
+ */
+class KTEXTEDITOR_EXPORT KateSpellCheckCache
+{
+public:
+    /**
+     * @param capacity maximal number of words per dictionary
+     */
+    explicit KateSpellCheckCache(qsizetype capacity = 20000);
+
+    KateSpellCheckCache(const KateSpellCheckCache &) = delete;
+    KateSpellCheckCache &operator=(const KateSpellCheckCache &) = delete;
+
+    /**
+     * Look up a word, marks it as recently used.
+     * @return whether the word is misspelled, nothing if it is not cached
+     */
+    std::optional<bool> isMisspelled(const QString &dictionary, const QString &word);
+
+    /**
+     * Remember the result of the dictionary for a word.
+     */
+    void insert(const QString &dictionary, const QString &word, bool misspelled);
+
+    /**
+     * Forget a word, e.g. after it was added to the session or the personal dictionary.
+     */
+    void remove(const QString &dictionary, const QString &word);
+
+    /**
+     * Forget all words of the given dictionary.
+     */
+    void clear(const QString &dictionary);
+
+    /**
+     * Forget everything.
+     */
+    void clear();
+
+    /**
+     * Number of cached words of the given dictionary.
+     */
+    qsizetype size(const QString &dictionary) const;
+
+private:
+    struct Dictionary {
+        /**
+         * words with their result, most recently used first
+         */
+        std::list<std::pair<QString, bool>> words;
+        QHash<QString, std::list<std::pair<QString, bool>>::iterator> index;
+    };
+
+    const qsizetype m_capacity;
+    mutable QMutex m_mutex;
+    std::map<QString, Dictionary> m_dictionaries;
+};
+
+#endif
@@ -619,6 +619,7 @@ QTimer *SwapFile::syncTimer()
 void SwapFile::writeFileToDisk()
 {
     if (m_needSync) {
+        KATE_PERF_SCOPE(m_document->perfCounters(), "swap file sync");
         m_needSync = false;
 
         // ensure buffers are flushed first
@@ -70,6 +70,9 @@ KateHighlighting::KateHighlighting(const KSyntaxHighlighting::Definition &def)
     // map the formats to the right properties in m_propertiesForFormat
     definitions.push_front(definition());
     m_properties.resize(definitions.size());
+    for (const auto &includedDefinition : std::as_const(definitions)) {
+        m_cacheKey += includedDefinition.name() + QLatin1Char(':') + QString::number(includedDefinition.version()) + QLatin1Char(';');
+    }
     size_t propertiesIndex = 0;
     for (const auto &includedDefinition : std::as_const(definitions)) {
         auto &properties = m_properties[propertiesIndex];
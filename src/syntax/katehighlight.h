@@ -306,6 +306,11 @@ private:
 
     bool m_foldingIndentationSensitive = false;
 
+    /**
+     * names and versions of all used definitions, see cacheKey()
+     */
+    QString m_cacheKey;
+
     // map schema name to attributes...
     QHash<QString, QList<KTextEditor::Attribute::Ptr>> m_attributeArrays;
 
@@ -332,6 +337,16 @@ public:
     {
         return m_foldingIndentationSensitive;
     }
+
+    /**
+     * Identifies the definition and all included ones in their current versions.
+     * Attributes of lines highlighted with another key don't match this highlighting.
+     * @return key for the on-disk highlighting cache
+     */
+    const QString &cacheKey() const
+    {
+        return m_cacheKey;
+    }
     inline bool allowsFolding()
     {
         return folding;
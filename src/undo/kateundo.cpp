@@ -80,6 +80,29 @@ void KateUndoGroup::undo(KateUndoManager *manager, KTextEditor::ViewPrivate *vie
         case UndoItem::editMarkLineAutoWrapped:
             doc->editMarkLineAutoWrapped(item.line, item.autowrapped);
             break;
+        case UndoItem::editReplaceText: {
+            // replace the inserted texts back, their columns are shifted by the replacements in front of them
+            std::vector<Kate::LineReplacement> replacements;
+            replacements.reserve(item.replacements.size());
+            int line = -1;
+            int shift = 0;
+            for (const UndoItem::Replacement &replacement : item.replacements) {
+                if (replacement.line != line) {
+                    line = replacement.line;
+                    shift = 0;
+                }
+                replacements.push_back({replacement.line, replacement.col + shift, int(replacement.insertedText.size()), replacement.removedText});
+                shift += replacement.insertedText.size() - replacement.removedText.size();
+            }
+            doc->editReplaceText(std::move(replacements));
+
+            for (const UndoItem::Replacement &replacement : item.replacements) {
+                Kate::TextLine tl = doc->plainKateTextLine(replacement.line);
+                tl.markAsModified(replacement.lineModFlags.testFlag(UndoItem::UndoLine1Modified));
+                tl.markAsSavedOnDisk(replacement.lineModFlags.testFlag(UndoItem::UndoLine1Saved));
+                doc->buffer().setLineMetaData(replacement.line, tl);
+            }
+        } break;
         case UndoItem::editInvalid:
             break;
         }
@@ -151,6 +174,21 @@ void KateUndoGroup::redo(KateUndoManager *manager, KTextEditor::ViewPrivate *vie
         case UndoItem::editMarkLineAutoWrapped:
             doc->editMarkLineAutoWrapped(item.line, item.autowrapped);
             break;
+        case UndoItem::editReplaceText: {
+            std::vector<Kate::LineReplacement> replacements;
+            replacements.reserve(item.replacements.size());
+            for (const UndoItem::Replacement &replacement : item.replacements) {
+                replacements.push_back({replacement.line, replacement.col, int(replacement.removedText.size()), replacement.insertedText});
+            }
+            doc->editReplaceText(std::move(replacements));
+
+            for (const UndoItem::Replacement &replacement : item.replacements) {
+                Kate::TextLine tl = doc->plainKateTextLine(replacement.line);
+                tl.markAsModified(replacement.lineModFlags.testFlag(UndoItem::RedoLine1Modified));
+                tl.markAsSavedOnDisk(replacement.lineModFlags.testFlag(UndoItem::RedoLine1Saved));
+                doc->buffer().setLineMetaData(replacement.line, tl);
+            }
+        } break;
         case UndoItem::editInvalid:
             break;
         }
@@ -258,6 +296,18 @@ void KateUndoGroup::safePoint(bool safePoint)
 void KateUndoGroup::flagSavedAsModified()
 {
     for (UndoItem &item : m_items) {
+        for (UndoItem::Replacement &replacement : item.replacements) {
+            if (replacement.lineModFlags.testFlag(UndoItem::UndoLine1Saved)) {
+                replacement.lineModFlags.setFlag(UndoItem::UndoLine1Saved, false);
+                replacement.lineModFlags.setFlag(UndoItem::UndoLine1Modified, true);
+            }
+
+            if (replacement.lineModFlags.testFlag(UndoItem::RedoLine1Saved)) {
+                replacement.lineModFlags.setFlag(UndoItem::RedoLine1Saved, false);
+                replacement.lineModFlags.setFlag(UndoItem::RedoLine1Modified, true);
+            }
+        }
+
         if (item.lineModFlags.testFlag(UndoItem::UndoLine1Saved)) {
             item.lineModFlags.setFlag(UndoItem::UndoLine1Saved, false);
             item.lineModFlags.setFlag(UndoItem::UndoLine1Modified, true);
@@ -280,8 +330,39 @@ void KateUndoGroup::flagSavedAsModified()
     }
 }
 
+// like for editInsertText/editRemoveText, once per line as all replacements of a line share its flags
+static void updateReplacementsSavedOnDiskFlag(UndoItem &item, QBitArray &lines, bool undo)
+{
+    int line = -1;
+    bool wasBitSet = false;
+    for (UndoItem::Replacement &replacement : item.replacements) {
+        if (replacement.line != line) {
+            line = replacement.line;
+            if (line >= lines.size()) {
+                lines.resize(line + 1);
+            }
+            wasBitSet = lines.testBit(line);
+            lines.setBit(line);
+        }
+
+        auto &lineFlags = replacement.lineModFlags;
+        if (!undo) {
+            lineFlags.setFlag(UndoItem::RedoLine1Modified, false);
+            lineFlags.setFlag(UndoItem::RedoLine1Saved, true);
+        } else if (!wasBitSet) {
+            lineFlags.setFlag(UndoItem::UndoLine1Modified, false);
+            lineFlags.setFlag(UndoItem::UndoLine1Saved, true);
+        }
+    }
+}
+
 static void updateUndoSavedOnDiskFlag(UndoItem &item, QBitArray &lines)
 {
+    if (item.type == UndoItem::editReplaceText) {
+        updateReplacementsSavedOnDiskFlag(item, lines, true);
+        return;
+    }
+
     const int line = item.line;
     if (line >= lines.size()) {
         lines.resize(line + 1);
@@ -327,6 +408,7 @@ static void updateUndoSavedOnDiskFlag(UndoItem &item, QBitArray &lines)
         break;
     case UndoItem::editInsertLine:
     case UndoItem::editMarkLineAutoWrapped:
+    case UndoItem::editReplaceText:
     case UndoItem::editInvalid:
         break;
     }
@@ -341,6 +423,11 @@ void KateUndoGroup::markUndoAsSaved(QBitArray &lines)
 
 static void updateRedoSavedOnDiskFlag(UndoItem &item, QBitArray &lines)
 {
+    if (item.type == UndoItem::editReplaceText) {
+        updateReplacementsSavedOnDiskFlag(item, lines, false);
+        return;
+    }
+
     const int line = item.line;
     if (line >= lines.size()) {
         lines.resize(line + 1);
@@ -382,6 +469,7 @@ static void updateRedoSavedOnDiskFlag(UndoItem &item, QBitArray &lines)
         break;
     case UndoItem::editRemoveLine:
     case UndoItem::editMarkLineAutoWrapped:
+    case UndoItem::editReplaceText:
     case UndoItem::editInvalid:
         break;
     }
@@ -35,6 +35,7 @@ public:
         editInsertLine,
         editRemoveLine,
         editMarkLineAutoWrapped,
+        editReplaceText,
         editInvalid
     };
 
@@ -59,6 +60,23 @@ public:
     bool newLine = false;
     bool removeLine = false;
     int len = 0;
+
+    /**
+     * One replacement of an editReplaceText item, with the columns before the edit.
+     * All replacements of a line carry the same modification flags of that line.
+     */
+    struct Replacement {
+        int line = 0;
+        int col = 0;
+        QString removedText;
+        QString insertedText;
+        ModificationFlags lineModFlags;
+    };
+
+    /**
+     * replacements of an editReplaceText item, sorted by line and column
+     */
+    std::vector<Replacement> replacements;
 };
 
 /**
@@ -10,6 +10,7 @@
 
 #include "katedocument.h"
 #include "katepartdebug.h"
+#include "katetextblock.h"
 #include "kateview.h"
 
 #include <QBitArray>
@@ -177,6 +178,30 @@ void KateUndoManager::slotTextRemoved(int line, int col, const QString &s, const
     addUndoItem(std::move(item));
 }
 
+void KateUndoManager::slotTextReplaced(std::span<const Kate::LineReplacement> replacements)
+{
+    if (!m_editCurrentUndo.has_value() || replacements.empty()) { // do we care about notifications?
+        return;
+    }
+
+    UndoItem item;
+    item.type = UndoItem::editReplaceText;
+    item.line = replacements.front().line;
+    item.replacements.reserve(replacements.size());
+
+    Kate::TextLine tl;
+    UndoItem::ModificationFlags lineModFlags;
+    for (const Kate::LineReplacement &replacement : replacements) {
+        if (item.replacements.empty() || item.replacements.back().line != replacement.line) {
+            tl = m_document->plainKateTextLine(replacement.line);
+            lineModFlags = UndoItem::RedoLine1Modified;
+            lineModFlags.setFlag(tl.markedAsModified() ? UndoItem::UndoLine1Modified : UndoItem::UndoLine1Saved);
+        }
+        item.replacements.push_back({replacement.line, replacement.column, tl.string(replacement.column, replacement.length), replacement.text, lineModFlags});
+    }
+    addUndoItem(std::move(item));
+}
+
 void KateUndoManager::slotMarkLineAutoWrapped(int line, bool autowrapped)
 {
     if (m_editCurrentUndo.has_value()) { // do we care about notifications?
@@ -15,6 +15,7 @@
 #include <QList>
 
 #include <optional>
+#include <span>
 
 namespace KTextEditor
 {
@@ -23,6 +24,11 @@ class DocumentPrivate;
 class KateUndo;
 class KateUndoGroup;
 
+namespace Kate
+{
+struct LineReplacement;
+}
+
 namespace KTextEditor
 {
 class Document;
@@ -154,6 +160,12 @@ public Q_SLOTS:
      */
     void slotTextRemoved(int line, int col, const QString &s, const Kate::TextLine &tl);
 
+    /**
+     * Notify KateUndoManager that text in many lines will be replaced, see DocumentPrivate::editReplaceText().
+     * The replacements must be sorted and not yet applied, all of them are recorded as one undo item.
+     */
+    void slotTextReplaced(std::span<const Kate::LineReplacement> replacements);
+
     /**
      * Notify KateUndoManager that a line was marked as autowrapped.
      */
@@ -6,6 +6,7 @@
 
 #include "document.h"
 #include "katedocument.h"
+#include "katetextdecorationlayer.h"
 
 using namespace KTextEditor;
 
@@ -110,6 +111,17 @@ bool Document::isEmpty() const
     return documentEnd() == Cursor::start();
 }
 
+DecorationLayer *Document::newDecorationLayer()
+{
+    return new Kate::TextDecorationLayer(&d->buffer());
+}
+
+TextSnapshot Document::snapshot() const
+{
+    d->ensureLoaded();
+    return d->buffer().snapshot();
+}
+
 QList<KTextEditor::Range> Document::searchText(KTextEditor::Range range, const QString &pattern, const SearchOptions options) const
 {
     return d->searchText(range, pattern, options);
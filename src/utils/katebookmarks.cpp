@@ -104,10 +104,10 @@ void KateBookmarks::toggleBookmark()
 
 void KateBookmarks::clearBookmarks()
 {
-    // work on a COPY of the hash, the removing will modify it otherwise!
-    const auto hash = m_view->doc()->marks();
-    for (auto it = hash.cbegin(); it != hash.cend(); ++it) {
-        m_view->doc()->removeMark(it.value()->line, KTextEditor::Document::markType01);
+    // work on a COPY of the marks, the removing will modify the index otherwise!
+    const auto marks = m_view->doc()->markIndex().marks();
+    for (KTextEditor::Mark *mark : marks) {
+        m_view->doc()->removeMark(mark->line, KTextEditor::Document::markType01);
     }
 }
 
@@ -118,18 +118,17 @@ void KateBookmarks::insertBookmarks(QMenu &menu)
     int next = -1; // -1 means next bookmark doesn't exist
     int prev = -1; // -1 means previous bookmark doesn't exist
 
-    // reference ok, not modified
-    const auto &hash = m_view->doc()->marks();
-    if (hash.isEmpty()) {
+    const KateMarkIndex &marks = m_view->doc()->markIndex();
+    if (marks.isEmpty()) {
         return;
     }
 
     std::vector<int> bookmarkLineArray; // Array of line numbers which have bookmarks
 
     // Find line numbers where bookmarks are set & store those line numbers in bookmarkLineArray
-    for (auto it = hash.cbegin(); it != hash.cend(); ++it) {
-        if (it.value()->type & KTextEditor::Document::markType01) {
-            bookmarkLineArray.push_back(it.value()->line);
+    for (KTextEditor::Mark *mark : marks.marks()) {
+        if (mark->type & KTextEditor::Document::markType01) {
+            bookmarkLineArray.push_back(mark->line);
         }
     }
 
@@ -224,65 +223,39 @@ void KateBookmarks::bookmarkMenuAboutToShow()
 
 void KateBookmarks::goNext()
 {
-    // reference ok, not modified
-    const auto &hash = m_view->doc()->marks();
-    if (hash.isEmpty()) {
+    const KateMarkIndex &marks = m_view->doc()->markIndex();
+    if (marks.isEmpty()) {
         return;
     }
 
-    int line = m_view->cursorPosition().line();
-    int found = -1;
-    int firstBookmarkLine = -1;
-    for (auto it = hash.cbegin(); it != hash.cend(); ++it) {
-        const int markLine = it.value()->line;
-        if (markLine > line && (found == -1 || found > markLine)) {
-            found = markLine;
-        }
-        if (markLine < firstBookmarkLine || firstBookmarkLine == -1) {
-            firstBookmarkLine = markLine;
-        }
-    }
-
     // either go to next bookmark or the first in the document, bug 472354
-    if (found != -1) {
-        gotoLine(found);
+    const int line = m_view->cursorPosition().line();
+    if (const KTextEditor::Mark *mark = marks.next(line)) {
+        gotoLine(mark->line);
     } else if (m_cycleThroughBookmarks) {
-        gotoLine(firstBookmarkLine);
+        gotoLine(marks.first()->line);
     }
 }
 
 void KateBookmarks::goPrevious()
 {
-    // reference ok, not modified
-    const auto &hash = m_view->doc()->marks();
-    if (hash.isEmpty()) {
+    const KateMarkIndex &marks = m_view->doc()->markIndex();
+    if (marks.isEmpty()) {
         return;
     }
 
-    int line = m_view->cursorPosition().line();
-    int found = -1;
-    int lastBookmarkLine = -1;
-    for (auto it = hash.cbegin(); it != hash.cend(); ++it) {
-        const int markLine = it.value()->line;
-        if (markLine < line && (found == -1 || found < markLine)) {
-            found = markLine;
-        }
-        if (markLine > lastBookmarkLine) {
-            lastBookmarkLine = markLine;
-        }
-    }
-
     // either go to previous bookmark or the last in the document, bug 472354
-    if (found != -1) {
-        gotoLine(found);
+    const int line = m_view->cursorPosition().line();
+    if (const KTextEditor::Mark *mark = marks.previous(line)) {
+        gotoLine(mark->line);
     } else if (m_cycleThroughBookmarks) {
-        gotoLine(lastBookmarkLine);
+        gotoLine(marks.last()->line);
     }
 }
 
 void KateBookmarks::marksChanged()
 {
-    const bool bookmarks = !m_view->doc()->marks().isEmpty();
+    const bool bookmarks = !m_view->doc()->markIndex().isEmpty();
     if (m_bookmarkClear) {
         m_bookmarkClear->setEnabled(bookmarks);
     }
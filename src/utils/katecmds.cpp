@@ -12,14 +12,18 @@
 #include "katecmd.h"
 #include "katedocument.h"
 #include "katepartdebug.h"
+#include "kateperf.h"
 #include "katerenderer.h"
 #include "katesyntaxmanager.h"
 #include "kateview.h"
 
+#include <ktexteditor/message.h>
+
 #include <KLocalizedString>
 
 #include <QCollator>
 #include <QDateTime>
+#include <QFile>
 #include <QRegularExpression>
 
 // BEGIN CoreCommands
@@ -603,6 +607,68 @@ bool KateCommands::Date::exec(KTextEditor::View *view, const QString &cmd, QStri
 
 // END Date
 
+// BEGIN Perf
+KateCommands::Perf *KateCommands::Perf::m_instance = nullptr;
+
+bool KateCommands::Perf::help(class KTextEditor::View *, const QString &cmd, QString &msg)
+{
+    if (cmd.trimmed() == QLatin1String("perf")) {
+        msg = i18n(
+            "<p>perf [reset|trace <i>file</i>]</p>"
+            "<p>Shows the performance counters of the current document and view.</p>"
+            "<p><b>reset</b> clears the counters, <b>trace</b> writes the recorded timings to <i>file</i> as Chrome trace JSON.</p>"
+            "<p>The counters are only collected if the editor was built with ENABLE_PERF_TRACING.</p>");
+        return true;
+    }
+    return false;
+}
+
+bool KateCommands::Perf::exec(KTextEditor::View *view, const QString &cmd, QString &msg, const KTextEditor::Range &)
+{
+    if (!KATE_PERF_TRACING) {
+        msg = i18n("Performance counters are not collected, the editor was built without ENABLE_PERF_TRACING.");
+        return false;
+    }
+
+    auto *v = static_cast<KTextEditor::ViewPrivate *>(view);
+    KTextEditor::DocumentPrivate *doc = v->doc();
+    const QStringList args = cmd.split(QLatin1Char(' '), Qt::SkipEmptyParts);
+
+    if (args.size() == 1) {
+        QString text = QStringLiteral("<b>%1</b><pre>%2</pre>").arg(i18n("Document"), doc->perfCounters().summary().toHtmlEscaped());
+        text += QStringLiteral("<b>%1</b><pre>%2</pre>").arg(i18n("View"), v->perfCounters().summary().toHtmlEscaped());
+        auto *message = new KTextEditor::Message(text, KTextEditor::Message::Information);
+        message->setView(view);
+        doc->postMessage(message);
+        return true;
+    }
+
+    if (args.size() == 2 && args.at(1) == QLatin1String("reset")) {
+        doc->perfCounters().reset();
+        v->perfCounters().reset();
+        return true;
+    }
+
+    if (args.size() == 3 && args.at(1) == QLatin1String("trace")) {
+        const QByteArray trace = KatePerf::chromeTrace({
+            {doc->documentName(), &doc->perfCounters()},
+            {i18n("View of %1", doc->documentName()), &v->perfCounters()},
+        });
+        QFile file(args.at(2));
+        if (!file.open(QIODevice::WriteOnly) || file.write(trace) != trace.size()) {
+            msg = i18n("Could not write the trace to %1.", args.at(2));
+            return false;
+        }
+        msg = i18n("Trace written to %1.", args.at(2));
+        return true;
+    }
+
+    msg = i18n("Usage: perf [reset|trace <file>]");
+    return false;
+}
+
+// END Perf
+
 KateCommands::EditingCommands *KateCommands::EditingCommands::s_instance = nullptr;
 
 KateCommands::EditingCommands::EditingCommands()
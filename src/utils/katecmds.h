@@ -191,6 +191,49 @@ public:
     }
 };
 
+/**
+ * show the performance counters of the current document and view, see KatePerf
+ * perf: show the counters
+ * perf reset: reset the counters
+ * perf trace <file>: export the recorded scopes as Chrome trace JSON
+ */
+class Perf : public KTextEditor::Command
+{
+    Perf()
+        : KTextEditor::Command({QStringLiteral("perf")})
+    {
+    }
+
+    static Perf *m_instance;
+
+public:
+    ~Perf() override
+    {
+        m_instance = nullptr;
+    }
+
+    /**
+     * execute command
+     * @param view view to use for execution
+     * @param cmd cmd string
+     * @param errorMsg error to return if no success
+     * @return success
+     */
+    bool
+    exec(class KTextEditor::View *view, const QString &cmd, QString &errorMsg, const KTextEditor::Range &range = KTextEditor::Range(-1, -0, -1, 0)) override;
+
+    /** @see KTextEditor::Command::help */
+    bool help(class KTextEditor::View *, const QString &, QString &) override;
+
+    static Perf *self()
+    {
+        if (m_instance == nullptr) {
+            m_instance = new Perf();
+        }
+        return m_instance;
+    }
+};
+
 class EditingCommands : public KTextEditor::Command
 {
 public:
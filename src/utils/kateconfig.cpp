@@ -252,6 +252,7 @@ KateGlobalConfig::KateGlobalConfig()
                                [](const QVariant &value) {
                                    return isEncodingOk(value.toString());
                                }));
+    addConfigEntry(ConfigEntry(HighlightingCache, "Highlighting Cache", QString(), false));
 
     // finalize the entries, e.g. hashes them
     finalizeConfigEntries();
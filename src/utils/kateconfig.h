@@ -297,7 +297,12 @@ public:
         /**
          * Fallback encoding
          */
-        FallbackEncoding
+        FallbackEncoding,
+
+        /**
+         * Keep the highlighting of files in the on-disk cache
+         */
+        HighlightingCache
     };
 
 public:
@@ -325,6 +330,16 @@ public:
         return setValue(FallbackEncoding, encoding);
     }
 
+    bool highlightingCache() const
+    {
+        return value(HighlightingCache).toBool();
+    }
+
+    void setHighlightingCache(bool on)
+    {
+        setValue(HighlightingCache, on);
+    }
+
 private:
     static KateGlobalConfig *s_global;
 };
@@ -27,6 +27,7 @@
 #include "katemodemanager.h"
 #include "katescriptmanager.h"
 #include "katesedcmd.h"
+#include "kateshapedlayoutcache.h"
 #include "katesyntaxmanager.h"
 #include "katethemeconfig.h"
 #include "katevariableexpansionmanager.h"
@@ -170,6 +171,11 @@ KTextEditor::EditorPrivate::EditorPrivate(QPointer<KTextEditor::EditorPrivate> &
     //
     m_spellCheckManager = new KateSpellCheckManager();
 
+    //
+    // shaped layout cache
+    //
+    m_shapedLayoutCache = std::make_unique<KateShapedLayoutCache>();
+
     // config objects
     m_globalConfig = new KateGlobalConfig();
     m_documentConfig = new KateDocumentConfig();
@@ -186,6 +192,7 @@ KTextEditor::EditorPrivate::EditorPrivate(QPointer<KTextEditor::EditorPrivate> &
         KateCommands::CoreCommands::self(),
         KateCommands::Character::self(),
         KateCommands::Date::self(),
+        KateCommands::Perf::self(),
         KateCommands::SedReplace::self(),
         KateCommands::Highlighting::self(),
         KateCommands::EditingCommands::self(),
@@ -220,6 +227,9 @@ KTextEditor::EditorPrivate::~EditorPrivate()
 
     delete m_spellCheckManager;
 
+    // drop shared layouts while the font machinery is still alive
+    m_shapedLayoutCache.reset();
+
     // cu model
     delete m_wordCompletionModel;
 
@@ -408,6 +418,40 @@ void KTextEditor::EditorPrivate::deregisterDocument(KTextEditor::DocumentPrivate
     int i = m_documents.indexOf(doc);
     Q_ASSERT(i != -1);
     m_documents.removeAt(i);
+    cancelDeferredLoad(doc);
+}
+
+void KTextEditor::EditorPrivate::scheduleDeferredLoad(KTextEditor::DocumentPrivate *doc)
+{
+    if (!m_deferredLoads.contains(doc)) {
+        m_deferredLoads.push_back(doc);
+    }
+
+    if (!m_deferredLoadQueued) {
+        m_deferredLoadQueued = true;
+        QTimer::singleShot(0, this, &KTextEditor::EditorPrivate::loadNextDeferredDocument);
+    }
+}
+
+void KTextEditor::EditorPrivate::cancelDeferredLoad(KTextEditor::DocumentPrivate *doc)
+{
+    m_deferredLoads.removeOne(doc);
+}
+
+void KTextEditor::EditorPrivate::loadNextDeferredDocument()
+{
+    m_deferredLoadQueued = false;
+    if (m_deferredLoads.isEmpty()) {
+        return;
+    }
+
+    // one document per pass, pending paint and input events go first
+    m_deferredLoads.takeFirst()->ensureLoaded();
+
+    if (!m_deferredLoads.isEmpty()) {
+        m_deferredLoadQueued = true;
+        QTimer::singleShot(0, this, &KTextEditor::EditorPrivate::loadNextDeferredDocument);
+    }
 }
 
 void KTextEditor::EditorPrivate::registerView(KTextEditor::ViewPrivate *view)
@@ -47,6 +47,7 @@ class KateScriptManager;
 class KDirWatch;
 class KateHlManager;
 class KateSpellCheckManager;
+class KateShapedLayoutCache;
 class KateWordCompletionModel;
 class KateAbstractInputModeFactory;
 class KateKeywordCompletionModel;
@@ -185,6 +186,20 @@ public:
      */
     void deregisterDocument(KTextEditor::DocumentPrivate *doc);
 
+    /**
+     * Load the file of a restored document in the background, once the event loop is idle.
+     * Documents are loaded one per event loop pass in the order they were scheduled,
+     * documents that get a view or are accessed otherwise load right away.
+     * @param doc document with a deferred load, see DocumentPrivate::ensureLoaded()
+     */
+    void scheduleDeferredLoad(KTextEditor::DocumentPrivate *doc);
+
+    /**
+     * Remove a document from the background loading, e.g. because it is loaded now.
+     * @param doc document to remove
+     */
+    void cancelDeferredLoad(KTextEditor::DocumentPrivate *doc);
+
     /**
      * register view at the factory
      * this allows us to loop over all views for example on config changes
@@ -294,6 +309,15 @@ public:
         return m_spellCheckManager;
     }
 
+    /**
+     * cache of shaped line layouts shared by all views
+     * @return shaped layout cache
+     */
+    KateShapedLayoutCache *shapedLayoutCache()
+    {
+        return m_shapedLayoutCache.get();
+    }
+
     /**
      * global instance of the simple word completion mode
      * @return global instance of the simple word completion mode
@@ -422,6 +446,11 @@ public:
     QTextToSpeech *speechEngine(KTextEditor::ViewPrivate *view);
 
 private Q_SLOTS:
+    /**
+     * Load the next document scheduled by scheduleDeferredLoad().
+     */
+    void loadNextDeferredDocument();
+
     /**
      * Emit configChanged if needed.
      * Used to bundle emissions.
@@ -463,6 +492,16 @@ private:
      */
     QList<KTextEditor::Document *> m_documents;
 
+    /**
+     * documents still to load in the background, in order
+     */
+    QList<KTextEditor::DocumentPrivate *> m_deferredLoads;
+
+    /**
+     * is loadNextDeferredDocument() already queued?
+     */
+    bool m_deferredLoadQueued = false;
+
     /**
      * registered views
      */
@@ -528,6 +567,11 @@ private:
      */
     KateSpellCheckManager *m_spellCheckManager;
 
+    /**
+     * cache of shaped line layouts
+     */
+    std::unique_ptr<KateShapedLayoutCache> m_shapedLayoutCache;
+
     /**
      * global instance of the simple word completion mode
      */
@@ -0,0 +1,178 @@
+/*
+    SPDX-FileCopyrightText: KDE Developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "kateperf.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMap>
+#include <QTextStream>
+
+#include <algorithm>
+#include <bit>
+
+using namespace KatePerf;
+
+void Timing::add(qint64 durationNs)
+{
+    ++count;
+    totalNs += durationNs;
+    maxNs = std::max(maxNs, durationNs);
+
+    // bucket i holds durations below 2^i microseconds
+    const quint64 us = quint64(std::max<qint64>(durationNs, 0)) / 1000;
+    histogram[std::min<int>(std::bit_width(us), HistogramBuckets - 1)]++;
+}
+
+qint64 Counters::now()
+{
+    static const QElapsedTimer epoch = [] {
+        QElapsedTimer t;
+        t.start();
+        return t;
+    }();
+    return epoch.nsecsElapsed();
+}
+
+void Counters::addTiming(const char *name, qint64 startNs, qint64 durationNs)
+{
+    m_timings[name].add(durationNs);
+
+    // ring buffer of the most recent scopes
+    if (m_traceEvents.size() < MaxTraceEvents) {
+        m_traceEvents.append({name, startNs, durationNs});
+    } else {
+        m_traceEvents[m_nextTraceEvent] = {name, startNs, durationNs};
+        m_nextTraceEvent = (m_nextTraceEvent + 1) % MaxTraceEvents;
+    }
+}
+
+void Counters::reset()
+{
+    m_timings.clear();
+    m_counts.clear();
+    m_traceEvents.clear();
+    m_nextTraceEvent = 0;
+}
+
+QHash<QString, Timing> Counters::timings() const
+{
+    // the same name might have several addresses if used in different translation units
+    QHash<QString, Timing> timings;
+    for (auto it = m_timings.cbegin(); it != m_timings.cend(); ++it) {
+        Timing &timing = timings[QString::fromLatin1(it.key())];
+        timing.count += it->count;
+        timing.totalNs += it->totalNs;
+        timing.maxNs = std::max(timing.maxNs, it->maxNs);
+        for (int i = 0; i < Timing::HistogramBuckets; ++i) {
+            timing.histogram[i] += it->histogram[i];
+        }
+    }
+    return timings;
+}
+
+QHash<QString, qint64> Counters::counts() const
+{
+    QHash<QString, qint64> counts;
+    for (auto it = m_counts.cbegin(); it != m_counts.cend(); ++it) {
+        counts[QString::fromLatin1(it.key())] += it.value();
+    }
+    return counts;
+}
+
+QString Counters::summary() const
+{
+    QString result;
+    QTextStream out(&result);
+
+    QMap<QString, Timing> sortedTimings;
+    const auto allTimings = timings();
+    for (auto it = allTimings.cbegin(); it != allTimings.cend(); ++it) {
+        sortedTimings.insert(it.key(), it.value());
+    }
+    for (auto it = sortedTimings.cbegin(); it != sortedTimings.cend(); ++it) {
+        const Timing &t = it.value();
+        // median from the histogram, as upper bound of its bucket
+        quint64 seen = 0;
+        int medianBucket = 0;
+        while (medianBucket < Timing::HistogramBuckets - 1 && (seen += t.histogram[medianBucket]) * 2 < t.count) {
+            ++medianBucket;
+        }
+        out << it.key() << ": " << t.count << " calls, total " << QString::number(t.totalNs / 1e6, 'f', 2) << " ms, avg "
+            << QString::number(t.count ? t.totalNs / 1e3 / t.count : 0, 'f', 1) << " us, median < " << (quint64(1) << medianBucket) << " us, max "
+            << QString::number(t.maxNs / 1e3, 'f', 1) << " us\n";
+    }
+
+    QMap<QString, qint64> sortedCounts;
+    const auto allCounts = counts();
+    for (auto it = allCounts.cbegin(); it != allCounts.cend(); ++it) {
+        sortedCounts.insert(it.key(), it.value());
+    }
+    for (auto it = sortedCounts.cbegin(); it != sortedCounts.cend(); ++it) {
+        out << it.key() << ": " << it.value() << "\n";
+    }
+
+    out.flush();
+    return result;
+}
+
+QList<TraceEvent> Counters::traceEvents() const
+{
+    QList<TraceEvent> events;
+    events.reserve(m_traceEvents.size());
+    events.append(m_traceEvents.mid(m_nextTraceEvent));
+    events.append(m_traceEvents.first(m_nextTraceEvent));
+    return events;
+}
+
+QByteArray KatePerf::chromeTrace(const QList<std::pair<QString, const Counters *>> &counters)
+{
+    QJsonArray events;
+    const qint64 tid = QCoreApplication::applicationPid();
+    int pid = 0;
+    for (const auto &[label, c] : counters) {
+        ++pid;
+        events.append(QJsonObject{
+            {QStringLiteral("name"), QStringLiteral("process_name")},
+            {QStringLiteral("ph"), QStringLiteral("M")},
+            {QStringLiteral("pid"), pid},
+            {QStringLiteral("args"), QJsonObject{{QStringLiteral("name"), label}}},
+        });
+
+        // complete events, times in microseconds
+        for (const TraceEvent &e : c->traceEvents()) {
+            events.append(QJsonObject{
+                {QStringLiteral("name"), QString::fromLatin1(e.name)},
+                {QStringLiteral("ph"), QStringLiteral("X")},
+                {QStringLiteral("ts"), e.startNs / 1e3},
+                {QStringLiteral("dur"), e.durationNs / 1e3},
+                {QStringLiteral("pid"), pid},
+                {QStringLiteral("tid"), tid},
+            });
+        }
+
+        // counters as one sample at the end of the trace
+        QJsonObject args;
+        const auto counts = c->counts();
+        for (auto it = counts.cbegin(); it != counts.cend(); ++it) {
+            args.insert(it.key(), it.value());
+        }
+        if (!args.isEmpty()) {
+            events.append(QJsonObject{
+                {QStringLiteral("name"), QStringLiteral("counters")},
+                {QStringLiteral("ph"), QStringLiteral("C")},
+                {QStringLiteral("ts"), Counters::now() / 1e3},
+                {QStringLiteral("pid"), pid},
+                {QStringLiteral("args"), args},
+            });
+        }
+    }
+
+    return QJsonDocument(QJsonObject{{QStringLiteral("traceEvents"), events}, {QStringLiteral("displayTimeUnit"), QStringLiteral("ms")}}).toJson(QJsonDocument::Compact);
+}
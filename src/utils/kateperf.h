@@ -0,0 +1,162 @@
+/*
+    SPDX-FileCopyrightText: KDE Developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef KATE_PERF_H
+#define KATE_PERF_H
+
+#include "config.h"
+
+#include <ktexteditor_export.h>
+
+#include <QHash>
+#include <QList>
+#include <QString>
+
+#include <array>
+
+/**
+ * Lightweight performance instrumentation of documents and views.
+ *
+ * Code marks interesting work with KATE_PERF_SCOPE and KATE_PERF_COUNT, the
+ * measurements end up in the KatePerf::Counters of the document or view doing
+ * the work. The counters can be shown with the :perf command and exported as
+ * Chrome trace JSON, see chrome://tracing or https://ui.perfetto.dev.
+ *
+ * The macros only do something if the build was configured with
+ * ENABLE_PERF_TRACING, otherwise they expand to nothing and don't evaluate
+ * their arguments. Everything is meant to be used from the GUI thread only.
+ */
+namespace KatePerf
+{
+/**
+ * Duration statistics of one kind of scope.
+ */
+struct Timing {
+    /**
+     * Buckets of the histogram, bucket i counts durations below 2^i microseconds,
+     * the last bucket everything longer.
+     */
+    static constexpr int HistogramBuckets = 24;
+
+    void add(qint64 durationNs);
+
+    quint64 count = 0;
+    qint64 totalNs = 0;
+    qint64 maxNs = 0;
+    std::array<quint64, HistogramBuckets> histogram{};
+};
+
+/**
+ * One finished scope, for the trace export.
+ */
+struct TraceEvent {
+    const char *name = nullptr;
+    qint64 startNs = 0;
+    qint64 durationNs = 0;
+};
+
+class KTEXTEDITOR_EXPORT Counters
+{
+public:
+    /**
+     * Only the most recent scopes are kept for the trace.
+     */
+    static constexpr qsizetype MaxTraceEvents = 100000;
+
+    /**
+     * Nanoseconds since a process wide epoch, the time base of all trace events.
+     */
+    static qint64 now();
+
+    /**
+     * Record a finished scope. @p name must be a string literal.
+     */
+    void addTiming(const char *name, qint64 startNs, qint64 durationNs);
+
+    /**
+     * Increase the counter @p name by @p n. @p name must be a string literal.
+     */
+    void count(const char *name, qint64 n = 1)
+    {
+        m_counts[name] += n;
+    }
+
+    void reset();
+
+    bool isEmpty() const
+    {
+        return m_timings.isEmpty() && m_counts.isEmpty();
+    }
+
+    /**
+     * Timings and counters by name.
+     */
+    QHash<QString, Timing> timings() const;
+    QHash<QString, qint64> counts() const;
+
+    /**
+     * Human readable table of all timings and counters.
+     */
+    QString summary() const;
+
+    /**
+     * Recorded scopes, oldest first.
+     */
+    QList<TraceEvent> traceEvents() const;
+
+private:
+    QHash<const char *, Timing> m_timings;
+    QHash<const char *, qint64> m_counts;
+    QList<TraceEvent> m_traceEvents;
+    qsizetype m_nextTraceEvent = 0;
+};
+
+/**
+ * Chrome trace JSON of several counter sets, each one is shown as its own process named by the given label.
+ */
+KTEXTEDITOR_EXPORT QByteArray chromeTrace(const QList<std::pair<QString, const Counters *>> &counters);
+
+/**
+ * Times its own lifetime, use KATE_PERF_SCOPE.
+ */
+class Scope
+{
+public:
+    Scope(Counters &counters, const char *name)
+        : m_counters(counters)
+        , m_name(name)
+        , m_startNs(Counters::now())
+    {
+    }
+
+    ~Scope()
+    {
+        m_counters.addTiming(m_name, m_startNs, Counters::now() - m_startNs);
+    }
+
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+private:
+    Counters &m_counters;
+    const char *const m_name;
+    const qint64 m_startNs;
+};
+}
+
+#if KATE_PERF_TRACING
+#define KATE_PERF_SCOPE(counters, name) const KatePerf::Scope katePerfScope((counters), (name))
+#define KATE_PERF_COUNT(counters, name, n) (counters).count((name), (n))
+#else
+#define KATE_PERF_SCOPE(counters, name)                                                                                                                        \
+    do {                                                                                                                                                       \
+    } while (false)
+#define KATE_PERF_COUNT(counters, name, n)                                                                                                                     \
+    do {                                                                                                                                                       \
+    } while (false)
+#endif
+
+#endif
@@ -178,13 +178,12 @@ KateCommands::SedReplace::InteractiveSedReplacer::InteractiveSedReplacer(KTextEd
                                                                          bool onlyOnePerLine,
                                                                          int startLine,
                                                                          int endLine)
-    : m_findPattern(findPattern)
-    , m_replacePattern(replacePattern)
+    : m_replacePattern(replacePattern)
     , m_onlyOnePerLine(onlyOnePerLine)
     , m_endLine(endLine)
     , m_doc(doc)
     , m_regExpSearch(doc)
-    , m_caseSensitive(caseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive)
+    , m_findRegExp(findPattern, caseSensitive ? QRegularExpression::NoPatternOption : QRegularExpression::CaseInsensitiveOption)
     , m_numReplacementsDone(0)
     , m_numLinesTouched(0)
     , m_lastChangedLineNum(-1)
@@ -283,11 +282,7 @@ const QList<KTextEditor::Range> KateCommands::SedReplace::InteractiveSedReplacer
         return QList<KTextEditor::Range>();
     }
 
-    QRegularExpression::PatternOptions options;
-    if (m_caseSensitive == Qt::CaseInsensitive) {
-        options |= (QRegularExpression::CaseInsensitiveOption);
-    }
-    return m_regExpSearch.search(m_findPattern, KTextEditor::Range(m_currentSearchPos, m_doc->documentEnd()), false /* search backwards */, options);
+    return m_regExpSearch.search(m_findRegExp, KTextEditor::Range(m_currentSearchPos, m_doc->documentEnd()), false /* search backwards */);
 }
 
 QString KateCommands::SedReplace::InteractiveSedReplacer::replacementTextForCurrentMatch()
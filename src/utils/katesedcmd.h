@@ -113,13 +113,12 @@ public:
         QString finalStatusReportMessage() const;
 
     private:
-        const QString m_findPattern;
         const QString m_replacePattern;
         bool m_onlyOnePerLine;
         int m_endLine;
         KTextEditor::DocumentPrivate *m_doc;
         KateRegExpSearch m_regExpSearch;
-        Qt::CaseSensitivity m_caseSensitive;
+        const KateRegExpSearchPattern m_findRegExp;
 
         int m_numReplacementsDone;
         int m_numLinesTouched;
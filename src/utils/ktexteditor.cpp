@@ -305,7 +305,8 @@ InlineNote::InlineNote(const KateInlineNoteData &data)
 
 qreal InlineNote::width() const
 {
-    return d.m_provider->inlineNoteSize(*this).width();
+    // views measure the notes once when they query them
+    return (d.m_width >= 0) ? d.m_width : d.m_provider->inlineNoteSize(*this).width();
 }
 
 bool KTextEditor::InlineNote::underMouse() const
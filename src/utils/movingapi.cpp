@@ -7,6 +7,7 @@
     SPDX-License-Identifier: LGPL-2.0-or-later
 */
 
+#include "decorationlayer.h"
 #include "document.h"
 #include "documentcursor.h"
 #include "movingcursor.h"
@@ -198,3 +199,9 @@ void MovingRangeFeedback::caretExitedRange(MovingRange *, View *)
 {
 }
 // END MovingRangeFeedback
+
+// BEGIN DecorationLayer
+DecorationLayer::DecorationLayer() = default;
+
+DecorationLayer::~DecorationLayer() = default;
+// END DecorationLayer
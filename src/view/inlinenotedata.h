@@ -40,6 +40,11 @@ public:
     bool m_underMouse = false;
     QFont m_font;
     int m_lineHeight = -1;
+
+    /**
+     * width measured by the provider, -1 if not yet measured
+     */
+    qreal m_width = -1;
 };
 
 #endif
@@ -2653,6 +2653,9 @@ void KTextEditor::ViewPrivate::editStart()
 
 void KTextEditor::ViewPrivate::editEnd(int editTagLineStart, int editTagLineEnd, bool tagFrom)
 {
+    // notes of edited lines need to be queried again, if lines got inserted or removed, all following lines moved
+    invalidateInlineNotes({editTagLineStart, editTagLineEnd}, tagFrom);
+
     m_viewInternal->editEnd(editTagLineStart, editTagLineEnd, tagFrom);
     textFolding().editEnd(editTagLineStart, editTagLineEnd, [this](int line) {
         return m_doc->buffer().isFoldingStartingOnLine(line).first;
@@ -2855,13 +2858,28 @@ bool KTextEditor::ViewPrivate::removeSelectedText()
     // Handle multicursors selection removal
     if (!blockSelect) {
         completionWidget()->setIgnoreBufferSignals(true);
+
+        // selections inside one line, e.g. after selecting all occurrences, are removed in one batch
+        const bool singleLineSelections = std::all_of(m_secondaryCursors.cbegin(), m_secondaryCursors.cend(), [](const SecondaryCursor &c) {
+            return !c.range || c.range->toRange().onSingleLine();
+        });
+        std::vector<Kate::LineReplacement> replacements;
         for (auto &c : m_secondaryCursors) {
             if (c.range) {
                 removed = true;
-                doc()->removeText(c.range->toRange());
+                const KTextEditor::Range range = c.range->toRange();
+                if (singleLineSelections) {
+                    replacements.push_back({.line = range.start().line(), .column = range.start().column(), .length = range.columnWidth(), .text = QString()});
+                } else {
+                    doc()->removeText(range);
+                }
                 c.clearSelection();
             }
         }
+        if (!replacements.empty()) {
+            doc()->editReplaceText(std::move(replacements));
+        }
+
         completionWidget()->setIgnoreBufferSignals(false);
     }
 
@@ -3332,10 +3350,10 @@ bool KTextEditor::ViewPrivate::removeSecondaryCursors(const std::vector<KTextEdi
         m_secondaryCursors.erase(std::remove_if(m_secondaryCursors.begin(),
                                                 m_secondaryCursors.end(),
                                                 [&](const SecondaryCursor &c) {
-                                                    auto it = std::find_if(cursorsToRemove.begin(), cursorsToRemove.end(), [&c](KTextEditor::Cursor pos) {
-                                                        return c.cursor() == pos || (c.range && c.range->contains(pos));
-                                                    });
-                                                    const bool match = it != cursorsToRemove.end();
+                                                    // cursorsToRemove is sorted, only look at the ones inside of the selection
+                                                    const KTextEditor::Range range = c.range ? c.range->toRange() : KTextEditor::Range(c.cursor(), c.cursor());
+                                                    auto it = std::lower_bound(cursorsToRemove.begin(), cursorsToRemove.end(), range.start());
+                                                    const bool match = it != cursorsToRemove.end() && (*it == c.cursor() || (c.range && c.range->contains(*it)));
                                                     if (match) {
                                                         linesToTag.push_back(c.cursor());
                                                     }
@@ -3346,10 +3364,7 @@ bool KTextEditor::ViewPrivate::removeSecondaryCursors(const std::vector<KTextEdi
         m_secondaryCursors.erase(std::remove_if(m_secondaryCursors.begin(),
                                                 m_secondaryCursors.end(),
                                                 [&](const SecondaryCursor &c) {
-                                                    auto it = std::find_if(cursorsToRemove.begin(), cursorsToRemove.end(), [&c](KTextEditor::Cursor pos) {
-                                                        return c.cursor() == pos;
-                                                    });
-                                                    const bool match = it != cursorsToRemove.end();
+                                                    const bool match = std::binary_search(cursorsToRemove.begin(), cursorsToRemove.end(), c.cursor());
                                                     if (match) {
                                                         linesToTag.push_back(c.cursor());
                                                     }
@@ -3900,9 +3915,27 @@ bool KTextEditor::ViewPrivate::isLineRTL(int line) const
 const QTextLayout *KTextEditor::ViewPrivate::textLayout(const KTextEditor::Cursor pos) const
 {
     KateLineLayout *thisLine = m_viewInternal->cache()->line(pos.line());
+
+    // the layout free fast path has no text to show
+    if (thisLine && thisLine->isGeometryOnly()) {
+        m_renderer->layoutLine(m_doc->kateTextLine(pos.line()), thisLine, -1, false);
+    }
+
     return thisLine && thisLine->isValid() ? &thisLine->layout() : nullptr;
 }
 
+int KTextEditor::ViewPrivate::nextCursorPosition(const KTextEditor::Cursor pos) const
+{
+    KateLineLayout *thisLine = m_viewInternal->cache()->line(pos.line());
+    return thisLine && thisLine->isValid() ? thisLine->nextCursorPosition(pos.column()) : pos.column() + 1;
+}
+
+int KTextEditor::ViewPrivate::previousCursorPosition(const KTextEditor::Cursor pos) const
+{
+    KateLineLayout *thisLine = m_viewInternal->cache()->line(pos.line());
+    return thisLine && thisLine->isValid() ? thisLine->previousCursorPosition(pos.column()) : pos.column() - 1;
+}
+
 void KTextEditor::ViewPrivate::indent()
 {
     if (blockSelect && selection()) {
@@ -5071,14 +5104,21 @@ void KTextEditor::ViewPrivate::exportHtmlToFile(const QString &file)
 
 void KTextEditor::ViewPrivate::exportHtmlToClipboard()
 {
-    KateExporter(this).exportToClipboard();
+    // in chunks, a huge selection shall not block the UI
+    auto *exporter = new KateExporter(this);
+    exporter->setExportInChunks(true);
+    connect(exporter, &KateExporter::finished, exporter, &QObject::deleteLater);
+    exporter->exportToClipboard();
 }
 
 void KTextEditor::ViewPrivate::exportHtmlToFile()
 {
     const QString file = QFileDialog::getSaveFileName(this, i18n("Export File as HTML"), doc()->documentName());
     if (!file.isEmpty()) {
-        KateExporter(this).exportToFile(file);
+        auto *exporter = new KateExporter(this);
+        exporter->setExportInChunks(true);
+        connect(exporter, &KateExporter::finished, exporter, &QObject::deleteLater);
+        exporter->exportToFile(file);
     }
 }
 
@@ -5215,6 +5255,7 @@ void KTextEditor::ViewPrivate::registerInlineNoteProvider(KTextEditor::InlineNot
 
         connect(provider, &KTextEditor::InlineNoteProvider::inlineNotesReset, this, &KTextEditor::ViewPrivate::inlineNotesReset);
         connect(provider, &KTextEditor::InlineNoteProvider::inlineNotesChanged, this, &KTextEditor::ViewPrivate::inlineNotesLineChanged);
+        connect(provider, &KTextEditor::InlineNoteProvider::inlineNotesRangeChanged, this, &KTextEditor::ViewPrivate::inlineNotesRangeChanged);
 
         inlineNotesReset();
     }
@@ -5233,19 +5274,60 @@ void KTextEditor::ViewPrivate::unregisterInlineNoteProvider(KTextEditor::InlineN
 
 QVarLengthArray<KateInlineNoteData, 8> KTextEditor::ViewPrivate::inlineNotes(int line) const
 {
-    QVarLengthArray<KateInlineNoteData, 8> allInlineNotes;
-    for (KTextEditor::InlineNoteProvider *provider : m_inlineNoteProviders) {
-        int index = 0;
-        const auto columns = provider->inlineNotes(line);
-        for (int column : columns) {
-            const bool underMouse = Cursor(line, column) == m_viewInternal->m_activeInlineNote.m_position;
-            KateInlineNoteData note =
-                {provider, this, {line, column}, index, underMouse, m_viewInternal->renderer()->currentFont(), m_viewInternal->renderer()->lineHeight()};
-            allInlineNotes.append(note);
-            index++;
+    if (m_inlineNoteProviders.empty()) {
+        return {};
+    }
+
+    // the notes are measured with the current font, start over if that changed
+    const QFont &font = m_viewInternal->renderer()->currentFont();
+    const int lineHeight = m_viewInternal->renderer()->lineHeight();
+    if (lineHeight != m_inlineNotesLineHeight || font != m_inlineNotesFont) {
+        m_inlineNotesCache.clear();
+        m_inlineNotesFont = font;
+        m_inlineNotesLineHeight = lineHeight;
+    }
+
+    // query the providers only once per line, painting and cursor movement ask a lot
+    auto it = m_inlineNotesCache.find(line);
+    if (it == m_inlineNotesCache.end()) {
+        pruneInlineNotesCache();
+
+        std::vector<KateInlineNoteData> allInlineNotes;
+        for (KTextEditor::InlineNoteProvider *provider : m_inlineNoteProviders) {
+            int index = 0;
+            const auto columns = provider->inlineNotes(line);
+            for (int column : columns) {
+                const bool underMouse = Cursor(line, column) == m_viewInternal->m_activeInlineNote.m_position;
+                KateInlineNoteData note = {provider, this, {line, column}, index, underMouse, font, lineHeight};
+                note.m_width = provider->inlineNoteSize(KTextEditor::InlineNote(note)).width();
+                allInlineNotes.push_back(note);
+                index++;
+            }
         }
+        it = m_inlineNotesCache.emplace(line, std::move(allInlineNotes)).first;
     }
-    return allInlineNotes;
+    return QVarLengthArray<KateInlineNoteData, 8>(it->second.cbegin(), it->second.cend());
+}
+
+void KTextEditor::ViewPrivate::pruneInlineNotesCache() const
+{
+    // keep the lines around the visible ones, after scrolling far the others are unlikely to be asked for again
+    const int visibleLines = qMax(m_viewInternal->linesDisplayed(), 1);
+    if (m_inlineNotesCache.size() <= size_t(InlineNotesCacheLinesPerScreen * visibleLines)) {
+        return;
+    }
+
+    const int startLine = firstDisplayedLineInternal(RealLine) - visibleLines;
+    const int endLine = lastDisplayedLineInternal(RealLine) + visibleLines;
+    m_inlineNotesCache.erase(m_inlineNotesCache.begin(), m_inlineNotesCache.lower_bound(startLine));
+    m_inlineNotesCache.erase(m_inlineNotesCache.upper_bound(endLine), m_inlineNotesCache.end());
+}
+
+void KTextEditor::ViewPrivate::invalidateInlineNotes(KTextEditor::LineRange lineRange, bool linesFollowing)
+{
+    const auto begin = m_inlineNotesCache.lower_bound(lineRange.start());
+    const auto end = linesFollowing ? m_inlineNotesCache.end() : m_inlineNotesCache.upper_bound(lineRange.end());
+    m_inlineNotesCache.erase(begin, end);
 }
 
 QRect KTextEditor::ViewPrivate::inlineNoteRect(const KateInlineNoteData &note) const
@@ -5256,15 +5338,26 @@ QRect KTextEditor::ViewPrivate::inlineNoteRect(const KateInlineNoteData &note) c
 void KTextEditor::ViewPrivate::inlineNotesReset()
 {
     m_viewInternal->m_activeInlineNote = {};
+    m_inlineNotesCache.clear();
     tagLines(KTextEditor::LineRange(0, doc()->lastLine()), true);
 }
 
 void KTextEditor::ViewPrivate::inlineNotesLineChanged(int line)
 {
-    if (line == m_viewInternal->m_activeInlineNote.m_position.line()) {
+    inlineNotesRangeChanged({line, line});
+}
+
+void KTextEditor::ViewPrivate::inlineNotesRangeChanged(KTextEditor::LineRange lineRange)
+{
+    if (!lineRange.isValid()) {
+        return;
+    }
+
+    if (lineRange.contains(m_viewInternal->m_activeInlineNote.m_position.line())) {
         m_viewInternal->m_activeInlineNote = {};
     }
-    tagLines({line, line}, true);
+    invalidateInlineNotes(lineRange);
+    tagLines(lineRange, true);
 }
 
 // END Inline Note Interface
@@ -19,7 +19,10 @@
 #include <QTimer>
 
 #include <array>
+#include <map>
 
+#include "inlinenotedata.h"
+#include "kateperf.h"
 #include "katetextfolding.h"
 #include "katetextrange.h"
 
@@ -394,12 +397,43 @@ public:
 
     QVarLengthArray<KateInlineNoteData, 8> inlineNotes(int line) const;
 
+    /**
+     * Drop the cached inline notes of the given lines, they are queried again on next use.
+     * @param lineRange lines to drop
+     * @param linesFollowing also drop all lines behind the range, e.g. after lines got inserted or removed
+     */
+    void invalidateInlineNotes(KTextEditor::LineRange lineRange, bool linesFollowing = false);
+
 private:
+    /**
+     * Drop the cached inline notes of lines far away from the visible ones once the cache grew too big.
+     */
+    void pruneInlineNotesCache() const;
+
     std::vector<KTextEditor::InlineNoteProvider *> m_inlineNoteProviders;
 
+    /**
+     * inline notes of all providers by line, with measured widths, filled on demand
+     * most lines have no notes, unlike an inline buffer an empty vector costs next to nothing
+     */
+    mutable std::map<int, std::vector<KateInlineNoteData>> m_inlineNotesCache;
+
+    /**
+     * the cache is pruned to the visible lines and one screen above and below once it holds more lines
+     * than this many screens
+     */
+    static constexpr int InlineNotesCacheLinesPerScreen = 8;
+
+    /**
+     * font and line height the cached notes were measured with
+     */
+    mutable QFont m_inlineNotesFont;
+    mutable int m_inlineNotesLineHeight = -1;
+
 private Q_SLOTS:
     void inlineNotesReset();
     void inlineNotesLineChanged(int line);
+    void inlineNotesRangeChanged(KTextEditor::LineRange lineRange);
 
     //
     // KTextEditor::SelectionInterface stuff
@@ -549,6 +583,13 @@ public:
 
     const QTextLayout *textLayout(const KTextEditor::Cursor pos) const;
 
+    /**
+     * Next/previous valid cursor position in the line of @p pos,
+     * e.g. to not split surrogate pairs or combining characters.
+     */
+    int nextCursorPosition(const KTextEditor::Cursor pos) const;
+    int previousCursorPosition(const KTextEditor::Cursor pos) const;
+
 public Q_SLOTS:
     void indent();
     void unIndent();
@@ -1279,6 +1320,18 @@ private:
     // for showSearchWrappedHint()
     QPointer<KTextEditor::Message> m_wrappedMessage;
     bool m_isLastSearchReversed = false;
+
+public:
+    /**
+     * Performance counters of this view, see KATE_PERF_SCOPE.
+     */
+    KatePerf::Counters &perfCounters()
+    {
+        return m_perfCounters;
+    }
+
+private:
+    KatePerf::Counters m_perfCounters;
 };
 
 }
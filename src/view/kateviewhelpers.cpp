@@ -379,7 +379,7 @@ bool KateScrollBar::eventFilter(QObject *object, QEvent *event)
 
 void KateScrollBar::paintEvent(QPaintEvent *e)
 {
-    if (m_doc->marks().size() != m_lines.size()) {
+    if (m_doc->markIndex().size() != m_lines.size()) {
         recomputeMarksPositions();
     }
     if (m_showMiniMap) {
@@ -1080,9 +1080,7 @@ void KateScrollBar::recomputeMarksPositions()
 
     // now repopulate the scrollbar lines list
     m_lines.clear();
-    const QHash<int, KTextEditor::Mark *> &marks = m_doc->marks();
-    for (QHash<int, KTextEditor::Mark *>::const_iterator i = marks.constBegin(); i != marks.constEnd(); ++i) {
-        KTextEditor::Mark *mark = i.value();
+    for (KTextEditor::Mark *mark : m_doc->markIndex().marks()) {
         const int line = m_view->textFolding().lineToVisibleLine(mark->line);
         const double ratio = static_cast<double>(line) / visibleLines;
         const QColor markColor = mark->type == KTextEditor::Document::SearchMatch
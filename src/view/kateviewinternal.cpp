@@ -586,7 +586,11 @@ void KateViewInternal::scrollColumns(int x)
     int dx = m_startX - x;
     m_startX = x;
 
-    if (qAbs(dx) < width()) {
+    if (cache()->relayoutLongLines(m_startX, m_startX + width())) {
+        // we scrolled out of the laid out part of some long line
+        updateView(true);
+        update();
+    } else if (qAbs(dx) < width()) {
         // scroll excluding child widgets (floating notifications)
         scroll(dx, 0, rect());
     } else {
@@ -850,11 +854,11 @@ QPoint KateViewInternal::cursorToCoordinate(const KTextEditor::Cursor cursor, bo
     // only set x value if we have a valid layout (bug #171027)
     if (layout.isValid()) {
         if (!layout.isRightToLeft() || (layout.isRightToLeft() && view()->dynWordWrap())) {
-            x = (int)layout.lineLayout().cursorToX(cursor.column());
+            x = (int)layout.cursorToX(cursor.column());
         } else /* rtl + dynWordWrap == false */ {
             // if text is rtl and dynamic wrap is false, the x offsets are in the opposite
             // direction i.e., [0] == biggest offset, [1] = next
-            x = (int)layout.lineLayout().cursorToX(textLength - cursor.column());
+            x = (int)layout.cursorToX(textLength - cursor.column());
         }
     }
     //  else
@@ -1026,13 +1030,13 @@ public:
                 }
 
             } else {
-                m_cursor.setColumn(thisLine->layout().nextCursorPosition(column()));
+                m_cursor.setColumn(thisLine->nextCursorPosition(column()));
             }
         } else {
             if (column() >= lineLength) {
                 m_cursor.setColumn(column() - 1);
             } else if (column() > 0) {
-                m_cursor.setColumn(thisLine->layout().previousCursorPosition(column()));
+                m_cursor.setColumn(thisLine->previousCursorPosition(column()));
             }
         }
 
@@ -1064,7 +1068,7 @@ public:
                 m_cursor.setColumn(0);
                 m_cursor.setLine(line() + 1);
             } else {
-                m_cursor.setColumn(thisLine->layout().nextCursorPosition(column()));
+                m_cursor.setColumn(thisLine->nextCursorPosition(column()));
             }
         } else {
             if (column() == 0) {
@@ -1080,7 +1084,7 @@ public:
                 if (column() > m_vi->doc()->lineLength(thisLine->line())) {
                     m_cursor.setColumn(column() - 1);
                 } else {
-                    m_cursor.setColumn(thisLine->layout().previousCursorPosition(column()));
+                    m_cursor.setColumn(thisLine->previousCursorPosition(column()));
                 }
             }
         }
@@ -2624,6 +2628,15 @@ void KateViewInternal::mergeSelections()
 
 void KateViewInternal::updateCursor(const KTextEditor::Cursor newCursor, bool force, bool center, bool calledExternally, bool scroll)
 {
+    // only remember the position, endBatchedCursorUpdates() does the rest once
+    if (m_batchedCursorUpdates > 0) {
+        view()->textFolding().ensureLineIsVisible(newCursor.line());
+        m_displayCursor = toVirtualCursor(newCursor);
+        m_cursor.setPosition(newCursor);
+        m_batchedCursorMoved = true;
+        return;
+    }
+
     if (!force && (m_cursor.toCursor() == newCursor)) {
         m_displayCursor = toVirtualCursor(newCursor);
         if (scroll && !m_madeVisible && m_view == doc()->activeView()) {
@@ -3633,7 +3646,7 @@ KTextEditor::Cursor KateViewInternal::coordinatesToCursor(QPoint coord, KTextEdi
     const KateTextLayout &thisLine = yToKateTextLayout(coord.y());
     if (thisLine.isValid()) {
         if (flags & KTextEditor::View::InvalidCursorOutsideText) {
-            if (coord.x() < 0 || coord.x() > thisLine.lineLayout().naturalTextWidth()) {
+            if (coord.x() < 0 || coord.x() > thisLine.width()) {
                 return ret;
             }
         }
@@ -3661,6 +3674,7 @@ void KateViewInternal::mouseMoveEvent(QMouseEvent *e)
         if (noteData.m_position.isValid()) {
             if (!m_activeInlineNote.m_position.isValid()) {
                 // no active note -- focus in
+                view()->invalidateInlineNotes({noteData.m_position.line(), noteData.m_position.line()});
                 tagLine(noteData.m_position);
                 focusChanged = true;
                 noteData.m_underMouse = true;
@@ -3670,6 +3684,7 @@ void KateViewInternal::mouseMoveEvent(QMouseEvent *e)
                 noteData.m_provider->inlineNoteMouseMoveEvent(KTextEditor::InlineNote(noteData), e->globalPosition().toPoint());
             }
         } else if (m_activeInlineNote.m_position.isValid()) {
+            view()->invalidateInlineNotes({m_activeInlineNote.m_position.line(), m_activeInlineNote.m_position.line()});
             tagLine(m_activeInlineNote.m_position);
             focusChanged = true;
             m_activeInlineNote.m_underMouse = false;
@@ -3811,6 +3826,8 @@ void KateViewInternal::hideEvent(QHideEvent *e)
 
 void KateViewInternal::paintEvent(QPaintEvent *e)
 {
+    KATE_PERF_SCOPE(view()->perfCounters(), "paint");
+
     if (debugPainting) {
         qCDebug(LOG_KTE) << "GOT PAINT EVENT: Region" << e->region();
     }
@@ -4534,6 +4551,26 @@ void KateViewInternal::editSetCursor(const KTextEditor::Cursor _cursor)
 }
 // END
 
+// BEGIN BATCHED CURSOR UPDATES
+void KateViewInternal::beginBatchedCursorUpdates()
+{
+    m_batchedCursorUpdates++;
+}
+
+void KateViewInternal::endBatchedCursorUpdates()
+{
+    Q_ASSERT(m_batchedCursorUpdates > 0);
+    if (--m_batchedCursorUpdates > 0 || !m_batchedCursorMoved) {
+        return;
+    }
+
+    m_batchedCursorMoved = false;
+    m_madeVisible = false;
+    m_leftBorder->updateForCursorLineChange();
+    updateCursor(m_cursor.toCursor(), true);
+}
+// END
+
 void KateViewInternal::viewSelectionChanged()
 {
     if (!view()->selection()) {
@@ -103,6 +103,22 @@ private:
     KTextEditor::Range editOldSelection;
     // END
 
+    // BEGIN BATCHED CURSOR UPDATES
+public:
+    /**
+     * Batch the cursor updates of replayed input, e.g. vi macros.
+     * The cursor position is still changed at once, but scrolling, repainting and
+     * cursorPositionChanged() are done once by the outermost endBatchedCursorUpdates().
+     * Inside of a batch, the visible lines are the ones from before the batch.
+     */
+    void beginBatchedCursorUpdates();
+    void endBatchedCursorUpdates();
+
+private:
+    int m_batchedCursorUpdates = 0;
+    bool m_batchedCursorMoved = false;
+    // END
+
     // BEGIN TAG & CLEAR & UPDATE STUFF
 public:
     bool tagLine(const KTextEditor::Cursor virtualCursor);
@@ -141,6 +157,12 @@ public:
     KTextEditor::Cursor endPos() const;
     int endLine() const;
 
+    // horizontal scroll position
+    int startX() const
+    {
+        return m_startX;
+    }
+
     KateTextLayout yToKateTextLayout(int y) const;
 
     void dynWrapChanged();
@@ -365,6 +365,11 @@ void EmulatedCommandBar::startHideExitStatusMessageTimer()
     }
 }
 
+void EmulatedCommandBar::updateMatchHighlightColors()
+{
+    m_matchHighligher->updateMatchHighlightAttrib();
+}
+
 void EmulatedCommandBar::setViInputModeManager(InputModeManager *viInputModeManager)
 {
     m_viInputModeManager = viInputModeManager;
@@ -56,6 +56,11 @@ public:
 
     void setViInputModeManager(InputModeManager *viInputModeManager);
 
+    /**
+     * The colors of the renderer changed, e.g. another theme.
+     */
+    void updateMatchHighlightColors();
+
 private:
     KateViInputMode *m_viInputMode;
     InputModeManager *m_viInputModeManager;
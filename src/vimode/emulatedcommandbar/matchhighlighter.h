@@ -26,8 +26,6 @@ public:
     explicit MatchHighlighter(KTextEditor::ViewPrivate *view);
     ~MatchHighlighter() override;
     void updateMatchHighlight(KTextEditor::Range matchRange);
-
-private:
     void updateMatchHighlightAttrib();
 
 private:
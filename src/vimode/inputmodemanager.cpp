@@ -150,6 +150,14 @@ bool InputModeManager::handleKeypress(const QKeyEvent *e)
 
 void InputModeManager::feedKeyPresses(const QString &keyPresses) const
 {
+    feedKeyEvents(decodeKeyPresses(keyPresses));
+}
+
+QList<KeyEvent> InputModeManager::decodeKeyPresses(const QString &keyPresses)
+{
+    QList<KeyEvent> keyEvents;
+    keyEvents.reserve(keyPresses.size());
+
     int key;
     Qt::KeyboardModifiers mods;
     QString text;
@@ -211,9 +219,18 @@ void InputModeManager::feedKeyPresses(const QString &keyPresses) const
             continue;
         }
 
+        keyEvents.append(KeyEvent::keyPress(key, mods, text));
+    }
+
+    return keyEvents;
+}
+
+void InputModeManager::feedKeyEvents(const QList<KeyEvent> &keyEvents) const
+{
+    for (const KeyEvent &keyEvent : keyEvents) {
         // We have to be clever about which widget we dispatch to, as we can trigger
         // shortcuts if we're not careful (even if Vim mode is configured to steal shortcuts).
-        QKeyEvent k(QEvent::KeyPress, key, mods, text);
+        QKeyEvent k(keyEvent.type(), keyEvent.key(), keyEvent.modifiers(), keyEvent.text());
         QWidget *destWidget = nullptr;
         if (QApplication::activePopupWidget()) {
             // According to the docs, the activePopupWidget, if present, takes all events.
@@ -231,6 +248,24 @@ void InputModeManager::feedKeyPresses(const QString &keyPresses) const
     }
 }
 
+void InputModeManager::beginBatchedExecution()
+{
+    if (m_batchedExecutionCount++ == 0) {
+        m_viewInternal->beginBatchedCursorUpdates();
+    }
+}
+
+void InputModeManager::endBatchedExecution()
+{
+    Q_ASSERT(m_batchedExecutionCount > 0);
+    if (--m_batchedExecutionCount > 0) {
+        return;
+    }
+
+    m_viewInternal->endBatchedCursorUpdates();
+    Q_EMIT m_view->viewModeChanged(m_view, m_inputAdapter->viewMode());
+}
+
 bool InputModeManager::isHandlingKeypress() const
 {
     return m_insideHandlingKeyPressCount > 0;
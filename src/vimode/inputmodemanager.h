@@ -16,6 +16,7 @@
 
 #include <vimode/completion.h>
 #include <vimode/definitions.h>
+#include <vimode/keyevent.h>
 
 class KConfigGroup;
 class KateViewInternal;
@@ -71,6 +72,34 @@ public:
      */
     void feedKeyPresses(const QString &keyPresses) const;
 
+    /**
+     * decode the given (encoded) key presses once, e.g. a macro that is replayed several times
+     */
+    static QList<KeyEvent> decodeKeyPresses(const QString &keyPresses);
+
+    /**
+     * feed the given decoded key presses to the key handling code, one by one
+     */
+    void feedKeyEvents(const QList<KeyEvent> &keyEvents) const;
+
+    /**
+     * Batched execution of replayed keys: the cursor moves still happen at once, but
+     * scrolling, repainting and the cursor and view mode change signals are deferred
+     * until the outermost endBatchedExecution().
+     * Used for macros and repeated changes, the keys are not typed by the user.
+     * Commands depending on the visible lines, like H or zz, see the view from before the batch.
+     */
+    void beginBatchedExecution();
+    void endBatchedExecution();
+
+    /**
+     * @return true if we are inside beginBatchedExecution() / endBatchedExecution()
+     */
+    bool isExecutingBatch() const
+    {
+        return m_batchedExecutionCount > 0;
+    }
+
     /**
      * Determines whether we are currently processing a Vi keypress
      * @return true if we are still in a call to handleKeypress, false otherwise
@@ -249,6 +278,8 @@ private:
 
     int m_insideHandlingKeyPressCount;
 
+    int m_batchedExecutionCount = 0;
+
     /**
      * a list of the (encoded) key events that was part of the last change.
      */
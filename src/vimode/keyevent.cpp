@@ -36,3 +36,13 @@ KeyEvent KeyEvent::fromQKeyEvent(const QKeyEvent &e)
     keyEvent.m_text = e.text();
     return keyEvent;
 }
+
+KeyEvent KeyEvent::keyPress(int key, Qt::KeyboardModifiers modifiers, const QString &text)
+{
+    KeyEvent keyEvent;
+    keyEvent.m_type = QEvent::KeyPress;
+    keyEvent.m_modifiers = modifiers;
+    keyEvent.m_key = key;
+    keyEvent.m_text = text;
+    return keyEvent;
+}
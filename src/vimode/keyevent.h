@@ -24,6 +24,7 @@ public:
     QString text() const;
 
     static KeyEvent fromQKeyEvent(const QKeyEvent &e);
+    static KeyEvent keyPress(int key, Qt::KeyboardModifiers modifiers, const QString &text);
 
 private:
     QEvent::Type m_type = QEvent::None;
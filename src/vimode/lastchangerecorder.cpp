@@ -98,8 +98,10 @@ bool LastChangeRecorder::isReplaying() const
 void LastChangeRecorder::replay(const QString &commands, const CompletionList &completions)
 {
     m_isReplaying = true;
+    m_viInputModeManager->beginBatchedExecution();
     m_viInputModeManager->completionReplayer()->start(completions);
-    m_viInputModeManager->feedKeyPresses(commands);
+    m_viInputModeManager->feedKeyEvents(InputModeManager::decodeKeyPresses(commands));
     m_viInputModeManager->completionReplayer()->stop();
+    m_viInputModeManager->endBatchedExecution();
     m_isReplaying = false;
 }
@@ -8,6 +8,7 @@
 #include "completionrecorder.h"
 #include "completionreplayer.h"
 #include "globalstate.h"
+#include "katedocument.h"
 #include "kateview.h"
 #include "lastchangerecorder.h"
 #include "macros.h"
@@ -68,22 +69,28 @@ void MacroRecorder::dropLast()
     }
 }
 
-void MacroRecorder::replay(const QChar &macroRegister)
+void MacroRecorder::replay(const QChar &macroRegister, unsigned int count)
 {
     const QChar reg = (macroRegister == LastPlayedRegister) ? m_lastPlayedMacroRegister : macroRegister;
 
     m_lastPlayedMacroRegister = reg;
-    const QString macroAsFeedableKeypresses = m_viInputModeManager->globalState()->macros()->get(reg);
-
-    std::shared_ptr<KeyMapper> mapper(new KeyMapper(m_viInputModeManager, m_viInputModeManager->view()->doc()));
-    CompletionList completions = m_viInputModeManager->globalState()->macros()->getCompletions(reg);
+    const QList<KeyEvent> macroKeyEvents = InputModeManager::decodeKeyPresses(m_viInputModeManager->globalState()->macros()->get(reg));
+    const CompletionList completions = m_viInputModeManager->globalState()->macros()->getCompletions(reg);
 
+    KTextEditor::DocumentPrivate *doc = m_viInputModeManager->view()->doc();
     m_macrosBeingReplayedCount++;
-    m_viInputModeManager->completionReplayer()->start(completions);
-    m_viInputModeManager->pushKeyMapper(mapper);
-    m_viInputModeManager->feedKeyPresses(macroAsFeedableKeypresses);
-    m_viInputModeManager->popKeyMapper();
-    m_viInputModeManager->completionReplayer()->stop();
+    m_viInputModeManager->beginBatchedExecution();
+    doc->editStart();
+    for (unsigned int i = 0; i < count; i++) {
+        std::shared_ptr<KeyMapper> mapper(new KeyMapper(m_viInputModeManager, doc));
+        m_viInputModeManager->completionReplayer()->start(completions);
+        m_viInputModeManager->pushKeyMapper(mapper);
+        m_viInputModeManager->feedKeyEvents(macroKeyEvents);
+        m_viInputModeManager->popKeyMapper();
+        m_viInputModeManager->completionReplayer()->stop();
+    }
+    doc->editEnd();
+    m_viInputModeManager->endBatchedExecution();
     m_macrosBeingReplayedCount--;
 }
 
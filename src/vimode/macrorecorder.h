@@ -30,7 +30,12 @@ public:
     void record(const QKeyEvent &event);
     void dropLast();
 
-    void replay(const QChar &macroRegister);
+    /**
+     * Replay the macro in @p macroRegister @p count times.
+     * The macro is decoded once and all repetitions run as one batched edit,
+     * the view is only scrolled and repainted at the end.
+     */
+    void replay(const QChar &macroRegister, unsigned int count = 1);
     bool isReplaying() const;
 
 private:
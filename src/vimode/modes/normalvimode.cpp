@@ -1898,11 +1898,7 @@ bool NormalViMode::commandReplayMacro()
     const QChar reg = m_keys[m_keys.size() - 1];
     const unsigned int count = getCount();
     resetParser();
-    doc()->editStart();
-    for (unsigned int i = 0; i < count; i++) {
-        m_viInputModeManager->macroRecorder()->replay(reg);
-    }
-    doc()->editEnd();
+    m_viInputModeManager->macroRecorder()->replay(reg, count);
     return true;
 }
 
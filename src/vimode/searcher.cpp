@@ -7,22 +7,21 @@
 #include "searcher.h"
 #include "globalstate.h"
 #include "history.h"
-#include "kateconfig.h"
+#include "katebuffer.h"
 #include "katedocument.h"
 #include "kateview.h"
 #include <vimode/inputmodemanager.h>
 #include <vimode/modes/modebase.h>
 
+#include <algorithm>
+#include <cstdlib>
+
 using namespace KateVi;
 
 Searcher::Searcher(InputModeManager *manager)
     : m_viInputModeManager(manager)
     , m_view(manager->view())
-    , m_lastHlSearchRange(KTextEditor::Range::invalid())
-    , highlightMatchAttribute(new KTextEditor::Attribute())
 {
-    updateHighlightColors();
-
     if (m_hlMode == HighlightMode::Enable) {
         connectSignals();
     }
@@ -31,7 +30,6 @@ Searcher::Searcher(InputModeManager *manager)
 Searcher::~Searcher()
 {
     disconnectSignals();
-    clearHighlights();
 }
 
 const QString Searcher::getLastSearchPattern() const
@@ -150,55 +148,160 @@ void Searcher::highlightVisibleResults(const SearchParams &searchParams, bool fo
     if (newPattern && searchParams.pattern.isEmpty())
         return;
 
-    auto vr = m_view->visibleRange();
-
     const SearchParams &l = searchParams;
     const SearchParams &r = m_lastHlSearchConfig;
 
-    if (!force && l.pattern == r.pattern && l.isCaseSensitive == r.isCaseSensitive && vr == m_lastHlSearchRange) {
+    if (!force && m_hlActive && l.pattern == r.pattern && l.isCaseSensitive == r.isCaseSensitive) {
         return;
     }
 
     m_lastHlSearchConfig = searchParams;
-    m_lastHlSearchRange = vr;
-
-    clearHighlights();
 
-    KTextEditor::SearchOptions flags = KTextEditor::Regex;
     m_lastSearchWrapped = false;
 
-    const QString &pattern = searchParams.pattern;
+    // matches are searched lazily by the renderer via highlightsForLine()
+    const KateRegExpSearchPattern &pattern = regExpPattern(searchParams);
+    if (!m_hlActive || m_hlPattern.pattern() != pattern.pattern() || m_hlPattern.options() != pattern.options()) {
+        m_hlPattern = pattern;
+        m_hlBlocks.clear();
+    }
+    m_hlActive = true;
+    repaintHighlights();
+}
+
+QList<KTextEditor::Range> Searcher::highlightsForLine(int line)
+{
+    KTextEditor::DocumentPrivate *doc = m_view->doc();
+    if (!m_hlActive || !m_hlPattern.isValid() || line < 0 || line >= doc->lines()) {
+        return {};
+    }
+
+    // the renderer asks for the lines top down, search a block of lines at once
+    const qint64 revision = doc->buffer().revision();
+    const int block = line / HighlightBlockLines;
+    const auto it = m_hlBlocks.find(block);
+    if (it != m_hlBlocks.end() && it->revision == revision) {
+        return it->lines[line - block * HighlightBlockLines];
+    }
+
+    // don't grow without limits while scrolling through huge documents,
+    // drop outdated blocks and else the one farthest away
+    if (it == m_hlBlocks.end() && m_hlBlocks.size() >= MaxHighlightBlocks) {
+        m_hlBlocks.removeIf([revision](const QHash<int, HighlightBlock>::iterator &entry) {
+            return entry->revision != revision;
+        });
+        if (m_hlBlocks.size() >= MaxHighlightBlocks) {
+            auto farthest = m_hlBlocks.begin();
+            for (auto candidate = m_hlBlocks.begin(); candidate != m_hlBlocks.end(); ++candidate) {
+                if (std::abs(candidate.key() - block) > std::abs(farthest.key() - block)) {
+                    farthest = candidate;
+                }
+            }
+            m_hlBlocks.erase(farthest);
+        }
+    }
+
+    HighlightBlock &entry = m_hlBlocks[block];
+    entry.revision = revision;
+    entry.lines.assign(HighlightBlockLines, {});
 
-    if (!searchParams.isCaseSensitive) {
-        flags |= KTextEditor::CaseInsensitive;
+    const int firstLine = block * HighlightBlockLines;
+    if (m_hlPattern.isMultiLine()) {
+        searchHighlightBlock(firstLine, entry.lines);
+        return entry.lines[line - firstLine];
     }
 
-    KTextEditor::Range match;
-    KTextEditor::Cursor current(vr.start());
+    // empty matches are highlighted as one character
+    const QRegularExpression &regex = m_hlPattern.regularExpression();
+    const int lastLine = std::min(firstLine + HighlightBlockLines, doc->lines()) - 1;
+    for (int l = firstLine; l <= lastLine; ++l) {
+        const QString text = doc->line(l);
+        QList<KTextEditor::Range> &ranges = entry.lines[l - firstLine];
+        int offset = 0;
+        while (offset <= text.size()) {
+            const QRegularExpressionMatch match = regex.matchView(text, offset);
+            if (!match.hasMatch()) {
+                break;
+            }
+            const int start = match.capturedStart();
+            const int end = std::max<int>(match.capturedEnd(), start + 1);
+            ranges.append(KTextEditor::Range(l, start, l, end));
+            offset = end;
+        }
+    }
+    return entry.lines[line - firstLine];
+}
 
-    do {
-        match = m_view->doc()->searchText(KTextEditor::Range(current, vr.end()), pattern, flags).first();
-        if (match.isValid()) {
-            if (match.isEmpty())
-                match = KTextEditor::Range(match.start(), 1);
+void Searcher::searchHighlightBlock(int firstLine, std::vector<QList<KTextEditor::Range>> &lines)
+{
+    // matches may span lines, the ones crossing the block borders start up to the line span
+    // in front of the block and end up to the line span behind it, for an unknown span anywhere
+    KTextEditor::DocumentPrivate *doc = m_view->doc();
+    const int lastLine = std::min(firstLine + HighlightBlockLines, doc->lines()) - 1;
+    const int span = m_hlPattern.lineSpan();
+    const int searchStartLine = (span < 0) ? 0 : std::max(0, firstLine - span);
+    const int searchEndLine = (span < 0) ? (doc->lines() - 1) : std::min(doc->lines() - 1, lastLine + span);
+
+    const KTextEditor::Cursor end(searchEndLine, doc->lineLength(searchEndLine));
+    KTextEditor::Cursor current(searchStartLine, 0);
+    while (current < end && current.line() <= lastLine) {
+        KTextEditor::Range match = doc->searchText(KTextEditor::Range(current, end), m_hlPattern).first();
+        if (!match.isValid() || match.start().line() > lastLine) {
+            break;
+        }
+        if (match.isEmpty()) {
+            match = KTextEditor::Range(match.start(), 1);
+        }
 
-            auto highlight = m_view->doc()->newMovingRange(match, Kate::TextRange::DoNotExpand);
-            highlight->setView(m_view);
-            highlight->setAttributeOnlyForViews(true);
-            highlight->setZDepth(-10000.0);
-            highlight->setAttribute(highlightMatchAttribute);
-            m_hlRanges.append(highlight);
+        // split into the parts on each line of the block
+        for (int l = std::max(match.start().line(), firstLine); l <= std::min(match.end().line(), lastLine); ++l) {
+            const int startColumn = (l == match.start().line()) ? match.start().column() : 0;
+            const int endColumn = (l == match.end().line()) ? match.end().column() : doc->lineLength(l);
+            lines[l - firstLine].append(KTextEditor::Range(l, startColumn, l, endColumn));
+        }
 
-            current = match.end();
+        current = match.end();
+        if (current.column() > doc->lineLength(current.line())) {
+            current = KTextEditor::Cursor(current.line() + 1, 0);
         }
-    } while (match.isValid() && current < vr.end());
+    }
+}
+
+void Searcher::repaintHighlights()
+{
+    // the highlights are part of the line layouts
+    const int lastLine = m_view->doc()->lines() - 1;
+    m_view->notifyAboutRangeChange(KTextEditor::LineRange(0, lastLine), true, nullptr);
+}
+
+void Searcher::repaintEditedHighlights()
+{
+    const int startLine = m_hlEditStartLine;
+    const int endLine = m_hlEditEndLine;
+    m_hlEditStartLine = m_hlEditEndLine = -1;
+    if (startLine < 0 || m_hlMode != HighlightMode::Enable || !m_hlActive || !m_hlPattern.isMultiLine()) {
+        return;
+    }
+
+    // a match can start span lines in front of the edit and end span lines behind it
+    const int span = m_hlPattern.lineSpan();
+    if (span < 0) {
+        repaintHighlights();
+        return;
+    }
+    const int lastLine = m_view->doc()->lines() - 1;
+    const KTextEditor::LineRange lines(std::max(0, startLine - span), std::min(lastLine, endLine + span));
+    if (lines.start() <= lines.end()) {
+        m_view->notifyAboutRangeChange(lines, true, nullptr);
+    }
 }
 
 void Searcher::clearHighlights()
 {
-    if (!m_hlRanges.empty()) {
-        qDeleteAll(m_hlRanges);
-        m_hlRanges.clear();
+    if (m_hlActive) {
+        m_hlActive = false;
+        m_hlBlocks.clear();
+        repaintHighlights();
     }
 }
 
@@ -210,15 +313,6 @@ void Searcher::hideCurrentHighlight()
     }
 }
 
-void Searcher::updateHighlightColors()
-{
-    const QColor foregroundColor = m_view->defaultStyleAttribute(KSyntaxHighlighting::Theme::TextStyle::Normal)->foreground().color();
-    const QColor &searchColor = m_view->rendererConfig()->searchHighlightColor();
-    // init match attribute
-    highlightMatchAttribute->setForeground(foregroundColor);
-    highlightMatchAttribute->setBackground(searchColor);
-}
-
 void Searcher::enableHighlightSearch(bool enable)
 {
     if (enable) {
@@ -241,22 +335,44 @@ bool Searcher::isHighlightSearchEnabled() const
 
 void Searcher::disconnectSignals()
 {
-    QObject::disconnect(m_displayRangeChangedConnection);
-    QObject::disconnect(m_textChangedConnection);
+    for (const QMetaObject::Connection &connection : m_textChangedConnections) {
+        QObject::disconnect(connection);
+    }
+    m_textChangedConnections.clear();
+    m_hlEditStartLine = m_hlEditEndLine = -1;
 }
 
 void Searcher::connectSignals()
 {
     disconnectSignals();
 
-    m_displayRangeChangedConnection = QObject::connect(m_view, &KTextEditor::View::displayRangeChanged, [this]() {
-        if (m_hlMode == HighlightMode::Enable)
-            highlightVisibleResults(m_lastHlSearchConfig);
-    });
-    m_textChangedConnection = QObject::connect(m_view->doc(), &KTextEditor::Document::textChanged, [this]() {
-        if (m_hlMode == HighlightMode::Enable)
-            highlightVisibleResults(m_lastHlSearchConfig, true);
-    });
+    // edits re-layout the changed lines and these ask again for their single-line matches,
+    // but multi-line matches might change in the lines around the edit, too
+    KTextEditor::DocumentPrivate *doc = m_view->doc();
+    auto addEditedLines = [this](int startLine, int endLine) {
+        if (m_hlEditStartLine < 0) {
+            m_hlEditStartLine = startLine;
+            m_hlEditEndLine = endLine;
+        } else {
+            m_hlEditStartLine = std::min(m_hlEditStartLine, startLine);
+            m_hlEditEndLine = std::max(m_hlEditEndLine, endLine);
+        }
+    };
+    m_textChangedConnections.push_back(
+        QObject::connect(doc, &KTextEditor::DocumentPrivate::textInsertedRange, [this, addEditedLines](KTextEditor::Document *, KTextEditor::Range range) {
+            // inserted lines move the lines edited before down
+            if (m_hlEditStartLine >= 0 && range.start().line() <= m_hlEditEndLine) {
+                m_hlEditEndLine += range.numberOfLines();
+            }
+            addEditedLines(range.start().line(), range.end().line());
+        }));
+    m_textChangedConnections.push_back(
+        QObject::connect(doc, &KTextEditor::Document::textRemoved, [addEditedLines](KTextEditor::Document *, KTextEditor::Range range, const QString &) {
+            addEditedLines(range.start().line(), range.start().line());
+        }));
+    m_textChangedConnections.push_back(QObject::connect(doc, &KTextEditor::Document::textChanged, [this]() {
+        repaintEditedHighlights();
+    }));
 }
 
 void Searcher::patternDone(bool wasAborted)
@@ -274,28 +390,29 @@ void Searcher::patternDone(bool wasAborted)
     newPattern = true;
 }
 
+const KateRegExpSearchPattern &Searcher::regExpPattern(const SearchParams &searchParams)
+{
+    const QRegularExpression::PatternOptions options =
+        searchParams.isCaseSensitive ? QRegularExpression::NoPatternOption : QRegularExpression::CaseInsensitiveOption;
+    if (m_regExp.pattern() != searchParams.pattern || m_regExp.options() != options) {
+        m_regExp = KateRegExpSearchPattern(searchParams.pattern, options);
+    }
+    return m_regExp;
+}
+
 KTextEditor::Range Searcher::findPatternWorker(const SearchParams &searchParams, const KTextEditor::Cursor startFrom, int count)
 {
     KTextEditor::Cursor searchBegin = startFrom;
-    KTextEditor::SearchOptions flags = KTextEditor::Regex;
     m_lastSearchWrapped = false;
 
-    const QString &pattern = searchParams.pattern;
+    const KateRegExpSearchPattern &pattern = regExpPattern(searchParams);
 
-    if (searchParams.isBackwards) {
-        flags |= KTextEditor::Backwards;
-    }
-    if (!searchParams.isCaseSensitive) {
-        flags |= KTextEditor::CaseInsensitive;
-    }
     KTextEditor::Range finalMatch;
     for (int i = 0; i < count; i++) {
         if (!searchParams.isBackwards) {
             const KTextEditor::Range matchRange =
                 m_view->doc()
-                    ->searchText(KTextEditor::Range(KTextEditor::Cursor(searchBegin.line(), searchBegin.column() + 1), m_view->doc()->documentEnd()),
-                                 pattern,
-                                 flags)
+                    ->searchText(KTextEditor::Range(KTextEditor::Cursor(searchBegin.line(), searchBegin.column() + 1), m_view->doc()->documentEnd()), pattern)
                     .first();
 
             if (matchRange.isValid()) {
@@ -303,7 +420,7 @@ KTextEditor::Range Searcher::findPatternWorker(const SearchParams &searchParams,
             } else {
                 // Wrap around.
                 const KTextEditor::Range wrappedMatchRange =
-                    m_view->doc()->searchText(KTextEditor::Range(m_view->doc()->documentRange().start(), m_view->doc()->documentEnd()), pattern, flags).first();
+                    m_view->doc()->searchText(KTextEditor::Range(m_view->doc()->documentRange().start(), m_view->doc()->documentEnd()), pattern).first();
                 if (wrappedMatchRange.isValid()) {
                     finalMatch = wrappedMatchRange;
                     m_lastSearchWrapped = true;
@@ -324,7 +441,7 @@ KTextEditor::Range Searcher::findPatternWorker(const SearchParams &searchParams,
             KTextEditor::Range bestMatch = KTextEditor::Range::invalid();
             while (true) {
                 QList<KTextEditor::Range> matchesUnfiltered =
-                    m_view->doc()->searchText(KTextEditor::Range(newSearchBegin, m_view->doc()->documentRange().start()), pattern, flags);
+                    m_view->doc()->searchText(KTextEditor::Range(newSearchBegin, m_view->doc()->documentRange().start()), pattern, true);
 
                 if (matchesUnfiltered.size() == 1 && !matchesUnfiltered.first().isValid()) {
                     break;
@@ -365,7 +482,7 @@ KTextEditor::Range Searcher::findPatternWorker(const SearchParams &searchParams,
                 finalMatch = matchRange;
             } else {
                 const KTextEditor::Range wrappedMatchRange =
-                    m_view->doc()->searchText(KTextEditor::Range(m_view->doc()->documentEnd(), m_view->doc()->documentRange().start()), pattern, flags).first();
+                    m_view->doc()->searchText(KTextEditor::Range(m_view->doc()->documentEnd(), m_view->doc()->documentRange().start()), pattern, true).first();
 
                 if (wrappedMatchRange.isValid()) {
                     finalMatch = wrappedMatchRange;
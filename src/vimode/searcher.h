@@ -7,17 +7,19 @@
 #ifndef KATEVI_SEARCHER_H
 #define KATEVI_SEARCHER_H
 
-#include "ktexteditor/attribute.h"
+#include "kateregexpsearch.h"
 #include "ktexteditor/range.h"
 #include <vimode/range.h>
 
+#include <QHash>
 #include <QString>
 
+#include <vector>
+
 namespace KTextEditor
 {
 class Cursor;
 class ViewPrivate;
-class MovingRange;
 }
 
 namespace KateVi
@@ -55,15 +57,28 @@ public:
     void enableHighlightSearch(bool enable);
     bool isHighlightSearchEnabled() const;
     void hideCurrentHighlight();
-    void updateHighlightColors();
     void clearHighlights();
     void patternDone(bool wasAborted);
 
+    /**
+     * Matches of the highlighted search in \p line, for the renderer.
+     * Results are cached per block of lines and only searched again after edits.
+     */
+    QList<KTextEditor::Range> highlightsForLine(int line);
+
 private:
     Range findPatternForMotion(const SearchParams &searchParams, const KTextEditor::Cursor startFrom, int count = 1);
     KTextEditor::Range findPatternWorker(const SearchParams &searchParams, const KTextEditor::Cursor startFrom, int count);
 
+    /**
+     * Compiled regular expression for the given search, reused until pattern or case sensitivity change.
+     */
+    const KateRegExpSearchPattern &regExpPattern(const SearchParams &searchParams);
+
     void highlightVisibleResults(const SearchParams &searchParams, bool force = false);
+    void searchHighlightBlock(int firstLine, std::vector<QList<KTextEditor::Range>> &lines);
+    void repaintHighlights();
+    void repaintEditedHighlights();
     void disconnectSignals();
     void connectSignals();
 
@@ -79,14 +94,31 @@ private:
 
     SearchParams m_lastSearchConfig;
     bool m_lastSearchWrapped;
+    KateRegExpSearchPattern m_regExp;
+
+    /**
+     * Matches of the highlighted search in a block of lines, one list per line.
+     * Valid for the buffer revision they were searched in.
+     */
+    struct HighlightBlock {
+        qint64 revision = -1;
+        std::vector<QList<KTextEditor::Range>> lines;
+    };
+
+    // number of lines searched together and bound for the lines in m_hlBlocks
+    static constexpr int HighlightBlockLines = 64;
+    static constexpr int MaxHighlightBlocks = 10000 / HighlightBlockLines;
 
     HighlightMode m_hlMode{HighlightMode::Enable};
-    QList<KTextEditor::MovingRange *> m_hlRanges;
+    bool m_hlActive = false;
+    KateRegExpSearchPattern m_hlPattern;
+    QHash<int, HighlightBlock> m_hlBlocks;
     SearchParams m_lastHlSearchConfig;
-    KTextEditor::Range m_lastHlSearchRange;
-    KTextEditor::Attribute::Ptr highlightMatchAttribute;
-    QMetaObject::Connection m_displayRangeChangedConnection;
-    QMetaObject::Connection m_textChangedConnection;
+    std::vector<QMetaObject::Connection> m_textChangedConnections;
+
+    // lines touched by the edits since the last textChanged(), -1 if none
+    int m_hlEditStartLine = -1;
+    int m_hlEditEndLine = -1;
     bool newPattern{true};
 };
 }